@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "Firestore/Source/Local/FSTLRUGarbageCollector.h"
+
+#import <XCTest/XCTest.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#import "Firestore/Source/Core/FSTQuery.h"
+#import "Firestore/Source/Local/FSTLevelDB.h"
+#import "Firestore/Source/Local/FSTLocalSerializer.h"
+#import "Firestore/Source/Local/FSTMemoryPersistence.h"
+#import "Firestore/Source/Local/FSTPersistence.h"
+#import "Firestore/Source/Local/FSTQueryData.h"
+#import "Firestore/Source/Model/FSTDocument.h"
+#import "Firestore/Source/Model/FSTFieldValue.h"
+#import "Firestore/Source/Remote/FSTSerializerBeta.h"
+
+#include "Firestore/core/include/firebase/firestore/timestamp.h"
+#include "Firestore/core/src/firebase/firestore/local/query_cache.h"
+#include "Firestore/core/src/firebase/firestore/local/reference_set.h"
+#include "Firestore/core/src/firebase/firestore/local/remote_document_cache.h"
+#include "Firestore/core/src/firebase/firestore/model/database_id.h"
+#include "Firestore/core/src/firebase/firestore/model/document_key.h"
+#include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
+#include "Firestore/core/src/firebase/firestore/model/resource_path.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
+#include "Firestore/core/src/firebase/firestore/model/types.h"
+#include "Firestore/core/src/firebase/firestore/util/filesystem.h"
+#include "Firestore/core/src/firebase/firestore/util/path.h"
+#include "Firestore/core/src/firebase/firestore/util/string_apple.h"
+#include "absl/strings/str_cat.h"
+
+namespace util = firebase::firestore::util;
+using firebase::Timestamp;
+using firebase::firestore::local::LruParams;
+using firebase::firestore::local::LruResults;
+using firebase::firestore::local::ReferenceSet;
+using firebase::firestore::model::DatabaseId;
+using firebase::firestore::model::DocumentKey;
+using firebase::firestore::model::DocumentKeySet;
+using firebase::firestore::model::ResourcePath;
+using firebase::firestore::model::SnapshotVersion;
+using firebase::firestore::model::TargetId;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace {
+
+const int kTargetCount = 10;
+const int kOrphanCount = 6;
+
+/** Collects whenever asked, removing up to half of the sequence numbers. */
+LruParams TestParams() {
+  return LruParams{0, 50, 1000};
+}
+
+FSTLocalSerializer *TestSerializer() {
+  FSTSerializerBeta *remoteSerializer =
+      [[FSTSerializerBeta alloc] initWithDatabaseID:DatabaseId("p", "d")];
+  return [[FSTLocalSerializer alloc] initWithRemoteSerializer:remoteSerializer];
+}
+
+DocumentKey TargetDocumentKey(int target, const char *suffix) {
+  return DocumentKey::FromPathString(absl::StrCat("rooms/", target, "/messages/", suffix));
+}
+
+DocumentKey OrphanDocumentKey(int orphan) {
+  return DocumentKey::FromPathString(absl::StrCat("orphans/", orphan));
+}
+
+}  // namespace
+
+/**
+ * Checks that an incremental collection removes the same targets and documents as a full one.
+ * Subclasses provide the persistence layer.
+ */
+@interface FSTLRUGarbageCollectorTests : XCTestCase
+@end
+
+@implementation FSTLRUGarbageCollectorTests {
+  // Pins nothing, but the delegates require a set of in-memory pins.
+  ReferenceSet _pins;
+  std::vector<id<FSTPersistence>> _persistences;
+}
+
+/** Creates an empty persistence layer using `params`, or nil for this abstract base class. */
+- (nullable id<FSTPersistence>)newPersistenceNamed:(NSString *)name params:(LruParams)params {
+  return nil;
+}
+
+- (void)tearDown {
+  for (id<FSTPersistence> persistence : _persistences) {
+    [persistence shutdown];
+  }
+  _persistences.clear();
+  [super tearDown];
+}
+
+- (nullable id<FSTPersistence>)persistenceNamed:(NSString *)name {
+  id<FSTPersistence> persistence = [self newPersistenceNamed:name params:TestParams()];
+  if (persistence) {
+    [persistence.referenceDelegate addInMemoryPins:&_pins];
+    _persistences.push_back(persistence);
+  }
+  return persistence;
+}
+
+- (FSTLRUGarbageCollector *)gcForPersistence:(id<FSTPersistence>)persistence {
+  return ((id<FSTLRUDelegate>)persistence.referenceDelegate).gc;
+}
+
+/**
+ * Fills `persistence` with targets, each in its own transaction so that their sequence numbers
+ * increase, interleaved with orphaned documents.
+ *
+ * Each target matches two documents of its own. Each of the first five also shares a document with
+ * the target five after it, which keeps that document alive if only the older target is removed.
+ */
+- (void)populatePersistence:(id<FSTPersistence>)persistence {
+  SnapshotVersion version{Timestamp{1, 0}};
+  for (int i = 0; i < kTargetCount; ++i) {
+    persistence.run("Add target", [&]() {
+      FSTQuery *query = [FSTQuery
+          queryWithPath:ResourcePath::FromString(absl::StrCat("rooms/", i, "/messages"))];
+      FSTQueryData *queryData =
+          [[FSTQueryData alloc] initWithQuery:query
+                                     targetID:(i + 1) * 2
+                         listenSequenceNumber:persistence.currentSequenceNumber
+                                      purpose:FSTQueryPurposeListen];
+      persistence.queryCache->AddTarget(queryData);
+
+      DocumentKeySet keys{TargetDocumentKey(i, "a"), TargetDocumentKey(i, "b"),
+                          TargetDocumentKey(i % 5, "shared")};
+      for (const DocumentKey &key : keys) {
+        persistence.remoteDocumentCache->Add(
+            [FSTDocument documentWithData:[FSTObjectValue objectValue]
+                                      key:key
+                                  version:version
+                                    state:FSTDocumentStateSynced],
+            version);
+      }
+      persistence.queryCache->AddMatchingKeys(keys, queryData.targetID);
+    });
+
+    if (i < kOrphanCount) {
+      persistence.run("Add orphan", [&]() {
+        DocumentKey key = OrphanDocumentKey(i);
+        persistence.remoteDocumentCache->Add(
+            [FSTDocument documentWithData:[FSTObjectValue objectValue]
+                                      key:key
+                                  version:version
+                                    state:FSTDocumentStateSynced],
+            version);
+        [persistence.referenceDelegate removeMutationReference:key];
+      });
+    }
+  }
+}
+
+/** Returns the target IDs still cached in `persistence`. */
+- (std::vector<TargetId>)targetsInPersistence:(id<FSTPersistence>)persistence {
+  std::vector<TargetId> targetIDs;
+  persistence.run("Read targets", [&]() {
+    for (int i = 0; i < kTargetCount; ++i) {
+      FSTQuery *query = [FSTQuery
+          queryWithPath:ResourcePath::FromString(absl::StrCat("rooms/", i, "/messages"))];
+      FSTQueryData *queryData = persistence.queryCache->GetTarget(query);
+      if (queryData) {
+        targetIDs.push_back(queryData.targetID);
+      }
+    }
+  });
+  return targetIDs;
+}
+
+/** Returns the paths of the documents still cached in `persistence`. */
+- (std::vector<std::string>)documentsInPersistence:(id<FSTPersistence>)persistence {
+  std::vector<DocumentKey> keys;
+  for (int i = 0; i < kTargetCount; ++i) {
+    keys.push_back(TargetDocumentKey(i, "a"));
+    keys.push_back(TargetDocumentKey(i, "b"));
+    keys.push_back(TargetDocumentKey(i, "shared"));
+  }
+  for (int i = 0; i < kOrphanCount; ++i) {
+    keys.push_back(OrphanDocumentKey(i));
+  }
+
+  std::vector<std::string> paths;
+  persistence.run("Read documents", [&]() {
+    for (const DocumentKey &key : keys) {
+      if (persistence.remoteDocumentCache->Get(key)) {
+        paths.push_back(key.ToString());
+      }
+    }
+  });
+  return paths;
+}
+
+- (void)testIncrementalCollectionRemovesWhatFullCollectionRemoves {
+  id<FSTPersistence> full = [self persistenceNamed:@"full"];
+  if (!full) return;
+  id<FSTPersistence> incremental = [self persistenceNamed:@"incremental"];
+  [self populatePersistence:full];
+  [self populatePersistence:incremental];
+
+  // Room 1's target is being listened to, so neither collection may remove it or its documents.
+  std::unordered_map<TargetId, FSTQueryData *> liveTargets;
+  FSTQuery *liveQuery = [FSTQuery queryWithPath:ResourcePath::FromString("rooms/1/messages")];
+  full.run("Read live target", [&]() {
+    FSTQueryData *queryData = full.queryCache->GetTarget(liveQuery);
+    liveTargets[queryData.targetID] = queryData;
+  });
+
+  FSTLRUGarbageCollector *fullGC = [self gcForPersistence:full];
+  LruResults fullResults = full.run("Collect garbage", [&]() -> LruResults {
+    return [fullGC collectWithLiveTargets:liveTargets];
+  });
+
+  // A zero budget removes a single candidate per slice.
+  FSTLRUGarbageCollector *incrementalGC = [self gcForPersistence:incremental];
+  LruResults incrementalResults = LruResults::DidNotRun();
+  int slices = 0;
+  do {
+    incrementalResults = incremental.run("Collect garbage incrementally", [&]() -> LruResults {
+      return [incrementalGC collectIncrementallyWithLiveTargets:liveTargets
+                                                         budget:std::chrono::milliseconds(0)];
+    });
+    slices++;
+  } while (incrementalGC.collecting);
+
+  XCTAssertTrue(fullResults.didRun);
+  XCTAssertTrue(incrementalResults.didRun);
+  XCTAssertGreaterThan(slices, 1);
+  XCTAssertEqual(incrementalResults.sequenceNumbersCollected, fullResults.sequenceNumbersCollected);
+  XCTAssertEqual(incrementalResults.targetsRemoved, fullResults.targetsRemoved);
+  XCTAssertEqual(incrementalResults.documentsRemoved, fullResults.documentsRemoved);
+
+  // Half of the 16 sequence numbers reach up to orphan 3. Below that are the targets of rooms 0, 2
+  // and 3, whose "a" and "b" documents they orphan, and orphans 0 to 3. The "shared" documents of
+  // those rooms are still matched by the targets of rooms 5, 7 and 8.
+  XCTAssertEqual(fullResults.targetsRemoved, 3);
+  XCTAssertEqual(fullResults.documentsRemoved, 10);
+
+  XCTAssertTrue([self targetsInPersistence:incremental] == [self targetsInPersistence:full]);
+  XCTAssertTrue([self documentsInPersistence:incremental] == [self documentsInPersistence:full]);
+}
+
+@end
+
+@interface FSTMemoryLRUGarbageCollectorTests : FSTLRUGarbageCollectorTests
+@end
+
+@implementation FSTMemoryLRUGarbageCollectorTests
+
+- (nullable id<FSTPersistence>)newPersistenceNamed:(NSString *)name params:(LruParams)params {
+  return [FSTMemoryPersistence persistenceWithLruParams:params serializer:TestSerializer()];
+}
+
+@end
+
+@interface FSTLevelDBLRUGarbageCollectorTests : FSTLRUGarbageCollectorTests
+@end
+
+@implementation FSTLevelDBLRUGarbageCollectorTests
+
+- (nullable id<FSTPersistence>)newPersistenceNamed:(NSString *)name params:(LruParams)params {
+  util::Path directory =
+      util::Path::JoinUtf8(util::TempDir(), "FSTLRUGarbageCollectorTests", util::MakeString(name));
+  util::Status status = util::RecursivelyDelete(directory);
+  XCTAssertTrue(status.ok(), @"Failed to clean up %s", status.ToString().c_str());
+
+  FSTLevelDB *db;
+  status = [FSTLevelDB dbWithDirectory:std::move(directory)
+                            serializer:TestSerializer()
+                             lruParams:params
+                                   ptr:&db];
+  XCTAssertTrue(status.ok(), @"Failed to open LevelDB: %s", status.ToString().c_str());
+  return db;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/local/leveldb_remote_document_cache.h"
+
+#import <XCTest/XCTest.h>
+
+#include <utility>
+#include <vector>
+
+#import "Firestore/Source/Core/FSTQuery.h"
+#import "Firestore/Source/Local/FSTLRUGarbageCollector.h"
+#import "Firestore/Source/Local/FSTLevelDB.h"
+#import "Firestore/Source/Local/FSTLocalSerializer.h"
+#import "Firestore/Source/Model/FSTDocument.h"
+#import "Firestore/Source/Model/FSTFieldValue.h"
+#import "Firestore/Source/Remote/FSTSerializerBeta.h"
+
+#include "Firestore/core/include/firebase/firestore/timestamp.h"
+#include "Firestore/core/src/firebase/firestore/model/database_id.h"
+#include "Firestore/core/src/firebase/firestore/model/document_key.h"
+#include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/field_value.h"
+#include "Firestore/core/src/firebase/firestore/model/resource_path.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
+#include "Firestore/core/src/firebase/firestore/util/filesystem.h"
+#include "Firestore/core/src/firebase/firestore/util/path.h"
+#include "absl/strings/str_cat.h"
+
+namespace util = firebase::firestore::util;
+using firebase::Timestamp;
+using firebase::firestore::local::LevelDbRemoteDocumentCache;
+using firebase::firestore::local::LruParams;
+using firebase::firestore::model::DatabaseId;
+using firebase::firestore::model::DocumentKey;
+using firebase::firestore::model::DocumentMap;
+using firebase::firestore::model::FieldValue;
+using firebase::firestore::model::ResourcePath;
+using firebase::firestore::model::SnapshotVersion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace {
+
+// Enough documents for GetMatching to decode them on its thread pool.
+const int kDocumentCount = 200;
+
+FSTLocalSerializer *TestSerializer() {
+  FSTSerializerBeta *remoteSerializer =
+      [[FSTSerializerBeta alloc] initWithDatabaseID:DatabaseId("p", "d")];
+  return [[FSTLocalSerializer alloc] initWithRemoteSerializer:remoteSerializer];
+}
+
+}  // namespace
+
+@interface LevelDbRemoteDocumentCacheTests : XCTestCase
+@end
+
+@implementation LevelDbRemoteDocumentCacheTests {
+  FSTLevelDB *_db;
+}
+
+- (void)setUp {
+  [super setUp];
+  util::Path directory =
+      util::Path::JoinUtf8(util::TempDir(), "LevelDbRemoteDocumentCacheTests");
+  util::Status status = util::RecursivelyDelete(directory);
+  XCTAssertTrue(status.ok(), @"Failed to clean up %s", status.ToString().c_str());
+
+  FSTLevelDB *db;
+  status = [FSTLevelDB dbWithDirectory:std::move(directory)
+                            serializer:TestSerializer()
+                             lruParams:LruParams::Disabled()
+                                   ptr:&db];
+  XCTAssertTrue(status.ok(), @"Failed to open LevelDB: %s", status.ToString().c_str());
+  _db = db;
+}
+
+- (void)tearDown {
+  [_db shutdown];
+  _db = nil;
+  [super tearDown];
+}
+
+- (void)testGetMatchingDecodesEveryDocument {
+  SnapshotVersion version{Timestamp{1, 0}};
+  std::vector<FSTDocument *> documents;
+  for (int i = 0; i < kDocumentCount; ++i) {
+    FSTFieldValue *n = [FSTDelegateValue delegateWithValue:FieldValue::FromInteger(i)];
+    FSTObjectValue *data = [[FSTObjectValue alloc] initWithDictionary:@{@"n" : n}];
+    documents.push_back([FSTDocument
+        documentWithData:data
+                     key:DocumentKey::FromPathString(absl::StrCat("rooms/", i))
+                 version:version
+                   state:FSTDocumentStateSynced]);
+  }
+  // A document in a subcollection, which the query must skip.
+  FSTDocument *message =
+      [FSTDocument documentWithData:[FSTObjectValue objectValue]
+                                key:DocumentKey::FromPathString("rooms/0/messages/0")
+                            version:version
+                              state:FSTDocumentStateSynced];
+
+  _db.run("Add documents", [&]() {
+    for (FSTDocument *document : documents) {
+      _db.remoteDocumentCache->Add(document, version);
+    }
+    _db.remoteDocumentCache->Add(message, version);
+  });
+
+  // A new cache has no decoded documents, so it decodes every row it reads.
+  LevelDbRemoteDocumentCache cache{_db, _db.serializer};
+  FSTQuery *query = [FSTQuery queryWithPath:ResourcePath::FromString("rooms")];
+  DocumentMap results = _db.run("GetMatching", [&]() -> DocumentMap {
+    return cache.GetMatching(query, SnapshotVersion::None());
+  });
+
+  XCTAssertEqual(results.size(), static_cast<size_t>(kDocumentCount));
+  XCTAssertEqual(cache.decoded_cache_misses(), static_cast<size_t>(kDocumentCount));
+  for (FSTDocument *document : documents) {
+    auto found = results.underlying_map().find(document.key);
+    XCTAssertTrue(found != results.underlying_map().end());
+    if (found != results.underlying_map().end()) {
+      XCTAssertEqualObjects(found->second, document);
+    }
+  }
+
+  // Reading them again is served from the decoded documents.
+  results = _db.run("GetMatching again", [&]() -> DocumentMap {
+    return cache.GetMatching(query, SnapshotVersion::None());
+  });
+  XCTAssertEqual(results.size(), static_cast<size_t>(kDocumentCount));
+  XCTAssertEqual(cache.decoded_cache_hits(), static_cast<size_t>(kDocumentCount));
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
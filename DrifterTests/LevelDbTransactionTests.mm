@@ -0,0 +1,246 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/local/leveldb_transaction.h"
+
+#import <XCTest/XCTest.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "Firestore/core/src/firebase/firestore/util/filesystem.h"
+#include "Firestore/core/src/firebase/firestore/util/path.h"
+#include "absl/memory/memory.h"
+#include "leveldb/db.h"
+#include "leveldb/iterator.h"
+
+namespace util = firebase::firestore::util;
+using firebase::firestore::local::LevelDbTransaction;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace {
+
+const int kKeyCount = 100;
+const int kMaxSkips = LevelDbTransaction::Iterator::kMaxSequentialSkips;
+
+std::string Key(int i) {
+  char key[16];
+  snprintf(key, sizeof(key), "key%03d", i);
+  return key;
+}
+
+/** Forwards to another iterator, counting the calls to Seek(). */
+class SeekCountingIterator : public leveldb::Iterator {
+ public:
+  SeekCountingIterator(leveldb::Iterator *iterator, int *seeks)
+      : iterator_(iterator), seeks_(seeks) {
+  }
+
+  bool Valid() const override {
+    return iterator_->Valid();
+  }
+  void SeekToFirst() override {
+    iterator_->SeekToFirst();
+  }
+  void SeekToLast() override {
+    iterator_->SeekToLast();
+  }
+  void Seek(const leveldb::Slice &target) override {
+    ++*seeks_;
+    iterator_->Seek(target);
+  }
+  void Next() override {
+    iterator_->Next();
+  }
+  void Prev() override {
+    iterator_->Prev();
+  }
+  leveldb::Slice key() const override {
+    return iterator_->key();
+  }
+  leveldb::Slice value() const override {
+    return iterator_->value();
+  }
+  leveldb::Status status() const override {
+    return iterator_->status();
+  }
+
+ private:
+  std::unique_ptr<leveldb::Iterator> iterator_;
+  int *seeks_;
+};
+
+/** Forwards to another database, counting the seeks of its iterators. */
+class SeekCountingDb : public leveldb::DB {
+ public:
+  explicit SeekCountingDb(leveldb::DB *db) : db_(db) {
+  }
+
+  int seeks() const {
+    return seeks_;
+  }
+
+  leveldb::Status Put(const leveldb::WriteOptions &options,
+                      const leveldb::Slice &key,
+                      const leveldb::Slice &value) override {
+    return db_->Put(options, key, value);
+  }
+  leveldb::Status Delete(const leveldb::WriteOptions &options,
+                         const leveldb::Slice &key) override {
+    return db_->Delete(options, key);
+  }
+  leveldb::Status Write(const leveldb::WriteOptions &options,
+                        leveldb::WriteBatch *updates) override {
+    return db_->Write(options, updates);
+  }
+  leveldb::Status Get(const leveldb::ReadOptions &options,
+                      const leveldb::Slice &key,
+                      std::string *value) override {
+    return db_->Get(options, key, value);
+  }
+  leveldb::Iterator *NewIterator(const leveldb::ReadOptions &options) override {
+    return new SeekCountingIterator(db_->NewIterator(options), &seeks_);
+  }
+  const leveldb::Snapshot *GetSnapshot() override {
+    return db_->GetSnapshot();
+  }
+  void ReleaseSnapshot(const leveldb::Snapshot *snapshot) override {
+    db_->ReleaseSnapshot(snapshot);
+  }
+  bool GetProperty(const leveldb::Slice &property, std::string *value) override {
+    return db_->GetProperty(property, value);
+  }
+  void GetApproximateSizes(const leveldb::Range *range, int n, uint64_t *sizes) override {
+    db_->GetApproximateSizes(range, n, sizes);
+  }
+  void CompactRange(const leveldb::Slice *begin, const leveldb::Slice *end) override {
+    db_->CompactRange(begin, end);
+  }
+
+ private:
+  leveldb::DB *db_;
+  int seeks_ = 0;
+};
+
+}  // namespace
+
+@interface LevelDbTransactionTests : XCTestCase
+@end
+
+@implementation LevelDbTransactionTests {
+  std::unique_ptr<leveldb::DB> _ldb;
+  std::unique_ptr<SeekCountingDb> _db;
+}
+
+- (void)setUp {
+  [super setUp];
+  util::Path directory = util::Path::JoinUtf8(util::TempDir(), "LevelDbTransactionTests");
+  util::Status status = util::RecursivelyDelete(directory);
+  XCTAssertTrue(status.ok(), @"Failed to clean up %s", status.ToString().c_str());
+
+  leveldb::Options options;
+  options.create_if_missing = true;
+  leveldb::DB *ldb = nullptr;
+  leveldb::Status opened = leveldb::DB::Open(options, directory.ToUtf8String(), &ldb);
+  XCTAssertTrue(opened.ok(), @"Failed to open LevelDB: %s", opened.ToString().c_str());
+  _ldb.reset(ldb);
+
+  // Only the even keys are committed.
+  for (int i = 0; i < kKeyCount; i += 2) {
+    _ldb->Put(leveldb::WriteOptions(), Key(i), "committed");
+  }
+  _db = absl::make_unique<SeekCountingDb>(_ldb.get());
+}
+
+- (void)tearDown {
+  _db.reset();
+  _ldb.reset();
+  [super tearDown];
+}
+
+- (void)testSeekForwardStepsOverNearbyEntries {
+  LevelDbTransaction transaction{_db.get(), "SeekForward nearby"};
+  auto it = transaction.NewIterator();
+  it->Seek(Key(0));
+  XCTAssertEqual(_db->seeks(), 1);
+
+  // The key kMaxSkips entries ahead is reached by stepping.
+  it->SeekForward(Key(2 * kMaxSkips));
+  XCTAssertTrue(it->Valid());
+  XCTAssertTrue(it->key() == Key(2 * kMaxSkips));
+  XCTAssertEqual(_db->seeks(), 1);
+
+  // So is a missing key just before the next entry.
+  it->SeekForward(Key(2 * kMaxSkips + 1));
+  XCTAssertTrue(it->key() == Key(2 * kMaxSkips + 2));
+  XCTAssertEqual(_db->seeks(), 1);
+}
+
+- (void)testSeekForwardSeeksPastDistantEntries {
+  LevelDbTransaction transaction{_db.get(), "SeekForward distant"};
+  auto it = transaction.NewIterator();
+  it->Seek(Key(0));
+
+  // One entry further than SeekForward steps over falls back to Seek().
+  it->SeekForward(Key(2 * (kMaxSkips + 1)));
+  XCTAssertTrue(it->Valid());
+  XCTAssertTrue(it->key() == Key(2 * (kMaxSkips + 1)));
+  XCTAssertEqual(_db->seeks(), 2);
+}
+
+- (void)testSeekForwardSeeksAfterTransactionChanges {
+  LevelDbTransaction transaction{_db.get(), "SeekForward after Put"};
+  auto it = transaction.NewIterator();
+  it->Seek(Key(0));
+
+  transaction.Put(Key(1), "pending");
+  it->SeekForward(Key(1));
+  XCTAssertTrue(it->key() == Key(1));
+  XCTAssertTrue(it->value() == "pending");
+  XCTAssertEqual(_db->seeks(), 2);
+}
+
+- (void)testSeekForwardMatchesSeek {
+  LevelDbTransaction transaction{_db.get(), "SeekForward matches Seek"};
+  for (int i = 1; i < kKeyCount; i += 3) {
+    transaction.Put(Key(i), "pending");
+  }
+  for (int i = 0; i < kKeyCount; i += 5) {
+    transaction.Delete(Key(i));
+  }
+
+  // Targets spaced ever further apart, past the end of the keys.
+  auto forward = transaction.NewIterator();
+  forward->Seek(Key(0));
+  int target = 0;
+  for (int step = 0; forward->Valid(); target += step++) {
+    forward->SeekForward(Key(target));
+    auto seeked = transaction.NewIterator();
+    seeked->Seek(Key(target));
+
+    XCTAssertEqual(forward->Valid(), seeked->Valid(), @"at %s", Key(target).c_str());
+    if (forward->Valid() && seeked->Valid()) {
+      XCTAssertTrue(forward->key() == seeked->key(), @"at %s", Key(target).c_str());
+      XCTAssertTrue(forward->value() == seeked->value(), @"at %s", Key(target).c_str());
+    }
+  }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
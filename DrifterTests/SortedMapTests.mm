@@ -0,0 +1,260 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/immutable/sorted_map.h"
+
+#import <XCTest/XCTest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/src/firebase/firestore/immutable/btree_sorted_map.h"
+
+using firebase::firestore::immutable::SortedMap;
+using firebase::firestore::immutable::impl::BTreeNode;
+using firebase::firestore::immutable::impl::BTreeSortedMap;
+
+using IntMap = SortedMap<int, int>;
+using IntBTree = BTreeSortedMap<int, int>;
+using Node = BTreeNode<int, int>;
+using Reference = std::map<int, int>;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace {
+
+const int kMaxEntries = static_cast<int>(Node::kMaxEntries);
+
+// The most entries a tree two levels tall holds; one more needs a third level.
+const int kTwoLevels = kMaxEntries * (kMaxEntries + 1) + kMaxEntries;
+
+const int kCount = kTwoLevels + 2 * kMaxEntries;
+
+/** Returns true if iterating `map` yields exactly the entries of `expected`. */
+template <typename Map>
+bool SameEntries(const Map &map, const Reference &expected) {
+  auto expected_iter = expected.begin();
+  for (const auto &entry : map) {
+    if (expected_iter == expected.end() || entry.first != expected_iter->first ||
+        entry.second != expected_iter->second) {
+      return false;
+    }
+    ++expected_iter;
+  }
+  return expected_iter == expected.end();
+}
+
+/** Returns the even numbers below 2 * kCount, so that odd keys are missing. */
+std::vector<int> AscendingKeys() {
+  std::vector<int> keys;
+  for (int i = 0; i < kCount; ++i) {
+    keys.push_back(i * 2);
+  }
+  return keys;
+}
+
+}  // namespace
+
+@interface SortedMapTests : XCTestCase
+@end
+
+@implementation SortedMapTests {
+  std::mt19937 _random;
+}
+
+- (void)setUp {
+  [super setUp];
+  _random.seed(42);
+}
+
+/**
+ * Checks the B-tree invariants of the subtree at `node`, whose keys must lie strictly between
+ * `low` and `high` where given, and returns its height.
+ */
+- (int)checkNode:(const Node &)node
+          isRoot:(bool)isRoot
+             low:(const int *_Nullable)low
+            high:(const int *_Nullable)high {
+  XCTAssertLessThanOrEqual(node.count(), Node::kMaxEntries);
+  XCTAssertGreaterThanOrEqual(node.count(), isRoot ? Node::size_type{1} : Node::kMinEntries);
+  Node::size_type size = node.count();
+  for (Node::size_type i = 0; i < node.count(); ++i) {
+    int key = node.entry(i).first;
+    XCTAssertTrue(i == 0 || node.entry(i - 1).first < key);
+    XCTAssertTrue(!low || *low < key);
+    XCTAssertTrue(!high || key < *high);
+  }
+  if (node.leaf()) {
+    XCTAssertEqual(node.size(), size);
+    return 1;
+  }
+
+  int height = 0;
+  for (Node::size_type i = 0; i <= node.count(); ++i) {
+    const int *childLow = i == 0 ? low : &node.entry(i - 1).first;
+    const int *childHigh = i == node.count() ? high : &node.entry(i).first;
+    int childHeight = [self checkNode:node.child(i) isRoot:false low:childLow high:childHigh];
+    // Every leaf is at the same depth.
+    XCTAssertTrue(height == 0 || childHeight == height);
+    height = childHeight;
+    size += node.child(i).size();
+  }
+  XCTAssertEqual(node.size(), size);
+  return height + 1;
+}
+
+/** Checks that `map` is a valid B-tree holding `expected`, and returns its height. */
+- (int)checkTree:(const IntBTree &)map expected:(const Reference &)expected {
+  XCTAssertEqual(map.size(), static_cast<IntBTree::size_type>(expected.size()));
+  XCTAssertTrue(SameEntries(map, expected));
+  IntBTree::size_type index = 0;
+  for (const auto &entry : expected) {
+    XCTAssertTrue(map.contains(entry.first));
+    XCTAssertEqual(map.find_index(entry.first), index++);
+  }
+  return map.root() ? [self checkNode:*map.root() isRoot:true low:nullptr high:nullptr] : 0;
+}
+
+- (std::vector<std::vector<int>>)keyOrders {
+  std::vector<int> ascending = AscendingKeys();
+  std::vector<int> descending(ascending.rbegin(), ascending.rend());
+  std::vector<int> shuffled = ascending;
+  std::shuffle(shuffled.begin(), shuffled.end(), _random);
+  return {ascending, descending, shuffled};
+}
+
+- (void)testInsertSplitsNodesAtCapacity {
+  for (const std::vector<int> &order : [self keyOrders]) {
+    IntBTree map;
+    Reference expected;
+    int maxHeight = 0;
+    for (int key : order) {
+      IntBTree before = map;
+      Reference beforeExpected = expected;
+      map = map.insert(key, key);
+      expected[key] = key;
+      maxHeight = std::max(maxHeight, [self checkTree:map expected:expected]);
+      // The original shares nodes with the result, but is unchanged.
+      [self checkTree:before expected:beforeExpected];
+    }
+    XCTAssertEqual(maxHeight, 3);
+
+    // Replacing a value keeps the shape.
+    IntBTree updated = map.insert(order[0], -1);
+    expected[order[0]] = -1;
+    [self checkTree:updated expected:expected];
+  }
+}
+
+- (void)testEraseMergesNodesAtMinimum {
+  Reference full;
+  IntBTree map;
+  for (int key : AscendingKeys()) {
+    map = map.insert(key, key);
+    full[key] = key;
+  }
+
+  // Erasing a missing key returns the same tree.
+  XCTAssertEqual(map.erase(1).root(), map.root());
+
+  for (const std::vector<int> &order : [self keyOrders]) {
+    IntBTree shrinking = map;
+    Reference expected = full;
+    for (int key : order) {
+      IntBTree before = shrinking;
+      Reference beforeExpected = expected;
+      shrinking = shrinking.erase(key);
+      expected.erase(key);
+      [self checkTree:shrinking expected:expected];
+      [self checkTree:before expected:beforeExpected];
+    }
+    XCTAssertTrue(shrinking.empty());
+  }
+  [self checkTree:map expected:full];
+}
+
+- (void)testFromSortedBuildsValidTrees {
+  // Every size up to three levels, then sizes up to four levels in steps.
+  const int maxCount = kCount + (kTwoLevels + 1) * (kMaxEntries + 1);
+  for (int count = 0; count <= maxCount; count += count < kCount ? 1 : 97) {
+    std::vector<std::pair<int, int>> entries;
+    Reference expected;
+    for (int i = 0; i < count; ++i) {
+      entries.emplace_back(i, -i);
+      expected[i] = -i;
+    }
+
+    IntBTree map = IntBTree::FromSorted(entries.begin(), count, {});
+    [self checkTree:map expected:expected];
+    XCTAssertTrue(SameEntries(IntMap::FromSorted(entries.begin(), entries.end()), expected));
+
+    // The result is as valid a starting point for later changes as an inserted tree.
+    if (count > 0) {
+      expected.erase(count / 2);
+      expected[count * 2] = 0;
+      [self checkTree:map.erase(count / 2).insert(count * 2, 0) expected:expected];
+    }
+  }
+}
+
+- (void)testSetOperationsMatchReference {
+  // Sizes on both sides of the array map's capacity, and far enough apart for the smaller operand
+  // to be applied as single updates.
+  const std::vector<int> sizes{0, 1, 10, 25, 26, 100, 2000};
+  std::uniform_int_distribution<int> keys{0, 4000};
+  for (int leftSize : sizes) {
+    for (int rightSize : sizes) {
+      Reference left;
+      Reference right;
+      while (static_cast<int>(left.size()) < leftSize) {
+        int key = keys(_random);
+        left[key] = key;
+      }
+      while (static_cast<int>(right.size()) < rightSize) {
+        int key = keys(_random);
+        right[key] = -key;
+      }
+
+      Reference expectedUnion = right;
+      expectedUnion.insert(left.begin(), left.end());
+      Reference expectedDifference;
+      Reference expectedIntersection;
+      for (const auto &entry : left) {
+        if (right.count(entry.first)) {
+          expectedIntersection.insert(entry);
+        } else {
+          expectedDifference.insert(entry);
+        }
+      }
+
+      IntMap leftMap = IntMap::FromSorted(left.begin(), left.end());
+      IntMap rightMap = IntMap::FromSorted(right.begin(), right.end());
+      XCTAssertTrue(SameEntries(leftMap.set_union(rightMap), expectedUnion), @"%d union %d",
+                    leftSize, rightSize);
+      XCTAssertTrue(SameEntries(leftMap.set_difference(rightMap), expectedDifference),
+                    @"%d - %d", leftSize, rightSize);
+      XCTAssertTrue(SameEntries(leftMap.set_intersection(rightMap), expectedIntersection),
+                    @"%d intersect %d", leftSize, rightSize);
+    }
+  }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/util/thread_pool.h"
+
+#import <XCTest/XCTest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "Firestore/core/src/firebase/firestore/util/async_queue.h"
+#include "Firestore/core/src/firebase/firestore/util/executor_std.h"
+#include "absl/memory/memory.h"
+
+using firebase::firestore::util::AsyncQueue;
+using firebase::firestore::util::ExecutorStd;
+using firebase::firestore::util::ThreadPool;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace {
+
+const NSTimeInterval kTimeout = 5.0;
+
+}  // namespace
+
+@interface ThreadPoolTests : XCTestCase
+@end
+
+@implementation ThreadPoolTests {
+  std::unique_ptr<AsyncQueue> _queue;
+}
+
+- (void)setUp {
+  [super setUp];
+  _queue = absl::make_unique<AsyncQueue>(absl::make_unique<ExecutorStd>());
+}
+
+- (void)tearDown {
+  _queue.reset();
+  [super tearDown];
+}
+
+/** Calls `ExecuteThen` from an operation on the queue and waits for the callback. */
+- (void)checkExecuteThenFromQueueWithPool:(ThreadPool *)pool {
+  XCTestExpectation *expectation = [self expectationWithDescription:@"callback"];
+  AsyncQueue *queue = _queue.get();
+  std::atomic<int> result{0};
+  queue->Enqueue([&, queue] {
+    pool->ExecuteThen<int>([] { return 42; }, queue,
+                           [&, queue](int value) {
+                             queue->VerifyIsCurrentQueue();
+                             result = value;
+                             [expectation fulfill];
+                           });
+  });
+  [self waitForExpectationsWithTimeout:kTimeout handler:nil];
+  XCTAssertEqual(result.load(), 42);
+}
+
+- (void)testExecuteThenFromQueueWithoutWorkers {
+  // The operation runs inline, while the queue's operation is still in progress.
+  ThreadPool pool{0};
+  [self checkExecuteThenFromQueueWithPool:&pool];
+}
+
+- (void)testExecuteThenFromQueueWithWorkers {
+  ThreadPool pool{3};
+  [self checkExecuteThenFromQueueWithPool:&pool];
+}
+
+- (void)testParallelForCallsEachIndexOnce {
+  for (size_t workers : {0, 1, 3}) {
+    ThreadPool pool{workers};
+    for (size_t count : {0, 1, 5, 1000}) {
+      std::vector<std::atomic<int>> calls(count);
+      pool.ParallelFor(count, [&](size_t i) { calls[i]++; });
+      for (size_t i = 0; i < count; ++i) {
+        XCTAssertEqual(calls[i].load(), 1, @"index %zu of %zu with %zu workers", i, count,
+                       workers);
+      }
+    }
+  }
+}
+
+- (void)testParallelForFromWorkers {
+  // The inner calls run on a worker and the calling thread, and may find no idle worker to help
+  // them; they must then make progress on their own.
+  ThreadPool pool{2};
+  std::atomic<int> calls{0};
+  pool.ParallelFor(2, [&](size_t) { pool.ParallelFor(100, [&](size_t) { calls++; }); });
+  XCTAssertEqual(calls.load(), 200);
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
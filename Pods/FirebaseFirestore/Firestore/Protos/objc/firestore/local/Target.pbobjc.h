@@ -73,6 +73,7 @@ typedef GPB_ENUM(FSTPBTarget_FieldNumber) {
   FSTPBTarget_FieldNumber_LastListenSequenceNumber = 4,
   FSTPBTarget_FieldNumber_Query = 5,
   FSTPBTarget_FieldNumber_Documents = 6,
+  FSTPBTarget_FieldNumber_LastLimboFreeSnapshotVersion = 7,
 };
 
 typedef GPB_ENUM(FSTPBTarget_TargetType_OneOfCase) {
@@ -149,6 +150,14 @@ typedef GPB_ENUM(FSTPBTarget_TargetType_OneOfCase) {
 /** A target specified by a set of document names. */
 @property(nonatomic, readwrite, strong, null_resettable) GCFSTarget_DocumentsTarget *documents;
 
+/**
+ * Denotes the maximum snapshot version at which the associated query view
+ * contained no limbo documents.  Undefined for limbo document queries.
+ **/
+@property(nonatomic, readwrite, strong, null_resettable) GPBTimestamp *lastLimboFreeSnapshotVersion;
+/** Test to see if @c lastLimboFreeSnapshotVersion has been set. */
+@property(nonatomic, readwrite) BOOL hasLastLimboFreeSnapshotVersion;
+
 @end
 
 /**
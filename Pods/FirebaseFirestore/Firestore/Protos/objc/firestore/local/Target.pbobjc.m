@@ -77,6 +77,7 @@ static GPBFileDescriptor *FSTPBTargetRoot_FileDescriptor(void) {
 @dynamic lastListenSequenceNumber;
 @dynamic query;
 @dynamic documents;
+@dynamic hasLastLimboFreeSnapshotVersion, lastLimboFreeSnapshotVersion;
 
 typedef struct FSTPBTarget__storage_ {
   uint32_t _has_storage_[2];
@@ -85,6 +86,7 @@ typedef struct FSTPBTarget__storage_ {
   NSData *resumeToken;
   GCFSTarget_QueryTarget *query;
   GCFSTarget_DocumentsTarget *documents;
+  GPBTimestamp *lastLimboFreeSnapshotVersion;
   int64_t lastListenSequenceNumber;
 } FSTPBTarget__storage_;
 
@@ -148,6 +150,15 @@ typedef struct FSTPBTarget__storage_ {
         .flags = GPBFieldOptional,
         .dataType = GPBDataTypeMessage,
       },
+      {
+        .name = "lastLimboFreeSnapshotVersion",
+        .dataTypeSpecific.className = GPBStringifySymbol(GPBTimestamp),
+        .number = FSTPBTarget_FieldNumber_LastLimboFreeSnapshotVersion,
+        .hasIndex = 4,
+        .offset = (uint32_t)offsetof(FSTPBTarget__storage_, lastLimboFreeSnapshotVersion),
+        .flags = GPBFieldOptional,
+        .dataType = GPBDataTypeMessage,
+      },
     };
     GPBDescriptor *localDescriptor =
         [GPBDescriptor allocDescriptorForClass:[FSTPBTarget class]
@@ -92,6 +92,10 @@ NS_ASSUME_NONNULL_BEGIN
 static const std::chrono::milliseconds FSTLruGcInitialDelay = std::chrono::minutes(1);
 /** Minimum amount of time between GC checks, after the first one. */
 static const std::chrono::milliseconds FSTLruGcRegularDelay = std::chrono::minutes(5);
+/** How long each slice of an incremental LRU GC may hold the worker queue. */
+static const std::chrono::milliseconds FSTLruGcSliceBudget = std::chrono::milliseconds(10);
+/** How long other work gets the worker queue between the slices of an LRU GC. */
+static const std::chrono::milliseconds FSTLruGcSliceDelay = std::chrono::milliseconds(50);
 
 @interface FSTFirestoreClient () {
   DatabaseInfo _databaseInfo;
@@ -271,12 +275,17 @@ static const std::chrono::milliseconds FSTLruGcRegularDelay = std::chrono::minut
 
 /**
  * Schedules a callback to try running LRU garbage collection. Reschedules itself after the GC has
- * run.
+ * run. The GC runs incrementally, in slices that give way to other work on the worker queue.
  */
 - (void)scheduleLruGarbageCollection {
-  std::chrono::milliseconds delay = _gcHasRun ? _regularGcDelay : _initialGcDelay;
+  std::chrono::milliseconds delay;
+  if (_lruDelegate.gc.collecting) {
+    delay = FSTLruGcSliceDelay;
+  } else {
+    delay = _gcHasRun ? _regularGcDelay : _initialGcDelay;
+  }
   _lruCallback = _workerQueue->EnqueueAfterDelay(delay, TimerId::GarbageCollectionDelay, [self]() {
-    [self->_localStore collectGarbage:self->_lruDelegate.gc];
+    [self->_localStore collectGarbage:self->_lruDelegate.gc budget:FSTLruGcSliceBudget];
     self->_gcHasRun = true;
     [self scheduleLruGarbageCollection];
   });
@@ -37,6 +37,7 @@ using firebase::firestore::core::DocumentViewChange;
 using firebase::firestore::core::DocumentViewChangeSet;
 using firebase::firestore::core::SyncState;
 using firebase::firestore::core::ViewSnapshot;
+using firebase::firestore::model::DocumentComparator;
 using firebase::firestore::model::DocumentKey;
 using firebase::firestore::model::DocumentKeySet;
 using firebase::firestore::model::DocumentSet;
@@ -224,6 +225,9 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
 @implementation FSTView {
   DelayedConstructor<DocumentSet> _documentSet;
 
+  /** The query's comparator, which is costly to build for every comparison. */
+  DelayedConstructor<DocumentComparator> _comparator;
+
   /** Documents included in the remote target. */
   DocumentKeySet _syncedDocuments;
 
@@ -232,6 +236,12 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
 
   /** Document Keys that have local changes. */
   DocumentKeySet _mutatedKeys;
+
+  /**
+   * Whether _limboDocuments reflects the current documents, so that it only needs updating for
+   * the documents that change. It doesn't while the view isn't current.
+   */
+  BOOL _limboDocumentsUpToDate;
 }
 
 - (instancetype)initWithQuery:(FSTQuery *)query remoteDocuments:(DocumentKeySet)remoteDocuments {
@@ -239,13 +249,14 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
   if (self) {
     _query = query;
     _documentSet.Init(query.comparator);
+    _comparator.Init(query.comparator);
     _syncedDocuments = std::move(remoteDocuments);
   }
   return self;
 }
 
 - (ComparisonResult)compare:(FSTDocument *)document with:(FSTDocument *)otherDocument {
-  return self.query.comparator.Compare(document, otherDocument);
+  return _comparator->Compare(document, otherDocument);
 }
 
 - (const DocumentKeySet &)syncedDocuments {
@@ -283,7 +294,13 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
           ? oldDocumentSet.GetLastDocument()
           : nil;
 
-  for (const auto &kv : docChanges) {
+  MaybeDocumentMap refillCandidates;
+  if (previousChanges) {
+    refillCandidates = [self refillCandidatesFromDocuments:docChanges documentSet:oldDocumentSet];
+  }
+  const MaybeDocumentMap &changedDocs = previousChanges ? refillCandidates : docChanges;
+
+  for (const auto &kv : changedDocs) {
     const DocumentKey &key = kv.first;
     FSTMaybeDocument *maybeNewDoc = kv.second;
 
@@ -375,6 +392,45 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
                                                  mutatedKeys:newMutatedKeys];
 }
 
+/**
+ * Returns the documents of a refill that can end up in the view. For a limit query, these are the
+ * documents already in the view, so that they are brought up to date, and the `limit` first other
+ * matching documents. Any further documents would be pushed past the limit again right away, so
+ * leaving them out keeps the cost of a refill proportional to the limit rather than to the number
+ * of documents in the local cache.
+ */
+- (MaybeDocumentMap)refillCandidatesFromDocuments:(const MaybeDocumentMap &)docs
+                                      documentSet:(const DocumentSet &)documentSet {
+  NSInteger limit = self.query.limit;
+  if (limit == NSNotFound || docs.size() <= static_cast<size_t>(limit)) {
+    return docs;
+  }
+
+  MaybeDocumentMap candidates;
+  std::vector<FSTDocument *> others;
+  for (const auto &kv : docs) {
+    FSTMaybeDocument *maybeDoc = kv.second;
+    if (documentSet.ContainsKey(kv.first)) {
+      candidates = candidates.insert(kv.first, maybeDoc);
+    } else if ([maybeDoc isKindOfClass:[FSTDocument class]] &&
+               [self.query matchesDocument:static_cast<FSTDocument *>(maybeDoc)]) {
+      others.push_back(static_cast<FSTDocument *>(maybeDoc));
+    }
+  }
+
+  if (others.size() > static_cast<size_t>(limit)) {
+    std::nth_element(others.begin(), others.begin() + limit, others.end(),
+                     [self](FSTDocument *lhs, FSTDocument *rhs) {
+                       return util::Ascending([self compare:lhs with:rhs]);
+                     });
+    others.resize(limit);
+  }
+  for (FSTDocument *doc : others) {
+    candidates = candidates.insert(doc.key, doc);
+  }
+  return candidates;
+}
+
 - (BOOL)shouldWaitForSyncedDocument:(FSTDocument *)newDoc oldDocument:(FSTDocument *)oldDoc {
   // We suppress the initial change event for documents that were modified as part of a write
   // acknowledgment (e.g. when the value of a server transform is applied) as Watch will send us
@@ -399,6 +455,15 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
 
   // Sort changes based on type and query comparator.
   std::vector<DocumentViewChange> changes = docChanges.changeSet.GetChanges();
+  // The change set yields its changes in key order.
+  std::vector<DocumentKey> changedKeyList;
+  changedKeyList.reserve(changes.size());
+  for (const DocumentViewChange &change : changes) {
+    changedKeyList.push_back(change.document().key);
+  }
+  DocumentKeySet changedKeys =
+      DocumentKeySet::FromSorted(changedKeyList.begin(), changedKeyList.end());
+
   std::sort(changes.begin(), changes.end(),
             [self](const DocumentViewChange &lhs, const DocumentViewChange &rhs) {
               int pos1 = GetDocumentViewChangeTypePosition(lhs.type());
@@ -410,7 +475,12 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
             });
 
   [self applyTargetChange:targetChange];
-  NSArray<FSTLimboDocumentChange *> *limboChanges = [self updateLimboDocuments];
+  if (targetChange.has_value()) {
+    changedKeys = changedKeys.set_union(targetChange->added_documents())
+                      .set_union(targetChange->removed_documents());
+  }
+  NSArray<FSTLimboDocumentChange *> *limboChanges =
+      [self updateLimboDocumentsWithChangedKeys:changedKeys];
   BOOL synced = _limboDocuments.empty() && self.isCurrent;
   SyncState newSyncState = synced ? SyncState::Synced : SyncState::Local;
   bool syncStateChanged = newSyncState != self.syncState;
@@ -495,33 +565,54 @@ int GetDocumentViewChangeTypePosition(DocumentViewChange::Type changeType) {
   }
 }
 
-/** Updates limboDocuments and returns any changes as FSTLimboDocumentChanges. */
-- (NSArray<FSTLimboDocumentChange *> *)updateLimboDocuments {
+/**
+ * Updates limboDocuments and returns any changes as FSTLimboDocumentChanges.
+ *
+ * @param changedKeys The keys of the documents that were added to, removed from or changed in the
+ *     view, or added to or removed from the remote target, since the last update. Whether any other
+ *     document is in limbo can't have changed, so only these are checked again.
+ */
+- (NSArray<FSTLimboDocumentChange *> *)updateLimboDocumentsWithChangedKeys:
+    (const DocumentKeySet &)changedKeys {
   // We can only determine limbo documents when we're in-sync with the server.
   if (!self.isCurrent) {
+    _limboDocumentsUpToDate = NO;
     return @[];
   }
 
-  // TODO(klimt): Do this incrementally so that it's not quadratic when updating many documents.
-  DocumentKeySet oldLimboDocuments = std::move(_limboDocuments);
-  _limboDocuments = DocumentKeySet{};
-  for (FSTDocument *doc : *_documentSet) {
-    if ([self shouldBeLimboDocumentKey:doc.key]) {
-      _limboDocuments = _limboDocuments.insert(doc.key);
+  BOOL incremental = _limboDocumentsUpToDate;
+  DocumentKeySet oldLimboDocuments = _limboDocuments;
+  if (incremental) {
+    for (const DocumentKey &key : changedKeys) {
+      if ([self shouldBeLimboDocumentKey:key]) {
+        _limboDocuments = _limboDocuments.insert(key);
+      } else {
+        _limboDocuments = _limboDocuments.erase(key);
+      }
+    }
+  } else {
+    _limboDocuments = DocumentKeySet{};
+    for (FSTDocument *doc : *_documentSet) {
+      if ([self shouldBeLimboDocumentKey:doc.key]) {
+        _limboDocuments = _limboDocuments.insert(doc.key);
+      }
     }
+    _limboDocumentsUpToDate = YES;
   }
 
-  // Diff the new limbo docs with the old limbo docs.
-  NSMutableArray<FSTLimboDocumentChange *> *changes =
-      [NSMutableArray arrayWithCapacity:(oldLimboDocuments.size() + _limboDocuments.size())];
-  for (const DocumentKey &key : oldLimboDocuments) {
-    if (!_limboDocuments.contains(key)) {
+  // Diff the new limbo docs with the old limbo docs. After an incremental update, only the changed
+  // keys can differ.
+  const DocumentKeySet &removedCandidates = incremental ? changedKeys : oldLimboDocuments;
+  const DocumentKeySet &addedCandidates = incremental ? changedKeys : _limboDocuments;
+  NSMutableArray<FSTLimboDocumentChange *> *changes = [NSMutableArray array];
+  for (const DocumentKey &key : removedCandidates) {
+    if (oldLimboDocuments.contains(key) && !_limboDocuments.contains(key)) {
       [changes addObject:[FSTLimboDocumentChange changeWithType:FSTLimboDocumentChangeTypeRemoved
                                                             key:key]];
     }
   }
-  for (const DocumentKey &key : _limboDocuments) {
-    if (!oldLimboDocuments.contains(key)) {
+  for (const DocumentKey &key : addedCandidates) {
+    if (_limboDocuments.contains(key) && !oldLimboDocuments.contains(key)) {
       [changes addObject:[FSTLimboDocumentChange changeWithType:FSTLimboDocumentChangeTypeAdded
                                                             key:key]];
     }
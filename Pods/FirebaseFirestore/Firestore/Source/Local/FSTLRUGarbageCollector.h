@@ -16,6 +16,7 @@
 
 #import <Foundation/Foundation.h>
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
 
@@ -105,6 +106,27 @@ namespace local = firebase::firestore::local;
                                   (const std::unordered_map<model::TargetId, FSTQueryData *> &)
                                       liveQueries;
 
+/**
+ * Removes the given target if it is still cached, is not currently being listened to and has a
+ * sequence number less than or equal to the given sequence number. Returns whether the target was
+ * removed.
+ *
+ * Calls `callback` with the key and sequence number of each document that the target referenced and
+ * that no remaining target does, since removing the target may have orphaned it.
+ */
+- (BOOL)removeInactiveTarget:(FSTQueryData *)queryData
+       throughSequenceNumber:(model::ListenSequenceNumber)sequenceNumber
+                 liveQueries:
+                     (const std::unordered_map<model::TargetId, FSTQueryData *> &)liveQueries
+           orphanedDocuments:(const local::OrphanedDocumentCallback &)callback;
+
+/**
+ * Removes the given document from the cache if it is still unreferenced and has a sequence number
+ * less than or equal to the given sequence number. Returns whether the document was removed.
+ */
+- (BOOL)removeOrphanedDocument:(const model::DocumentKey &)key
+         throughSequenceNumber:(model::ListenSequenceNumber)sequenceNumber;
+
 - (size_t)byteSize;
 
 /** Returns the number of targets and orphaned documents cached. */
@@ -158,4 +180,24 @@ namespace local = firebase::firestore::local;
 - (local::LruResults)collectWithLiveTargets:
     (const std::unordered_map<model::TargetId, FSTQueryData *> &)liveTargets;
 
+/**
+ * Runs one slice of an incremental collection, which spreads the work of collectWithLiveTargets:
+ * over several calls so that no single call holds up the queue for long. Absent foreground work in
+ * between, it removes the same targets and documents.
+ *
+ * If no collection is in progress, this starts one: it applies the same thresholds as
+ * collectWithLiveTargets: and gathers the least recently used targets and orphaned documents into
+ * a heap ordered by sequence number. Each call then removes candidates, oldest first, until the
+ * budget has elapsed, re-checking each one since foreground work may have used it in between.
+ * Documents orphaned by the targets removed along the way join the heap too.
+ *
+ * Returns the progress of the current collection so far. Call again while `collecting` is YES.
+ */
+- (local::LruResults)collectIncrementallyWithLiveTargets:
+                         (const std::unordered_map<model::TargetId, FSTQueryData *> &)liveTargets
+                                                  budget:(std::chrono::milliseconds)budget;
+
+/** Whether an incremental collection has candidates left to remove. */
+@property(nonatomic, assign, readonly, getter=isCollecting) BOOL collecting;
+
 @end
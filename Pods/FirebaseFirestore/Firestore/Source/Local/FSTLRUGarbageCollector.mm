@@ -19,6 +19,7 @@
 #include <chrono>  //NOLINT(build/c++11)
 #include <queue>
 #include <utility>
+#include <vector>
 
 #import "Firestore/Source/Local/FSTPersistence.h"
 #include "Firestore/core/include/firebase/firestore/timestamp.h"
@@ -27,6 +28,7 @@
 #include "Firestore/core/src/firebase/firestore/util/log.h"
 
 namespace api = firebase::firestore::api;
+using Clock = std::chrono::steady_clock;
 using Millis = std::chrono::milliseconds;
 using firebase::Timestamp;
 using firebase::firestore::local::LruParams;
@@ -82,11 +84,39 @@ class RollingSequenceNumberBuffer {
   const size_t max_elements_;
 };
 
+/**
+ * A target or orphaned document that an incremental collection may remove, along with the sequence
+ * number it had when the collection started.
+ */
+struct LruCandidate {
+  ListenSequenceNumber sequence_number;
+  /** The target to remove, or nil if this is a document. */
+  FSTQueryData *query_data;
+  DocumentKey document_key;
+};
+
+struct LaterSequenceNumber {
+  bool operator()(const LruCandidate &lhs, const LruCandidate &rhs) const {
+    return lhs.sequence_number > rhs.sequence_number;
+  }
+};
+
+/** A min-heap of candidates: the least recently used one is on top. */
+using LruCandidateHeap =
+    std::priority_queue<LruCandidate, std::vector<LruCandidate>, LaterSequenceNumber>;
+
 }  // namespace
 
 @implementation FSTLRUGarbageCollector {
   __weak id<FSTLRUDelegate> _delegate;
   LruParams _params;
+
+  // The state of the incremental collection in progress, if any.
+  LruCandidateHeap _candidates;
+  ListenSequenceNumber _incrementalUpperBound;
+  LruResults _incrementalResults;
+  Timestamp _incrementalStart;
+  int _incrementalSlices;
 }
 
 - (instancetype)initWithDelegate:(id<FSTLRUDelegate>)delegate params:(LruParams)params {
@@ -100,9 +130,16 @@ class RollingSequenceNumberBuffer {
 
 - (LruResults)collectWithLiveTargets:
     (const std::unordered_map<TargetId, FSTQueryData *> &)liveTargets {
+  if (![self shouldCollect]) {
+    return LruResults::DidNotRun();
+  }
+  return [self runGCWithLiveTargets:liveTargets];
+}
+
+- (BOOL)shouldCollect {
   if (_params.minBytesThreshold == api::Settings::CacheSizeUnlimited) {
     LOG_DEBUG("Garbage collection skipped; disabled");
-    return LruResults::DidNotRun();
+    return NO;
   }
 
   size_t currentSize = [self byteSize];
@@ -110,21 +147,17 @@ class RollingSequenceNumberBuffer {
     // Not enough on disk to warrant collection. Wait another timeout cycle.
     LOG_DEBUG("Garbage collection skipped; Cache size %s is lower than threshold %s", currentSize,
               _params.minBytesThreshold);
-    return LruResults::DidNotRun();
+    return NO;
   } else {
     LOG_DEBUG("Running garbage collection on cache of size: %s", currentSize);
-    return [self runGCWithLiveTargets:liveTargets];
+    return YES;
   }
 }
 
 - (LruResults)runGCWithLiveTargets:
     (const std::unordered_map<TargetId, FSTQueryData *> &)liveTargets {
   Timestamp start = Timestamp::Now();
-  int sequenceNumbers = [self queryCountForPercentile:_params.percentileToCollect];
-  // Cap at the configured max
-  if (sequenceNumbers > _params.maximumSequenceNumbersToCollect) {
-    sequenceNumbers = _params.maximumSequenceNumbersToCollect;
-  }
+  int sequenceNumbers = [self sequenceNumbersToCollect];
   Timestamp countedTargets = Timestamp::Now();
 
   ListenSequenceNumber upperBound = [self sequenceNumberForQueryCount:sequenceNumbers];
@@ -153,6 +186,98 @@ class RollingSequenceNumberBuffer {
   return LruResults{/* didRun= */ true, sequenceNumbers, numTargetsRemoved, numDocumentsRemoved};
 }
 
+- (BOOL)isCollecting {
+  return !_candidates.empty();
+}
+
+- (LruResults)collectIncrementallyWithLiveTargets:
+                  (const std::unordered_map<TargetId, FSTQueryData *> &)liveTargets
+                                           budget:(Millis)budget {
+  Clock::time_point deadline = Clock::now() + budget;
+  if (!self.collecting) {
+    if (![self shouldCollect]) {
+      return LruResults::DidNotRun();
+    }
+    [self gatherCandidatesWithLiveTargets:liveTargets];
+  }
+  _incrementalSlices++;
+
+  // Always remove at least one candidate so that the collection finishes even if gathering the
+  // candidates used up the budget.
+  bool madeProgress = false;
+  LruCandidateHeap &candidates = _candidates;
+  ListenSequenceNumber upperBound = _incrementalUpperBound;
+  while (!_candidates.empty() && (!madeProgress || Clock::now() < deadline)) {
+    LruCandidate candidate = _candidates.top();
+    _candidates.pop();
+    if (candidate.query_data) {
+      // collectWithLiveTargets: removes the documents orphaned by the targets it removes, so
+      // collect those too.
+      if ([_delegate removeInactiveTarget:candidate.query_data
+                    throughSequenceNumber:upperBound
+                              liveQueries:liveTargets
+                        orphanedDocuments:[&](const DocumentKey &docKey,
+                                              ListenSequenceNumber sequenceNumber) {
+                          if (sequenceNumber <= upperBound) {
+                            candidates.push(LruCandidate{sequenceNumber, nil, docKey});
+                          }
+                        }]) {
+        _incrementalResults.targetsRemoved++;
+      }
+    } else if ([_delegate removeOrphanedDocument:candidate.document_key
+                           throughSequenceNumber:upperBound]) {
+      _incrementalResults.documentsRemoved++;
+    }
+    madeProgress = true;
+  }
+
+  if (_candidates.empty()) {
+    LOG_DEBUG("Incremental LRU Garbage Collection removed %s targets and %s documents in %s "
+              "slices over %sms",
+              _incrementalResults.targetsRemoved, _incrementalResults.documentsRemoved,
+              _incrementalSlices, millisecondsBetween(_incrementalStart, Timestamp::Now()));
+  }
+  return _incrementalResults;
+}
+
+/**
+ * Starts an incremental collection by gathering every target and orphaned document at or below the
+ * percentile sequence number that runGCWithLiveTargets: would use.
+ */
+- (void)gatherCandidatesWithLiveTargets:
+    (const std::unordered_map<TargetId, FSTQueryData *> &)liveTargets {
+  _incrementalStart = Timestamp::Now();
+  _incrementalSlices = 0;
+
+  int sequenceNumbers = [self sequenceNumbersToCollect];
+  ListenSequenceNumber upperBound = [self sequenceNumberForQueryCount:sequenceNumbers];
+  _incrementalUpperBound = upperBound;
+  _incrementalResults = LruResults{/* didRun= */ true, sequenceNumbers, 0, 0};
+
+  LruCandidateHeap &candidates = _candidates;
+  [_delegate enumerateTargetsUsingCallback:[&](FSTQueryData *queryData) {
+    if (queryData.sequenceNumber <= upperBound &&
+        liveTargets.find(queryData.targetID) == liveTargets.end()) {
+      candidates.push(LruCandidate{queryData.sequenceNumber, queryData, DocumentKey{}});
+    }
+  }];
+  [_delegate enumerateMutationsUsingCallback:[&](const DocumentKey &docKey,
+                                                 ListenSequenceNumber sequenceNumber) {
+    if (sequenceNumber <= upperBound) {
+      candidates.push(LruCandidate{sequenceNumber, nil, docKey});
+    }
+  }];
+}
+
+/** Returns the number of sequence numbers to collect, capped at the configured max. */
+- (int)sequenceNumbersToCollect {
+  int sequenceNumbers = [self queryCountForPercentile:_params.percentileToCollect];
+  if (sequenceNumbers > _params.maximumSequenceNumbersToCollect) {
+    sequenceNumbers = _params.maximumSequenceNumbersToCollect;
+  }
+  return sequenceNumbers;
+}
+
 - (int)queryCountForPercentile:(NSUInteger)percentile {
   size_t totalCount = [_delegate sequenceNumberCount];
   int setSize = (int)((percentile / 100.0f) * totalCount);
@@ -41,6 +41,7 @@
 #include "Firestore/core/src/firebase/firestore/local/remote_document_cache.h"
 #include "Firestore/core/src/firebase/firestore/model/database_id.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
+#include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/model/resource_path.h"
 #include "Firestore/core/src/firebase/firestore/model/types.h"
 #include "Firestore/core/src/firebase/firestore/util/filesystem.h"
@@ -54,6 +55,7 @@
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "leveldb/db.h"
+#include "leveldb/filter_policy.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -69,6 +71,7 @@ using firebase::firestore::local::LevelDbIndexManager;
 using firebase::firestore::local::LevelDbMigrations;
 using firebase::firestore::local::LevelDbMutationKey;
 using firebase::firestore::local::LevelDbMutationQueue;
+using firebase::firestore::local::LevelDbPrefixExtractor;
 using firebase::firestore::local::LevelDbQueryCache;
 using firebase::firestore::local::LevelDbRemoteDocumentCache;
 using firebase::firestore::local::LevelDbTransaction;
@@ -79,6 +82,7 @@ using firebase::firestore::local::ReferenceSet;
 using firebase::firestore::local::RemoteDocumentCache;
 using firebase::firestore::local::TargetCallback;
 using firebase::firestore::model::DocumentKey;
+using firebase::firestore::model::DocumentKeySet;
 using firebase::firestore::model::ListenSequenceNumber;
 using firebase::firestore::model::ResourcePath;
 using firebase::firestore::model::TargetId;
@@ -245,6 +249,58 @@ static const char *kReservedPathComponent = "firestore";
   return _db.queryCache->RemoveTargets(sequenceNumber, liveQueries);
 }
 
+- (BOOL)removeInactiveTarget:(FSTQueryData *)queryData
+       throughSequenceNumber:(ListenSequenceNumber)sequenceNumber
+                 liveQueries:
+                     (const std::unordered_map<TargetId, FSTQueryData *> &)liveQueries
+           orphanedDocuments:(const OrphanedDocumentCallback &)callback {
+  if (liveQueries.find(queryData.targetID) != liveQueries.end()) {
+    return NO;
+  }
+  // The target may have been used or removed since the caller read it.
+  FSTQueryData *current = _db.queryCache->GetTarget(queryData.query);
+  if (!current || current.targetID != queryData.targetID ||
+      current.sequenceNumber > sequenceNumber) {
+    return NO;
+  }
+  DocumentKeySet keys = _db.queryCache->GetMatchingKeys(current.targetID);
+  _db.queryCache->RemoveTarget(current);
+
+  // Removing the target leaves the sentinel rows of its documents in place.
+  for (const DocumentKey &key : keys) {
+    if (_db.queryCache->Contains(key)) {
+      continue;
+    }
+    std::string encodedSequenceNumber;
+    leveldb::Status status = _db.currentTransaction->Get(LevelDbDocumentTargetKey::SentinelKey(key),
+                                                        &encodedSequenceNumber);
+    if (status.ok()) {
+      callback(key, LevelDbDocumentTargetKey::DecodeSentinelValue(encodedSequenceNumber));
+    }
+  }
+  return YES;
+}
+
+- (BOOL)removeOrphanedDocument:(const DocumentKey &)key
+         throughSequenceNumber:(ListenSequenceNumber)sequenceNumber {
+  std::string encodedSequenceNumber;
+  leveldb::Status status = _db.currentTransaction->Get(LevelDbDocumentTargetKey::SentinelKey(key),
+                                                      &encodedSequenceNumber);
+  if (status.IsNotFound()) {
+    // Already removed.
+    return NO;
+  }
+  HARD_ASSERT(status.ok(), "Failed to read sentinel for %s: %s", key.ToString(), status.ToString());
+
+  if (LevelDbDocumentTargetKey::DecodeSentinelValue(encodedSequenceNumber) > sequenceNumber ||
+      _db.queryCache->Contains(key) || [self isPinned:key]) {
+    return NO;
+  }
+  _db.remoteDocumentCache->Remove(key);
+  [self removeSentinel:key];
+  return YES;
+}
+
 - (size_t)sequenceNumberCount {
   size_t totalCount = _db.queryCache->size();
   [self enumerateMutationsUsingCallback:[&totalCount](const DocumentKey &key,
@@ -463,8 +519,13 @@ static const char *kReservedPathComponent = "firestore";
 
 /** Opens the database within the given directory. */
 + (StatusOr<std::unique_ptr<DB>>)createDBWithDirectory:(const Path &)directory {
+  // Shared by every database and never deleted, so that it outlives them.
+  static const leveldb::FilterPolicy *filterPolicy =
+      leveldb::NewPrefixBloomFilterPolicy(10, new LevelDbPrefixExtractor());
+
   Options options;
   options.create_if_missing = true;
+  options.filter_policy = filterPolicy;
 
   DB *database = nullptr;
   leveldb::Status status = DB::Open(options, directory.ToUtf8String(), &database);
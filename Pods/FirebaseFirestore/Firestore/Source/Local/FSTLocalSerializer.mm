@@ -230,6 +230,10 @@ using firebase::firestore::model::TargetId;
   proto.lastListenSequenceNumber = queryData.sequenceNumber;
   proto.snapshotVersion = [remoteSerializer encodedVersion:queryData.snapshotVersion];
   proto.resumeToken = queryData.resumeToken;
+  if (queryData.lastLimboFreeSnapshotVersion != SnapshotVersion::None()) {
+    proto.lastLimboFreeSnapshotVersion =
+        [remoteSerializer encodedVersion:queryData.lastLimboFreeSnapshotVersion];
+  }
 
   FSTQuery *query = queryData.query;
   if ([query isDocumentQuery]) {
@@ -248,6 +252,10 @@ using firebase::firestore::model::TargetId;
   ListenSequenceNumber sequenceNumber = target.lastListenSequenceNumber;
   SnapshotVersion version = [remoteSerializer decodedVersion:target.snapshotVersion];
   NSData *resumeToken = target.resumeToken;
+  SnapshotVersion lastLimboFreeVersion =
+      target.hasLastLimboFreeSnapshotVersion
+          ? [remoteSerializer decodedVersion:target.lastLimboFreeSnapshotVersion]
+          : SnapshotVersion::None();
 
   FSTQuery *query;
   switch (target.targetTypeOneOfCase) {
@@ -268,6 +276,7 @@ using firebase::firestore::model::TargetId;
                         listenSequenceNumber:sequenceNumber
                                      purpose:FSTQueryPurposeListen
                              snapshotVersion:version
+                lastLimboFreeSnapshotVersion:lastLimboFreeVersion
                                  resumeToken:resumeToken];
 }
 
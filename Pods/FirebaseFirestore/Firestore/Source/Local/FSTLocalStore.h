@@ -16,6 +16,7 @@
 
 #import <Foundation/Foundation.h>
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <vector>
 
 #import "Firestore/Source/Local/FSTLRUGarbageCollector.h"
@@ -192,6 +193,13 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (local::LruResults)collectGarbage:(FSTLRUGarbageCollector *)garbageCollector;
 
+/**
+ * Runs one slice of an incremental garbage collection, taking at most about `budget`. See
+ * -[FSTLRUGarbageCollector collectIncrementallyWithLiveTargets:budget:].
+ */
+- (local::LruResults)collectGarbage:(FSTLRUGarbageCollector *)garbageCollector
+                             budget:(std::chrono::milliseconds)budget;
+
 @end
 
 NS_ASSUME_NONNULL_END
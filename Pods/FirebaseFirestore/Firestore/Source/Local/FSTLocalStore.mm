@@ -16,6 +16,7 @@
 
 #import "Firestore/Source/Local/FSTLocalStore.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -39,6 +40,7 @@
 #include "Firestore/core/src/firebase/firestore/local/local_documents_view.h"
 #include "Firestore/core/src/firebase/firestore/local/mutation_queue.h"
 #include "Firestore/core/src/firebase/firestore/local/query_cache.h"
+#include "Firestore/core/src/firebase/firestore/local/query_engine.h"
 #include "Firestore/core/src/firebase/firestore/local/reference_set.h"
 #include "Firestore/core/src/firebase/firestore/local/remote_document_cache.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
@@ -55,6 +57,7 @@ using firebase::firestore::local::LocalDocumentsView;
 using firebase::firestore::local::LruResults;
 using firebase::firestore::local::MutationQueue;
 using firebase::firestore::local::QueryCache;
+using firebase::firestore::local::QueryEngine;
 using firebase::firestore::local::ReferenceSet;
 using firebase::firestore::local::RemoteDocumentCache;
 using firebase::firestore::model::BatchId;
@@ -104,6 +107,9 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
   /** The "local" view of all documents (layering mutationQueue on top of remoteDocumentCache). */
   std::unique_ptr<LocalDocumentsView> _localDocuments;
 
+  /** Executes queries against _localDocuments, reading only what changed where possible. */
+  std::unique_ptr<QueryEngine> _queryEngine;
+
   /** The set of document references maintained by any local views. */
   ReferenceSet _localViewReferences;
 
@@ -120,6 +126,7 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
     _queryCache = [persistence queryCache];
     _localDocuments = absl::make_unique<LocalDocumentsView>(_remoteDocumentCache, _mutationQueue,
                                                             [_persistence indexManager]);
+    _queryEngine = absl::make_unique<QueryEngine>(_localDocuments.get());
     [_persistence.referenceDelegate addInMemoryPins:&_localViewReferences];
 
     _targetIDGenerator = TargetIdGenerator::QueryCacheTargetIdGenerator(0);
@@ -144,6 +151,7 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
       [&]() -> std::vector<FSTMutationBatch *> { return _mutationQueue->AllMutationBatches(); });
 
   // The old one has a reference to the mutation queue, so nil it out first.
+  _queryEngine.reset();
   _localDocuments.reset();
   _mutationQueue = [self.persistence mutationQueueForUser:user];
 
@@ -155,6 +163,7 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
     // Recreate our LocalDocumentsView using the new MutationQueue.
     _localDocuments = absl::make_unique<LocalDocumentsView>(_remoteDocumentCache, _mutationQueue,
                                                             [_persistence indexManager]);
+    _queryEngine = absl::make_unique<QueryEngine>(_localDocuments.get());
 
     // Union the old/new changed keys.
     DocumentKeySet changedKeys;
@@ -285,12 +294,8 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
       // If the document is only updated while removing it from a target then watch isn't obligated
       // to send the absolute latest version: it can send the first version that caused the document
       // not to match.
-      for (const DocumentKey &key : change.added_documents()) {
-        authoritativeUpdates = authoritativeUpdates.insert(key);
-      }
-      for (const DocumentKey &key : change.modified_documents()) {
-        authoritativeUpdates = authoritativeUpdates.insert(key);
-      }
+      authoritativeUpdates = authoritativeUpdates.set_union(change.added_documents())
+                                 .set_union(change.modified_documents());
 
       _queryCache->RemoveMatchingKeys(change.removed_documents(), targetID);
       _queryCache->AddMatchingKeys(change.added_documents(), targetID);
@@ -337,7 +342,7 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
       if (!existingDoc || doc.version == SnapshotVersion::None() ||
           (authoritativeUpdates.contains(doc.key) && !existingDoc.hasPendingWrites) ||
           doc.version >= existingDoc.version) {
-        _remoteDocumentCache->Add(doc);
+        _remoteDocumentCache->Add(doc, remoteEvent.snapshot_version());
         changedDocs = changedDocs.insert(key, doc);
       } else {
         LOG_DEBUG("FSTLocalStore Ignoring outdated watch update for %s. "
@@ -408,11 +413,24 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
 - (void)notifyLocalViewChanges:(NSArray<FSTLocalViewChanges *> *)viewChanges {
   self.persistence.run("NotifyLocalViewChanges", [&]() {
     for (FSTLocalViewChanges *viewChange in viewChanges) {
+      TargetId targetID = viewChange.targetID;
       for (const DocumentKey &key : viewChange.removedKeys) {
         [self->_persistence.referenceDelegate removeReference:key];
       }
-      _localViewReferences.AddReferences(viewChange.addedKeys, viewChange.targetID);
-      _localViewReferences.AddReferences(viewChange.removedKeys, viewChange.targetID);
+      _localViewReferences.AddReferences(viewChange.addedKeys, targetID);
+      _localViewReferences.AddReferences(viewChange.removedKeys, targetID);
+
+      if (!viewChange.fromCache) {
+        auto found = _targetIDs.find(targetID);
+        HARD_ASSERT(found != _targetIDs.end(),
+                    "Can't set limbo-free snapshot version for unknown target: %s", targetID);
+
+        // Advance the last limbo free snapshot version: the view is in sync with the target as of
+        // the target's latest snapshot.
+        FSTQueryData *queryData = found->second;
+        found->second = [queryData
+            queryDataByReplacingLastLimboFreeSnapshotVersion:queryData.snapshotVersion];
+      }
     }
   });
 }
@@ -463,10 +481,12 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
     if (found != _targetIDs.end()) {
       FSTQueryData *cachedQueryData = found->second;
 
-      if (cachedQueryData.snapshotVersion > queryData.snapshotVersion) {
+      if (cachedQueryData.snapshotVersion > queryData.snapshotVersion ||
+          cachedQueryData.lastLimboFreeSnapshotVersion > queryData.lastLimboFreeSnapshotVersion) {
         // If we've been avoiding persisting the resumeToken (see shouldPersistQueryData for
         // conditions and rationale) we need to persist the token now because there will no
-        // longer be an in-memory version to fall back on.
+        // longer be an in-memory version to fall back on. The same goes for the last limbo-free
+        // snapshot version, which is only tracked in memory while the query is active.
         queryData = cachedQueryData;
         _queryCache->UpdateTarget(queryData);
       }
@@ -487,10 +507,35 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
 
 - (DocumentMap)executeQuery:(FSTQuery *)query {
   return self.persistence.run("ExecuteQuery", [&]() -> DocumentMap {
-    return _localDocuments->GetDocumentsMatchingQuery(query);
+    SnapshotVersion lastLimboFreeSnapshotVersion = SnapshotVersion::None();
+    DocumentKeySet remoteKeys;
+
+    FSTQueryData *queryData = [self queryDataForQuery:query];
+    if (queryData) {
+      lastLimboFreeSnapshotVersion = queryData.lastLimboFreeSnapshotVersion;
+      remoteKeys = _queryCache->GetMatchingKeys(queryData.targetID);
+    }
+
+    return _queryEngine->GetDocumentsMatchingQuery(query, lastLimboFreeSnapshotVersion,
+                                                   remoteKeys);
   });
 }
 
+/**
+ * Returns the query data for the given query, preferring the in-memory version of an active query
+ * over the persisted one, or nil if the query has never been allocated.
+ */
+- (nullable FSTQueryData *)queryDataForQuery:(FSTQuery *)query {
+  FSTQueryData *queryData = _queryCache->GetTarget(query);
+  if (queryData) {
+    auto found = _targetIDs.find(queryData.targetID);
+    if (found != _targetIDs.end()) {
+      return found->second;
+    }
+  }
+  return queryData;
+}
+
 - (DocumentKeySet)remoteDocumentKeysForTarget:(TargetId)targetID {
   return self.persistence.run("RemoteDocumentKeysForTarget", [&]() -> DocumentKeySet {
     return _queryCache->GetMatchingKeys(targetID);
@@ -515,7 +560,7 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
         HARD_ASSERT(!remoteDoc, "Mutation batch %s applied to document %s resulted in nil.", batch,
                     remoteDoc);
       } else {
-        _remoteDocumentCache->Add(doc);
+        _remoteDocumentCache->Add(doc, batchResult.commitVersion);
       }
     }
   }
@@ -529,6 +574,13 @@ static const int64_t kResumeTokenMaxAgeSeconds = 5 * 60;  // 5 minutes
   });
 }
 
+- (LruResults)collectGarbage:(FSTLRUGarbageCollector *)garbageCollector
+                      budget:(std::chrono::milliseconds)budget {
+  return self.persistence.run("Collect garbage incrementally", [&]() -> LruResults {
+    return [garbageCollector collectIncrementallyWithLiveTargets:_targetIDs budget:budget];
+  });
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
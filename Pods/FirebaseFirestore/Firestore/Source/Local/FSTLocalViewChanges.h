@@ -39,6 +39,11 @@ NS_ASSUME_NONNULL_BEGIN
                        addedKeys:(model::DocumentKeySet)addedKeys
                      removedKeys:(model::DocumentKeySet)removedKeys;
 
++ (instancetype)changesForTarget:(model::TargetId)targetID
+                       addedKeys:(model::DocumentKeySet)addedKeys
+                     removedKeys:(model::DocumentKeySet)removedKeys
+                       fromCache:(BOOL)fromCache;
+
 + (instancetype)changesForViewSnapshot:(const core::ViewSnapshot &)viewSnapshot
                           withTargetID:(model::TargetId)targetID;
 
@@ -46,6 +51,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property(readonly) model::TargetId targetID;
 
+/**
+ * Whether the view snapshot these changes were computed from was marked as fromCache. If not, the
+ * view was in sync with the backend and had no limbo documents.
+ */
+@property(readonly) BOOL fromCache;
+
 - (const model::DocumentKeySet &)addedKeys;
 - (const model::DocumentKeySet &)removedKeys;
 
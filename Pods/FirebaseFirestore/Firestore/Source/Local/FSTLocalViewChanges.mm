@@ -32,7 +32,8 @@ NS_ASSUME_NONNULL_BEGIN
 @interface FSTLocalViewChanges ()
 - (instancetype)initWithTarget:(TargetId)targetID
                      addedKeys:(DocumentKeySet)addedKeys
-                   removedKeys:(DocumentKeySet)removedKeys NS_DESIGNATED_INITIALIZER;
+                   removedKeys:(DocumentKeySet)removedKeys
+                     fromCache:(BOOL)fromCache NS_DESIGNATED_INITIALIZER;
 @end
 
 @implementation FSTLocalViewChanges {
@@ -63,25 +64,39 @@ NS_ASSUME_NONNULL_BEGIN
 
   return [self changesForTarget:targetID
                       addedKeys:std::move(addedKeys)
-                    removedKeys:std::move(removedKeys)];
+                    removedKeys:std::move(removedKeys)
+                      fromCache:viewSnapshot.from_cache()];
 }
 
 + (instancetype)changesForTarget:(TargetId)targetID
                        addedKeys:(DocumentKeySet)addedKeys
                      removedKeys:(DocumentKeySet)removedKeys {
+  return [self changesForTarget:targetID
+                      addedKeys:std::move(addedKeys)
+                    removedKeys:std::move(removedKeys)
+                      fromCache:YES];
+}
+
++ (instancetype)changesForTarget:(TargetId)targetID
+                       addedKeys:(DocumentKeySet)addedKeys
+                     removedKeys:(DocumentKeySet)removedKeys
+                       fromCache:(BOOL)fromCache {
   return [[FSTLocalViewChanges alloc] initWithTarget:targetID
                                            addedKeys:std::move(addedKeys)
-                                         removedKeys:std::move(removedKeys)];
+                                         removedKeys:std::move(removedKeys)
+                                           fromCache:fromCache];
 }
 
 - (instancetype)initWithTarget:(TargetId)targetID
                      addedKeys:(DocumentKeySet)addedKeys
-                   removedKeys:(DocumentKeySet)removedKeys {
+                   removedKeys:(DocumentKeySet)removedKeys
+                     fromCache:(BOOL)fromCache {
   self = [super init];
   if (self) {
     _targetID = targetID;
     _addedKeys = std::move(addedKeys);
     _removedKeys = std::move(removedKeys);
+    _fromCache = fromCache;
   }
   return self;
 }
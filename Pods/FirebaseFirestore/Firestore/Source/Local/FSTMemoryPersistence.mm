@@ -30,6 +30,7 @@
 #include "Firestore/core/src/firebase/firestore/local/memory_remote_document_cache.h"
 #include "Firestore/core/src/firebase/firestore/local/reference_set.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
+#include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/util/hard_assert.h"
 #include "absl/memory/memory.h"
 
@@ -44,6 +45,7 @@ using firebase::firestore::local::MemoryRemoteDocumentCache;
 using firebase::firestore::local::ReferenceSet;
 using firebase::firestore::local::TargetCallback;
 using firebase::firestore::model::DocumentKey;
+using firebase::firestore::model::DocumentKeySet;
 using firebase::firestore::model::DocumentKeyHash;
 using firebase::firestore::model::ListenSequenceNumber;
 using firebase::firestore::model::TargetId;
@@ -258,6 +260,44 @@ NS_ASSUME_NONNULL_BEGIN
   return _persistence.queryCache->RemoveTargets(sequenceNumber, liveQueries);
 }
 
+- (BOOL)removeInactiveTarget:(FSTQueryData *)queryData
+       throughSequenceNumber:(ListenSequenceNumber)sequenceNumber
+                 liveQueries:
+                     (const std::unordered_map<TargetId, FSTQueryData *> &)liveQueries
+           orphanedDocuments:
+               (const firebase::firestore::local::OrphanedDocumentCallback &)callback {
+  if (liveQueries.find(queryData.targetID) != liveQueries.end()) {
+    return NO;
+  }
+  // The target may have been used or removed since the caller read it.
+  FSTQueryData *current = _persistence.queryCache->GetTarget(queryData.query);
+  if (!current || current.targetID != queryData.targetID ||
+      current.sequenceNumber > sequenceNumber) {
+    return NO;
+  }
+  DocumentKeySet keys = _persistence.queryCache->GetMatchingKeys(current.targetID);
+  _persistence.queryCache->RemoveTarget(current);
+
+  for (const DocumentKey &key : keys) {
+    auto it = _sequenceNumbers.find(key);
+    if (it != _sequenceNumbers.end() && !_persistence.queryCache->Contains(key)) {
+      callback(key, it->second);
+    }
+  }
+  return YES;
+}
+
+- (BOOL)removeOrphanedDocument:(const DocumentKey &)key
+         throughSequenceNumber:(ListenSequenceNumber)sequenceNumber {
+  if (_sequenceNumbers.find(key) == _sequenceNumbers.end() ||
+      [self isPinnedAtSequenceNumber:sequenceNumber document:key]) {
+    return NO;
+  }
+  _persistence.remoteDocumentCache->Remove(key);
+  _sequenceNumbers.erase(key);
+  return YES;
+}
+
 - (size_t)sequenceNumberCount {
   size_t totalCount = _persistence.queryCache->size();
   [self enumerateMutationsUsingCallback:[&totalCount](const DocumentKey &key,
@@ -45,8 +45,17 @@ typedef NS_ENUM(NSInteger, FSTQueryPurpose) {
          listenSequenceNumber:(model::ListenSequenceNumber)sequenceNumber
                       purpose:(FSTQueryPurpose)purpose
               snapshotVersion:(model::SnapshotVersion)snapshotVersion
+ lastLimboFreeSnapshotVersion:(model::SnapshotVersion)lastLimboFreeSnapshotVersion
                   resumeToken:(NSData *)resumeToken NS_DESIGNATED_INITIALIZER;
 
+/** Convenience initializer for query data without a last limbo-free snapshot version. */
+- (instancetype)initWithQuery:(FSTQuery *)query
+                     targetID:(model::TargetId)targetID
+         listenSequenceNumber:(model::ListenSequenceNumber)sequenceNumber
+                      purpose:(FSTQueryPurpose)purpose
+              snapshotVersion:(model::SnapshotVersion)snapshotVersion
+                  resumeToken:(NSData *)resumeToken;
+
 /** Convenience initializer for use when creating an FSTQueryData for the first time. */
 - (instancetype)initWithQuery:(FSTQuery *)query
                      targetID:(model::TargetId)targetID
@@ -63,9 +72,23 @@ typedef NS_ENUM(NSInteger, FSTQueryPurpose) {
                                         resumeToken:(NSData *)resumeToken
                                      sequenceNumber:(model::ListenSequenceNumber)sequenceNumber;
 
+/**
+ * Creates a new query data instance with an updated last limbo-free snapshot version.
+ */
+- (instancetype)queryDataByReplacingLastLimboFreeSnapshotVersion:
+    (model::SnapshotVersion)lastLimboFreeSnapshotVersion;
+
 /** The latest snapshot version seen for this target. */
 - (const model::SnapshotVersion &)snapshotVersion;
 
+/**
+ * The maximum snapshot version at which the associated view contained no limbo documents, or
+ * SnapshotVersion::None() if that is not known. Documents that are still part of the target's
+ * result set and were not changed after this version do not need to be read again when the query
+ * is re-executed.
+ */
+- (const model::SnapshotVersion &)lastLimboFreeSnapshotVersion;
+
 /** The query being listened to. */
 @property(nonatomic, strong, readonly) FSTQuery *query;
 
@@ -32,6 +32,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @implementation FSTQueryData {
   SnapshotVersion _snapshotVersion;
+  SnapshotVersion _lastLimboFreeSnapshotVersion;
 }
 
 - (instancetype)initWithQuery:(FSTQuery *)query
@@ -39,6 +40,7 @@ NS_ASSUME_NONNULL_BEGIN
          listenSequenceNumber:(ListenSequenceNumber)sequenceNumber
                       purpose:(FSTQueryPurpose)purpose
               snapshotVersion:(SnapshotVersion)snapshotVersion
+ lastLimboFreeSnapshotVersion:(SnapshotVersion)lastLimboFreeSnapshotVersion
                   resumeToken:(NSData *)resumeToken {
   self = [super init];
   if (self) {
@@ -47,11 +49,27 @@ NS_ASSUME_NONNULL_BEGIN
     _sequenceNumber = sequenceNumber;
     _purpose = purpose;
     _snapshotVersion = std::move(snapshotVersion);
+    _lastLimboFreeSnapshotVersion = std::move(lastLimboFreeSnapshotVersion);
     _resumeToken = [resumeToken copy];
   }
   return self;
 }
 
+- (instancetype)initWithQuery:(FSTQuery *)query
+                     targetID:(TargetId)targetID
+         listenSequenceNumber:(ListenSequenceNumber)sequenceNumber
+                      purpose:(FSTQueryPurpose)purpose
+              snapshotVersion:(SnapshotVersion)snapshotVersion
+                  resumeToken:(NSData *)resumeToken {
+  return [self initWithQuery:query
+                          targetID:targetID
+              listenSequenceNumber:sequenceNumber
+                           purpose:purpose
+                   snapshotVersion:std::move(snapshotVersion)
+      lastLimboFreeSnapshotVersion:SnapshotVersion::None()
+                       resumeToken:resumeToken];
+}
+
 - (instancetype)initWithQuery:(FSTQuery *)query
                      targetID:(TargetId)targetID
          listenSequenceNumber:(ListenSequenceNumber)sequenceNumber
@@ -68,6 +86,10 @@ NS_ASSUME_NONNULL_BEGIN
   return _snapshotVersion;
 }
 
+- (const firebase::firestore::model::SnapshotVersion &)lastLimboFreeSnapshotVersion {
+  return _lastLimboFreeSnapshotVersion;
+}
+
 - (BOOL)isEqual:(id)object {
   if (self == object) {
     return YES;
@@ -80,20 +102,24 @@ NS_ASSUME_NONNULL_BEGIN
   return [self.query isEqual:other.query] && self.targetID == other.targetID &&
          self.sequenceNumber == other.sequenceNumber && self.purpose == other.purpose &&
          self.snapshotVersion == other.snapshotVersion &&
+         self.lastLimboFreeSnapshotVersion == other.lastLimboFreeSnapshotVersion &&
          [self.resumeToken isEqual:other.resumeToken];
 }
 
 - (NSUInteger)hash {
   return util::Hash([self.query hash], self.targetID, self.sequenceNumber,
                     static_cast<NSInteger>(self.purpose), self.snapshotVersion.Hash(),
-                    [self.resumeToken hash]);
+                    self.lastLimboFreeSnapshotVersion.Hash(), [self.resumeToken hash]);
 }
 
 - (NSString *)description {
   return [NSString
-      stringWithFormat:@"<FSTQueryData: query:%@ target:%d purpose:%lu version:%s resumeToken:%@)>",
+      stringWithFormat:@"<FSTQueryData: query:%@ target:%d purpose:%lu version:%s "
+                       @"lastLimboFreeVersion:%s resumeToken:%@)>",
                        self.query, self.targetID, (unsigned long)self.purpose,
-                       self.snapshotVersion.timestamp().ToString().c_str(), self.resumeToken];
+                       self.snapshotVersion.timestamp().ToString().c_str(),
+                       self.lastLimboFreeSnapshotVersion.timestamp().ToString().c_str(),
+                       self.resumeToken];
 }
 
 - (instancetype)queryDataByReplacingSnapshotVersion:(SnapshotVersion)snapshotVersion
@@ -104,9 +130,21 @@ NS_ASSUME_NONNULL_BEGIN
                         listenSequenceNumber:sequenceNumber
                                      purpose:self.purpose
                              snapshotVersion:std::move(snapshotVersion)
+                lastLimboFreeSnapshotVersion:self.lastLimboFreeSnapshotVersion
                                  resumeToken:resumeToken];
 }
 
+- (instancetype)queryDataByReplacingLastLimboFreeSnapshotVersion:
+    (SnapshotVersion)lastLimboFreeSnapshotVersion {
+  return [[FSTQueryData alloc] initWithQuery:self.query
+                                    targetID:self.targetID
+                        listenSequenceNumber:self.sequenceNumber
+                                     purpose:self.purpose
+                             snapshotVersion:self.snapshotVersion
+                lastLimboFreeSnapshotVersion:std::move(lastLimboFreeSnapshotVersion)
+                                 resumeToken:self.resumeToken];
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
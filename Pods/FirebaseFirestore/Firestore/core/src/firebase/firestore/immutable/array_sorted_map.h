@@ -152,6 +152,22 @@ class ArraySortedMap : public SortedMapBase {
       : array_{SortedArray(entries, comparator)}, comparator_{comparator} {
   }
 
+  /**
+   * Creates an ArraySortedMap of the `count` entries starting at `begin`,
+   * which must be sorted and unique.
+   */
+  template <typename Iterator>
+  static ArraySortedMap FromSorted(Iterator begin,
+                                   size_type count,
+                                   const C& comparator) {
+    HARD_ASSERT(count <= kFixedSize);
+    auto array = std::make_shared<array_type>();
+    for (size_type i = 0; i < count; ++i, ++begin) {
+      array->append(value_type(*begin));
+    }
+    return ArraySortedMap{std::move(array), comparator};
+  }
+
   /** Returns true if the map contains no elements. */
   bool empty() const {
     return size() == 0;
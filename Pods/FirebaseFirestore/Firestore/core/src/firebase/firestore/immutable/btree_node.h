@@ -0,0 +1,578 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Firestore/core/src/firebase/firestore/immutable/btree_node_iterator.h"
+#include "Firestore/core/src/firebase/firestore/immutable/sorted_container.h"
+#include "Firestore/core/src/firebase/firestore/util/comparison.h"
+
+namespace firebase {
+namespace firestore {
+namespace immutable {
+namespace impl {
+
+/**
+ * BTreeNode is a node in a BTreeSortedMap: a persistent B-tree whose nodes
+ * each hold up to kMaxEntries entries, stored inline, and (for internal nodes)
+ * one more child than entries.
+ *
+ * Nodes are immutable once built and are shared between all the versions of
+ * a map that contain them. Mutations copy the path from the root to the
+ * affected leaf, so an insertion or erasure allocates O(log(n)) nodes but
+ * leaves all other nodes shared with the original map. Compared with
+ * LlrbNode, the path is several times shorter and each node holds many
+ * adjacent entries, so lookups and iteration touch far fewer cache lines.
+ *
+ * Every node other than the root holds at least kMinEntries entries.
+ */
+template <typename K, typename V>
+class BTreeNode : public SortedMapBase {
+ public:
+  using first_type = K;
+  using second_type = V;
+
+  /**
+   * The type of the entries stored in the map.
+   */
+  using value_type = std::pair<K, V>;
+  using pointer = std::shared_ptr<const BTreeNode>;
+  using const_iterator = BTreeNodeIterator<BTreeNode<K, V>>;
+
+  static constexpr size_type kMaxEntries = 16;
+  static constexpr size_type kMinEntries = kMaxEntries / 2;
+
+  BTreeNode(const BTreeNode& other) = delete;
+  BTreeNode& operator=(const BTreeNode& other) = delete;
+
+  ~BTreeNode() {
+    for (size_type i = 0; i < count_; ++i) {
+      entry_slot(i)->~value_type();
+    }
+  }
+
+  /** Returns true if this node has no children. */
+  bool leaf() const {
+    return children_ == nullptr;
+  }
+
+  /** Returns the number of entries in this node itself. */
+  size_type count() const {
+    return count_;
+  }
+
+  /** Returns the number of entries in this node and all its descendants. */
+  size_type size() const {
+    return size_;
+  }
+
+  const value_type& entry(size_type index) const {
+    return *entry_slot(index);
+  }
+
+  /** Returns the child holding the entries just before entry(index). */
+  const BTreeNode& child(size_type index) const {
+    return *children_[index];
+  }
+
+  const pointer& child_pointer(size_type index) const {
+    return children_[index];
+  }
+
+  /**
+   * Returns the index of the first entry in this node whose key is not less
+   * than the given key, or count() if there is none.
+   */
+  template <typename Comparator>
+  size_type LowerBound(const K& key, const Comparator& comparator) const {
+    size_type low = 0;
+    size_type high = count_;
+    while (low < high) {
+      size_type mid = low + (high - low) / 2;
+      if (util::Ascending(comparator.Compare(entry(mid).first, key))) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  /**
+   * Returns a tree with the given key-value pair set/updated. `root` may be
+   * null, representing the empty tree.
+   */
+  template <typename Comparator>
+  static pointer Insert(const pointer& root,
+                        const K& key,
+                        const V& value,
+                        const Comparator& comparator);
+
+  /**
+   * Returns a tree without the given key, or `root` itself if the tree
+   * doesn't contain it. The result is null if the tree becomes empty.
+   */
+  template <typename Comparator>
+  static pointer Erase(const pointer& root,
+                       const K& key,
+                       const Comparator& comparator);
+
+  /**
+   * Returns a tree of the `count` entries starting at `begin`, which must be
+   * sorted and unique. This copies each entry once and allocates about
+   * count / kMinEntries nodes, where inserting the entries one at a time would
+   * copy O(log(n)) nodes for each.
+   */
+  template <typename Iterator>
+  static pointer Build(Iterator begin, size_type count);
+
+ private:
+  /**
+   * The parts of a node under construction: pointers to the entries to copy
+   * into it and its children. Leaves room for the single extra entry of an
+   * overflowing node.
+   *
+   * The entries belong to nodes of the original tree, which the caller keeps
+   * alive, or to the one node created during the operation that `keep_alive`
+   * holds on to.
+   */
+  struct Parts {
+    size_type count = 0;
+    const value_type* entries[kMaxEntries + 1];
+    pointer children[kMaxEntries + 2];
+    pointer keep_alive;
+
+    void Append(const value_type* entry) {
+      entries[count++] = entry;
+    }
+  };
+
+  /** Constructs an empty node, with room for children if it's internal. */
+  explicit BTreeNode(bool leaf) {
+    if (!leaf) {
+      children_.reset(new pointer[kMaxEntries + 2]);
+    }
+  }
+
+  static pointer Make(bool leaf, const Parts& parts);
+
+  /**
+   * Builds a subtree `height` levels tall from the next `count` entries,
+   * whose root has at least `min_children` children if it's internal.
+   */
+  template <typename Iterator>
+  static pointer BuildSubtree(Iterator* next,
+                              size_type count,
+                              int height,
+                              size_type min_children);
+
+  /** Returns the most entries that a subtree `height` levels tall can hold. */
+  static uint64_t Capacity(int height) {
+    uint64_t capacity = 0;
+    for (int i = 0; i < height; ++i) {
+      capacity = capacity * (kMaxEntries + 1) + kMaxEntries;
+    }
+    return capacity;
+  }
+
+  /** Returns the parts of `node`, referring to its entries. */
+  static Parts Split(const BTreeNode& node);
+
+  template <typename Comparator>
+  static pointer InsertInto(const BTreeNode& node,
+                            const K& key,
+                            const V& value,
+                            const Comparator& comparator,
+                            const value_type& new_entry);
+
+  template <typename Comparator>
+  static pointer EraseFrom(const pointer& node,
+                           const K& key,
+                           const Comparator& comparator);
+
+  /**
+   * Replaces the full child at `index` of `parts` with its two halves, moving
+   * its middle entry up into `parts`.
+   */
+  static void SplitChild(Parts* parts, size_type index);
+
+  /**
+   * Restores the minimum size of the child at `index` of `parts` by borrowing
+   * an entry from one of its siblings or merging it with one.
+   */
+  static void Rebalance(Parts* parts, size_type index);
+
+  value_type* entry_slot(size_type index) {
+    return reinterpret_cast<value_type*>(&entries_[index]);
+  }
+  const value_type* entry_slot(size_type index) const {
+    return reinterpret_cast<const value_type*>(&entries_[index]);
+  }
+
+  using Storage = typename std::aligned_storage<sizeof(value_type),
+                                                alignof(value_type)>::type;
+
+  size_type count_ = 0;
+  size_type size_ = 0;
+  Storage entries_[kMaxEntries + 1];
+  std::unique_ptr<pointer[]> children_;
+};
+
+template <typename K, typename V>
+constexpr typename BTreeNode<K, V>::size_type BTreeNode<K, V>::kMaxEntries;
+
+template <typename K, typename V>
+constexpr typename BTreeNode<K, V>::size_type BTreeNode<K, V>::kMinEntries;
+
+template <typename K, typename V>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::Make(bool leaf,
+                                                        const Parts& parts) {
+  // make_shared can't use the private constructor.
+  std::shared_ptr<BTreeNode> node{new BTreeNode(leaf)};
+  for (size_type i = 0; i < parts.count; ++i) {
+    new (node->entry_slot(i)) value_type(*parts.entries[i]);
+    node->count_ = i + 1;
+  }
+
+  node->size_ = parts.count;
+  if (!leaf) {
+    for (size_type i = 0; i <= parts.count; ++i) {
+      node->children_[i] = parts.children[i];
+      node->size_ += parts.children[i]->size();
+    }
+  }
+  return node;
+}
+
+template <typename K, typename V>
+typename BTreeNode<K, V>::Parts BTreeNode<K, V>::Split(const BTreeNode& node) {
+  Parts parts;
+  for (size_type i = 0; i < node.count(); ++i) {
+    parts.Append(&node.entry(i));
+  }
+  if (!node.leaf()) {
+    for (size_type i = 0; i <= node.count(); ++i) {
+      parts.children[i] = node.child_pointer(i);
+    }
+  }
+  return parts;
+}
+
+template <typename K, typename V>
+template <typename Comparator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::Insert(
+    const pointer& root,
+    const K& key,
+    const V& value,
+    const Comparator& comparator) {
+  value_type new_entry{key, value};
+  if (!root) {
+    Parts parts;
+    parts.Append(&new_entry);
+    return Make(/*leaf=*/true, parts);
+  }
+
+  pointer result = InsertInto(*root, key, value, comparator, new_entry);
+  if (result->count() <= kMaxEntries) {
+    return result;
+  }
+
+  // The root overflowed: it becomes the only child of a new root, which then
+  // splits it.
+  Parts parts;
+  parts.children[0] = std::move(result);
+  SplitChild(&parts, 0);
+  return Make(/*leaf=*/false, parts);
+}
+
+template <typename K, typename V>
+template <typename Iterator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::Build(Iterator begin,
+                                                         size_type count) {
+  if (count == 0) {
+    return nullptr;
+  }
+
+  int height = 1;
+  while (Capacity(height) < count) {
+    ++height;
+  }
+  return BuildSubtree(&begin, count, height, /*min_children=*/2);
+}
+
+template <typename K, typename V>
+template <typename Iterator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::BuildSubtree(
+    Iterator* next, size_type count, int height, size_type min_children) {
+  bool leaf = height == 1;
+  std::shared_ptr<BTreeNode> node{new BTreeNode(leaf)};
+  node->size_ = count;
+  if (leaf) {
+    for (size_type i = 0; i < count; ++i, ++*next) {
+      new (node->entry_slot(i)) value_type(**next);
+      node->count_ = i + 1;
+    }
+    return node;
+  }
+
+  // Use as few children as will hold the entries, and spread the entries
+  // evenly between them. Since `count` is between the sizes of the smallest
+  // and largest valid subtrees of this height, so is every child's share.
+  uint64_t child_capacity = Capacity(height - 1);
+  auto children = static_cast<size_type>(
+      std::max<uint64_t>(min_children, (count + child_capacity + 1) /
+                                           (child_capacity + 1)));
+  size_type child_entries = count - (children - 1);
+  for (size_type i = 0; i < children; ++i) {
+    size_type child_count =
+        child_entries / children + (i < child_entries % children ? 1 : 0);
+    node->children_[i] =
+        BuildSubtree(next, child_count, height - 1, kMinEntries + 1);
+    if (i + 1 < children) {
+      new (node->entry_slot(i)) value_type(**next);
+      node->count_ = i + 1;
+      ++*next;
+    }
+  }
+  return node;
+}
+
+template <typename K, typename V>
+template <typename Comparator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::InsertInto(
+    const BTreeNode& node,
+    const K& key,
+    const V& value,
+    const Comparator& comparator,
+    const value_type& new_entry) {
+  size_type index = node.LowerBound(key, comparator);
+  bool found = index < node.count() &&
+               util::Same(comparator.Compare(key, node.entry(index).first));
+
+  Parts parts = Split(node);
+  if (found) {
+    parts.entries[index] = &new_entry;
+    return Make(node.leaf(), parts);
+  }
+
+  if (node.leaf()) {
+    for (size_type i = parts.count; i > index; --i) {
+      parts.entries[i] = parts.entries[i - 1];
+    }
+    parts.entries[index] = &new_entry;
+    ++parts.count;
+    return Make(/*leaf=*/true, parts);
+  }
+
+  // The returned child may hold one entry too many, which is moved up here.
+  // That may in turn make this node overflow, for its parent to handle.
+  parts.children[index] =
+      InsertInto(node.child(index), key, value, comparator, new_entry);
+  if (parts.children[index]->count() > kMaxEntries) {
+    SplitChild(&parts, index);
+  }
+  return Make(/*leaf=*/false, parts);
+}
+
+template <typename K, typename V>
+void BTreeNode<K, V>::SplitChild(Parts* parts, size_type index) {
+  pointer full = std::move(parts->children[index]);
+  Parts whole = Split(*full);
+  size_type middle = whole.count / 2;
+
+  Parts left;
+  Parts right;
+  for (size_type i = 0; i < middle; ++i) {
+    left.Append(whole.entries[i]);
+  }
+  for (size_type i = middle + 1; i < whole.count; ++i) {
+    right.Append(whole.entries[i]);
+  }
+  if (!full->leaf()) {
+    for (size_type i = 0; i <= middle; ++i) {
+      left.children[i] = whole.children[i];
+    }
+    for (size_type i = middle + 1; i <= whole.count; ++i) {
+      right.children[i - middle - 1] = whole.children[i];
+    }
+  }
+
+  for (size_type i = parts->count; i > index; --i) {
+    parts->entries[i] = parts->entries[i - 1];
+    parts->children[i + 1] = std::move(parts->children[i]);
+  }
+  parts->entries[index] = whole.entries[middle];
+  parts->children[index] = Make(full->leaf(), left);
+  parts->children[index + 1] = Make(full->leaf(), right);
+  ++parts->count;
+  // The middle entry still lives in `full`, which was only just created.
+  parts->keep_alive = std::move(full);
+}
+
+template <typename K, typename V>
+template <typename Comparator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::Erase(
+    const pointer& root, const K& key, const Comparator& comparator) {
+  if (!root) {
+    return root;
+  }
+
+  pointer result = EraseFrom(root, key, comparator);
+  if (result == root || result->count() > 0) {
+    return result;
+  }
+
+  // The root lost its last entry: the tree is either empty or one level
+  // shorter.
+  return result->leaf() ? nullptr : result->child_pointer(0);
+}
+
+template <typename K, typename V>
+template <typename Comparator>
+typename BTreeNode<K, V>::pointer BTreeNode<K, V>::EraseFrom(
+    const pointer& node, const K& key, const Comparator& comparator) {
+  size_type index = node->LowerBound(key, comparator);
+  bool found = index < node->count() &&
+               util::Same(comparator.Compare(key, node->entry(index).first));
+
+  Parts parts = Split(*node);
+  if (node->leaf()) {
+    if (!found) {
+      return node;
+    }
+    for (size_type i = index + 1; i < parts.count; ++i) {
+      parts.entries[i - 1] = parts.entries[i];
+    }
+    --parts.count;
+    return Make(/*leaf=*/true, parts);
+  }
+
+  if (found) {
+    // Replace the entry with its predecessor, the largest entry of the child
+    // before it, and erase that from the child instead.
+    const BTreeNode* predecessor = &node->child(index);
+    while (!predecessor->leaf()) {
+      predecessor = &predecessor->child(predecessor->count());
+    }
+    const value_type* replacement =
+        &predecessor->entry(predecessor->count() - 1);
+    parts.entries[index] = replacement;
+    parts.children[index] = EraseFrom(node->child_pointer(index),
+                                      replacement->first, comparator);
+  } else {
+    parts.children[index] =
+        EraseFrom(node->child_pointer(index), key, comparator);
+    if (parts.children[index] == node->child_pointer(index)) {
+      return node;
+    }
+  }
+
+  if (parts.children[index]->count() < kMinEntries) {
+    Rebalance(&parts, index);
+  }
+  return Make(/*leaf=*/false, parts);
+}
+
+template <typename K, typename V>
+void BTreeNode<K, V>::Rebalance(Parts* parts, size_type index) {
+  bool leaf = parts->children[index]->leaf();
+
+  if (index > 0 && parts->children[index - 1]->count() > kMinEntries) {
+    // Rotate the last entry of the left sibling up, and the separator down.
+    Parts left = Split(*parts->children[index - 1]);
+    Parts child = Split(*parts->children[index]);
+    for (size_type i = child.count; i > 0; --i) {
+      child.entries[i] = child.entries[i - 1];
+    }
+    child.entries[0] = parts->entries[index - 1];
+    if (!leaf) {
+      for (size_type i = child.count + 1; i > 0; --i) {
+        child.children[i] = std::move(child.children[i - 1]);
+      }
+      child.children[0] = std::move(left.children[left.count]);
+    }
+    ++child.count;
+    parts->entries[index - 1] = left.entries[--left.count];
+
+    pointer old_child = std::move(parts->children[index]);
+    parts->children[index - 1] = Make(leaf, left);
+    parts->children[index] = Make(leaf, child);
+    return;
+  }
+
+  if (index < parts->count &&
+      parts->children[index + 1]->count() > kMinEntries) {
+    // Rotate the first entry of the right sibling up, and the separator down.
+    Parts child = Split(*parts->children[index]);
+    Parts right = Split(*parts->children[index + 1]);
+    child.entries[child.count] = parts->entries[index];
+    ++child.count;
+    if (!leaf) {
+      child.children[child.count] = std::move(right.children[0]);
+      for (size_type i = 0; i < right.count; ++i) {
+        right.children[i] = std::move(right.children[i + 1]);
+      }
+    }
+    parts->entries[index] = right.entries[0];
+    for (size_type i = 1; i < right.count; ++i) {
+      right.entries[i - 1] = right.entries[i];
+    }
+    --right.count;
+
+    pointer old_child = std::move(parts->children[index]);
+    parts->children[index] = Make(leaf, child);
+    parts->children[index + 1] = Make(leaf, right);
+    return;
+  }
+
+  // Neither sibling can spare an entry, so merge the child with one of them
+  // and the separator between them.
+  size_type left_index = index > 0 ? index - 1 : index;
+  Parts merged = Split(*parts->children[left_index]);
+  Parts right = Split(*parts->children[left_index + 1]);
+  if (!leaf) {
+    for (size_type i = 0; i <= right.count; ++i) {
+      merged.children[merged.count + 1 + i] = std::move(right.children[i]);
+    }
+  }
+  merged.Append(parts->entries[left_index]);
+  for (size_type i = 0; i < right.count; ++i) {
+    merged.Append(right.entries[i]);
+  }
+
+  pointer old_child = std::move(parts->children[index]);
+  parts->children[left_index] = Make(leaf, merged);
+  for (size_type i = left_index + 1; i < parts->count; ++i) {
+    parts->entries[i - 1] = parts->entries[i];
+    parts->children[i] = std::move(parts->children[i + 1]);
+  }
+  --parts->count;
+}
+
+}  // namespace impl
+}  // namespace immutable
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_H_
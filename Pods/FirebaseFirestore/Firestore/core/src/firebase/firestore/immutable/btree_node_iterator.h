@@ -0,0 +1,228 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_ITERATOR_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_ITERATOR_H_
+
+#include <cstddef>
+#include <iterator>
+
+#include "Firestore/core/src/firebase/firestore/util/comparison.h"
+#include "Firestore/core/src/firebase/firestore/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace immutable {
+namespace impl {
+
+/**
+ * A forward iterator for traversing BTreeNodes in order.
+ *
+ * Like LlrbNodeIterator, it keeps an explicit stack because the nodes have no
+ * parent pointers. The stack holds one frame per level, recording the node
+ * and the index of the next entry to visit in it, and is stored inline: the
+ * tree is at most kMaxDepth levels deep. Incrementing visits the next entry
+ * of the current leaf in O(1), and is O(lg(n)) only at the end of a leaf.
+ *
+ * Note: BTreeNodeIterator does not extend the lifetime of its underlying tree.
+ */
+template <typename N>
+class BTreeNodeIterator {
+ public:
+  using node_type = N;
+  using key_type = typename node_type::first_type;
+  using size_type = typename node_type::size_type;
+
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename node_type::value_type;
+
+  using pointer = typename node_type::value_type const*;
+  using reference = typename node_type::value_type const&;
+  using difference_type = std::ptrdiff_t;
+
+  /**
+   * The maximum depth of a tree. Every node but the root has at least
+   * kMinEntries + 1 children, so this is enough for any size_type size.
+   */
+  static constexpr int kMaxDepth = 16;
+
+  // Default constructor to conform to the requirements of ForwardIterator
+  BTreeNodeIterator() {
+  }
+
+  /**
+   * Constructs an iterator pointing at the first entry of the tree with the
+   * given root, which may be null for the empty tree.
+   */
+  static BTreeNodeIterator Begin(const node_type* root) {
+    BTreeNodeIterator result;
+    if (root) {
+      result.PushLeftmost(root);
+    }
+    return result;
+  }
+
+  /**
+   * Constructs an iterator pointing one past the last entry of any tree.
+   */
+  static BTreeNodeIterator End() {
+    return BTreeNodeIterator{};
+  }
+
+  /**
+   * Constructs an iterator pointing at the last entry of the tree with the
+   * given root, which may be null for the empty tree.
+   */
+  static BTreeNodeIterator Max(const node_type* root) {
+    BTreeNodeIterator result;
+    for (const node_type* node = root; node;) {
+      if (node->leaf()) {
+        result.Push(node, node->count() - 1);
+        break;
+      }
+      // Nothing in this node comes after its last child.
+      result.Push(node, node->count());
+      node = &node->child(node->count());
+    }
+    return result;
+  }
+
+  /**
+   * Constructs an iterator pointing to the first entry whose key is not less
+   * than the given key, or an equivalent to `End()` if there is none.
+   */
+  template <typename C>
+  static BTreeNodeIterator LowerBound(const node_type* root,
+                                      const key_type& key,
+                                      const C& comparator) {
+    BTreeNodeIterator result;
+    for (const node_type* node = root; node;) {
+      size_type index = node->LowerBound(key, comparator);
+      result.Push(node, index);
+      if (index < node->count() &&
+          util::Same(comparator.Compare(key, node->entry(index).first))) {
+        return result;
+      }
+      node = node->leaf() ? nullptr : &node->child(index);
+    }
+
+    result.PopFinished();
+    return result;
+  }
+
+  /**
+   * Returns true if this iterator points at the end of the iteration sequence.
+   */
+  bool is_end() const {
+    return depth_ == 0;
+  }
+
+  /**
+   * Returns the address of the entry that this iterator points to. This can
+   * only be called if `end()` is false.
+   */
+  pointer get() const {
+    HARD_ASSERT(!is_end());
+    const Frame& top = frames_[depth_ - 1];
+    return &top.node->entry(top.index);
+  }
+
+  reference operator*() const {
+    return *get();
+  }
+
+  pointer operator->() const {
+    return get();
+  }
+
+  BTreeNodeIterator& operator++() {
+    HARD_ASSERT(!is_end());
+
+    Frame& top = frames_[depth_ - 1];
+    ++top.index;
+    if (!top.node->leaf()) {
+      // The entries of the child after the current entry come next.
+      PushLeftmost(&top.node->child(top.index));
+    } else {
+      PopFinished();
+    }
+    return *this;
+  }
+
+  BTreeNodeIterator operator++(int /*unused*/) {
+    BTreeNodeIterator result = *this;
+    ++*this;
+    return result;
+  }
+
+  friend bool operator==(const BTreeNodeIterator& a,
+                         const BTreeNodeIterator& b) {
+    if (a.is_end()) {
+      return b.is_end();
+    } else if (b.is_end()) {
+      return false;
+    } else {
+      const key_type& left_key = a.get()->first;
+      const key_type& right_key = b.get()->first;
+      return left_key == right_key;
+    }
+  }
+
+  bool operator!=(const BTreeNodeIterator& b) const {
+    return !(*this == b);
+  }
+
+ private:
+  struct Frame {
+    const node_type* node;
+    size_type index;
+  };
+
+  void Push(const node_type* node, size_type index) {
+    HARD_ASSERT(depth_ < kMaxDepth, "BTree is too deep");
+    frames_[depth_++] = Frame{node, index};
+  }
+
+  void PushLeftmost(const node_type* node) {
+    for (;; node = &node->child(0)) {
+      Push(node, 0);
+      if (node->leaf()) {
+        break;
+      }
+    }
+  }
+
+  /** Pops the frames of nodes that have no entries left to visit. */
+  void PopFinished() {
+    while (depth_ > 0 &&
+           frames_[depth_ - 1].index == frames_[depth_ - 1].node->count()) {
+      --depth_;
+    }
+  }
+
+  Frame frames_[kMaxDepth];
+  int depth_ = 0;
+};
+
+template <typename N>
+constexpr int BTreeNodeIterator<N>::kMaxDepth;
+
+}  // namespace impl
+}  // namespace immutable
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_NODE_ITERATOR_H_
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_SORTED_MAP_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_SORTED_MAP_H_
+
+#include <utility>
+
+#include "Firestore/core/src/firebase/firestore/immutable/btree_node.h"
+#include "Firestore/core/src/firebase/firestore/immutable/keys_view.h"
+#include "Firestore/core/src/firebase/firestore/immutable/sorted_container.h"
+#include "Firestore/core/src/firebase/firestore/util/comparison.h"
+#include "Firestore/core/src/firebase/firestore/util/compressed_member.h"
+
+namespace firebase {
+namespace firestore {
+namespace immutable {
+namespace impl {
+
+/**
+ * BTreeSortedMap is a value type containing a map, stored in a persistent
+ * B-tree. It is immutable, but has methods to efficiently create new maps that
+ * are mutations of it.
+ *
+ * It has the same interface as TreeSortedMap, and replaces it as the
+ * representation of large SortedMaps: see BTreeNode for the differences.
+ */
+template <typename K, typename V, typename C = util::Comparator<K>>
+class BTreeSortedMap : public SortedMapBase, private util::CompressedMember<C> {
+  using ComparatorMember = util::CompressedMember<C>;
+
+ public:
+  /**
+   * The type of the entries stored in the map.
+   */
+  using value_type = std::pair<K, V>;
+
+  /**
+   * The type of the node containing entries of value_type.
+   */
+  using node_type = BTreeNode<K, V>;
+  using const_iterator = typename node_type::const_iterator;
+  using const_key_iterator = util::iterator_first<const_iterator>;
+
+  /**
+   * Creates an empty BTreeSortedMap.
+   */
+  explicit BTreeSortedMap(const C& comparator = {})
+      : ComparatorMember{comparator} {
+  }
+
+  /**
+   * Creates a BTreeSortedMap from a range of pairs to insert.
+   */
+  template <typename Range>
+  static BTreeSortedMap Create(const Range& range, const C& comparator) {
+    typename node_type::pointer root;
+    for (auto&& element : range) {
+      root = node_type::Insert(root, element.first, element.second, comparator);
+    }
+    return BTreeSortedMap{std::move(root), comparator};
+  }
+
+  /**
+   * Creates a BTreeSortedMap of the `count` entries starting at `begin`,
+   * which must be sorted and unique.
+   */
+  template <typename Iterator>
+  static BTreeSortedMap FromSorted(Iterator begin,
+                                   size_type count,
+                                   const C& comparator) {
+    return BTreeSortedMap{node_type::Build(std::move(begin), count),
+                          comparator};
+  }
+
+  /** Returns true if the map contains no elements. */
+  bool empty() const {
+    return root_ == nullptr;
+  }
+
+  /** Returns the number of items in this map. */
+  size_type size() const {
+    return root_ ? root_->size() : 0;
+  }
+
+  /** Returns the root node, or nullptr if the map is empty. */
+  const node_type* root() const {
+    return root_.get();
+  }
+
+  const C& comparator() const {
+    return ComparatorMember::get();
+  }
+
+  /**
+   * Creates a new map identical to this one, but with a key-value pair added or
+   * updated.
+   *
+   * @param key The key to insert/update.
+   * @param value The value to associate with the key.
+   * @return A new dictionary with the added/updated value.
+   */
+  BTreeSortedMap insert(const K& key, const V& value) const {
+    const C& comparator = this->comparator();
+    return BTreeSortedMap{node_type::Insert(root_, key, value, comparator),
+                          comparator};
+  }
+
+  /**
+   * Creates a new map identical to this one, but with a key removed from it.
+   *
+   * @param key The key to remove.
+   * @return A new map without that value.
+   */
+  BTreeSortedMap erase(const K& key) const {
+    const C& comparator = this->comparator();
+    return BTreeSortedMap{node_type::Erase(root_, key, comparator),
+                          comparator};
+  }
+
+  bool contains(const K& key) const {
+    // Inline the tree traversal here to avoid building up the stack required
+    // to construct a full iterator.
+    const C& comparator = this->comparator();
+    for (const node_type* node = root_.get(); node;) {
+      size_type index = node->LowerBound(key, comparator);
+      if (index < node->count() &&
+          util::Same(comparator.Compare(key, node->entry(index).first))) {
+        return true;
+      }
+      node = node->leaf() ? nullptr : &node->child(index);
+    }
+    return false;
+  }
+
+  /**
+   * Finds a value in the map.
+   *
+   * @param key The key to look up.
+   * @return An iterator pointing to the entry containing the key, or end() if
+   *     not found.
+   */
+  const_iterator find(const K& key) const {
+    const_iterator found = lower_bound(key);
+    if (!found.is_end() &&
+        util::Same(this->comparator().Compare(key, found->first))) {
+      return found;
+    } else {
+      return end();
+    }
+  }
+
+  /**
+   * Finds the index of the given key in the map.
+   *
+   * @param key The key to look up.
+   * @return The index of the entry containing the key, or npos if not found.
+   */
+  size_type find_index(const K& key) const {
+    const C& comparator = this->comparator();
+
+    size_type pruned_entries = 0;
+    for (const node_type* node = root_.get(); node;) {
+      size_type index = node->LowerBound(key, comparator);
+      bool found =
+          index < node->count() &&
+          util::Same(comparator.Compare(key, node->entry(index).first));
+      if (node->leaf()) {
+        return found ? pruned_entries + index : npos;
+      }
+
+      // Every entry before `index`, and the subtree before each of them,
+      // precedes the key.
+      pruned_entries += index;
+      for (size_type i = 0; i < index; ++i) {
+        pruned_entries += node->child(i).size();
+      }
+      if (found) {
+        return pruned_entries + node->child(index).size();
+      }
+      node = &node->child(index);
+    }
+    return npos;
+  }
+
+  /**
+   * Finds the first entry in the map containing a key greater than or equal
+   * to the given key.
+   *
+   * @param key The key to look up.
+   * @return An iterator pointing to the entry containing the key or the next
+   *     largest key. Can return end() if all keys in the map are less than the
+   *     requested key.
+   */
+  const_iterator lower_bound(const K& key) const {
+    return const_iterator::LowerBound(root_.get(), key, this->comparator());
+  }
+
+  const_iterator min() const {
+    return begin();
+  }
+
+  const_iterator max() const {
+    return const_iterator::Max(root_.get());
+  }
+
+  /**
+   * Returns a forward iterator pointing to the first entry in the map. If there
+   * are no entries in the map, begin() == end().
+   *
+   * See BTreeNodeIterator for details
+   */
+  const_iterator begin() const {
+    return const_iterator::Begin(root_.get());
+  }
+
+  /**
+   * Returns an iterator pointing past the last entry in the map.
+   */
+  const_iterator end() const {
+    return const_iterator::End();
+  }
+
+  /**
+   * Returns a view of this SortedMap containing just the keys that have been
+   * inserted.
+   */
+  const util::range<const_key_iterator> keys() const {
+    return KeysView(*this);
+  }
+
+  /**
+   * Returns a view of this SortedMap containing just the keys that have been
+   * inserted that are greater than or equal to the given key.
+   */
+  const util::range<const_key_iterator> keys_from(const K& key) const {
+    return KeysViewFrom(*this, key);
+  }
+
+  /**
+   * Returns a view of this SortedMap containing just the keys that have been
+   * inserted that are greater than or equal to the given start_key and less
+   * than the given end_key.
+   */
+  const util::range<const_key_iterator> keys_in(const K& start_key,
+                                                const K& end_key) const {
+    return impl::KeysViewIn(*this, start_key, end_key, this->comparator());
+  }
+
+ private:
+  BTreeSortedMap(typename node_type::pointer&& root,
+                 const C& comparator) noexcept
+      : ComparatorMember{comparator}, root_{std::move(root)} {
+  }
+
+  typename node_type::pointer root_;
+};
+
+}  // namespace impl
+}  // namespace immutable
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_BTREE_SORTED_MAP_H_
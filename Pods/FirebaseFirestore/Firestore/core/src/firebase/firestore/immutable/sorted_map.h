@@ -18,13 +18,16 @@
 #define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_IMMUTABLE_SORTED_MAP_H_
 
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/firebase/firestore/immutable/array_sorted_map.h"
+#include "Firestore/core/src/firebase/firestore/immutable/btree_sorted_map.h"
 #include "Firestore/core/src/firebase/firestore/immutable/keys_view.h"
 #include "Firestore/core/src/firebase/firestore/immutable/sorted_container.h"
 #include "Firestore/core/src/firebase/firestore/immutable/sorted_map_iterator.h"
-#include "Firestore/core/src/firebase/firestore/immutable/tree_sorted_map.h"
 #include "Firestore/core/src/firebase/firestore/util/comparison.h"
+#include "Firestore/core/src/firebase/firestore/util/hard_assert.h"
+#include "Firestore/core/src/firebase/firestore/util/iterator_adaptors.h"
 #include "absl/base/attributes.h"
 
 namespace firebase {
@@ -43,12 +46,12 @@ class SortedMap : public SortedMapBase {
   /** The type of the entries stored in the map. */
   using value_type = std::pair<K, V>;
   using array_type = impl::ArraySortedMap<K, V, C>;
-  using tree_type = impl::TreeSortedMap<K, V, C>;
+  using tree_type = impl::BTreeSortedMap<K, V, C>;
 
   using const_iterator = impl::SortedMapIterator<
       value_type,
       typename impl::FixedArray<value_type>::const_iterator,
-      typename impl::LlrbNode<K, V>::const_iterator>;
+      typename impl::BTreeNode<K, V>::const_iterator>;
 
   using const_key_iterator = util::iterator_first<const_iterator>;
 
@@ -72,6 +75,31 @@ class SortedMap : public SortedMapBase {
     }
   }
 
+  /**
+   * Creates a SortedMap containing the entries in the range [begin, end),
+   * which must be sorted by key and unique. This takes O(n) time, where
+   * inserting the entries one at a time would take O(n log(n)).
+   */
+  template <typename Iterator>
+  static SortedMap FromSorted(Iterator begin,
+                              Iterator end,
+                              const C& comparator = {}) {
+    size_type count = 0;
+    for (Iterator previous = begin, iter = begin; iter != end; ++iter) {
+      HARD_ASSERT(count == 0 || util::Ascending(comparator.Compare(
+                                    (*previous).first, (*iter).first)),
+                  "SortedMap::FromSorted entries are not sorted and unique");
+      previous = iter;
+      ++count;
+    }
+
+    if (count <= kFixedSize) {
+      return SortedMap{array_type::FromSorted(begin, count, comparator)};
+    } else {
+      return SortedMap{tree_type::FromSorted(begin, count, comparator)};
+    }
+  }
+
   SortedMap(const SortedMap& other) : tag_{other.tag_} {
     switch (tag_) {
       case Tag::Array:
@@ -100,7 +128,7 @@ class SortedMap : public SortedMapBase {
         array_.~ArraySortedMap();
         break;
       case Tag::Tree:
-        tree_.~TreeSortedMap();
+        tree_.~BTreeSortedMap();
         break;
     }
   }
@@ -211,6 +239,133 @@ class SortedMap : public SortedMapBase {
     UNREACHABLE();
   }
 
+  /**
+   * Creates a new map containing the entries of both this map and `other`,
+   * taking the value from `other` for keys in both.
+   *
+   * Only when one operand is much smaller than the other (see
+   * kBulkRebuildRatio) does the result share nodes with the larger one: the
+   * smaller one's entries are then inserted one at a time. Otherwise the
+   * operands are merged and the result is built from scratch with FromSorted,
+   * taking O(n + m) time and sharing no nodes with either operand, even when
+   * they only overlap in a small key range. Results equal to an operand
+   * return that operand.
+   */
+  ABSL_MUST_USE_RESULT SortedMap set_union(const SortedMap& other) const {
+    if (other.empty()) {
+      return *this;
+    } else if (empty()) {
+      return other;
+    }
+
+    if (PreferUpdates(other.size(), size())) {
+      SortedMap result = *this;
+      for (const value_type& entry : other) {
+        result = result.insert(entry.first, entry.second);
+      }
+      return result;
+    } else if (PreferUpdates(size(), other.size())) {
+      SortedMap result = other;
+      for (const value_type& entry : *this) {
+        if (!other.contains(entry.first)) {
+          result = result.insert(entry.first, entry.second);
+        }
+      }
+      return result;
+    }
+
+    std::vector<const value_type*> merged;
+    merged.reserve(size() + other.size());
+    const C& comparator = this->comparator();
+    const_iterator left = begin();
+    const_iterator left_end = end();
+    const_iterator right = other.begin();
+    const_iterator right_end = other.end();
+    while (left != left_end && right != right_end) {
+      util::ComparisonResult cmp =
+          comparator.Compare(left->first, right->first);
+      if (util::Ascending(cmp)) {
+        merged.push_back(left.get());
+        ++left;
+      } else {
+        if (util::Same(cmp)) {
+          ++left;
+        }
+        merged.push_back(right.get());
+        ++right;
+      }
+    }
+    for (; left != left_end; ++left) {
+      merged.push_back(left.get());
+    }
+    for (; right != right_end; ++right) {
+      merged.push_back(right.get());
+    }
+    return FromPointers(merged);
+  }
+
+  /**
+   * Creates a new map containing the entries of this map whose keys are not in
+   * `other`.
+   *
+   * Shares nodes with this map only if `other` is much smaller; otherwise the
+   * result is rebuilt from the kept entries, as in set_union.
+   */
+  template <typename Other>
+  ABSL_MUST_USE_RESULT SortedMap set_difference(const Other& other) const {
+    if (empty() || other.empty()) {
+      return *this;
+    }
+
+    if (PreferUpdates(other.size(), size())) {
+      SortedMap result = *this;
+      for (const auto& entry : other) {
+        result = result.erase(KeyOf(entry));
+      }
+      return result;
+    }
+
+    std::vector<const value_type*> kept;
+    for (const value_type& entry : *this) {
+      if (!other.contains(entry.first)) {
+        kept.push_back(&entry);
+      }
+    }
+    return kept.size() == size() ? *this : FromPointers(kept);
+  }
+
+  /**
+   * Creates a new map containing the entries of this map whose keys are also
+   * in `other`.
+   *
+   * Unless every entry is kept, the result is rebuilt from the kept entries
+   * and shares no nodes with this map.
+   */
+  template <typename Other>
+  ABSL_MUST_USE_RESULT SortedMap set_intersection(const Other& other) const {
+    if (empty() || other.empty()) {
+      return SortedMap{comparator()};
+    }
+
+    std::vector<const value_type*> kept;
+    if (PreferUpdates(other.size(), size())) {
+      // Look up the few keys of `other` here rather than visiting every entry.
+      for (const auto& entry : other) {
+        const_iterator found = find(KeyOf(entry));
+        if (found != end()) {
+          kept.push_back(found.get());
+        }
+      }
+    } else {
+      for (const value_type& entry : *this) {
+        if (other.contains(entry.first)) {
+          kept.push_back(&entry);
+        }
+      }
+    }
+    return kept.size() == size() ? *this : FromPointers(kept);
+  }
+
   bool contains(const K& key) const {
     switch (tag_) {
       case Tag::Array:
@@ -355,6 +510,32 @@ class SortedMap : public SortedMapBase {
       : tag_{Tag::Tree}, tree_{std::move(tree)} {
   }
 
+  /**
+   * The ratio of map size to the number of changes below which applying the
+   * changes one at a time, sharing most of the original tree, is cheaper than
+   * building the result from scratch.
+   */
+  static constexpr size_type kBulkRebuildRatio = 32;
+
+  static bool PreferUpdates(size_type changes, size_type size) {
+    return changes <= size / kBulkRebuildRatio;
+  }
+
+  /** Returns the key of an entry of a map or of a set. */
+  template <typename T>
+  static const K& KeyOf(const std::pair<K, T>& entry) {
+    return entry.first;
+  }
+  static const K& KeyOf(const K& key) {
+    return key;
+  }
+
+  /** Creates a map with the same comparator from pointers to its entries. */
+  SortedMap FromPointers(const std::vector<const value_type*>& entries) const {
+    return FromSorted(util::make_iterator_ptr(entries.begin()),
+                      util::make_iterator_ptr(entries.end()), comparator());
+  }
+
   const C& comparator() const {
     switch (tag_) {
       case Tag::Array:
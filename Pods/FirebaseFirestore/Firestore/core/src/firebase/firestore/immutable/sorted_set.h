@@ -40,6 +40,33 @@ struct Empty {
   }
 };
 
+/**
+ * Adapts an iterator over keys into one over the entries of the map underlying
+ * a SortedSet, pairing each key with an empty value.
+ */
+template <typename Iterator, typename Entry>
+class SetEntryIterator {
+ public:
+  explicit SetEntryIterator(Iterator iter) : iter_{std::move(iter)} {
+  }
+
+  Entry operator*() const {
+    return Entry{*iter_, {}};
+  }
+
+  SetEntryIterator& operator++() {
+    ++iter_;
+    return *this;
+  }
+
+  bool operator!=(const SetEntryIterator& other) const {
+    return iter_ != other.iter_;
+  }
+
+ private:
+  Iterator iter_;
+};
+
 }  // namespace impl
 
 template <typename K,
@@ -69,6 +96,21 @@ class SortedSet : public SortedContainer {
     }
   }
 
+  /**
+   * Creates a SortedSet containing the values in the range [begin, end), which
+   * must be sorted and unique. This takes O(n) time, where inserting the
+   * values one at a time would take O(n log(n)).
+   */
+  template <typename Iterator>
+  static SortedSet FromSorted(Iterator begin,
+                              Iterator end,
+                              const C& comparator = {}) {
+    using EntryIterator =
+        impl::SetEntryIterator<Iterator, typename M::value_type>;
+    return SortedSet{M::FromSorted(EntryIterator{std::move(begin)},
+                                   EntryIterator{std::move(end)}, comparator)};
+  }
+
   bool empty() const {
     return map_.empty();
   }
@@ -85,6 +127,29 @@ class SortedSet : public SortedContainer {
     return SortedSet{map_.erase(key)};
   }
 
+  /**
+   * Creates a new set containing the values in either this set or `other`.
+   * See SortedMap::set_union for when the result shares nodes with an operand.
+   */
+  ABSL_MUST_USE_RESULT SortedSet set_union(const SortedSet& other) const {
+    return SortedSet{map_.set_union(other.map_)};
+  }
+
+  /**
+   * Creates a new set containing the values in this set but not in `other`.
+   */
+  ABSL_MUST_USE_RESULT SortedSet set_difference(const SortedSet& other) const {
+    return SortedSet{map_.set_difference(other)};
+  }
+
+  /**
+   * Creates a new set containing the values in both this set and `other`.
+   */
+  ABSL_MUST_USE_RESULT SortedSet
+  set_intersection(const SortedSet& other) const {
+    return SortedSet{map_.set_intersection(other)};
+  }
+
   bool contains(const K& key) const {
     return map_.contains(key);
   }
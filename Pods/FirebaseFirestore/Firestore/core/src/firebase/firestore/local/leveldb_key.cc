@@ -27,6 +27,7 @@
 
 using firebase::firestore::model::DocumentKey;
 using firebase::firestore::model::ResourcePath;
+using firebase::firestore::model::SnapshotVersion;
 using firebase::firestore::util::OrderedCode;
 
 namespace firebase {
@@ -46,6 +47,8 @@ const char* kTargetDocumentsTable = "target_document";
 const char* kDocumentTargetsTable = "document_target";
 const char* kRemoteDocumentsTable = "remote_document";
 const char* kCollectionParentsTable = "collection_parent";
+const char* kRemoteDocumentReadTimesTable = "remote_document_read_time";
+const char* kDocumentReadTimesTable = "document_read_time";
 
 /**
  * Labels for the components of keys. These serve to make keys self-describing.
@@ -96,6 +99,18 @@ enum ComponentLabel {
    */
   CollectionId = 14,
 
+  /**
+   * A component containing a snapshot version, written as its seconds and
+   * nanoseconds.
+   */
+  ReadTime = 15,
+
+  /**
+   * A component containing the last segment of a document path, when the
+   * segments before it are not stored next to it.
+   */
+  DocumentId = 16,
+
   /**
    * A path segment describes just a single segment in a resource path. Path
    * segments that occur sequentially in a key represent successive segments in
@@ -143,6 +158,12 @@ class Reader {
    */
   std::string Describe();
 
+  /**
+   * Parses the key and returns the length of its scan prefix, as described
+   * by LevelDbPrefixExtractor, or 0 if the key has none.
+   */
+  size_t ReadScanPrefixLength();
+
   void ReadTableNameMatching(const char* expected_table_name) {
     if (!ReadLabeledStringMatching(ComponentLabel::TableName,
                                    expected_table_name)) {
@@ -170,6 +191,19 @@ class Reader {
     return ReadLabeledString(ComponentLabel::CollectionId);
   }
 
+  std::string ReadDocumentId() {
+    return ReadLabeledString(ComponentLabel::DocumentId);
+  }
+
+  /**
+   * Reads a ComponentLabel::ReadTime component and the seconds and
+   * nanoseconds that follow it.
+   *
+   * If the read is unsuccessful, returns SnapshotVersion::None() and fails
+   * the Reader.
+   */
+  SnapshotVersion ReadSnapshotVersion();
+
   /**
    * Reads component labels and strings from the key until it finds a component
    * label other than ComponentLabel::PathSegment (or the key is exhausted).
@@ -396,6 +430,20 @@ ResourcePath Reader::ReadResourcePath() {
   return ResourcePath{std::move(path_segments)};
 }
 
+SnapshotVersion Reader::ReadSnapshotVersion() {
+  if (!ReadComponentLabelMatching(ComponentLabel::ReadTime)) {
+    Fail();
+    return SnapshotVersion::None();
+  }
+  int64_t seconds = ReadSignedNumIncreasing();
+  int64_t nanos = ReadSignedNumIncreasing();
+  if (!ok_ || nanos < 0 || nanos >= 1000000000) {
+    Fail();
+    return SnapshotVersion::None();
+  }
+  return SnapshotVersion{Timestamp{seconds, static_cast<int32_t>(nanos)}};
+}
+
 DocumentKey Reader::ReadDocumentKey() {
   ResourcePath path = ReadResourcePath();
 
@@ -408,6 +456,45 @@ DocumentKey Reader::ReadDocumentKey() {
   return DocumentKey{};
 }
 
+size_t Reader::ReadScanPrefixLength() {
+  const size_t total = src_.size();
+  std::string table = ReadLabeledString(ComponentLabel::TableName);
+  if (!ok_) return 0;
+
+  if (table == kRemoteDocumentsTable) {
+    // Documents in the same collection share everything up to their last path
+    // segment, which is exactly LevelDbRemoteDocumentKey::KeyPrefix(parent).
+    size_t prefix_length = 0;
+    while (!empty()) {
+      leveldb::Slice saved_position = src_;
+      if (!ReadComponentLabelMatching(ComponentLabel::PathSegment)) {
+        src_ = saved_position;
+        break;
+      }
+      prefix_length = total - saved_position.size();
+      ReadString();
+    }
+    ReadTerminator();
+    return ok_ && src_.empty() ? prefix_length : 0;
+
+  } else if (table == kRemoteDocumentReadTimesTable) {
+    // Matches LevelDbRemoteDocumentReadTimeKey::KeyPrefix(collection_path).
+    ReadResourcePath();
+    size_t prefix_length = total - src_.size();
+    ReadSnapshotVersion();
+    ReadDocumentId();
+    ReadTerminator();
+    return ok_ && src_.empty() ? prefix_length : 0;
+
+  } else if (table == kTargetDocumentsTable) {
+    // Matches LevelDbTargetDocumentKey::KeyPrefix(target_id).
+    ReadTargetId();
+    return ok_ ? total - src_.size() : 0;
+  }
+
+  return 0;
+}
+
 /**
  * Returns a base64-encoded string for an invalid key, used for debug-friendly
  * description text.
@@ -485,6 +572,19 @@ std::string Reader::Describe() {
         absl::StrAppend(&description, " collection_id=", collection_id);
       }
 
+    } else if (label == ComponentLabel::ReadTime) {
+      SnapshotVersion read_time = ReadSnapshotVersion();
+      if (ok_) {
+        absl::StrAppend(&description,
+                        " read_time=", read_time.timestamp().ToString());
+      }
+
+    } else if (label == ComponentLabel::DocumentId) {
+      std::string document_id = ReadDocumentId();
+      if (ok_) {
+        absl::StrAppend(&description, " document_id=", document_id);
+      }
+
     } else {
       absl::StrAppend(&description, " unknown label=", static_cast<int>(label));
       Fail();
@@ -536,6 +636,18 @@ class Writer {
     WriteLabeledString(ComponentLabel::CollectionId, collection_id);
   }
 
+  void WriteDocumentId(absl::string_view document_id) {
+    WriteLabeledString(ComponentLabel::DocumentId, document_id);
+  }
+
+  void WriteSnapshotVersion(const SnapshotVersion& version) {
+    WriteComponentLabel(ComponentLabel::ReadTime);
+    OrderedCode::WriteSignedNumIncreasing(&dest_,
+                                          version.timestamp().seconds());
+    OrderedCode::WriteSignedNumIncreasing(&dest_,
+                                          version.timestamp().nanoseconds());
+  }
+
   /**
    * For each segment in the given resource path writes a
    * ComponentLabel::PathSegment component label and a string containing the
@@ -882,6 +994,91 @@ bool LevelDbRemoteDocumentKey::Decode(absl::string_view key) {
   return reader.ok();
 }
 
+std::string LevelDbRemoteDocumentReadTimeKey::KeyPrefix() {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentReadTimesTable);
+  return writer.result();
+}
+
+std::string LevelDbRemoteDocumentReadTimeKey::KeyPrefix(
+    const ResourcePath& collection_path) {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentReadTimesTable);
+  writer.WriteResourcePath(collection_path);
+  return writer.result();
+}
+
+std::string LevelDbRemoteDocumentReadTimeKey::KeyPrefix(
+    const ResourcePath& collection_path, const SnapshotVersion& read_time) {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentReadTimesTable);
+  writer.WriteResourcePath(collection_path);
+  writer.WriteSnapshotVersion(read_time);
+  return writer.result();
+}
+
+std::string LevelDbRemoteDocumentReadTimeKey::Key(
+    const ResourcePath& collection_path,
+    const SnapshotVersion& read_time,
+    absl::string_view document_id) {
+  Writer writer;
+  writer.WriteTableName(kRemoteDocumentReadTimesTable);
+  writer.WriteResourcePath(collection_path);
+  writer.WriteSnapshotVersion(read_time);
+  writer.WriteDocumentId(document_id);
+  writer.WriteTerminator();
+  return writer.result();
+}
+
+bool LevelDbRemoteDocumentReadTimeKey::Decode(absl::string_view key) {
+  Reader reader{key};
+  reader.ReadTableNameMatching(kRemoteDocumentReadTimesTable);
+  collection_path_ = reader.ReadResourcePath();
+  read_time_ = reader.ReadSnapshotVersion();
+  document_id_ = reader.ReadDocumentId();
+  reader.ReadTerminator();
+  return reader.ok();
+}
+
+std::string LevelDbDocumentReadTimeKey::KeyPrefix() {
+  Writer writer;
+  writer.WriteTableName(kDocumentReadTimesTable);
+  return writer.result();
+}
+
+std::string LevelDbDocumentReadTimeKey::Key(const DocumentKey& document_key) {
+  Writer writer;
+  writer.WriteTableName(kDocumentReadTimesTable);
+  writer.WriteResourcePath(document_key.path());
+  writer.WriteTerminator();
+  return writer.result();
+}
+
+std::string LevelDbDocumentReadTimeKey::EncodeReadTime(
+    const SnapshotVersion& read_time) {
+  Writer writer;
+  writer.WriteSnapshotVersion(read_time);
+  return writer.result();
+}
+
+SnapshotVersion LevelDbDocumentReadTimeKey::DecodeReadTime(
+    absl::string_view encoded) {
+  Reader reader{encoded};
+  SnapshotVersion read_time = reader.ReadSnapshotVersion();
+  if (!reader.ok() || !reader.empty()) {
+    HARD_FAIL("Failed to read the read time of a document");
+  }
+  return read_time;
+}
+
+bool LevelDbDocumentReadTimeKey::Decode(absl::string_view key) {
+  Reader reader{key};
+  reader.ReadTableNameMatching(kDocumentReadTimesTable);
+  document_key_ = reader.ReadDocumentKey();
+  reader.ReadTerminator();
+  return reader.ok();
+}
+
 std::string LevelDbCollectionParentKey::KeyPrefix() {
   Writer writer;
   writer.WriteTableName(kCollectionParentsTable);
@@ -915,6 +1112,15 @@ bool LevelDbCollectionParentKey::Decode(absl::string_view key) {
   return reader.ok();
 }
 
+const char* LevelDbPrefixExtractor::Name() const {
+  return "firestore.ScanPrefix";
+}
+
+size_t LevelDbPrefixExtractor::PrefixLength(const leveldb::Slice& key) const {
+  Reader reader{key};
+  return reader.ReadScanPrefixLength();
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
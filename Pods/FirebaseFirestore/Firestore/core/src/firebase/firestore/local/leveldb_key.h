@@ -21,8 +21,10 @@
 
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
 #include "Firestore/core/src/firebase/firestore/model/resource_path.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
 #include "Firestore/core/src/firebase/firestore/model/types.h"
 #include "absl/strings/string_view.h"
+#include "leveldb/filter_policy.h"
 #include "leveldb/slice.h"
 
 namespace firebase {
@@ -78,6 +80,16 @@ namespace local {
 //   - table_name: string = "remote_document"
 //   - path: ResourcePath
 //
+// remote_document_read_times:
+//   - table_name: string = "remote_document_read_time"
+//   - collection_path: ResourcePath
+//   - read_time: model::SnapshotVersion
+//   - document_id: string
+//
+// document_read_times:
+//   - table_name: string = "document_read_time"
+//   - path: ResourcePath
+//
 // collection_parents:
 //   - table_name: string = "collection_parent"
 //   - collectionId: string
@@ -525,6 +537,123 @@ class LevelDbRemoteDocumentKey {
   model::DocumentKey document_key_;
 };
 
+/**
+ * A key in the remote document read time index, which records the snapshot
+ * version at which each remote document was last written to the cache. Keys
+ * are grouped by collection and sorted by read time, so that the documents of
+ * a collection that changed after a given version can be found with a single
+ * range scan. The value of each row is empty.
+ *
+ * Each document has at most one row here. The read time it was written with
+ * is kept in LevelDbDocumentReadTimeKey, so that the row can be found and
+ * replaced when the document is read again or removed. Documents written
+ * before the index existed have no row at all.
+ */
+class LevelDbRemoteDocumentReadTimeKey {
+ public:
+  /**
+   * Creates a key prefix that points just before the first key in the table.
+   */
+  static std::string KeyPrefix();
+
+  /**
+   * Creates a key prefix that points just before the first key for documents
+   * in the given collection.
+   */
+  static std::string KeyPrefix(const model::ResourcePath& collection_path);
+
+  /**
+   * Creates a key prefix that points just before the first key for documents
+   * in the given collection that were read at `read_time`. Seeking to it
+   * positions an iterator at the first document read at or after
+   * `read_time`.
+   */
+  static std::string KeyPrefix(const model::ResourcePath& collection_path,
+                               const model::SnapshotVersion& read_time);
+
+  /**
+   * Creates a complete key for the document with the given id in the given
+   * collection, read at `read_time`.
+   */
+  static std::string Key(const model::ResourcePath& collection_path,
+                         const model::SnapshotVersion& read_time,
+                         absl::string_view document_id);
+
+  /**
+   * Decodes the given complete key, storing the decoded values in this
+   * instance.
+   *
+   * @return true if the key successfully decoded, false otherwise. If false is
+   * returned, this instance is in an undefined state until the next call to
+   * `Decode()`.
+   */
+  ABSL_MUST_USE_RESULT
+  bool Decode(absl::string_view key);
+
+  /** The path to the collection, as encoded in the key. */
+  const model::ResourcePath& collection_path() const {
+    return collection_path_;
+  }
+
+  /** The read time of the document, as encoded in the key. */
+  const model::SnapshotVersion& read_time() const {
+    return read_time_;
+  }
+
+  /** The document key that the collection path and document id make up. */
+  model::DocumentKey document_key() const {
+    return model::DocumentKey{collection_path_.Append(document_id_)};
+  }
+
+ private:
+  // Assigned in Decode
+  model::ResourcePath collection_path_;
+  model::SnapshotVersion read_time_{model::SnapshotVersion::None()};
+  std::string document_id_;
+};
+
+/**
+ * A key in the document read times table, which maps each document key to the
+ * read time of its row in the remote document read time index. The value of
+ * each row is the read time, as written by EncodeReadTime().
+ */
+class LevelDbDocumentReadTimeKey {
+ public:
+  /**
+   * Creates a key prefix that points just before the first key in the table.
+   */
+  static std::string KeyPrefix();
+
+  /** Creates a complete key that points to a specific document. */
+  static std::string Key(const model::DocumentKey& document_key);
+
+  /** Encodes a read time for storage in the value of a row. */
+  static std::string EncodeReadTime(const model::SnapshotVersion& read_time);
+
+  /** Decodes the contents of a row value written by EncodeReadTime(). */
+  static model::SnapshotVersion DecodeReadTime(absl::string_view encoded);
+
+  /**
+   * Decodes the given complete key, storing the decoded values in this
+   * instance.
+   *
+   * @return true if the key successfully decoded, false otherwise. If false is
+   * returned, this instance is in an undefined state until the next call to
+   * `Decode()`.
+   */
+  ABSL_MUST_USE_RESULT
+  bool Decode(absl::string_view key);
+
+  /** The path to the document, as encoded in the key. */
+  const model::DocumentKey& document_key() const {
+    return document_key_;
+  }
+
+ private:
+  // Deliberately uninitialized: will be assigned in Decode
+  model::DocumentKey document_key_;
+};
+
 /**
  * A key in the collection parents index, which stores an association between a
  * Collection ID (e.g. 'messages') to a parent path (e.g. '/chats/123') that
@@ -578,6 +707,26 @@ class LevelDbCollectionParentKey {
   model::ResourcePath parent_;
 };
 
+/**
+ * Picks the prefix that range scans over a key's table start from, so that a
+ * prefix bloom filter (see leveldb::NewPrefixBloomFilterPolicy) can rule out
+ * whole tables for those scans:
+ *
+ *   - remote document keys yield LevelDbRemoteDocumentKey::KeyPrefix() of
+ *     the collection containing the document;
+ *   - remote document read time keys yield
+ *     LevelDbRemoteDocumentReadTimeKey::KeyPrefix() of their collection;
+ *   - target document keys yield LevelDbTargetDocumentKey::KeyPrefix() of
+ *     the target.
+ *
+ * All other keys have no prefix and are only filtered as whole keys.
+ */
+class LevelDbPrefixExtractor : public leveldb::PrefixExtractor {
+ public:
+  const char* Name() const override;
+  size_t PrefixLength(const leveldb::Slice& key) const override;
+};
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
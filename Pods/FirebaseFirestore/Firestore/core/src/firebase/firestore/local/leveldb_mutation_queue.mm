@@ -229,6 +229,10 @@ LevelDbMutationQueue::AllMutationBatchesAffectingDocumentKeys(
   // Take a pass through the document keys and collect the set of unique
   // mutation batch_ids that affect them all. Some batches can affect more than
   // one key.
+  //
+  // The index rows of each document sort before those of every document that
+  // follows it in `document_keys`, so a single iterator moves forward through
+  // the index instead of seeking from scratch for each key.
   std::set<BatchId> batch_ids;
 
   auto index_iterator = db_.currentTransaction->NewIterator();
@@ -236,7 +240,7 @@ LevelDbMutationQueue::AllMutationBatchesAffectingDocumentKeys(
   for (const DocumentKey& document_key : document_keys) {
     std::string index_prefix =
         LevelDbDocumentMutationKey::KeyPrefix(user_id_, document_key.path());
-    for (index_iterator->Seek(index_prefix); index_iterator->Valid();
+    for (index_iterator->SeekForward(index_prefix); index_iterator->Valid();
          index_iterator->Next()) {
       // Only consider rows matching exactly the specific key of interest. Index
       // rows have this form (with markers in brackets):
@@ -422,7 +426,7 @@ std::vector<FSTMutationBatch*> LevelDbMutationQueue::AllMutationBatchesWithIds(
   auto mutation_iterator = db_.currentTransaction->NewIterator();
   for (BatchId batch_id : batch_ids) {
     std::string mutation_key = mutation_batch_key(batch_id);
-    mutation_iterator->Seek(mutation_key);
+    mutation_iterator->SeekForward(mutation_key);
     if (!mutation_iterator->Valid() ||
         mutation_iterator->key() != mutation_key) {
       HARD_FAIL("Dangling document-mutation reference found: "
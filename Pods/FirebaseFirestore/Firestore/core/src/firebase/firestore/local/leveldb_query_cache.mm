@@ -231,7 +231,7 @@ void LevelDbQueryCache::RemoveMatchingKeys(const DocumentKeySet& keys,
 
 void LevelDbQueryCache::RemoveAllKeysForTarget(TargetId target_id) {
   std::string index_prefix = LevelDbTargetDocumentKey::KeyPrefix(target_id);
-  auto index_iterator = db_.currentTransaction->NewIterator();
+  auto index_iterator = db_.currentTransaction->NewIterator(index_prefix);
   index_iterator->Seek(index_prefix);
 
   LevelDbTargetDocumentKey row_key;
@@ -253,16 +253,18 @@ void LevelDbQueryCache::RemoveAllKeysForTarget(TargetId target_id) {
 
 DocumentKeySet LevelDbQueryCache::GetMatchingKeys(TargetId target_id) {
   std::string index_prefix = LevelDbTargetDocumentKey::KeyPrefix(target_id);
-  auto index_iterator = db_.currentTransaction->NewIterator();
+  auto index_iterator = db_.currentTransaction->NewIterator(index_prefix);
   index_iterator->Seek(index_prefix);
 
+  // The rows of a target are contiguous and ordered by document key, so this
+  // is a single forward walk that stops at the first row outside the prefix
+  // without decoding it.
   DocumentKeySet result;
   LevelDbTargetDocumentKey row_key;
-  for (; index_iterator->Valid(); index_iterator->Next()) {
-    // TODO(gsoltis): could we use a StartsWith instead?
-    // Only consider rows matching this specific target_id.
-    if (!row_key.Decode(index_iterator->key()) ||
-        row_key.target_id() != target_id) {
+  for (; index_iterator->Valid() &&
+         absl::StartsWith(index_iterator->key(), index_prefix);
+       index_iterator->Next()) {
+    if (!row_key.Decode(index_iterator->key())) {
       break;
     }
 
@@ -21,13 +21,20 @@
 #error "For now, this file must only be included by ObjC source files."
 #endif  // !defined(__OBJC__)
 
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Firestore/core/src/firebase/firestore/local/remote_document_cache.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/resource_path.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
 #include "Firestore/core/src/firebase/firestore/model/types.h"
+#include "Firestore/core/src/firebase/firestore/util/thread_pool.h"
 #include "absl/strings/string_view.h"
 
 @class FSTLevelDB;
@@ -41,25 +48,133 @@ namespace firebase {
 namespace firestore {
 namespace local {
 
-/** Cached Remote Documents backed by leveldb. */
+/**
+ * Cached Remote Documents backed by leveldb.
+ *
+ * Decoding a document from its stored protocol buffer is usually the most
+ * expensive part of reading it, so recently used documents are also kept in
+ * decoded form. All writes to the remote documents table go through this
+ * class, which updates the decoded documents along with the table; documents
+ * are immutable, so the same instance can be handed out to every reader.
+ */
 class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
  public:
-  LevelDbRemoteDocumentCache(FSTLevelDB* db, FSTLocalSerializer* serializer);
+  /**
+   * The default budget for decoded documents, in bytes of their encoded form.
+   */
+  static constexpr size_t kDefaultDecodedCacheSize = 4 * 1024 * 1024;
+
+  /**
+   * Creates a cache that keeps up to `decoded_cache_size` bytes of decoded
+   * documents in memory. Documents are charged the size of their encoded
+   * form; a size of zero disables the decoded document cache.
+   */
+  LevelDbRemoteDocumentCache(
+      FSTLevelDB* db,
+      FSTLocalSerializer* serializer,
+      size_t decoded_cache_size = kDefaultDecodedCacheSize);
 
-  void Add(FSTMaybeDocument* document) override;
+  void Add(FSTMaybeDocument* document,
+           const model::SnapshotVersion& read_time) override;
   void Remove(const model::DocumentKey& key) override;
 
   FSTMaybeDocument* _Nullable Get(const model::DocumentKey& key) override;
   model::MaybeDocumentMap GetAll(const model::DocumentKeySet& keys) override;
-  model::DocumentMap GetMatching(FSTQuery* query) override;
+  model::DocumentMap GetMatching(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time) override;
+
+  /** The number of document reads served without decoding the document. */
+  size_t decoded_cache_hits() const {
+    return decoded_cache_hits_;
+  }
+
+  /**
+   * The number of document reads that had to read and decode the stored
+   * document, including reads of documents that turned out not to exist.
+   */
+  size_t decoded_cache_misses() const {
+    return decoded_cache_misses_;
+  }
+
+  /** The number of bytes currently charged to the decoded document cache. */
+  size_t decoded_cache_bytes() const {
+    return decoded_cache_bytes_;
+  }
 
  private:
+  /** A decoded document and the bytes it is charged against the budget. */
+  struct DecodedEntry {
+    model::DocumentKey key;
+    FSTMaybeDocument* document;
+    size_t charge;
+  };
+
+  using DecodedList = std::list<DecodedEntry>;
+
+  /**
+   * Returns the decoded document for `key` and marks it as most recently
+   * used, or returns nil if it is not in the decoded document cache. Counts
+   * the lookup as a hit or a miss.
+   */
+  FSTMaybeDocument* _Nullable LookupDecoded(const model::DocumentKey& key);
+
+  /**
+   * Adds `document` to the decoded document cache, replacing any previous
+   * entry for its key and evicting the least recently used documents until
+   * the cache fits its budget again.
+   */
+  void InsertDecoded(FSTMaybeDocument* document, size_t charge);
+
+  /** Drops the decoded document for `key`, if there is one. */
+  void EraseDecoded(const model::DocumentKey& key);
+
+  /** Decodes a stored document and adds it to the decoded document cache. */
+  FSTMaybeDocument* DecodeAndCache(absl::string_view encoded,
+                                   const model::DocumentKey& key);
+
+  /**
+   * Decodes the stored documents in `encoded`, whose keys are `keys`, and
+   * adds them to the decoded document cache. Large batches are decoded
+   * concurrently on `decode_pool_`.
+   */
+  std::vector<FSTMaybeDocument*> DecodeAndCacheAll(
+      const std::vector<std::string>& encoded,
+      const std::vector<model::DocumentKey>& keys);
+
+  /**
+   * Deletes the read time index row of the document with the given key, if
+   * it has one.
+   */
+  void RemoveReadTime(const model::DocumentKey& key);
+
+  /**
+   * Returns the documents in the collection at `collection_path` that were
+   * read after `since_read_time`, found through the read time index.
+   */
+  model::DocumentMap GetMatchingSince(
+      const model::ResourcePath& collection_path,
+      const model::SnapshotVersion& since_read_time);
+
   FSTMaybeDocument* DecodeMaybeDocument(absl::string_view encoded,
                                         const model::DocumentKey& key);
 
   // This instance is owned by FSTLevelDB; avoid a retain cycle.
   __weak FSTLevelDB* db_;
   FSTLocalSerializer* serializer_;
+
+  // Decoded documents, most recently used first, and an index into them.
+  DecodedList decoded_lru_;
+  std::unordered_map<model::DocumentKey,
+                     DecodedList::iterator,
+                     model::DocumentKeyHash>
+      decoded_index_;
+  size_t decoded_cache_size_;
+  size_t decoded_cache_bytes_ = 0;
+  size_t decoded_cache_hits_ = 0;
+  size_t decoded_cache_misses_ = 0;
+
+  // Decodes large batches of documents; created on first use.
+  std::unique_ptr<util::ThreadPool> decode_pool_;
 };
 
 }  // namespace local
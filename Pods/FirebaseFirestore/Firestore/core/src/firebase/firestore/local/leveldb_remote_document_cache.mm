@@ -18,7 +18,9 @@
 
 #import <Foundation/Foundation.h>
 
+#include <algorithm>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 
 #import "Firestore/Protos/objc/firestore/local/MaybeDocument.pbobjc.h"
 #import "Firestore/Source/Core/FSTQuery.h"
@@ -28,45 +30,112 @@
 
 #include "Firestore/core/src/firebase/firestore/local/leveldb_key.h"
 #include "Firestore/core/src/firebase/firestore/util/status.h"
+#include "absl/memory/memory.h"
 #include "leveldb/db.h"
 
 using firebase::firestore::model::DocumentKey;
 using firebase::firestore::model::DocumentKeySet;
 using firebase::firestore::model::DocumentMap;
 using firebase::firestore::model::MaybeDocumentMap;
+using firebase::firestore::model::ResourcePath;
+using firebase::firestore::model::SnapshotVersion;
+using firebase::firestore::util::ThreadPool;
 using leveldb::Status;
 
 namespace firebase {
 namespace firestore {
 namespace local {
 
+namespace {
+
+/**
+ * The fewest documents worth decoding on the pool; handing fewer to the
+ * workers costs about as much as decoding them on the calling thread.
+ */
+const size_t kMinParallelDecodes = 32;
+
+}  // namespace
+
+constexpr size_t LevelDbRemoteDocumentCache::kDefaultDecodedCacheSize;
+
 LevelDbRemoteDocumentCache::LevelDbRemoteDocumentCache(
-    FSTLevelDB* db, FSTLocalSerializer* serializer)
-    : db_(db), serializer_(serializer) {
+    FSTLevelDB* db, FSTLocalSerializer* serializer, size_t decoded_cache_size)
+    : db_(db),
+      serializer_(serializer),
+      decoded_cache_size_(decoded_cache_size) {
 }
 
-void LevelDbRemoteDocumentCache::Add(FSTMaybeDocument* document) {
-  std::string ldb_key = LevelDbRemoteDocumentKey::Key(document.key);
-  db_.currentTransaction->Put(ldb_key,
-                              [serializer_ encodedMaybeDocument:document]);
+void LevelDbRemoteDocumentCache::Add(FSTMaybeDocument* document,
+                                     const SnapshotVersion& read_time) {
+  const DocumentKey& key = document.key;
+  const ResourcePath& path = key.path();
+  std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
+  NSData* encoded = [[serializer_ encodedMaybeDocument:document] data];
+  db_.currentTransaction->Put(
+      ldb_key,
+      absl::string_view{static_cast<const char*>(encoded.bytes),
+                        encoded.length});
+  if ([document isKindOfClass:[FSTDocument class]] &&
+      static_cast<FSTDocument*>(document).hasLocalMutations) {
+    // The stored form does not record local mutations, so reading the
+    // document back would not return an equivalent instance.
+    EraseDecoded(key);
+  } else {
+    InsertDecoded(document, encoded.length);
+  }
 
-  db_.indexManager->AddToCollectionParentIndex(document.key.path().PopLast());
+  RemoveReadTime(key);
+  db_.currentTransaction->Put(
+      LevelDbRemoteDocumentReadTimeKey::Key(path.PopLast(), read_time,
+                                            path.last_segment()),
+      std::string{});
+  db_.currentTransaction->Put(
+      LevelDbDocumentReadTimeKey::Key(key),
+      LevelDbDocumentReadTimeKey::EncodeReadTime(read_time));
+
+  db_.indexManager->AddToCollectionParentIndex(path.PopLast());
 }
 
 void LevelDbRemoteDocumentCache::Remove(const DocumentKey& key) {
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
   db_.currentTransaction->Delete(ldb_key);
+  EraseDecoded(key);
+
+  RemoveReadTime(key);
+  db_.currentTransaction->Delete(LevelDbDocumentReadTimeKey::Key(key));
+}
+
+void LevelDbRemoteDocumentCache::RemoveReadTime(const DocumentKey& key) {
+  std::string value;
+  Status status =
+      db_.currentTransaction->Get(LevelDbDocumentReadTimeKey::Key(key), &value);
+  if (status.IsNotFound()) {
+    return;
+  } else if (!status.ok()) {
+    HARD_FAIL("Fetch read time for key (%s) failed with status: %s",
+              key.ToString(), status.ToString());
+  }
+
+  const ResourcePath& path = key.path();
+  db_.currentTransaction->Delete(LevelDbRemoteDocumentReadTimeKey::Key(
+      path.PopLast(), LevelDbDocumentReadTimeKey::DecodeReadTime(value),
+      path.last_segment()));
 }
 
 FSTMaybeDocument* _Nullable LevelDbRemoteDocumentCache::Get(
     const DocumentKey& key) {
+  FSTMaybeDocument* decoded = LookupDecoded(key);
+  if (decoded) {
+    return decoded;
+  }
+
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
   std::string value;
   Status status = db_.currentTransaction->Get(ldb_key, &value);
   if (status.IsNotFound()) {
     return nil;
   } else if (status.ok()) {
-    return DecodeMaybeDocument(value, key);
+    return DecodeAndCache(value, key);
   } else {
     HARD_FAIL("Fetch document for key (%s) failed with status: %s",
               key.ToString(), status.ToString());
@@ -77,27 +146,40 @@ MaybeDocumentMap LevelDbRemoteDocumentCache::GetAll(
     const DocumentKeySet& keys) {
   MaybeDocumentMap results;
 
+  // The keys are visited in ascending order, which is also the order of their
+  // rows in the table, so a single iterator walks forward through the table.
   LevelDbRemoteDocumentKey currentKey;
   auto it = db_.currentTransaction->NewIterator();
 
   for (const DocumentKey& key : keys) {
-    it->Seek(LevelDbRemoteDocumentKey::Key(key));
+    FSTMaybeDocument* decoded = LookupDecoded(key);
+    if (decoded) {
+      results = results.insert(key, decoded);
+      continue;
+    }
+
+    it->SeekForward(LevelDbRemoteDocumentKey::Key(key));
     if (!it->Valid() || !currentKey.Decode(it->key()) ||
         currentKey.document_key() != key) {
       results = results.insert(key, nil);
     } else {
-      results = results.insert(key, DecodeMaybeDocument(it->value(), key));
+      results = results.insert(key, DecodeAndCache(it->value(), key));
     }
   }
 
   return results;
 }
 
-DocumentMap LevelDbRemoteDocumentCache::GetMatching(FSTQuery* query) {
+DocumentMap LevelDbRemoteDocumentCache::GetMatching(
+    FSTQuery* query, const SnapshotVersion& since_read_time) {
   HARD_ASSERT(
       ![query isCollectionGroupQuery],
       "CollectionGroup queries should be handled in LocalDocumentsView");
 
+  if (since_read_time != SnapshotVersion::None()) {
+    return GetMatchingSince(query.path, since_read_time);
+  }
+
   DocumentMap results;
 
   // Use the query path as a prefix for testing if a document matches the query.
@@ -107,9 +189,13 @@ DocumentMap LevelDbRemoteDocumentCache::GetMatching(FSTQuery* query) {
   // Documents are ordered by key, so we can use a prefix scan to narrow down
   // the documents we need to match the query against.
   std::string start_key = LevelDbRemoteDocumentKey::KeyPrefix(query_path);
-  auto it = db_.currentTransaction->NewIterator();
+  auto it = db_.currentTransaction->NewIterator(start_key);
   it->Seek(start_key);
 
+  // Documents that are not decoded yet are decoded together after the scan.
+  std::vector<DocumentKey> undecoded_keys;
+  std::vector<std::string> undecoded;
+
   LevelDbRemoteDocumentKey current_key;
   for (; it->Valid() && current_key.Decode(it->key()); it->Next()) {
     // The query is actually returning any path that starts with the query path
@@ -121,20 +207,146 @@ DocumentMap LevelDbRemoteDocumentCache::GetMatching(FSTQuery* query) {
     if (document_key.path().size() != immediate_children_path_length) {
       continue;
     }
-
-    FSTMaybeDocument* maybe_doc =
-        DecodeMaybeDocument(it->value(), document_key);
-    if (!query_path.IsPrefixOf(maybe_doc.key.path())) {
+    if (!query_path.IsPrefixOf(document_key.path())) {
       break;
+    }
+
+    FSTMaybeDocument* maybe_doc = LookupDecoded(document_key);
+    if (!maybe_doc) {
+      absl::string_view value = it->value();
+      undecoded_keys.push_back(document_key);
+      undecoded.emplace_back(value.data(), value.size());
     } else if ([maybe_doc isKindOfClass:[FSTDocument class]]) {
       results =
           results.insert(maybe_doc.key, static_cast<FSTDocument*>(maybe_doc));
     }
   }
 
+  for (FSTMaybeDocument* maybe_doc :
+       DecodeAndCacheAll(undecoded, undecoded_keys)) {
+    if ([maybe_doc isKindOfClass:[FSTDocument class]]) {
+      results =
+          results.insert(maybe_doc.key, static_cast<FSTDocument*>(maybe_doc));
+    }
+  }
+
+  return results;
+}
+
+DocumentMap LevelDbRemoteDocumentCache::GetMatchingSince(
+    const ResourcePath& collection_path,
+    const SnapshotVersion& since_read_time) {
+  // Rows of the read time index are sorted by read time within a collection,
+  // so everything read after since_read_time is a contiguous range that ends
+  // where the next collection (or a subcollection) begins.
+  std::string prefix =
+      LevelDbRemoteDocumentReadTimeKey::KeyPrefix(collection_path);
+  auto it = db_.currentTransaction->NewIterator(prefix);
+  it->Seek(LevelDbRemoteDocumentReadTimeKey::KeyPrefix(collection_path,
+                                                        since_read_time));
+
+  DocumentKeySet keys;
+  LevelDbRemoteDocumentReadTimeKey current_key;
+  for (; it->Valid() && current_key.Decode(it->key()); it->Next()) {
+    if (current_key.collection_path() != collection_path) {
+      break;
+    }
+    // The seek lands on the first row read at since_read_time; only strictly
+    // newer reads are wanted.
+    if (current_key.read_time() > since_read_time) {
+      keys = keys.insert(current_key.document_key());
+    }
+  }
+
+  DocumentMap results;
+  for (const auto& kv : GetAll(keys)) {
+    FSTMaybeDocument* maybe_doc = kv.second;
+    if ([maybe_doc isKindOfClass:[FSTDocument class]]) {
+      results = results.insert(kv.first, static_cast<FSTDocument*>(maybe_doc));
+    }
+  }
   return results;
 }
 
+FSTMaybeDocument* _Nullable LevelDbRemoteDocumentCache::LookupDecoded(
+    const DocumentKey& key) {
+  auto found = decoded_index_.find(key);
+  if (found == decoded_index_.end()) {
+    ++decoded_cache_misses_;
+    return nil;
+  }
+
+  ++decoded_cache_hits_;
+  decoded_lru_.splice(decoded_lru_.begin(), decoded_lru_, found->second);
+  return found->second->document;
+}
+
+void LevelDbRemoteDocumentCache::InsertDecoded(FSTMaybeDocument* document,
+                                               size_t charge) {
+  EraseDecoded(document.key);
+  if (charge > decoded_cache_size_) {
+    return;
+  }
+
+  decoded_lru_.push_front(DecodedEntry{document.key, document, charge});
+  decoded_index_[document.key] = decoded_lru_.begin();
+  decoded_cache_bytes_ += charge;
+
+  while (decoded_cache_bytes_ > decoded_cache_size_) {
+    const DecodedEntry& oldest = decoded_lru_.back();
+    decoded_cache_bytes_ -= oldest.charge;
+    decoded_index_.erase(oldest.key);
+    decoded_lru_.pop_back();
+  }
+}
+
+void LevelDbRemoteDocumentCache::EraseDecoded(const DocumentKey& key) {
+  auto found = decoded_index_.find(key);
+  if (found == decoded_index_.end()) {
+    return;
+  }
+
+  decoded_cache_bytes_ -= found->second->charge;
+  decoded_lru_.erase(found->second);
+  decoded_index_.erase(found);
+}
+
+FSTMaybeDocument* LevelDbRemoteDocumentCache::DecodeAndCache(
+    absl::string_view encoded, const DocumentKey& key) {
+  FSTMaybeDocument* document = DecodeMaybeDocument(encoded, key);
+  InsertDecoded(document, encoded.size());
+  return document;
+}
+
+std::vector<FSTMaybeDocument*> LevelDbRemoteDocumentCache::DecodeAndCacheAll(
+    const std::vector<std::string>& encoded,
+    const std::vector<DocumentKey>& keys) {
+  std::vector<FSTMaybeDocument*> documents(encoded.size());
+  if (encoded.size() < kMinParallelDecodes) {
+    for (size_t i = 0; i < encoded.size(); ++i) {
+      documents[i] = DecodeMaybeDocument(encoded[i], keys[i]);
+    }
+  } else {
+    if (!decode_pool_) {
+      // The calling thread decodes too, so it is one of the threads.
+      size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+      decode_pool_ = absl::make_unique<ThreadPool>(threads - 1);
+    }
+    // Decoding only reads the serializer, and each call writes its own slot.
+    decode_pool_->ParallelFor(encoded.size(), [&](size_t i) {
+      @autoreleasepool {
+        documents[i] = DecodeMaybeDocument(encoded[i], keys[i]);
+      }
+    });
+  }
+
+  // The decoded document cache is only touched from the calling thread.
+  for (size_t i = 0; i < documents.size(); ++i) {
+    InsertDecoded(documents[i], encoded[i].size());
+  }
+  return documents;
+}
+
 FSTMaybeDocument* LevelDbRemoteDocumentCache::DecodeMaybeDocument(
     absl::string_view encoded, const DocumentKey& key) {
   NSData* data = [[NSData alloc] initWithBytesNoCopy:(void*)encoded.data()
@@ -17,6 +17,7 @@
 #include "Firestore/core/src/firebase/firestore/local/leveldb_transaction.h"
 
 #include "Firestore/core/src/firebase/firestore/local/leveldb_key.h"
+#include "Firestore/core/src/firebase/firestore/local/leveldb_util.h"
 #include "Firestore/core/src/firebase/firestore/util/hard_assert.h"
 #include "Firestore/core/src/firebase/firestore/util/log.h"
 #include "absl/memory/memory.h"
@@ -34,11 +35,24 @@ namespace firebase {
 namespace firestore {
 namespace local {
 
+namespace {
+
+/** Returns `read_options` restricted to keys starting with `prefix`. */
+ReadOptions PrefixReadOptions(ReadOptions read_options,
+                              absl::string_view prefix) {
+  read_options.prefix = MakeSlice(prefix);
+  return read_options;
+}
+
+}  // namespace
+
+constexpr int LevelDbTransaction::Iterator::kMaxSequentialSkips;
+
 LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn)
     : db_iter_(txn->db_->NewIterator(txn->read_options_)),
       last_version_(txn->version_),
       txn_(txn),
-      mutations_iter_(txn->mutations_.begin()),
+      writes_iter_(txn->writes_.begin()),
       current_(),
       is_mutation_(false),
       // Iterator doesn't really point to anything yet, so is
@@ -46,8 +60,20 @@ LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn)
       is_valid_(false) {
 }
 
+LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn,
+                                       absl::string_view prefix)
+    : db_iter_(txn->db_->NewIterator(
+          PrefixReadOptions(txn->read_options_, prefix))),
+      last_version_(txn->version_),
+      txn_(txn),
+      writes_iter_(txn->writes_.begin()),
+      current_(),
+      is_mutation_(false),
+      is_valid_(false) {
+}
+
 void LevelDbTransaction::Iterator::UpdateCurrent() {
-  bool mutation_is_valid = mutations_iter_ != txn_->mutations_.end();
+  bool mutation_is_valid = writes_iter_ != txn_->writes_.end();
   is_valid_ = mutation_is_valid || db_iter_->Valid();
 
   if (is_valid_) {
@@ -60,12 +86,19 @@ void LevelDbTransaction::Iterator::UpdateCurrent() {
       // than the current mutation key, we are looking at a mutation next. It's
       // either sooner in the iteration or directly shadowing the underlying
       // committed value in leveldb.
-      is_mutation_ = db_iter_->key().compare(mutations_iter_->first) >= 0;
+      is_mutation_ =
+          MakeStringView(db_iter_->key()).compare(writes_iter_->first) >= 0;
     }
+    // Assign rather than construct, so that current_ reuses its buffers.
     if (is_mutation_) {
-      current_ = *mutations_iter_;
+      current_.first.assign(writes_iter_->first.data(),
+                            writes_iter_->first.size());
+      current_.second.assign(writes_iter_->second.value.data(),
+                             writes_iter_->second.value.size());
     } else {
-      current_ = {db_iter_->key().ToString(), db_iter_->value().ToString()};
+      current_.first.assign(db_iter_->key().data(), db_iter_->key().size());
+      current_.second.assign(db_iter_->value().data(),
+                             db_iter_->value().size());
     }
   }
 }
@@ -78,11 +111,32 @@ void LevelDbTransaction::Iterator::Seek(const std::string& key) {
   }
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
-  mutations_iter_ = txn_->mutations_.lower_bound(key);
+  writes_iter_ = txn_->writes_.lower_bound(key);
+  SkipPendingDeletes();
   UpdateCurrent();
   last_version_ = txn_->version_;
 }
 
+void LevelDbTransaction::Iterator::SeekForward(const std::string& key) {
+  // Stepping is only valid while current_ reflects the transaction; if it has
+  // changed since, Seek() resynchronizes anyway.
+  if (is_valid_ && last_version_ == txn_->version_) {
+    for (int skipped = 0; current_.first < key; ++skipped) {
+      if (skipped == kMaxSequentialSkips) {
+        Seek(key);
+        return;
+      }
+      Next();
+      if (!is_valid_) {
+        // Walked off the end, so there is nothing at or after `key` either.
+        return;
+      }
+    }
+    return;
+  }
+  Seek(key);
+}
+
 absl::string_view LevelDbTransaction::Iterator::key() {
   HARD_ASSERT(Valid(), "key() called on invalid iterator");
   return current_.first;
@@ -94,7 +148,15 @@ absl::string_view LevelDbTransaction::Iterator::value() {
 }
 
 bool LevelDbTransaction::Iterator::IsDeleted(leveldb::Slice slice) {
-  return txn_->deletions_.find(slice.ToString()) != txn_->deletions_.end();
+  auto found = txn_->writes_.find(MakeStringView(slice));
+  return found != txn_->writes_.end() && found->second.is_delete;
+}
+
+void LevelDbTransaction::Iterator::SkipPendingDeletes() {
+  while (writes_iter_ != txn_->writes_.end() &&
+         writes_iter_->second.is_delete) {
+    ++writes_iter_;
+  }
 }
 
 bool LevelDbTransaction::Iterator::SyncToTransaction() {
@@ -124,10 +186,12 @@ void LevelDbTransaction::Iterator::Next() {
   if (!advanced && is_valid_) {
     if (is_mutation_) {
       // A mutation might be shadowing leveldb. If so, advance both.
-      if (db_iter_->Valid() && db_iter_->key() == mutations_iter_->first) {
+      if (db_iter_->Valid() &&
+          MakeStringView(db_iter_->key()) == writes_iter_->first) {
         AdvanceLDB();
       }
-      ++mutations_iter_;
+      ++writes_iter_;
+      SkipPendingDeletes();
     } else {
       AdvanceLDB();
     }
@@ -140,8 +204,8 @@ LevelDbTransaction::LevelDbTransaction(DB* db,
                                        const ReadOptions& read_options,
                                        const WriteOptions& write_options)
     : db_(db),
-      mutations_(),
-      deletions_(),
+      arena_(),
+      writes_(std::less<absl::string_view>(), Writes::allocator_type(&arena_)),
       read_options_(read_options),
       write_options_(write_options),
       version_(0),
@@ -162,47 +226,59 @@ const WriteOptions& LevelDbTransaction::DefaultWriteOptions() {
   return options;
 }
 
-void LevelDbTransaction::Put(std::string key, std::string value) {
-  deletions_.erase(key);
-  mutations_.emplace(std::make_pair(std::move(key), std::move(value)));
+void LevelDbTransaction::Record(absl::string_view key, PendingWrite write) {
+  auto found = writes_.lower_bound(key);
+  if (found != writes_.end() && found->first == key) {
+    // The key and the previous value stay in the arena until the transaction
+    // is destroyed.
+    found->second = write;
+  } else {
+    writes_.emplace_hint(found, arena_.Copy(key), write);
+  }
   version_++;
 }
 
+void LevelDbTransaction::Put(absl::string_view key, absl::string_view value) {
+  Record(key, PendingWrite{arena_.Copy(value), false});
+}
+
 std::unique_ptr<LevelDbTransaction::Iterator>
 LevelDbTransaction::NewIterator() {
   return absl::make_unique<LevelDbTransaction::Iterator>(this);
 }
 
+std::unique_ptr<LevelDbTransaction::Iterator> LevelDbTransaction::NewIterator(
+    absl::string_view prefix) {
+  return absl::make_unique<LevelDbTransaction::Iterator>(this, prefix);
+}
+
 Status LevelDbTransaction::Get(absl::string_view key, std::string* value) {
-  std::string key_string(key);
-  if (deletions_.find(key_string) != deletions_.end()) {
-    return Status::NotFound(key_string + " is not present in the transaction");
+  Writes::iterator iter{writes_.find(key)};
+  if (iter == writes_.end()) {
+    return db_->Get(read_options_, MakeSlice(key), value);
+  } else if (iter->second.is_delete) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
   } else {
-    Mutations::iterator iter{mutations_.find(key_string)};
-    if (iter != mutations_.end()) {
-      *value = iter->second;
-      return Status::OK();
-    } else {
-      return db_->Get(read_options_, key_string, value);
-    }
+    value->assign(iter->second.value.data(), iter->second.value.size());
+    return Status::OK();
   }
 }
 
 void LevelDbTransaction::Delete(absl::string_view key) {
-  std::string to_delete(key);
-  deletions_.insert(to_delete);
-  mutations_.erase(to_delete);
-  version_++;
+  Record(key, PendingWrite{absl::string_view{}, true});
 }
 
 void LevelDbTransaction::Commit() {
+  // Each key is written once, with its latest change, and in key order, which
+  // keeps the memtable inserts cheap.
   WriteBatch batch;
-  for (const auto& deletion : deletions_) {
-    batch.Delete(deletion);
-  }
-
-  for (const auto& entry : mutations_) {
-    batch.Put(entry.first, entry.second);
+  for (const auto& entry : writes_) {
+    if (entry.second.is_delete) {
+      batch.Delete(MakeSlice(entry.first));
+    } else {
+      batch.Put(MakeSlice(entry.first), MakeSlice(entry.second.value));
+    }
   }
 
   LOG_DEBUG("Committing transaction: %s", ToString());
@@ -214,19 +290,22 @@ void LevelDbTransaction::Commit() {
 
 std::string LevelDbTransaction::ToString() {
   std::string dest = absl::StrCat("<LevelDbTransaction ", label_, ": ");
-  size_t changes = deletions_.size() + mutations_.size();
+  size_t changes = writes_.size();
   size_t bytes = 0;  // accumulator for size of individual mutations.
   dest += std::to_string(changes) + " changes ";
-  std::string items;  // accumulator for individual changes.
-  for (const auto& deletion : deletions_) {
-    absl::StrAppend(&items, "\n  - Delete ", DescribeKey(deletion));
-  }
-  for (const auto& entry : mutations_) {
-    size_t change_bytes = entry.second.size();
-    bytes += change_bytes;
-    absl::StrAppend(&items, "\n  - Put ", DescribeKey(entry.first), " (",
-                    change_bytes, " bytes)");
+  std::string deletes;  // accumulator for individual deletions.
+  std::string puts;     // accumulator for individual puts.
+  for (const auto& entry : writes_) {
+    if (entry.second.is_delete) {
+      absl::StrAppend(&deletes, "\n  - Delete ", DescribeKey(entry.first));
+    } else {
+      size_t change_bytes = entry.second.value.size();
+      bytes += change_bytes;
+      absl::StrAppend(&puts, "\n  - Put ", DescribeKey(entry.first), " (",
+                      change_bytes, " bytes)");
+    }
   }
+  std::string items = absl::StrCat(deletes, puts);
   absl::StrAppend(&dest, "(", bytes, " bytes):", items, ">");
   return dest;
 }
@@ -18,12 +18,13 @@
 #define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_LOCAL_LEVELDB_TRANSACTION_H_
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
 
+#include "Firestore/core/src/firebase/firestore/util/arena.h"
 #include "absl/strings/string_view.h"
 #include "leveldb/db.h"
 
@@ -39,10 +40,25 @@ namespace local {
  * LevelDBTransaction tracks pending changes to entries in leveldb, including
  * deletions. It also provides an Iterator to traverse a merged view of pending
  * changes and committed values.
+ *
+ * Pending changes are kept in a map from key to the latest change to that key.
+ * The map's nodes, keys and values all live in an Arena owned by the
+ * transaction, so recording a change does not normally allocate, and reads
+ * look keys up without copying them.
  */
 class LevelDbTransaction {
-  using Deletions = std::set<std::string>;
-  using Mutations = std::map<std::string, std::string>;
+  /** The latest pending change to a key. */
+  struct PendingWrite {
+    /** The value to write, or empty if `is_delete` is true. */
+    absl::string_view value;
+    bool is_delete;
+  };
+
+  using Writes = std::map<
+      absl::string_view,
+      PendingWrite,
+      std::less<absl::string_view>,
+      util::ArenaAllocator<std::pair<const absl::string_view, PendingWrite>>>;
 
  public:
   /**
@@ -51,8 +67,21 @@ class LevelDbTransaction {
    */
   class Iterator {
    public:
+    /**
+     * The number of entries SeekForward() steps over with Next() before giving
+     * up and seeking instead.
+     */
+    static constexpr int kMaxSequentialSkips = 8;
+
     explicit Iterator(LevelDbTransaction* txn);
 
+    /**
+     * Creates an iterator whose committed entries are limited to keys starting
+     * with `prefix` (see leveldb::ReadOptions::prefix). Pending changes are
+     * not limited, so callers must still stop once they leave the prefix.
+     */
+    Iterator(LevelDbTransaction* txn, absl::string_view prefix);
+
     /**
      * Returns true if this iterator points to an entry
      */
@@ -66,6 +95,18 @@ class LevelDbTransaction {
      */
     void Seek(const std::string& key);
 
+    /**
+     * Moves this iterator forward to the first key equal to or greater than
+     * the given key. This is equivalent to Seek(), provided that every entry
+     * the iterator has moved past since it was last positioned sorts before
+     * `key`, which is the case when walking an ascending sequence of keys.
+     *
+     * Short distances are covered by calling Next(), which avoids the full
+     * seek through the memtable and every level of the database; longer ones
+     * fall back to Seek().
+     */
+    void SeekForward(const std::string& key);
+
     /**
      * Advances the iterator to the next entry
      */
@@ -88,11 +129,16 @@ class LevelDbTransaction {
     void AdvanceLDB();
 
     /**
-     * Returns true if the given slice matches a key present in the deletions_
-     * set.
+     * Returns true if the given slice matches a key that is pending deletion
+     * in the transaction.
      */
     bool IsDeleted(leveldb::Slice slice);
 
+    /**
+     * Advances writes_iter_ past any pending deletions.
+     */
+    void SkipPendingDeletes();
+
     /**
      * Syncs with the underlying transaction. If the transaction has been
      * updated, the mutation iterator may need to be reset. Returns true if this
@@ -113,12 +159,13 @@ class LevelDbTransaction {
     int32_t last_version_;
     // The underlying transaction.
     LevelDbTransaction* txn_;
-    Mutations::iterator mutations_iter_;
+    // Points to the next pending Put at or after the current position.
+    Writes::iterator writes_iter_;
     // We save the current key and value so that once an iterator is Valid(), it
     // remains so at least until the next call to Seek() or Next(), even if the
     // underlying data is deleted.
     std::pair<std::string, std::string> current_;
-    // True if current_ represents an entry in the mutations_ map, rather than
+    // True if current_ represents an entry in the writes_ map, rather than
     // committed data.
     bool is_mutation_;
     // True if the iterator pointed to a valid entry the last time Next() or
@@ -147,7 +194,7 @@ class LevelDbTransaction {
   static const leveldb::WriteOptions& DefaultWriteOptions();
 
   size_t changed_keys() const {
-    return mutations_.size() + deletions_.size();
+    return writes_.size();
   }
 
   /**
@@ -163,9 +210,8 @@ class LevelDbTransaction {
    */
   void Put(absl::string_view key, GPBMessage* message) {
     NSData* data = [message data];
-    std::string key_string(key);
-    mutations_[key_string] = std::string((const char*)data.bytes, data.length);
-    version_++;
+    Put(key, absl::string_view{static_cast<const char*>(data.bytes),
+                               data.length});
   }
 #endif
 
@@ -173,7 +219,7 @@ class LevelDbTransaction {
    * Schedules the row identified by `key` to be set to `value` when this
    * transaction commits.
    */
-  void Put(std::string key, std::string value);
+  void Put(absl::string_view key, absl::string_view value);
 
   /**
    * Sets the contents of `value` to the latest known value for the given key,
@@ -189,6 +235,13 @@ class LevelDbTransaction {
    */
   std::unique_ptr<Iterator> NewIterator();
 
+  /**
+   * Returns a new Iterator for scanning the keys that start with `prefix`.
+   * Tables that cannot contain such keys are skipped if the database's filter
+   * policy records prefixes (see LevelDbPrefixExtractor).
+   */
+  std::unique_ptr<Iterator> NewIterator(absl::string_view prefix);
+
   /**
    * Commits the transaction. All pending changes are written. The transaction
    * should not be used after calling this method.
@@ -198,9 +251,15 @@ class LevelDbTransaction {
   std::string ToString();
 
  private:
+  /**
+   * Records `write` as the latest pending change to `key`.
+   */
+  void Record(absl::string_view key, PendingWrite write);
+
   leveldb::DB* db_;
-  Mutations mutations_;
-  Deletions deletions_;
+  // Declared before writes_, which allocates from it.
+  util::Arena arena_;
+  Writes writes_;
   leveldb::ReadOptions read_options_;
   leveldb::WriteOptions write_options_;
   int32_t version_;
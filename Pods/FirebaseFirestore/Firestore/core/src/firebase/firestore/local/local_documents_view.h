@@ -27,6 +27,7 @@
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -80,6 +81,18 @@ class LocalDocumentsView {
   /** Performs a query against the local view of all documents. */
   model::DocumentMap GetDocumentsMatchingQuery(FSTQuery* query);
 
+  /**
+   * Performs a query against the local view of all documents, considering
+   * only remote documents that were read after `since_read_time`. Documents
+   * with local mutations are always considered.
+   *
+   * @param query The query to match documents against.
+   * @param since_read_time If not SnapshotVersion::None(), return only
+   * documents that have been read since this snapshot version (exclusive).
+   */
+  model::DocumentMap GetDocumentsMatchingQuery(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time);
+
  private:
   /** Internal version of GetDocument that allows re-using batches. */
   FSTMaybeDocument* _Nullable GetDocument(
@@ -98,10 +111,23 @@ class LocalDocumentsView {
   model::DocumentMap GetDocumentsMatchingDocumentQuery(
       const model::ResourcePath& doc_path);
 
-  model::DocumentMap GetDocumentsMatchingCollectionGroupQuery(FSTQuery* query);
+  model::DocumentMap GetDocumentsMatchingCollectionGroupQuery(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time);
 
   /** Queries the remote documents and overlays mutations. */
-  model::DocumentMap GetDocumentsMatchingCollectionQuery(FSTQuery* query);
+  model::DocumentMap GetDocumentsMatchingCollectionQuery(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time);
+
+  /**
+   * Adds the remote documents that the patch mutations in `batches` apply to
+   * to `existing_docs`, for those that are not in it yet. Patch mutations
+   * only produce a document when applied to one, so if `existing_docs` was
+   * restricted to recently read documents the base documents would otherwise
+   * be missing.
+   */
+  model::DocumentMap AddMissingBaseDocuments(
+      const std::vector<FSTMutationBatch*>& batches,
+      model::DocumentMap existing_docs);
 
   RemoteDocumentCache* remote_document_cache_;
   MutationQueue* mutation_queue_;
@@ -17,6 +17,7 @@
 #import "Firestore/core/src/firebase/firestore/local/local_documents_view.h"
 
 #include <string>
+#include <utility>
 
 #import "Firestore/Source/Core/FSTQuery.h"
 #import "Firestore/Source/Model/FSTDocument.h"
@@ -91,10 +92,9 @@ MaybeDocumentMap LocalDocumentsView::GetLocalViewOfDocuments(
     const MaybeDocumentMap& base_docs) {
   MaybeDocumentMap results;
 
-  DocumentKeySet all_keys;
-  for (const auto& kv : base_docs) {
-    all_keys = all_keys.insert(kv.first);
-  }
+  auto base_keys = base_docs.keys();
+  DocumentKeySet all_keys =
+      DocumentKeySet::FromSorted(base_keys.begin(), base_keys.end());
   std::vector<FSTMutationBatch*> batches =
       mutation_queue_->AllMutationBatchesAffectingDocumentKeys(all_keys);
 
@@ -117,12 +117,17 @@ MaybeDocumentMap LocalDocumentsView::GetLocalViewOfDocuments(
 }
 
 DocumentMap LocalDocumentsView::GetDocumentsMatchingQuery(FSTQuery* query) {
+  return GetDocumentsMatchingQuery(query, SnapshotVersion::None());
+}
+
+DocumentMap LocalDocumentsView::GetDocumentsMatchingQuery(
+    FSTQuery* query, const SnapshotVersion& since_read_time) {
   if ([query isDocumentQuery]) {
     return GetDocumentsMatchingDocumentQuery(query.path);
   } else if ([query isCollectionGroupQuery]) {
-    return GetDocumentsMatchingCollectionGroupQuery(query);
+    return GetDocumentsMatchingCollectionGroupQuery(query, since_read_time);
   } else {
-    return GetDocumentsMatchingCollectionQuery(query);
+    return GetDocumentsMatchingCollectionQuery(query, since_read_time);
   }
 }
 
@@ -138,7 +143,7 @@ DocumentMap LocalDocumentsView::GetDocumentsMatchingDocumentQuery(
 }
 
 model::DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionGroupQuery(
-    FSTQuery* query) {
+    FSTQuery* query, const SnapshotVersion& since_read_time) {
   HARD_ASSERT(
       query.path.empty(),
       "Currently we only support collection group queries at the root.");
@@ -154,7 +159,7 @@ model::DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionGroupQuery(
     FSTQuery* collection_query =
         [query collectionQueryAtPath:parent.Append(collection_id)];
     DocumentMap collection_results =
-        GetDocumentsMatchingCollectionQuery(collection_query);
+        GetDocumentsMatchingCollectionQuery(collection_query, since_read_time);
     for (const auto& kv : collection_results.underlying_map()) {
       const DocumentKey& key = kv.first;
       FSTDocument* doc = static_cast<FSTDocument*>(kv.second);
@@ -165,12 +170,17 @@ model::DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionGroupQuery(
 }
 
 DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionQuery(
-    FSTQuery* query) {
-  DocumentMap results = remote_document_cache_->GetMatching(query);
+    FSTQuery* query, const SnapshotVersion& since_read_time) {
+  DocumentMap results =
+      remote_document_cache_->GetMatching(query, since_read_time);
   // Get locally persisted mutation batches.
   std::vector<FSTMutationBatch*> matchingBatches =
       mutation_queue_->AllMutationBatchesAffectingQuery(query);
 
+  if (since_read_time != SnapshotVersion::None()) {
+    results = AddMissingBaseDocuments(matchingBatches, std::move(results));
+  }
+
   for (FSTMutationBatch* batch : matchingBatches) {
     for (FSTMutation* mutation : [batch mutations]) {
       // Only process documents belonging to the collection.
@@ -215,6 +225,31 @@ DocumentMap LocalDocumentsView::GetDocumentsMatchingCollectionQuery(
   return results;
 }
 
+DocumentMap LocalDocumentsView::AddMissingBaseDocuments(
+    const std::vector<FSTMutationBatch*>& batches, DocumentMap existing_docs) {
+  DocumentKeySet missing_doc_keys;
+  for (FSTMutationBatch* batch : batches) {
+    for (FSTMutation* mutation : [batch mutations]) {
+      const DocumentKey& key = mutation.key;
+      if ([mutation isKindOfClass:[FSTPatchMutation class]] &&
+          existing_docs.underlying_map().find(key) ==
+              existing_docs.underlying_map().end()) {
+        missing_doc_keys = missing_doc_keys.insert(key);
+      }
+    }
+  }
+
+  DocumentMap merged_docs = std::move(existing_docs);
+  for (const auto& kv : remote_document_cache_->GetAll(missing_doc_keys)) {
+    FSTMaybeDocument* doc = kv.second;
+    if ([doc isKindOfClass:[FSTDocument class]]) {
+      merged_docs =
+          merged_docs.insert(kv.first, static_cast<FSTDocument*>(doc));
+    }
+  }
+  return merged_docs;
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -21,12 +21,14 @@
 #error "For now, this file must only be included by ObjC source files."
 #endif  // !defined(__OBJC__)
 
+#include <unordered_map>
 #include <vector>
 
 #include "Firestore/core/src/firebase/firestore/local/remote_document_cache.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
 #include "Firestore/core/src/firebase/firestore/model/types.h"
 
 @class FSTLocalSerializer;
@@ -45,12 +47,14 @@ class MemoryRemoteDocumentCache : public RemoteDocumentCache {
  public:
   explicit MemoryRemoteDocumentCache(FSTMemoryPersistence* persistence);
 
-  void Add(FSTMaybeDocument* document) override;
+  void Add(FSTMaybeDocument* document,
+           const model::SnapshotVersion& read_time) override;
   void Remove(const model::DocumentKey& key) override;
 
   FSTMaybeDocument* _Nullable Get(const model::DocumentKey& key) override;
   model::MaybeDocumentMap GetAll(const model::DocumentKeySet& keys) override;
-  model::DocumentMap GetMatching(FSTQuery* query) override;
+  model::DocumentMap GetMatching(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time) override;
 
   std::vector<model::DocumentKey> RemoveOrphanedDocuments(
       FSTMemoryLRUReferenceDelegate* reference_delegate,
@@ -62,6 +66,12 @@ class MemoryRemoteDocumentCache : public RemoteDocumentCache {
   /** Underlying cache of documents. */
   model::MaybeDocumentMap docs_;
 
+  /** The read time of each document in docs_. */
+  std::unordered_map<model::DocumentKey,
+                     model::SnapshotVersion,
+                     model::DocumentKeyHash>
+      read_times_;
+
   // This instance is owned by FSTMemoryPersistence; avoid a retain cycle.
   __weak FSTMemoryPersistence* persistence_;
 };
@@ -28,6 +28,7 @@ using firebase::firestore::model::DocumentKeySet;
 using firebase::firestore::model::DocumentMap;
 using firebase::firestore::model::ListenSequenceNumber;
 using firebase::firestore::model::MaybeDocumentMap;
+using firebase::firestore::model::SnapshotVersion;
 
 namespace firebase {
 namespace firestore {
@@ -53,8 +54,10 @@ MemoryRemoteDocumentCache::MemoryRemoteDocumentCache(
   persistence_ = persistence;
 }
 
-void MemoryRemoteDocumentCache::Add(FSTMaybeDocument* document) {
+void MemoryRemoteDocumentCache::Add(FSTMaybeDocument* document,
+                                    const SnapshotVersion& read_time) {
   docs_ = docs_.insert(document.key, document);
+  read_times_[document.key] = read_time;
 
   persistence_.indexManager->AddToCollectionParentIndex(
       document.key.path().PopLast());
@@ -62,6 +65,7 @@ void MemoryRemoteDocumentCache::Add(FSTMaybeDocument* document) {
 
 void MemoryRemoteDocumentCache::Remove(const DocumentKey& key) {
   docs_ = docs_.erase(key);
+  read_times_.erase(key);
 }
 
 FSTMaybeDocument* _Nullable MemoryRemoteDocumentCache::Get(
@@ -81,7 +85,8 @@ MaybeDocumentMap MemoryRemoteDocumentCache::GetAll(const DocumentKeySet& keys) {
   return results;
 }
 
-DocumentMap MemoryRemoteDocumentCache::GetMatching(FSTQuery* query) {
+DocumentMap MemoryRemoteDocumentCache::GetMatching(
+    FSTQuery* query, const SnapshotVersion& since_read_time) {
   HARD_ASSERT(
       ![query isCollectionGroupQuery],
       "CollectionGroup queries should be handled in LocalDocumentsView");
@@ -100,6 +105,13 @@ DocumentMap MemoryRemoteDocumentCache::GetMatching(FSTQuery* query) {
     if (![maybeDoc isKindOfClass:[FSTDocument class]]) {
       continue;
     }
+    if (since_read_time != SnapshotVersion::None()) {
+      auto read_time = read_times_.find(key);
+      if (read_time == read_times_.end() ||
+          read_time->second <= since_read_time) {
+        continue;
+      }
+    }
     FSTDocument* doc = static_cast<FSTDocument*>(maybeDoc);
     if ([query matchesDocument:doc]) {
       results = results.insert(key, doc);
@@ -118,6 +130,7 @@ std::vector<DocumentKey> MemoryRemoteDocumentCache::RemoveOrphanedDocuments(
     if (![reference_delegate isPinnedAtSequenceNumber:upper_bound
                                              document:key]) {
       updated_docs = updated_docs.erase(key);
+      read_times_.erase(key);
       removed.push_back(key);
     }
   }
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_LOCAL_QUERY_ENGINE_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_LOCAL_QUERY_ENGINE_H_
+
+#if !defined(__OBJC__)
+#error "For now, this file must only be included by ObjC source files."
+#endif  // !defined(__OBJC__)
+
+#import <Foundation/Foundation.h>
+
+#include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
+#include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/document_set.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
+
+@class FSTQuery;
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+class LocalDocumentsView;
+
+/**
+ * Executes queries against the local view of all documents.
+ *
+ * A query that was previously in sync with the backend does not need a full
+ * collection scan: the documents that matched it as of the last snapshot
+ * without limbo documents are known (they are the target's remote keys), and
+ * all that can have changed since are documents read from the backend after
+ * that snapshot and documents with local mutations. QueryEngine looks up the
+ * former by key and the latter through the remote document cache's read time
+ * index, so re-executing a listen after a remote event costs roughly the size
+ * of the change rather than the size of the collection.
+ *
+ * Queries without such a snapshot, queries that match every document of the
+ * collection anyway, and limit queries whose previous results can no longer
+ * be trusted to contain the top documents fall back to a full scan.
+ */
+class QueryEngine {
+ public:
+  explicit QueryEngine(LocalDocumentsView* local_documents_view)
+      : local_documents_view_{local_documents_view} {
+  }
+
+  /**
+   * Returns all local documents matching the specified query.
+   *
+   * @param query The query to execute.
+   * @param last_limbo_free_snapshot_version The last snapshot version at
+   * which the query's view had no limbo documents, or
+   * SnapshotVersion::None() to force a full scan.
+   * @param remote_keys The keys of the documents that the backend reported
+   * as matching the query's target.
+   */
+  model::DocumentMap GetDocumentsMatchingQuery(
+      FSTQuery* query,
+      const model::SnapshotVersion& last_limbo_free_snapshot_version,
+      const model::DocumentKeySet& remote_keys);
+
+ private:
+  /**
+   * Returns the documents in `documents` that match `query`, sorted by the
+   * query's comparator.
+   */
+  model::DocumentSet ApplyQuery(FSTQuery* query,
+                                const model::MaybeDocumentMap& documents);
+
+  /**
+   * Determines if a limit query needs to be refilled from cache, making it
+   * ineligible for key-based execution.
+   *
+   * @param sorted_previous_results The documents that matched the query when
+   * it was last synchronized, sorted by the query's comparator.
+   * @param remote_keys The document keys that matched the query at the last
+   * snapshot.
+   * @param limbo_free_snapshot_version The version of the snapshot when the
+   * query was last synchronized.
+   */
+  bool NeedsRefill(const model::DocumentSet& sorted_previous_results,
+                   const model::DocumentKeySet& remote_keys,
+                   const model::SnapshotVersion& limbo_free_snapshot_version);
+
+  model::DocumentMap ExecuteFullCollectionScan(FSTQuery* query);
+
+  LocalDocumentsView* local_documents_view_;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+NS_ASSUME_NONNULL_END
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_LOCAL_QUERY_ENGINE_H_
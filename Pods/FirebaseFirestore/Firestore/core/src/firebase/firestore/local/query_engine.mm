@@ -0,0 +1,140 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/firebase/firestore/local/query_engine.h"
+
+#import "Firestore/Source/Core/FSTQuery.h"
+#import "Firestore/Source/Model/FSTDocument.h"
+
+#include "Firestore/core/src/firebase/firestore/local/local_documents_view.h"
+#include "Firestore/core/src/firebase/firestore/model/field_path.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using model::DocumentKeySet;
+using model::DocumentMap;
+using model::DocumentSet;
+using model::MaybeDocumentMap;
+using model::SnapshotVersion;
+
+namespace {
+
+/**
+ * Returns true if every document in the query's collection matches the query,
+ * in which case looking up documents one by one is slower than a scan.
+ */
+bool MatchesAllDocuments(FSTQuery* query) {
+  if (query.filters.count > 0 || query.limit != NSNotFound || query.startAt ||
+      query.endAt) {
+    return false;
+  }
+
+  // Ordering by a field excludes documents that don't have it.
+  NSArray<FSTSortOrder*>* sort_orders = query.explicitSortOrders;
+  return sort_orders.count == 0 ||
+         (sort_orders.count == 1 && sort_orders[0].field.IsKeyFieldPath());
+}
+
+}  // namespace
+
+DocumentMap QueryEngine::GetDocumentsMatchingQuery(
+    FSTQuery* query,
+    const SnapshotVersion& last_limbo_free_snapshot_version,
+    const DocumentKeySet& remote_keys) {
+  if (MatchesAllDocuments(query) ||
+      last_limbo_free_snapshot_version == SnapshotVersion::None()) {
+    return ExecuteFullCollectionScan(query);
+  }
+
+  MaybeDocumentMap documents = local_documents_view_->GetDocuments(remote_keys);
+  DocumentSet previous_results = ApplyQuery(query, documents);
+
+  if (query.limit != NSNotFound &&
+      NeedsRefill(previous_results, remote_keys,
+                  last_limbo_free_snapshot_version)) {
+    return ExecuteFullCollectionScan(query);
+  }
+
+  // Retrieve all results for documents that were updated since the last
+  // limbo-document free remote snapshot.
+  DocumentMap updated_results =
+      local_documents_view_->GetDocumentsMatchingQuery(
+          query, last_limbo_free_snapshot_version);
+
+  // Both sets were read from the same local view, so a document contained in
+  // both has the same contents in each.
+  for (FSTDocument* doc : previous_results) {
+    updated_results = updated_results.insert(doc.key, doc);
+  }
+  return updated_results;
+}
+
+DocumentSet QueryEngine::ApplyQuery(FSTQuery* query,
+                                    const MaybeDocumentMap& documents) {
+  // Sort the documents and re-apply the query filter since previously
+  // matching documents do not necessarily still match the query.
+  DocumentSet query_results{query.comparator};
+  for (const auto& kv : documents) {
+    FSTMaybeDocument* maybe_doc = kv.second;
+    if ([maybe_doc isKindOfClass:[FSTDocument class]]) {
+      FSTDocument* doc = static_cast<FSTDocument*>(maybe_doc);
+      if ([query matchesDocument:doc]) {
+        query_results = query_results.insert(doc);
+      }
+    }
+  }
+  return query_results;
+}
+
+bool QueryEngine::NeedsRefill(
+    const DocumentSet& sorted_previous_results,
+    const DocumentKeySet& remote_keys,
+    const SnapshotVersion& limbo_free_snapshot_version) {
+  // The query needs to be refilled if a previously matching document no longer
+  // matches.
+  if (remote_keys.size() != sorted_previous_results.size()) {
+    return true;
+  }
+
+  // We don't need to find a better match from cache if no documents matched.
+  if (sorted_previous_results.empty()) {
+    return false;
+  }
+
+  // A document from cache that was outside the limit can only sort before the
+  // last document of the limit if that document now sorts lower than it did
+  // when the query was last synchronized. This may have happened if it has a
+  // pending write or was updated after that snapshot.
+  FSTDocument* last_document_in_limit =
+      sorted_previous_results.GetLastDocument();
+  return last_document_in_limit.hasPendingWrites ||
+         last_document_in_limit.version > limbo_free_snapshot_version;
+}
+
+DocumentMap QueryEngine::ExecuteFullCollectionScan(FSTQuery* query) {
+  return local_documents_view_->GetDocumentsMatchingQuery(query);
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+NS_ASSUME_NONNULL_END
@@ -26,6 +26,7 @@
 #include "Firestore/core/src/firebase/firestore/model/document_key.h"
 #include "Firestore/core/src/firebase/firestore/model/document_key_set.h"
 #include "Firestore/core/src/firebase/firestore/model/document_map.h"
+#include "Firestore/core/src/firebase/firestore/model/snapshot_version.h"
 #include "Firestore/core/src/firebase/firestore/model/types.h"
 
 @class FSTMaybeDocument;
@@ -57,8 +58,12 @@ class RemoteDocumentCache {
    * entry for the key, it will be replaced.
    *
    * @param document A FSTDocument or FSTDeletedDocument to put in the cache.
+   * @param read_time The snapshot version at which the document was read
+   * from the backend, i.e. the version of the remote event or of the
+   * acknowledged write that delivered it.
    */
-  virtual void Add(FSTMaybeDocument* document) = 0;
+  virtual void Add(FSTMaybeDocument* document,
+                   const model::SnapshotVersion& read_time) = 0;
 
   /** Removes the cached entry for the given key (no-op if no entry exists). */
   virtual void Remove(const model::DocumentKey& key) = 0;
@@ -90,9 +95,12 @@ class RemoteDocumentCache {
    * Cached FSTDeletedDocument entries have no bearing on query results.
    *
    * @param query The query to match documents against.
+   * @param since_read_time If not SnapshotVersion::None(), only documents
+   * that were read after this snapshot version are returned.
    * @return The set of matching documents.
    */
-  virtual model::DocumentMap GetMatching(FSTQuery* query) = 0;
+  virtual model::DocumentMap GetMatching(
+      FSTQuery* query, const model::SnapshotVersion& since_read_time) = 0;
 };
 
 }  // namespace local
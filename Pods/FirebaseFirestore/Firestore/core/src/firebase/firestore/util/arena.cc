@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/util/arena.h"
+
+#include <cstring>
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+constexpr size_t Arena::kBlockSize;
+
+absl::string_view Arena::Copy(absl::string_view data) {
+  if (data.empty()) {
+    return absl::string_view{};
+  }
+  char* result = Allocate(data.size(), 1);
+  std::memcpy(result, data.data(), data.size());
+  return absl::string_view{result, data.size()};
+}
+
+char* Arena::AllocateFallback(size_t bytes) {
+  // new[] returns memory aligned for any fundamental type, so the start of a
+  // block never needs padding.
+  if (bytes > kBlockSize / 4) {
+    // Give large objects a block of their own to avoid wasting the remainder
+    // of the current block.
+    return AllocateNewBlock(bytes);
+  }
+
+  // Waste the remainder of the current block.
+  alloc_ptr_ = AllocateNewBlock(kBlockSize);
+  alloc_bytes_remaining_ = kBlockSize;
+
+  char* result = alloc_ptr_;
+  alloc_ptr_ += bytes;
+  alloc_bytes_remaining_ -= bytes;
+  return result;
+}
+
+char* Arena::AllocateNewBlock(size_t block_bytes) {
+  blocks_.emplace_back(new char[block_bytes]);
+  allocated_bytes_ += block_bytes;
+  return blocks_.back().get();
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
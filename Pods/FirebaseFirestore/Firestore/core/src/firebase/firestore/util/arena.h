@@ -0,0 +1,136 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_ARENA_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * A bump allocator for short-lived objects. Memory is carved out of large
+ * blocks and is only released, all at once, when the Arena is destroyed, so
+ * many small allocations cost a handful of calls to the system allocator.
+ *
+ * Arena is not thread-safe.
+ */
+class Arena {
+ public:
+  Arena() = default;
+
+  Arena(const Arena& other) = delete;
+  Arena& operator=(const Arena& other) = delete;
+
+  /**
+   * Returns a pointer to `bytes` bytes of memory aligned to `alignment`, which
+   * must be a power of two no greater than alignof(std::max_align_t). The
+   * memory stays valid for the lifetime of the Arena.
+   */
+  char* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    size_t misalignment =
+        reinterpret_cast<uintptr_t>(alloc_ptr_) & (alignment - 1);
+    size_t padding = misalignment == 0 ? 0 : alignment - misalignment;
+    if (alloc_ptr_ && bytes + padding <= alloc_bytes_remaining_) {
+      char* result = alloc_ptr_ + padding;
+      alloc_ptr_ += bytes + padding;
+      alloc_bytes_remaining_ -= bytes + padding;
+      return result;
+    }
+    return AllocateFallback(bytes);
+  }
+
+  /**
+   * Copies the contents of `data` into the Arena and returns a view of the
+   * copy.
+   */
+  absl::string_view Copy(absl::string_view data);
+
+  /**
+   * Returns the total number of bytes obtained from the system allocator.
+   */
+  size_t allocated_bytes() const {
+    return allocated_bytes_;
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 8192;
+
+  char* AllocateFallback(size_t bytes);
+  char* AllocateNewBlock(size_t block_bytes);
+
+  char* alloc_ptr_ = nullptr;
+  size_t alloc_bytes_remaining_ = 0;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t allocated_bytes_ = 0;
+};
+
+/**
+ * A standard allocator that obtains memory from an Arena, so that containers
+ * can place their nodes in it. `deallocate` does nothing: the memory is
+ * reclaimed when the Arena is destroyed, which must happen after the
+ * container using it has been destroyed.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT(runtime/explicit)
+      : arena_(other.arena()) {
+  }
+
+  T* allocate(size_t n) {
+    return reinterpret_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) {
+  }
+
+  Arena* arena() const {
+    return arena_;
+  }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() != rhs.arena();
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_ARENA_H_
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/firebase/firestore/util/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+namespace {
+
+// Splitting the range of `ParallelFor` into a few chunks per thread keeps the
+// threads busy when some chunks take longer than others.
+constexpr size_t kChunksPerThread = 4;
+
+}  // namespace
+
+ThreadPool::ThreadPool(const size_t thread_count) {
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerThread, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    shutting_down_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Execute(Operation&& operation) {
+  if (workers_.empty()) {
+    operation();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    operations_.push_back(std::move(operation));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPool::WorkerThread() {
+  while (true) {
+    Operation operation;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      cv_.wait(lock,
+               [this] { return shutting_down_ || !operations_.empty(); });
+      if (operations_.empty()) {
+        // Shutting down, and everything scheduled has run.
+        return;
+      }
+      operation = std::move(operations_.front());
+      operations_.pop_front();
+    }
+    operation();
+  }
+}
+
+void ThreadPool::ParallelFor(const size_t count,
+                             const std::function<void(size_t)>& operation) {
+  if (count == 0) {
+    return;
+  }
+
+  const size_t chunks =
+      std::min(count, (workers_.size() + 1) * kChunksPerThread);
+
+  struct State {
+    std::atomic<size_t> next_chunk{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t finished_chunks = 0;
+  };
+  auto state = std::make_shared<State>();
+
+  // A helper may only start once every chunk has been claimed and this call
+  // has returned, in which case it doesn't touch `operation`.
+  auto run_chunks = [state, chunks, count, &operation] {
+    size_t chunk;
+    while ((chunk = state->next_chunk++) < chunks) {
+      size_t end = count * (chunk + 1) / chunks;
+      for (size_t i = count * chunk / chunks; i < end; ++i) {
+        operation(i);
+      }
+
+      std::lock_guard<std::mutex> lock{state->mutex};
+      if (++state->finished_chunks == chunks) {
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  size_t helpers = std::min(workers_.size(), chunks - 1);
+  for (size_t i = 0; i < helpers; ++i) {
+    Execute(run_chunks);
+  }
+  run_chunks();
+
+  std::unique_lock<std::mutex> lock{state->mutex};
+  state->cv.wait(lock, [&] { return state->finished_chunks == chunks; });
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2019 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_THREAD_POOL_H_
+#define FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/src/firebase/firestore/util/async_queue.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+// A fixed set of worker threads that run operations concurrently and in no
+// particular order, using C++11 standard library functionality.
+//
+// `ThreadPool` is a companion to the serial `ExecutorStd` behind the
+// `AsyncQueue`: CPU-bound work that doesn't depend on the queue's ordering,
+// such as decoding a batch of documents, can be split across the pool while
+// everything that touches shared state stays on the queue. Use `ExecuteThen`
+// to hand the result of such work back to the queue.
+class ThreadPool {
+ public:
+  using Operation = std::function<void()>;
+
+  // Starts `thread_count` worker threads. With no workers, `Execute` runs
+  // operations on the calling thread.
+  explicit ThreadPool(size_t thread_count);
+
+  // Runs the operations that are already scheduled, then stops the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+
+  size_t thread_count() const {
+    return workers_.size();
+  }
+
+  // Schedules the `operation` to be run on one of the workers.
+  void Execute(Operation&& operation);
+
+  // Runs `operation` on one of the workers, then enqueues `callback` with its
+  // result on `queue`.
+  //
+  // This may be called from an operation on `queue`: with no workers,
+  // `operation` runs on the calling thread, so `callback` is enqueued without
+  // the checks of `AsyncQueue::Enqueue`, which fail when called on the queue.
+  template <typename T>
+  void ExecuteThen(std::function<T()> operation,
+                   AsyncQueue* queue,
+                   std::function<void(T)> callback) {
+    Execute([operation, queue, callback] {
+      // `AsyncQueue` operations must be copyable, so share the result rather
+      // than requiring `T` to be.
+      auto result = std::make_shared<T>(operation());
+      queue->EnqueueRelaxed(
+          [callback, result] { callback(std::move(*result)); });
+    });
+  }
+
+  // Calls `operation(i)` for each `i` in [0, count) and returns once all the
+  // calls have returned. The range is split into contiguous chunks that the
+  // workers and the calling thread share, so this may be called from a worker
+  // without risk of deadlock.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& operation);
+
+ private:
+  void WorkerThread();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Operation> operations_;
+  bool shutting_down_ = false;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_FIREBASE_FIRESTORE_UTIL_THREAD_POOL_H_
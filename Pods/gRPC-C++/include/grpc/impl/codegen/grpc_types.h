@@ -310,6 +310,29 @@ typedef struct {
   "grpc.experimental.tcp_min_read_chunk_size"
 #define GRPC_ARG_TCP_MAX_READ_CHUNK_SIZE \
   "grpc.experimental.tcp_max_read_chunk_size"
+/** Channel arg (bool) enabling sending large writes with MSG_ZEROCOPY on
+   Linux, where the kernel transmits from the slices instead of copying them.
+   Defaults to false. **/
+#define GRPC_ARG_TCP_TX_ZEROCOPY_ENABLED \
+  "grpc.experimental.tcp_tx_zerocopy_enabled"
+/** Channel arg (integer) setting the smallest write, in bytes, to send with
+   MSG_ZEROCOPY when GRPC_ARG_TCP_TX_ZEROCOPY_ENABLED is set. Smaller writes
+   are copied, which is cheaper than pinning their pages. **/
+#define GRPC_ARG_TCP_TX_ZEROCOPY_SEND_BYTES_THRESHOLD \
+  "grpc.experimental.tcp_tx_zerocopy_send_bytes_threshold"
+/** Note this is not a "channel arg" key. This is the default threshold to use
+ * if the GRPC_ARG_TCP_TX_ZEROCOPY_SEND_BYTES_THRESHOLD channel arg is
+ * unspecified. */
+#define GRPC_TCP_DEFAULT_TX_ZEROCOPY_SEND_BYTES_THRESHOLD (16 * 1024)
+/** Channel arg (integer) setting how many writes sent with MSG_ZEROCOPY may
+   wait for the kernel to release their slices at once. Writes beyond that are
+   copied. **/
+#define GRPC_ARG_TCP_TX_ZEROCOPY_MAX_SIMULT_SENDS \
+  "grpc.experimental.tcp_tx_zerocopy_max_simultaneous_sends"
+/** Note this is not a "channel arg" key. This is the default number of writes
+ * to use if the GRPC_ARG_TCP_TX_ZEROCOPY_MAX_SIMULT_SENDS channel arg is
+ * unspecified. */
+#define GRPC_TCP_DEFAULT_TX_ZEROCOPY_MAX_SIMULT_SENDS 4
 /* Timeout in milliseconds to use for calls to the grpclb load balancer.
    If 0 or unset, the balancer calls will have no deadline. */
 #define GRPC_ARG_GRPCLB_CALL_TIMEOUT_MS "grpc.grpclb_call_timeout_ms"
@@ -92,70 +92,95 @@ grpc_slice grpc_chttp2_base64_encode(const grpc_slice& input) {
   return output;
 }
 
-grpc_slice grpc_chttp2_huffman_compress(const grpc_slice& input) {
-  size_t nbits;
-  const uint8_t* in;
+typedef struct {
+  uint64_t temp;
+  uint32_t temp_length;
   uint8_t* out;
-  grpc_slice output;
-  uint32_t temp = 0;
-  uint32_t temp_length = 0;
-
-  nbits = 0;
-  for (in = GRPC_SLICE_START_PTR(input); in != GRPC_SLICE_END_PTR(input);
-       ++in) {
-    nbits += grpc_chttp2_huffsyms[*in].length;
+} huff_out;
+
+static void enc_flush_some(huff_out* out) {
+  while (out->temp_length > 8) {
+    out->temp_length -= 8;
+    *out->out++ = static_cast<uint8_t>(out->temp >> out->temp_length);
   }
+}
 
-  output = GRPC_SLICE_MALLOC(nbits / 8 + (nbits % 8 != 0));
-  out = GRPC_SLICE_START_PTR(output);
-  for (in = GRPC_SLICE_START_PTR(input); in != GRPC_SLICE_END_PTR(input);
-       ++in) {
-    int sym = *in;
-    temp <<= grpc_chttp2_huffsyms[sym].length;
-    temp |= grpc_chttp2_huffsyms[sym].bits;
-    temp_length += grpc_chttp2_huffsyms[sym].length;
-
-    while (temp_length > 8) {
-      temp_length -= 8;
-      *out++ = static_cast<uint8_t>(temp >> temp_length);
-    }
+/* Store 32 bits once that many are pending, leaving fewer than 32 so that
+   another 32 always fit in temp. */
+static void enc_flush_word(huff_out* out) {
+  if (out->temp_length >= 32) {
+    out->temp_length -= 32;
+    uint32_t word = static_cast<uint32_t>(out->temp >> out->temp_length);
+    uint8_t* p = out->out;
+    p[0] = static_cast<uint8_t>(word >> 24);
+    p[1] = static_cast<uint8_t>(word >> 16);
+    p[2] = static_cast<uint8_t>(word >> 8);
+    p[3] = static_cast<uint8_t>(word);
+    out->out = p + 4;
   }
+}
 
-  if (temp_length) {
+/* write out the remaining bits, padded with ones to a byte boundary */
+static void enc_finish(huff_out* out) {
+  enc_flush_some(out);
+  if (out->temp_length) {
     /* NB: the following integer arithmetic operation needs to be in its
      * expanded form due to the "integral promotion" performed (see section
      * 3.2.1.1 of the C89 draft standard). A cast to the smaller container type
      * is then required to avoid the compiler warning */
-    *out++ =
-        static_cast<uint8_t>(static_cast<uint8_t>(temp << (8u - temp_length)) |
-                             static_cast<uint8_t>(0xffu >> temp_length));
+    *out->out++ = static_cast<uint8_t>(
+        static_cast<uint8_t>(out->temp << (8u - out->temp_length)) |
+        static_cast<uint8_t>(0xffu >> out->temp_length));
   }
-
-  GPR_ASSERT(out == GRPC_SLICE_END_PTR(output));
-
-  return output;
 }
 
-typedef struct {
-  uint32_t temp;
-  uint32_t temp_length;
-  uint8_t* out;
-} huff_out;
+grpc_slice grpc_chttp2_huffman_compress(const grpc_slice& input) {
+  const uint8_t* in = GRPC_SLICE_START_PTR(input);
+  const uint8_t* in_end = GRPC_SLICE_END_PTR(input);
+  size_t nbits = 0;
+  for (const uint8_t* p = in; p != in_end; ++p) {
+    nbits += grpc_chttp2_huffsyms[*p].length;
+  }
 
-static void enc_flush_some(huff_out* out) {
-  while (out->temp_length > 8) {
-    out->temp_length -= 8;
-    *out->out++ = static_cast<uint8_t>(out->temp >> out->temp_length);
+  grpc_slice output = GRPC_SLICE_MALLOC(nbits / 8 + (nbits % 8 != 0));
+  huff_out out;
+  out.temp = 0;
+  out.temp_length = 0;
+  out.out = GRPC_SLICE_START_PTR(output);
+
+  if (g_hpack_huffman_tables_enabled) {
+    for (; in != in_end; ++in) {
+      const grpc_chttp2_huffsym& sym = grpc_chttp2_huffsyms[*in];
+      out.temp = (out.temp << sym.length) | sym.bits;
+      out.temp_length += sym.length;
+      enc_flush_word(&out);
+    }
+  } else {
+    for (; in != in_end; ++in) {
+      const grpc_chttp2_huffsym& sym = grpc_chttp2_huffsyms[*in];
+      out.temp = (out.temp << sym.length) | sym.bits;
+      out.temp_length += sym.length;
+      enc_flush_some(&out);
+    }
   }
+  enc_finish(&out);
+
+  GPR_ASSERT(out.out == GRPC_SLICE_END_PTR(output));
+
+  return output;
 }
 
-static void enc_add2(huff_out* out, uint8_t a, uint8_t b) {
+static void enc_push2(huff_out* out, uint8_t a, uint8_t b) {
   b64_huff_sym sa = huff_alphabet[a];
   b64_huff_sym sb = huff_alphabet[b];
   out->temp = (out->temp << (sa.length + sb.length)) |
-              (static_cast<uint32_t>(sa.bits) << sb.length) | sb.bits;
+              (static_cast<uint64_t>(sa.bits) << sb.length) | sb.bits;
   out->temp_length +=
       static_cast<uint32_t>(sa.length) + static_cast<uint32_t>(sb.length);
+}
+
+static void enc_add2(huff_out* out, uint8_t a, uint8_t b) {
+  enc_push2(out, a, b);
   enc_flush_some(out);
 }
 
@@ -185,15 +210,30 @@ grpc_slice grpc_chttp2_base64_encode_and_huffman_compress(
   out.out = start_out;
 
   /* encode full triplets */
-  for (i = 0; i < input_triplets; i++) {
-    const uint8_t low_to_high = static_cast<uint8_t>((in[0] & 0x3) << 4);
-    const uint8_t high_to_low = in[1] >> 4;
-    enc_add2(&out, in[0] >> 2, low_to_high | high_to_low);
+  if (g_hpack_huffman_tables_enabled) {
+    for (i = 0; i < input_triplets; i++) {
+      const uint8_t low_to_high = static_cast<uint8_t>((in[0] & 0x3) << 4);
+      const uint8_t high_to_low = in[1] >> 4;
+      enc_push2(&out, in[0] >> 2, low_to_high | high_to_low);
+      enc_flush_word(&out);
 
-    const uint8_t a = static_cast<uint8_t>((in[1] & 0xf) << 2);
-    const uint8_t b = (in[2] >> 6);
-    enc_add2(&out, a | b, in[2] & 0x3f);
-    in += 3;
+      const uint8_t a = static_cast<uint8_t>((in[1] & 0xf) << 2);
+      const uint8_t b = (in[2] >> 6);
+      enc_push2(&out, a | b, in[2] & 0x3f);
+      enc_flush_word(&out);
+      in += 3;
+    }
+  } else {
+    for (i = 0; i < input_triplets; i++) {
+      const uint8_t low_to_high = static_cast<uint8_t>((in[0] & 0x3) << 4);
+      const uint8_t high_to_low = in[1] >> 4;
+      enc_add2(&out, in[0] >> 2, low_to_high | high_to_low);
+
+      const uint8_t a = static_cast<uint8_t>((in[1] & 0xf) << 2);
+      const uint8_t b = (in[2] >> 6);
+      enc_add2(&out, a | b, in[2] & 0x3f);
+      in += 3;
+    }
   }
 
   /* encode the remaining bytes */
@@ -214,15 +254,7 @@ grpc_slice grpc_chttp2_base64_encode_and_huffman_compress(
     }
   }
 
-  if (out.temp_length) {
-    /* NB: the following integer arithmetic operation needs to be in its
-     * expanded form due to the "integral promotion" performed (see section
-     * 3.2.1.1 of the C89 draft standard). A cast to the smaller container type
-     * is then required to avoid the compiler warning */
-    *out.out++ = static_cast<uint8_t>(
-        static_cast<uint8_t>(out.temp << (8u - out.temp_length)) |
-        static_cast<uint8_t>(0xffu >> out.temp_length));
-  }
+  enc_finish(&out);
 
   GPR_ASSERT(out.out <= GRPC_SLICE_END_PTR(output));
   GRPC_SLICE_SET_LENGTH(output, out.out - start_out);
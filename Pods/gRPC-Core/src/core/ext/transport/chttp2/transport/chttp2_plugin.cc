@@ -18,7 +18,13 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <string.h>
+
+#include <grpc/support/log.h>
+
 #include "src/core/ext/transport/chttp2/transport/chttp2_transport.h"
+#include "src/core/ext/transport/chttp2/transport/hpack_encoder.h"
+#include "src/core/ext/transport/chttp2/transport/huffsyms.h"
 #include "src/core/lib/debug/trace.h"
 #include "src/core/lib/gprpp/global_config.h"
 #include "src/core/lib/transport/metadata.h"
@@ -29,9 +35,44 @@ GPR_GLOBAL_CONFIG_DEFINE_BOOL(
     "assume the remote peer does the same. Thus we can ignore any flow control "
     "bookkeeping, error checking, and decision making");
 
+GPR_GLOBAL_CONFIG_DEFINE_STRING(
+    grpc_hpack_huffman_impl, "table",
+    "Declares how HPACK huffman strings are coded: 'table' (decoding through "
+    "multi-symbol lookup tables, encoding 32 bits at a time) or 'nibble' "
+    "(decoding through the 4 bit state machine, encoding byte at a time).");
+
+GPR_GLOBAL_CONFIG_DEFINE_STRING(
+    grpc_hpack_index_policy, "adaptive",
+    "Declares how the HPACK encoder picks headers to add to the dynamic "
+    "table: 'adaptive' (popularity needed scales with entry size and table "
+    "churn, large entries are never added) or 'filter' (a fixed popularity "
+    "threshold).");
+
 void grpc_chttp2_plugin_init(void) {
   g_flow_control_enabled =
       !GPR_GLOBAL_CONFIG_GET(grpc_experimental_disable_flow_control);
+  grpc_core::UniquePtr<char> huffman_impl =
+      GPR_GLOBAL_CONFIG_GET(grpc_hpack_huffman_impl);
+  if (strcmp(huffman_impl.get(), "table") == 0) {
+    g_hpack_huffman_tables_enabled = true;
+  } else if (strcmp(huffman_impl.get(), "nibble") == 0) {
+    g_hpack_huffman_tables_enabled = false;
+  } else {
+    gpr_log(GPR_ERROR, "Unknown HPACK huffman implementation %s, using tables",
+            huffman_impl.get());
+    g_hpack_huffman_tables_enabled = true;
+  }
+  grpc_core::UniquePtr<char> index_policy =
+      GPR_GLOBAL_CONFIG_GET(grpc_hpack_index_policy);
+  if (strcmp(index_policy.get(), "adaptive") == 0) {
+    g_hpack_adaptive_indexing_enabled = true;
+  } else if (strcmp(index_policy.get(), "filter") == 0) {
+    g_hpack_adaptive_indexing_enabled = false;
+  } else {
+    gpr_log(GPR_ERROR, "Unknown HPACK index policy %s, using adaptive",
+            index_policy.get());
+    g_hpack_adaptive_indexing_enabled = true;
+  }
 }
 
 void grpc_chttp2_plugin_shutdown(void) {}
@@ -21,6 +21,7 @@
 #include "src/core/ext/transport/chttp2/transport/hpack_encoder.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <string.h>
 
 /* This is here for grpc_is_binary_header
@@ -55,6 +56,18 @@
 #define ONE_ON_ADD_PROBABILITY (GRPC_CHTTP2_HPACKC_NUM_VALUES >> 1)
 /* don't consider adding anything bigger than this to the hpack table */
 #define MAX_DECODER_SPACE_USAGE 512
+/* adaptive policy: don't add an element that would use more than 1/x of the
+   table */
+#define ADAPTIVE_ELEM_TABLE_SHARE 8
+/* adaptive policy: don't add an uninterned element (which only gets its key
+   indexed) that would use more than 1/x of the table */
+#define ADAPTIVE_KEY_TABLE_SHARE 16
+/* adaptive policy: elements bigger than this need to be proportionally more
+   popular to be added */
+#define ADAPTIVE_TYPICAL_ELEM_SIZE 64
+#define ADAPTIVE_MAX_ADMIT_SHIFT 3
+
+bool g_hpack_adaptive_indexing_enabled = true;
 
 static grpc_slice_refcount terminal_slice_refcount;
 static const grpc_slice terminal_slice = {
@@ -212,6 +225,47 @@ static uint32_t prepare_space_for_new_elem(grpc_chttp2_hpack_compressor* c,
   return new_index;
 }
 
+// Move the key in entries_keys[idx] to its other cuckoo slot if that slot
+// holds nothing still in the decoder table. Return true if it was moved.
+static bool relocate_key(grpc_chttp2_hpack_compressor* c, uint32_t idx) {
+  uint32_t key_hash = grpc_slice_hash(c->entries_keys[idx]);
+  uint32_t other = HASH_FRAGMENT_2(key_hash) == idx ? HASH_FRAGMENT_3(key_hash)
+                                                    : HASH_FRAGMENT_2(key_hash);
+  const bool other_empty =
+      c->entries_keys[other].refcount == &terminal_slice_refcount;
+  if (other == idx ||
+      (!other_empty && c->indices_keys[other] > c->tail_remote_index)) {
+    return false;
+  }
+  if (!other_empty) {
+    grpc_slice_unref_internal(c->entries_keys[other]);
+  }
+  c->entries_keys[other] = c->entries_keys[idx];
+  c->indices_keys[other] = c->indices_keys[idx];
+  c->entries_keys[idx] = terminal_slice;
+  return true;
+}
+
+// Move the element in entries_elems[idx] to its other cuckoo slot if that slot
+// holds nothing still in the decoder table. Return true if it was moved.
+static bool relocate_elem(grpc_chttp2_hpack_compressor* c, uint32_t idx) {
+  grpc_mdelem elem = c->entries_elems[idx];
+  uint32_t elem_hash = GRPC_MDSTR_KV_HASH(grpc_slice_hash(GRPC_MDKEY(elem)),
+                                          grpc_slice_hash(GRPC_MDVALUE(elem)));
+  uint32_t other = HASH_FRAGMENT_2(elem_hash) == idx
+                       ? HASH_FRAGMENT_3(elem_hash)
+                       : HASH_FRAGMENT_2(elem_hash);
+  if (other == idx || (!GRPC_MDISNULL(c->entries_elems[other]) &&
+                       c->indices_elems[other] > c->tail_remote_index)) {
+    return false;
+  }
+  GRPC_MDELEM_UNREF(c->entries_elems[other]);
+  c->entries_elems[other] = elem;
+  c->indices_elems[other] = c->indices_elems[idx];
+  c->entries_elems[idx] = GRPC_MDNULL;
+  return true;
+}
+
 // Add a key to the dynamic table. Both key and value will be added to table at
 // the decoder.
 static void add_key_with_index(grpc_chttp2_hpack_compressor* c,
@@ -239,17 +293,26 @@ static void add_key_with_index(grpc_chttp2_hpack_compressor* c,
     c->entries_keys[HASH_FRAGMENT_3(key_hash)] =
         grpc_slice_ref_internal(GRPC_MDKEY(elem));
     c->indices_keys[HASH_FRAGMENT_3(key_hash)] = new_index;
-  } else if (c->indices_keys[HASH_FRAGMENT_2(key_hash)] <
-             c->indices_keys[HASH_FRAGMENT_3(key_hash)]) {
-    grpc_slice_unref_internal(c->entries_keys[HASH_FRAGMENT_2(key_hash)]);
-    c->entries_keys[HASH_FRAGMENT_2(key_hash)] =
-        grpc_slice_ref_internal(GRPC_MDKEY(elem));
-    c->indices_keys[HASH_FRAGMENT_2(key_hash)] = new_index;
   } else {
-    grpc_slice_unref_internal(c->entries_keys[HASH_FRAGMENT_3(key_hash)]);
-    c->entries_keys[HASH_FRAGMENT_3(key_hash)] =
-        grpc_slice_ref_internal(GRPC_MDKEY(elem));
-    c->indices_keys[HASH_FRAGMENT_3(key_hash)] = new_index;
+    /* replace the oldest, unless the adaptive policy can make room by moving
+       a key that is still in the decoder table to its other slot */
+    uint32_t slot = c->indices_keys[HASH_FRAGMENT_2(key_hash)] <
+                            c->indices_keys[HASH_FRAGMENT_3(key_hash)]
+                        ? HASH_FRAGMENT_2(key_hash)
+                        : HASH_FRAGMENT_3(key_hash);
+    if (g_hpack_adaptive_indexing_enabled &&
+        c->indices_keys[slot] > c->tail_remote_index) {
+      if (relocate_key(c, HASH_FRAGMENT_2(key_hash))) {
+        slot = HASH_FRAGMENT_2(key_hash);
+      } else if (relocate_key(c, HASH_FRAGMENT_3(key_hash))) {
+        slot = HASH_FRAGMENT_3(key_hash);
+      }
+    }
+    if (c->entries_keys[slot].refcount != &terminal_slice_refcount) {
+      grpc_slice_unref_internal(c->entries_keys[slot]);
+    }
+    c->entries_keys[slot] = grpc_slice_ref_internal(GRPC_MDKEY(elem));
+    c->indices_keys[slot] = new_index;
   }
 }
 
@@ -281,26 +344,58 @@ static void add_elem_with_index(grpc_chttp2_hpack_compressor* c,
     /* not there (cuckoo), but a free element: add */
     c->entries_elems[HASH_FRAGMENT_3(elem_hash)] = GRPC_MDELEM_REF(elem);
     c->indices_elems[HASH_FRAGMENT_3(elem_hash)] = new_index;
-  } else if (c->indices_elems[HASH_FRAGMENT_2(elem_hash)] <
-             c->indices_elems[HASH_FRAGMENT_3(elem_hash)]) {
-    /* not there: replace oldest */
-    GRPC_MDELEM_UNREF(c->entries_elems[HASH_FRAGMENT_2(elem_hash)]);
-    c->entries_elems[HASH_FRAGMENT_2(elem_hash)] = GRPC_MDELEM_REF(elem);
-    c->indices_elems[HASH_FRAGMENT_2(elem_hash)] = new_index;
   } else {
-    /* not there: replace oldest */
-    GRPC_MDELEM_UNREF(c->entries_elems[HASH_FRAGMENT_3(elem_hash)]);
-    c->entries_elems[HASH_FRAGMENT_3(elem_hash)] = GRPC_MDELEM_REF(elem);
-    c->indices_elems[HASH_FRAGMENT_3(elem_hash)] = new_index;
+    /* not there: replace oldest, unless the adaptive policy can make room by
+       moving an element that is still in the decoder table (cuckoo) */
+    uint32_t slot = c->indices_elems[HASH_FRAGMENT_2(elem_hash)] <
+                            c->indices_elems[HASH_FRAGMENT_3(elem_hash)]
+                        ? HASH_FRAGMENT_2(elem_hash)
+                        : HASH_FRAGMENT_3(elem_hash);
+    if (g_hpack_adaptive_indexing_enabled &&
+        c->indices_elems[slot] > c->tail_remote_index) {
+      if (relocate_elem(c, HASH_FRAGMENT_2(elem_hash))) {
+        slot = HASH_FRAGMENT_2(elem_hash);
+      } else if (relocate_elem(c, HASH_FRAGMENT_3(elem_hash))) {
+        slot = HASH_FRAGMENT_3(elem_hash);
+      }
+    }
+    GRPC_MDELEM_UNREF(c->entries_elems[slot]);
+    c->entries_elems[slot] = GRPC_MDELEM_REF(elem);
+    c->indices_elems[slot] = new_index;
   }
 
   add_key_with_index(c, elem, new_index);
 }
 
+/* adaptive policy: once a table's worth of elements has been added, make
+   adding harder if the table is churning (fewer hits than additions), and
+   easier again once it is not */
+static void update_admit_window(grpc_chttp2_hpack_compressor* c,
+                                size_t elem_size) {
+  c->window_adds++;
+  c->window_bytes += static_cast<uint32_t>(elem_size);
+  if (c->window_bytes < c->max_table_size) {
+    return;
+  }
+  if (c->window_hits < c->window_adds) {
+    if (c->admit_shift < ADAPTIVE_MAX_ADMIT_SHIFT) {
+      c->admit_shift++;
+    }
+  } else if (c->admit_shift > 0) {
+    c->admit_shift--;
+  }
+  c->window_bytes = 0;
+  c->window_adds = 0;
+  c->window_hits = 0;
+}
+
 static void add_elem(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
                      size_t elem_size) {
   uint32_t new_index = prepare_space_for_new_elem(c, elem_size);
   add_elem_with_index(c, elem, new_index);
+  if (g_hpack_adaptive_indexing_enabled && new_index != 0) {
+    update_admit_window(c, elem_size);
+  }
 }
 
 static void add_key(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
@@ -315,6 +410,7 @@ static void emit_indexed(grpc_chttp2_hpack_compressor* c, uint32_t elem_index,
   uint32_t len = GRPC_CHTTP2_VARINT_LENGTH(elem_index, 1);
   GRPC_CHTTP2_WRITE_VARINT(elem_index, 1, 0x80, add_tiny_header_data(st, len),
                            len);
+  c->indexed_bytes += len;
 }
 
 typedef struct {
@@ -361,6 +457,7 @@ static void add_wire_value(framer_state* st, wire_value v) {
 static void emit_lithdr_incidx(grpc_chttp2_hpack_compressor* c,
                                uint32_t key_index, grpc_mdelem elem,
                                framer_state* st) {
+  const uint64_t header_bytes_at_start = st->stats->header_bytes;
   GRPC_STATS_INC_HPACK_SEND_LITHDR_INCIDX();
   uint32_t len_pfx = GRPC_CHTTP2_VARINT_LENGTH(key_index, 2);
   wire_value value = get_wire_value(elem, st->use_true_binary_metadata);
@@ -373,11 +470,13 @@ static void emit_lithdr_incidx(grpc_chttp2_hpack_compressor* c,
   GRPC_CHTTP2_WRITE_VARINT((uint32_t)len_val, 1, value.huffman_prefix,
                            add_tiny_header_data(st, len_val_len), len_val_len);
   add_wire_value(st, value);
+  c->incremental_bytes += st->stats->header_bytes - header_bytes_at_start;
 }
 
 static void emit_lithdr_noidx(grpc_chttp2_hpack_compressor* c,
                               uint32_t key_index, grpc_mdelem elem,
                               framer_state* st) {
+  const uint64_t header_bytes_at_start = st->stats->header_bytes;
   GRPC_STATS_INC_HPACK_SEND_LITHDR_NOTIDX();
   uint32_t len_pfx = GRPC_CHTTP2_VARINT_LENGTH(key_index, 4);
   wire_value value = get_wire_value(elem, st->use_true_binary_metadata);
@@ -390,11 +489,13 @@ static void emit_lithdr_noidx(grpc_chttp2_hpack_compressor* c,
   GRPC_CHTTP2_WRITE_VARINT((uint32_t)len_val, 1, value.huffman_prefix,
                            add_tiny_header_data(st, len_val_len), len_val_len);
   add_wire_value(st, value);
+  c->literal_bytes += st->stats->header_bytes - header_bytes_at_start;
 }
 
 static void emit_lithdr_incidx_v(grpc_chttp2_hpack_compressor* c,
                                  uint32_t unused_index, grpc_mdelem elem,
                                  framer_state* st) {
+  const uint64_t header_bytes_at_start = st->stats->header_bytes;
   GPR_ASSERT(unused_index == 0);
   GRPC_STATS_INC_HPACK_SEND_LITHDR_INCIDX_V();
   GRPC_STATS_INC_HPACK_SEND_UNCOMPRESSED();
@@ -412,11 +513,13 @@ static void emit_lithdr_incidx_v(grpc_chttp2_hpack_compressor* c,
   GRPC_CHTTP2_WRITE_VARINT(len_val, 1, value.huffman_prefix,
                            add_tiny_header_data(st, len_val_len), len_val_len);
   add_wire_value(st, value);
+  c->incremental_bytes += st->stats->header_bytes - header_bytes_at_start;
 }
 
 static void emit_lithdr_noidx_v(grpc_chttp2_hpack_compressor* c,
                                 uint32_t unused_index, grpc_mdelem elem,
                                 framer_state* st) {
+  const uint64_t header_bytes_at_start = st->stats->header_bytes;
   GPR_ASSERT(unused_index == 0);
   GRPC_STATS_INC_HPACK_SEND_LITHDR_NOTIDX_V();
   GRPC_STATS_INC_HPACK_SEND_UNCOMPRESSED();
@@ -434,6 +537,7 @@ static void emit_lithdr_noidx_v(grpc_chttp2_hpack_compressor* c,
   GRPC_CHTTP2_WRITE_VARINT(len_val, 1, value.huffman_prefix,
                            add_tiny_header_data(st, len_val_len), len_val_len);
   add_wire_value(st, value);
+  c->literal_bytes += st->stats->header_bytes - header_bytes_at_start;
 }
 
 static void emit_advertise_table_size_change(grpc_chttp2_hpack_compressor* c,
@@ -449,6 +553,23 @@ static uint32_t dynidx(grpc_chttp2_hpack_compressor* c, uint32_t elem_index) {
          c->table_elems - elem_index;
 }
 
+/* adaptive policy: elements may only use a small share of the table, and need
+   to be more popular the bigger they are and the more the table churns */
+static bool adaptive_should_add_elem(grpc_chttp2_hpack_compressor* c,
+                                     uint32_t elem_hash, size_t elem_size) {
+  if (elem_size >= MAX_DECODER_SPACE_USAGE ||
+      elem_size > c->max_table_size / ADAPTIVE_ELEM_TABLE_SHARE) {
+    return false;
+  }
+  uint32_t needed = (c->filter_elems_sum / ONE_ON_ADD_PROBABILITY)
+                    << c->admit_shift;
+  if (elem_size > ADAPTIVE_TYPICAL_ELEM_SIZE) {
+    needed = static_cast<uint32_t>(needed * elem_size /
+                                   ADAPTIVE_TYPICAL_ELEM_SIZE);
+  }
+  return c->filter_elems[HASH_FRAGMENT_1(elem_hash)] >= needed;
+}
+
 /* encode an mdelem */
 static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
                       framer_state* st) {
@@ -503,6 +624,7 @@ static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
     if (grpc_mdelem_eq(c->entries_elems[HASH_FRAGMENT_2(elem_hash)], elem) &&
         c->indices_elems[HASH_FRAGMENT_2(elem_hash)] > c->tail_remote_index) {
       /* HIT: complete element (first cuckoo hash) */
+      c->window_hits++;
       emit_indexed(c, dynidx(c, c->indices_elems[HASH_FRAGMENT_2(elem_hash)]),
                    st);
       return;
@@ -511,6 +633,7 @@ static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
     if (grpc_mdelem_eq(c->entries_elems[HASH_FRAGMENT_3(elem_hash)], elem) &&
         c->indices_elems[HASH_FRAGMENT_3(elem_hash)] > c->tail_remote_index) {
       /* HIT: complete element (second cuckoo hash) */
+      c->window_hits++;
       emit_indexed(c, dynidx(c, c->indices_elems[HASH_FRAGMENT_3(elem_hash)]),
                    st);
       return;
@@ -522,10 +645,13 @@ static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
   /* should this elem be in the table? */
   const size_t decoder_space_usage =
       grpc_chttp2_get_size_in_hpack_table(elem, st->use_true_binary_metadata);
-  const bool should_add_elem = elem_interned &&
-                               decoder_space_usage < MAX_DECODER_SPACE_USAGE &&
-                               c->filter_elems[HASH_FRAGMENT_1(elem_hash)] >=
-                                   c->filter_elems_sum / ONE_ON_ADD_PROBABILITY;
+  const bool should_add_elem =
+      elem_interned &&
+      (g_hpack_adaptive_indexing_enabled
+           ? adaptive_should_add_elem(c, elem_hash, decoder_space_usage)
+           : decoder_space_usage < MAX_DECODER_SPACE_USAGE &&
+                 c->filter_elems[HASH_FRAGMENT_1(elem_hash)] >=
+                     c->filter_elems_sum / ONE_ON_ADD_PROBABILITY);
 
   auto emit_maybe_add = [&should_add_elem, &elem, &st, &c, &indices_key,
                          &decoder_space_usage] {
@@ -537,6 +663,22 @@ static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
     }
   };
 
+  /* the adaptive policy prefers a key from the static table: its index is
+     shorter, and it needs no dynamic table space to stay indexed */
+  const uint8_t static_key_index =
+      g_hpack_adaptive_indexing_enabled
+          ? grpc_chttp2_get_static_hpack_table_key_index(GRPC_MDKEY(elem))
+          : 0;
+  if (static_key_index != 0) {
+    if (should_add_elem) {
+      emit_lithdr_incidx(c, static_key_index, elem, st);
+      add_elem(c, elem, decoder_space_usage);
+    } else {
+      emit_lithdr_noidx(c, static_key_index, elem, st);
+    }
+    return;
+  }
+
   /* no hits for the elem... maybe there's a key? */
   indices_key = c->indices_keys[HASH_FRAGMENT_2(key_hash)];
   if (grpc_slice_eq(c->entries_keys[HASH_FRAGMENT_2(key_hash)],
@@ -558,7 +700,12 @@ static void hpack_enc(grpc_chttp2_hpack_compressor* c, grpc_mdelem elem,
 
   /* no elem, key in the table... fall back to literal emission */
   const bool should_add_key =
-      !elem_interned && decoder_space_usage < MAX_DECODER_SPACE_USAGE;
+      !elem_interned &&
+      (g_hpack_adaptive_indexing_enabled
+           ? decoder_space_usage < MAX_DECODER_SPACE_USAGE &&
+                 decoder_space_usage <=
+                     c->max_table_size / ADAPTIVE_KEY_TABLE_SHARE
+           : decoder_space_usage < MAX_DECODER_SPACE_USAGE);
   if (should_add_elem || should_add_key) {
     emit_lithdr_incidx_v(c, 0, elem, st);
   } else {
@@ -612,6 +759,12 @@ void grpc_chttp2_hpack_compressor_destroy(grpc_chttp2_hpack_compressor* c) {
     GRPC_MDELEM_UNREF(c->entries_elems[i]);
   }
   gpr_free(c->table_elem_size);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_http_trace)) {
+    gpr_log(GPR_INFO,
+            "hpack encoder sent %" PRIu64 " indexed, %" PRIu64
+            " incremental and %" PRIu64 " literal header bytes",
+            c->indexed_bytes, c->incremental_bytes, c->literal_bytes);
+  }
 }
 
 void grpc_chttp2_hpack_compressor_set_max_usable_size(
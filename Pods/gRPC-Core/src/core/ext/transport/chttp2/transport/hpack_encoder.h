@@ -28,8 +28,9 @@
 #include "src/core/lib/transport/metadata_batch.h"
 #include "src/core/lib/transport/transport.h"
 
-// This should be <= 8. We use 6 to save space.
-#define GRPC_CHTTP2_HPACKC_NUM_VALUES_BITS 6
+// This should be <= 8: the filter and both cuckoo slots are taken from
+// disjoint fragments of a 32 bit hash.
+#define GRPC_CHTTP2_HPACKC_NUM_VALUES_BITS 8
 #define GRPC_CHTTP2_HPACKC_NUM_VALUES (1 << GRPC_CHTTP2_HPACKC_NUM_VALUES_BITS)
 /* initial table size, per spec */
 #define GRPC_CHTTP2_HPACKC_INITIAL_TABLE_SIZE 4096
@@ -38,6 +39,11 @@
 
 extern grpc_core::TraceFlag grpc_http_trace;
 
+/* if true, headers are added to the dynamic table by the adaptive policy
+   (admission scaled by entry size and table churn), otherwise by the
+   popularity filter alone */
+extern bool g_hpack_adaptive_indexing_enabled;
+
 typedef struct {
   uint32_t filter_elems_sum;
   uint32_t max_table_size;
@@ -69,6 +75,21 @@ typedef struct {
   uint32_t indices_elems[GRPC_CHTTP2_HPACKC_NUM_VALUES];
 
   uint16_t* table_elem_size;
+
+  /* adaptive policy state: every time a table's worth of bytes has been
+     added, the popularity needed to add an element is doubled (up to 8x) if
+     there were fewer hits than additions, and halved otherwise */
+  uint8_t admit_shift;
+  uint32_t window_bytes;
+  uint32_t window_adds;
+  uint32_t window_hits;
+
+  /* bytes of header block written, split by how each header was sent: as a
+     table index, as a literal added to the decoder table, or as a literal
+     that is not */
+  uint64_t indexed_bytes;
+  uint64_t incremental_bytes;
+  uint64_t literal_bytes;
 } grpc_chttp2_hpack_compressor;
 
 void grpc_chttp2_hpack_compressor_init(grpc_chttp2_hpack_compressor* c);
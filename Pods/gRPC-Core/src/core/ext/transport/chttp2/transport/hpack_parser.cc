@@ -28,8 +28,10 @@
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 #include <grpc/support/string_util.h>
+#include <grpc/support/sync.h>
 
 #include "src/core/ext/transport/chttp2/transport/bin_encoder.h"
+#include "src/core/ext/transport/chttp2/transport/huffsyms.h"
 #include "src/core/lib/debug/stats.h"
 #include "src/core/lib/gpr/string.h"
 #include "src/core/lib/profiling/timers.h"
@@ -1414,12 +1416,166 @@ static grpc_error* add_huff_bytes(grpc_chttp2_hpack_parser* p,
   return GRPC_ERROR_NONE;
 }
 
+/* Multi-symbol huffman decoding, used instead of huff_nibble when
+   g_hpack_huffman_tables_enabled is set.
+
+   The next HUFF_LOOKUP_BITS bits of input index huff_lookup_tbl, whose entry
+   gives up to two symbols with codes fitting in those bits. Longer codes
+   (bytes outside printable ASCII, and EOS) have no entry there: as the HPACK
+   code is canonical, they are found by comparing the input with the range of
+   codes of each length in turn.
+
+   The tables are built from grpc_chttp2_huffsyms when the first parser is
+   initialized. */
+#define HUFF_LOOKUP_BITS 11
+#define HUFF_MAX_CODE_BITS 30
+
+/* lookup table entries: the first and second symbols, the length of the first
+   code (0 for the prefix of a longer code), the length of both codes, and the
+   number of symbols */
+#define HUFF_ENTRY(sym0, sym1, len0, len, nsyms)                             \
+  (static_cast<uint32_t>(sym0) | (static_cast<uint32_t>(sym1) << 8) |       \
+   (static_cast<uint32_t>(len0) << 16) | (static_cast<uint32_t>(len) << 21) | \
+   (static_cast<uint32_t>(nsyms) << 26))
+#define HUFF_ENTRY_SYM0(e) static_cast<uint8_t>(e)
+#define HUFF_ENTRY_SYM1(e) static_cast<uint8_t>((e) >> 8)
+#define HUFF_ENTRY_LEN0(e) (((e) >> 16) & 0x1f)
+#define HUFF_ENTRY_LEN(e) (((e) >> 21) & 0x1f)
+#define HUFF_ENTRY_NSYMS(e) ((e) >> 26)
+
+static uint32_t huff_lookup_tbl[1 << HUFF_LOOKUP_BITS];
+/* per code length: the first code, one past the last code, and the index in
+   huff_syms of the first symbol */
+static uint32_t huff_first_code[HUFF_MAX_CODE_BITS + 1];
+static uint32_t huff_limit_code[HUFF_MAX_CODE_BITS + 1];
+static uint16_t huff_first_sym[HUFF_MAX_CODE_BITS + 1];
+/* symbols in code order */
+static uint16_t huff_syms[GRPC_CHTTP2_NUM_HUFFSYMS];
+static gpr_once huff_tables_once = GPR_ONCE_INIT;
+
+static void build_huff_tables(void) {
+  uint32_t counts[HUFF_MAX_CODE_BITS + 1] = {};
+  for (int i = 0; i < GRPC_CHTTP2_NUM_HUFFSYMS; i++) {
+    counts[grpc_chttp2_huffsyms[i].length]++;
+  }
+  uint32_t code = 0;
+  uint16_t nsyms = 0;
+  for (int len = 1; len <= HUFF_MAX_CODE_BITS; len++) {
+    huff_first_code[len] = code;
+    huff_first_sym[len] = nsyms;
+    for (int i = 0; i < GRPC_CHTTP2_NUM_HUFFSYMS; i++) {
+      if (grpc_chttp2_huffsyms[i].length != static_cast<unsigned>(len)) {
+        continue;
+      }
+      GPR_ASSERT(grpc_chttp2_huffsyms[i].bits == code);
+      huff_syms[nsyms++] = static_cast<uint16_t>(i);
+      code++;
+    }
+    huff_limit_code[len] = code;
+    code <<= 1;
+  }
+
+  /* single symbols first: every index starting with a short code */
+  for (int i = 0; i < 256; i++) {
+    uint32_t len = grpc_chttp2_huffsyms[i].length;
+    if (len > HUFF_LOOKUP_BITS) continue;
+    uint32_t first = grpc_chttp2_huffsyms[i].bits << (HUFF_LOOKUP_BITS - len);
+    for (uint32_t j = 0; j < (1u << (HUFF_LOOKUP_BITS - len)); j++) {
+      huff_lookup_tbl[first + j] = HUFF_ENTRY(i, 0, len, len, 1);
+    }
+  }
+  /* then pair each with the code that follows it, when that fits too */
+  for (uint32_t i = 0; i < (1u << HUFF_LOOKUP_BITS); i++) {
+    uint32_t e = huff_lookup_tbl[i];
+    uint32_t len0 = HUFF_ENTRY_LEN0(e);
+    if (len0 == 0) continue;
+    uint32_t rest = (i << len0) & ((1u << HUFF_LOOKUP_BITS) - 1);
+    uint32_t next = huff_lookup_tbl[rest];
+    uint32_t len1 = HUFF_ENTRY_LEN0(next);
+    if (len1 == 0 || len0 + len1 > HUFF_LOOKUP_BITS) continue;
+    huff_lookup_tbl[i] = HUFF_ENTRY(HUFF_ENTRY_SYM0(e), HUFF_ENTRY_SYM0(next),
+                                    len0, len0 + len1, 2);
+  }
+}
+
+/* decode full bytes from a huffman encoded stream using the lookup tables */
+static grpc_error* add_huff_bytes_tables(grpc_chttp2_hpack_parser* p,
+                                         const uint8_t* cur,
+                                         const uint8_t* end) {
+  uint8_t decoded[256];
+  size_t ndecoded = 0;
+  uint64_t bits = p->huff_bits;
+  uint32_t nbits = p->huff_nbits;
+  const uint8_t* in = cur;
+  for (;;) {
+    while (nbits <= 56 && in != end) {
+      bits = (bits << 8) | *in++;
+      nbits += 8;
+    }
+    /* decode every complete code: input bits missing from an index are taken
+       as zeros, and a code is only used when all of its bits have arrived */
+    for (;;) {
+      if (ndecoded > sizeof(decoded) - 2) {
+        grpc_error* err = append_string(p, decoded, decoded + ndecoded);
+        if (err != GRPC_ERROR_NONE) return parse_error(p, cur, end, err);
+        ndecoded = 0;
+      }
+      uint32_t index =
+          static_cast<uint32_t>(nbits >= HUFF_LOOKUP_BITS
+                                    ? bits >> (nbits - HUFF_LOOKUP_BITS)
+                                    : bits << (HUFF_LOOKUP_BITS - nbits)) &
+          ((1u << HUFF_LOOKUP_BITS) - 1);
+      uint32_t e = huff_lookup_tbl[index];
+      uint32_t len = HUFF_ENTRY_LEN(e);
+      if (len != 0 && len <= nbits) {
+        decoded[ndecoded] = HUFF_ENTRY_SYM0(e);
+        decoded[ndecoded + 1] = HUFF_ENTRY_SYM1(e);
+        ndecoded += HUFF_ENTRY_NSYMS(e);
+        nbits -= len;
+        continue;
+      }
+      len = HUFF_ENTRY_LEN0(e);
+      if (len != 0) {
+        if (len > nbits) break;
+        decoded[ndecoded++] = HUFF_ENTRY_SYM0(e);
+        nbits -= len;
+        continue;
+      }
+      uint32_t top = static_cast<uint32_t>(
+                         nbits >= HUFF_MAX_CODE_BITS
+                             ? bits >> (nbits - HUFF_MAX_CODE_BITS)
+                             : bits << (HUFF_MAX_CODE_BITS - nbits)) &
+                     ((1u << HUFF_MAX_CODE_BITS) - 1);
+      uint32_t code;
+      len = HUFF_LOOKUP_BITS;
+      do {
+        len++;
+        code = top >> (HUFF_MAX_CODE_BITS - len);
+      } while (code >= huff_limit_code[len]);
+      if (len > nbits) break;
+      uint16_t sym =
+          huff_syms[huff_first_sym[len] + code - huff_first_code[len]];
+      if (sym < 256) decoded[ndecoded++] = static_cast<uint8_t>(sym);
+      nbits -= len;
+    }
+    if (in == end) break;
+  }
+  p->huff_bits = bits;
+  p->huff_nbits = static_cast<uint8_t>(nbits);
+  if (ndecoded != 0) {
+    grpc_error* err = append_string(p, decoded, decoded + ndecoded);
+    if (err != GRPC_ERROR_NONE) return parse_error(p, cur, end, err);
+  }
+  return GRPC_ERROR_NONE;
+}
+
 /* decode some string bytes based on the current decoding mode
    (huffman or not) */
 static grpc_error* add_str_bytes(grpc_chttp2_hpack_parser* p,
                                  const uint8_t* cur, const uint8_t* end) {
   if (p->huff) {
-    return add_huff_bytes(p, cur, end);
+    return g_hpack_huffman_tables_enabled ? add_huff_bytes_tables(p, cur, end)
+                                          : add_huff_bytes(p, cur, end);
   } else {
     return append_string(p, cur, end);
   }
@@ -1467,6 +1623,8 @@ static grpc_error* begin_parse_string(grpc_chttp2_hpack_parser* p,
   str->data.copied.length = 0;
   p->parsing.str = str;
   p->huff_state = 0;
+  p->huff_bits = 0;
+  p->huff_nbits = 0;
   p->binary = binary;
   switch (p->binary) {
     case NOT_BINARY:
@@ -1553,6 +1711,7 @@ void grpc_chttp2_hpack_parser_init(grpc_chttp2_hpack_parser* p) {
   p->dynamic_table_update_allowed = 2;
   p->last_error = GRPC_ERROR_NONE;
   grpc_chttp2_hptbl_init(&p->table);
+  gpr_once_init(&huff_tables_once, build_huff_tables);
 }
 
 void grpc_chttp2_hpack_parser_set_has_priority(grpc_chttp2_hpack_parser* p) {
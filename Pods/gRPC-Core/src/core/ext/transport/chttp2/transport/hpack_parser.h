@@ -75,6 +75,10 @@ struct grpc_chttp2_hpack_parser {
   uint32_t strgot;
   /* huffman decoding state */
   int16_t huff_state;
+  /* input bits not yet decoded, when decoding with the lookup tables: the low
+     huff_nbits bits of huff_bits */
+  uint64_t huff_bits;
+  uint8_t huff_nbits;
   /* is the string being decoded binary? */
   uint8_t binary;
   /* is the current string huffman encoded? */
@@ -26,9 +26,11 @@
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 #include <grpc/support/string_util.h>
+#include <grpc/support/sync.h>
 
 #include "src/core/lib/debug/trace.h"
 #include "src/core/lib/gpr/murmur_hash.h"
+#include "src/core/lib/slice/slice_internal.h"
 #include "src/core/lib/transport/static_metadata.h"
 
 extern grpc_core::TraceFlag grpc_http_trace;
@@ -395,3 +397,22 @@ uint8_t grpc_chttp2_get_static_hpack_table_index(grpc_mdelem md) {
   }
   return 0;
 }
+
+/* static hpack table key index of each static string, or 0 */
+static uint8_t static_key_index[GRPC_STATIC_MDSTR_COUNT];
+static gpr_once static_key_index_once = GPR_ONCE_INIT;
+
+static void build_static_key_index(void) {
+  for (uint8_t i = GRPC_CHTTP2_LAST_STATIC_ENTRY; i > 0; i--) {
+    const grpc_slice& key = grpc_static_mdelem_table[i - 1].key;
+    static_key_index[GRPC_STATIC_METADATA_INDEX(key)] = i;
+  }
+}
+
+uint8_t grpc_chttp2_get_static_hpack_table_key_index(const grpc_slice& key) {
+  if (!GRPC_IS_STATIC_METADATA_STRING(key)) {
+    return 0;
+  }
+  gpr_once_init(&static_key_index_once, build_static_key_index);
+  return static_key_index[GRPC_STATIC_METADATA_INDEX(key)];
+}
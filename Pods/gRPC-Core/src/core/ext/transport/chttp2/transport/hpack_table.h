@@ -92,6 +92,10 @@ size_t grpc_chttp2_get_size_in_hpack_table(grpc_mdelem elem,
   table */
 uint8_t grpc_chttp2_get_static_hpack_table_index(grpc_mdelem md);
 
+/* Returns the index of the first static hpack table entry whose key is /a key.
+   Returns 0 if /a key is not a static string or not a key in that table */
+uint8_t grpc_chttp2_get_static_hpack_table_key_index(const grpc_slice& key);
+
 /* Find a key/value pair in the table... returns the index in the table of the
    most similar entry, or 0 if the value was not found */
 typedef struct {
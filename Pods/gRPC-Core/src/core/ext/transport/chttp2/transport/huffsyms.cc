@@ -20,6 +20,8 @@
 
 #include "src/core/ext/transport/chttp2/transport/huffsyms.h"
 
+bool g_hpack_huffman_tables_enabled = true;
+
 /* Constants pulled from the HPACK spec, and converted to C using the vim
    command:
    :%s/.*   \([0-9a-f]\+\)  \[ *\([0-9]\+\)\]/{0x\1, \2},/g */
@@ -30,4 +30,10 @@ typedef struct {
 
 extern const grpc_chttp2_huffsym grpc_chttp2_huffsyms[GRPC_CHTTP2_NUM_HUFFSYMS];
 
+/* Whether huffman strings are decoded with the multi-symbol lookup tables and
+   encoded 32 bits at a time, rather than with the nibble state machine and
+   byte at a time. Set from the grpc_hpack_huffman_impl config by
+   grpc_chttp2_plugin_init. */
+extern bool g_hpack_huffman_tables_enabled;
+
 #endif /* GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_HUFFSYMS_H */
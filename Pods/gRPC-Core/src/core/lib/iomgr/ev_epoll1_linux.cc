@@ -1305,6 +1305,10 @@ static const grpc_event_engine_vtable vtable = {
     shutdown_background_closure,
     shutdown_engine,
     add_closure_to_background_poller,
+
+    nullptr, /* fd_recvmsg */
+
+    "epoll1",
 };
 
 /* Called by the child process's post-fork handler to close open fds, including
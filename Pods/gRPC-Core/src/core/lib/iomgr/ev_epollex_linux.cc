@@ -1625,6 +1625,10 @@ static const grpc_event_engine_vtable vtable = {
     shutdown_background_closure,
     shutdown_engine,
     add_closure_to_background_poller,
+
+    nullptr, /* fd_recvmsg */
+
+    "epollex",
 };
 
 const grpc_event_engine_vtable* grpc_init_epollex_linux(
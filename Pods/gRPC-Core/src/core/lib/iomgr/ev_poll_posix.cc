@@ -1370,6 +1370,10 @@ static const grpc_event_engine_vtable vtable = {
     shutdown_background_closure,
     shutdown_engine,
     add_closure_to_background_poller,
+
+    nullptr, /* fd_recvmsg */
+
+    "poll",
 };
 
 /* Called by the child process's post-fork handler to close open fds, including
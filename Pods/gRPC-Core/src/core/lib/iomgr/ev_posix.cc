@@ -36,6 +36,7 @@
 #include "src/core/lib/iomgr/ev_epoll1_linux.h"
 #include "src/core/lib/iomgr/ev_epollex_linux.h"
 #include "src/core/lib/iomgr/ev_poll_posix.h"
+#include "src/core/lib/iomgr/ev_uring_linux.h"
 #include "src/core/lib/iomgr/internal_errqueue.h"
 
 GPR_GLOBAL_CONFIG_DEFINE_STRING(
@@ -109,7 +110,10 @@ const grpc_event_engine_vtable* init_non_polling(bool explicit_request) {
   real_poll_function = grpc_poll_function;
   grpc_poll_function = dummy_poll;
 
-  return ret;
+  static grpc_event_engine_vtable vtable;
+  vtable = *ret;
+  vtable.name = "none";
+  return &vtable;
 }
 }  // namespace
 
@@ -130,10 +134,11 @@ const grpc_event_engine_vtable* init_non_polling(bool explicit_request) {
 static event_engine_factory g_factories[] = {
     {ENGINE_HEAD_CUSTOM, nullptr},        {ENGINE_HEAD_CUSTOM, nullptr},
     {ENGINE_HEAD_CUSTOM, nullptr},        {ENGINE_HEAD_CUSTOM, nullptr},
-    {"epollex", grpc_init_epollex_linux}, {"epoll1", grpc_init_epoll1_linux},
-    {"poll", grpc_init_poll_posix},       {"none", init_non_polling},
-    {ENGINE_TAIL_CUSTOM, nullptr},        {ENGINE_TAIL_CUSTOM, nullptr},
+    {"uring", grpc_init_uring_linux},     {"epollex", grpc_init_epollex_linux},
+    {"epoll1", grpc_init_epoll1_linux},   {"poll", grpc_init_poll_posix},
+    {"none", init_non_polling},           {ENGINE_TAIL_CUSTOM, nullptr},
     {ENGINE_TAIL_CUSTOM, nullptr},        {ENGINE_TAIL_CUSTOM, nullptr},
+    {ENGINE_TAIL_CUSTOM, nullptr},
 };
 
 static void add(const char* beg, const char* end, char*** ss, size_t* ns) {
@@ -170,8 +175,10 @@ static void try_engine(const char* engine) {
     if (g_factories[i].factory != nullptr && is(engine, g_factories[i].name)) {
       if ((g_event_engine = g_factories[i].factory(
                0 == strcmp(engine, g_factories[i].name)))) {
-        g_poll_strategy_name = g_factories[i].name;
-        gpr_log(GPR_DEBUG, "Using polling engine: %s", g_factories[i].name);
+        g_poll_strategy_name = g_event_engine->name != nullptr
+                                   ? g_event_engine->name
+                                   : g_factories[i].name;
+        gpr_log(GPR_DEBUG, "Using polling engine: %s", g_poll_strategy_name);
         return;
       }
     }
@@ -249,6 +256,10 @@ bool grpc_event_engine_run_in_background(void) {
   return g_event_engine->run_in_background;
 }
 
+bool grpc_event_engine_can_recvmsg(void) {
+  return g_event_engine->fd_recvmsg != nullptr;
+}
+
 grpc_fd* grpc_fd_create(int fd, const char* name, bool track_err) {
   GRPC_POLLING_API_TRACE("fd_create(%d, %s, %d)", fd, name, track_err);
   GRPC_FD_TRACE("fd_create(%d, %s, %d)", fd, name, track_err);
@@ -291,6 +302,11 @@ void grpc_fd_notify_on_error(grpc_fd* fd, grpc_closure* closure) {
   g_event_engine->fd_notify_on_error(fd, closure);
 }
 
+void grpc_fd_recvmsg(grpc_fd* fd, struct msghdr* msg, ssize_t* result,
+                     grpc_closure* closure) {
+  g_event_engine->fd_recvmsg(fd, msg, result, closure);
+}
+
 void grpc_fd_set_readable(grpc_fd* fd) { g_event_engine->fd_set_readable(fd); }
 
 void grpc_fd_set_writable(grpc_fd* fd) { g_event_engine->fd_set_writable(fd); }
@@ -22,6 +22,7 @@
 #include <grpc/support/port_platform.h>
 
 #include <poll.h>
+#include <sys/socket.h>
 
 #include "src/core/lib/debug/trace.h"
 #include "src/core/lib/gprpp/global_config.h"
@@ -88,6 +89,14 @@ typedef struct grpc_event_engine_vtable {
   void (*shutdown_engine)(void);
   bool (*add_closure_to_background_poller)(grpc_closure* closure,
                                            grpc_error* error);
+
+  /* nullptr if the engine can't complete reads: see grpc_fd_recvmsg */
+  void (*fd_recvmsg)(grpc_fd* fd, struct msghdr* msg, ssize_t* result,
+                     grpc_closure* closure);
+
+  /* reported by grpc_get_poll_strategy_name(); an engine that falls back to
+     another one returns that engine's vtable, and so its name */
+  const char* name;
 } grpc_event_engine_vtable;
 
 /* register a new event engine factory */
@@ -114,6 +123,12 @@ bool grpc_event_engine_can_track_errors();
  */
 bool grpc_event_engine_run_in_background();
 
+/* Returns true if polling engine can complete reads on fds, false otherwise.
+ * If this is true, grpc_fd_recvmsg can be used to read from fds.
+ * Currently only 'uring' can complete reads.
+ */
+bool grpc_event_engine_can_recvmsg();
+
 /* Create a wrapped file descriptor.
    Requires fd is a non-blocking file descriptor.
    \a track_err if true means that error events would be tracked separately
@@ -162,6 +177,16 @@ void grpc_fd_notify_on_write(grpc_fd* fd, grpc_closure* closure);
  * needs to have been set on grpc_fd_create */
 void grpc_fd_notify_on_error(grpc_fd* fd, grpc_closure* closure);
 
+/* Start a recvmsg(2) of msg from fd, calling closure once it completes or
+   the fd is shut down. The result of the recvmsg is stored in *result, or
+   -errno if it failed. msg and the buffers it points to must stay valid until
+   closure is called. Only one recvmsg may be pending on fd at a time, and it
+   must complete before fd is orphaned.
+
+   Requires: grpc_event_engine_can_recvmsg() */
+void grpc_fd_recvmsg(grpc_fd* fd, struct msghdr* msg, ssize_t* result,
+                     grpc_closure* closure);
+
 /* Forcibly set the fd to be readable, resulting in the closure registered with
  * grpc_fd_notify_on_read being invoked.
  */
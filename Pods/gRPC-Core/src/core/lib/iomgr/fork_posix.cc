@@ -60,10 +60,11 @@ void grpc_prefork() {
     return;
   }
   if (strcmp(grpc_get_poll_strategy_name(), "epoll1") != 0 &&
-      strcmp(grpc_get_poll_strategy_name(), "poll") != 0) {
+      strcmp(grpc_get_poll_strategy_name(), "poll") != 0 &&
+      strcmp(grpc_get_poll_strategy_name(), "uring") != 0) {
     gpr_log(GPR_INFO,
-            "Fork support is only compatible with the epoll1 and poll polling "
-            "strategies");
+            "Fork support is only compatible with the epoll1, poll and uring "
+            "polling strategies");
   }
   if (!grpc_core::Fork::BlockExecCtx()) {
     gpr_log(GPR_INFO,
@@ -63,6 +63,17 @@ constexpr int SCM_TSTAMP_ACK = 2;
 #define SCM_TIMESTAMPING_OPT_STATS 54
 #endif
 
+/* Constants for sending with MSG_ZEROCOPY, for systems that don't have them */
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+
 /* Redefine required constants from <linux/net_tstamp.h> */
 constexpr uint32_t SOF_TIMESTAMPING_TX_SOFTWARE = 1u << 1;
 constexpr uint32_t SOF_TIMESTAMPING_SOFTWARE = 1u << 4;
@@ -28,6 +28,7 @@
 #include <limits.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -79,7 +80,26 @@ typedef size_t msg_iovlen_type;
 
 extern grpc_core::TraceFlag grpc_tcp_trace;
 
+#define MAX_READ_IOVEC 4
+
 namespace {
+/* The slices of a write sent with MSG_ZEROCOPY. The kernel may read from them
+ * until it reports the sends complete on the socket's error queue, which can
+ * be after the write callback ran. */
+struct zerocopy_send_record {
+  grpc_slice_buffer buf;
+  /* The index in buf of the next slice to send */
+  size_t slice_idx;
+  /* The sequence number of the first send, and the number of sends made */
+  uint32_t first_seq;
+  uint32_t sends;
+  /* The number of sends the kernel reported complete */
+  uint32_t completed;
+  /* True while the write is in progress, when more sends may follow */
+  bool writing;
+  bool in_use;
+};
+
 struct grpc_tcp {
   grpc_endpoint base;
   grpc_fd* em_fd;
@@ -115,6 +135,16 @@ struct grpc_tcp {
   grpc_closure write_done_closure;
   grpc_closure error_closure;
 
+  /* Set if the polling engine completes reads, in which case reads are
+   * started with grpc_fd_recvmsg instead of waiting for the fd to be readable.
+   * The following fields belong to the pending read. */
+  bool use_recvmsg;
+  struct msghdr read_msg;
+  struct iovec read_iov[MAX_READ_IOVEC];
+  char read_cmsgbuf[24 /*CMSG_SPACE(sizeof(int))*/];
+  ssize_t read_result;
+  grpc_closure recvmsg_done_closure;
+
   char* peer_string;
 
   grpc_resource_user* resource_user;
@@ -142,6 +172,21 @@ struct grpc_tcp {
   bool ts_capable;        /* Cache whether we can set timestamping options */
   gpr_atm stop_error_notification; /* Set to 1 if we do not want to be notified
                                       on errors anymore */
+
+  /* Set if writes of at least zerocopy_threshold bytes are sent with
+   * MSG_ZEROCOPY, using one of the zerocopy_max_sends records. */
+  bool zerocopy_enabled;
+  size_t zerocopy_threshold;
+  int zerocopy_max_sends;
+  /* Guards the records, which are released as the kernel completes sends */
+  gpr_mu zerocopy_mu;
+  zerocopy_send_record* zerocopy_records;
+  /* Set when the endpoint is destroyed; later sends copy their bytes */
+  bool zerocopy_shutdown;
+  /* The record of the write in progress, if sent with MSG_ZEROCOPY */
+  zerocopy_send_record* zerocopy_current;
+  /* The sequence number the kernel gives the next MSG_ZEROCOPY send */
+  uint32_t zerocopy_next_seq;
 };
 
 struct backup_poller {
@@ -345,6 +390,15 @@ static void tcp_free(grpc_tcp* tcp) {
   grpc_fd_orphan(tcp->em_fd, tcp->release_fd_cb, tcp->release_fd,
                  "tcp_unref_orphan");
   grpc_slice_buffer_destroy_internal(&tcp->last_read_buffer);
+  if (tcp->zerocopy_enabled) {
+    /* tcp_destroy waited for the kernel to complete every zerocopy send, so
+     * nothing reads from these slices anymore */
+    for (int i = 0; i < tcp->zerocopy_max_sends; i++) {
+      grpc_slice_buffer_destroy_internal(&tcp->zerocopy_records[i].buf);
+    }
+    gpr_free(tcp->zerocopy_records);
+    gpr_mu_destroy(&tcp->zerocopy_mu);
+  }
   grpc_resource_user_unref(tcp->resource_user);
   gpr_free(tcp->peer_string);
   /* The lock is not really necessary here, since all refs have been released */
@@ -396,9 +450,12 @@ static void tcp_unref(grpc_tcp* tcp) {
 static void tcp_ref(grpc_tcp* tcp) { gpr_ref(&tcp->refcount); }
 #endif
 
+static void tcp_zerocopy_disable_and_wait(grpc_tcp* tcp);
+
 static void tcp_destroy(grpc_endpoint* ep) {
   grpc_tcp* tcp = reinterpret_cast<grpc_tcp*>(ep);
   grpc_slice_buffer_reset_and_unref_internal(&tcp->last_read_buffer);
+  tcp_zerocopy_disable_and_wait(tcp);
   if (grpc_event_engine_can_track_errors()) {
     gpr_atm_no_barrier_store(&tcp->stop_error_notification, true);
     grpc_fd_set_error(tcp->em_fd);
@@ -430,9 +487,122 @@ static void call_read_cb(grpc_tcp* tcp, grpc_error* error) {
   GRPC_CLOSURE_SCHED(cb, error);
 }
 
-#define MAX_READ_IOVEC 4
+/* Updates tcp->inq from the TCP_INQ control message of a read, if any */
+static void tcp_update_inq(grpc_tcp* tcp, struct msghdr* msg) {
+#ifdef GRPC_HAVE_TCP_INQ
+  if (tcp->inq_capable) {
+    GPR_DEBUG_ASSERT(!(msg->msg_flags & MSG_CTRUNC));
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg);
+    for (; cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_TCP && cmsg->cmsg_type == TCP_CM_INQ &&
+          cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
+        tcp->inq = *reinterpret_cast<int*>(CMSG_DATA(cmsg));
+      }
+    }
+  }
+#endif /* GRPC_HAVE_TCP_INQ */
+}
+
+/* Starts a single read into incoming_buffer, completed by the polling engine:
+ * unlike tcp_do_read(), there is no need to wait for the fd to be readable
+ * first. tcp_handle_recvmsg() finishes the read. */
+static void tcp_do_read_async(grpc_tcp* tcp) {
+  GPR_TIMER_SCOPE("tcp_do_read_async", 0);
+  size_t iov_len =
+      std::min<size_t>(MAX_READ_IOVEC, tcp->incoming_buffer->count);
+  for (size_t i = 0; i < iov_len; i++) {
+    tcp->read_iov[i].iov_base =
+        GRPC_SLICE_START_PTR(tcp->incoming_buffer->slices[i]);
+    tcp->read_iov[i].iov_len =
+        GRPC_SLICE_LENGTH(tcp->incoming_buffer->slices[i]);
+  }
+
+  struct msghdr* msg = &tcp->read_msg;
+  msg->msg_name = nullptr;
+  msg->msg_namelen = 0;
+  msg->msg_iov = tcp->read_iov;
+  msg->msg_iovlen = static_cast<msg_iovlen_type>(iov_len);
+  if (tcp->inq_capable) {
+    msg->msg_control = tcp->read_cmsgbuf;
+    msg->msg_controllen = sizeof(tcp->read_cmsgbuf);
+  } else {
+    msg->msg_control = nullptr;
+    msg->msg_controllen = 0;
+  }
+  msg->msg_flags = 0;
+
+  GRPC_STATS_INC_TCP_READ_OFFER(tcp->incoming_buffer->length);
+  GRPC_STATS_INC_TCP_READ_OFFER_IOV_SIZE(tcp->incoming_buffer->count);
+  grpc_fd_recvmsg(tcp->em_fd, msg, &tcp->read_result,
+                  &tcp->recvmsg_done_closure);
+}
+
+static void tcp_handle_recvmsg(void* arg /* grpc_tcp */, grpc_error* error) {
+  grpc_tcp* tcp = static_cast<grpc_tcp*>(arg);
+  ssize_t read_bytes = tcp->read_result;
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_tcp_trace)) {
+    gpr_log(GPR_INFO, "TCP:%p got_recvmsg: %" PRIdPTR " %s", tcp,
+            static_cast<intptr_t>(read_bytes), grpc_error_string(error));
+  }
+
+  if (error != GRPC_ERROR_NONE) {
+    grpc_slice_buffer_reset_and_unref_internal(tcp->incoming_buffer);
+    grpc_slice_buffer_reset_and_unref_internal(&tcp->last_read_buffer);
+    call_read_cb(tcp, GRPC_ERROR_REF(error));
+    TCP_UNREF(tcp, "read");
+    return;
+  }
+  if (read_bytes == -EINTR || read_bytes == -EAGAIN) {
+    tcp_do_read_async(tcp);
+    return;
+  }
+  if (read_bytes < 0) {
+    grpc_slice_buffer_reset_and_unref_internal(tcp->incoming_buffer);
+    call_read_cb(tcp, tcp_annotate_error(
+                          GRPC_OS_ERROR(static_cast<int>(-read_bytes),
+                                        "recvmsg"),
+                          tcp));
+    TCP_UNREF(tcp, "read");
+    return;
+  }
+  if (read_bytes == 0) {
+    /* 0 read size ==> end of stream */
+    grpc_slice_buffer_reset_and_unref_internal(tcp->incoming_buffer);
+    call_read_cb(
+        tcp, tcp_annotate_error(
+                 GRPC_ERROR_CREATE_FROM_STATIC_STRING("Socket closed"), tcp));
+    TCP_UNREF(tcp, "read");
+    return;
+  }
+
+  GRPC_STATS_INC_TCP_READ_SIZE(read_bytes);
+  add_to_estimate(tcp, static_cast<size_t>(read_bytes));
+  GPR_DEBUG_ASSERT((size_t)read_bytes <= tcp->incoming_buffer->length);
+
+  /* Without TCP_INQ, a read that doesn't fill incoming_buffer is taken to
+   * have drained the socket. */
+  tcp->inq =
+      static_cast<size_t>(read_bytes) < tcp->incoming_buffer->length ? 0 : 1;
+  tcp_update_inq(tcp, &tcp->read_msg);
+  if (tcp->inq == 0) {
+    finish_estimate(tcp);
+  }
+
+  if (static_cast<size_t>(read_bytes) < tcp->incoming_buffer->length) {
+    grpc_slice_buffer_trim_end(tcp->incoming_buffer,
+                               tcp->incoming_buffer->length - read_bytes,
+                               &tcp->last_read_buffer);
+  }
+  call_read_cb(tcp, GRPC_ERROR_NONE);
+  TCP_UNREF(tcp, "read");
+}
+
 static void tcp_do_read(grpc_tcp* tcp) {
   GPR_TIMER_SCOPE("tcp_do_read", 0);
+  if (tcp->use_recvmsg) {
+    tcp_do_read_async(tcp);
+    return;
+  }
   struct msghdr msg;
   struct iovec iov[MAX_READ_IOVEC];
   char cmsgbuf[24 /*CMSG_SPACE(sizeof(int))*/];
@@ -516,18 +686,7 @@ static void tcp_do_read(grpc_tcp* tcp) {
     GPR_DEBUG_ASSERT((size_t)read_bytes <=
                      tcp->incoming_buffer->length - total_read_bytes);
 
-#ifdef GRPC_HAVE_TCP_INQ
-    if (tcp->inq_capable) {
-      GPR_DEBUG_ASSERT(!(msg.msg_flags & MSG_CTRUNC));
-      struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-      for (; cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-        if (cmsg->cmsg_level == SOL_TCP && cmsg->cmsg_type == TCP_CM_INQ &&
-            cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
-          tcp->inq = *reinterpret_cast<int*>(CMSG_DATA(cmsg));
-        }
-      }
-    }
-#endif /* GRPC_HAVE_TCP_INQ */
+    tcp_update_inq(tcp, &msg);
 
     total_read_bytes += read_bytes;
     if (tcp->inq == 0 || total_read_bytes == tcp->incoming_buffer->length) {
@@ -630,7 +789,12 @@ static void tcp_read(grpc_endpoint* ep, grpc_slice_buffer* incoming_buffer,
   grpc_slice_buffer_reset_and_unref_internal(incoming_buffer);
   grpc_slice_buffer_swap(incoming_buffer, &tcp->last_read_buffer);
   TCP_REF(tcp, "read");
-  if (tcp->is_first_read) {
+  if (tcp->use_recvmsg) {
+    /* The polling engine waits for data as part of the read, so there is no
+     * need to wait for the fd to be readable first. */
+    tcp->is_first_read = false;
+    GRPC_CLOSURE_SCHED(&tcp->read_done_closure, GRPC_ERROR_NONE);
+  } else if (tcp->is_first_read) {
     /* Endpoint read called for the very first time. Register read callback with
      * the polling engine */
     tcp->is_first_read = false;
@@ -651,14 +815,15 @@ static void tcp_read(grpc_endpoint* ep, grpc_slice_buffer* incoming_buffer,
 }
 
 /* A wrapper around sendmsg. It sends \a msg over \a fd and returns the number
- * of bytes sent. */
-ssize_t tcp_send(int fd, const struct msghdr* msg) {
+ * of bytes sent. \a additional_flags are passed to sendmsg along with the
+ * default ones. */
+ssize_t tcp_send(int fd, const struct msghdr* msg, int additional_flags = 0) {
   GPR_TIMER_SCOPE("sendmsg", 1);
   ssize_t sent_length;
   do {
     /* TODO(klempner): Cork if this is a partial write */
     GRPC_STATS_INC_SYSCALL_WRITE();
-    sent_length = sendmsg(fd, msg, SENDMSG_FLAGS);
+    sent_length = sendmsg(fd, msg, SENDMSG_FLAGS | additional_flags);
   } while (sent_length < 0 && errno == EINTR);
   return sent_length;
 }
@@ -676,6 +841,58 @@ static bool tcp_write_with_timestamps(grpc_tcp* tcp, struct msghdr* msg,
 /** The callback function to be invoked when we get an error on the socket. */
 static void tcp_handle_error(void* arg /* grpc_tcp */, grpc_error* error);
 
+/** Releases the slices of \a record once its write is over and the kernel
+ * completed all its sends. zerocopy_mu must be held. */
+static void zerocopy_maybe_release_locked(zerocopy_send_record* record) {
+  if (!record->writing && record->completed == record->sends) {
+    grpc_slice_buffer_reset_and_unref_internal(&record->buf);
+    record->in_use = false;
+  }
+}
+
+/** Returns a record to send \a buf with MSG_ZEROCOPY, moving the slices of
+ * \a buf into it, or nullptr if \a buf should be copied: it is small enough
+ * that pinning its pages costs more than copying them, or too many zerocopy
+ * sends are still in flight. */
+static zerocopy_send_record* tcp_zerocopy_start_send(grpc_tcp* tcp,
+                                                     grpc_slice_buffer* buf) {
+  if (!tcp->zerocopy_enabled || buf->length < tcp->zerocopy_threshold ||
+      tcp->outgoing_buffer_arg != nullptr) {
+    return nullptr;
+  }
+  zerocopy_send_record* record = nullptr;
+  gpr_mu_lock(&tcp->zerocopy_mu);
+  for (int i = 0; i < tcp->zerocopy_max_sends && !tcp->zerocopy_shutdown;
+       i++) {
+    if (!tcp->zerocopy_records[i].in_use) {
+      record = &tcp->zerocopy_records[i];
+      record->slice_idx = 0;
+      record->first_seq = tcp->zerocopy_next_seq;
+      record->sends = 0;
+      record->completed = 0;
+      record->writing = true;
+      record->in_use = true;
+      break;
+    }
+  }
+  gpr_mu_unlock(&tcp->zerocopy_mu);
+  if (record != nullptr) {
+    grpc_slice_buffer_swap(buf, &record->buf);
+  }
+  return record;
+}
+
+/** Ends the zerocopy write in progress, if any */
+static void tcp_zerocopy_finish_send(grpc_tcp* tcp) {
+  zerocopy_send_record* record = tcp->zerocopy_current;
+  if (record == nullptr) return;
+  tcp->zerocopy_current = nullptr;
+  gpr_mu_lock(&tcp->zerocopy_mu);
+  record->writing = false;
+  zerocopy_maybe_release_locked(record);
+  gpr_mu_unlock(&tcp->zerocopy_mu);
+}
+
 #ifdef GRPC_LINUX_ERRQUEUE
 
 static bool tcp_write_with_timestamps(grpc_tcp* tcp, struct msghdr* msg,
@@ -781,6 +998,37 @@ struct cmsghdr* process_timestamp(grpc_tcp* tcp, msghdr* msg,
   return next_cmsg;
 }
 
+/** If \a cmsg reports completed MSG_ZEROCOPY sends, releases the records that
+ * have no sends left in flight and returns true. */
+static bool process_zerocopy_completion(grpc_tcp* tcp, struct cmsghdr* cmsg) {
+  if (!(cmsg->cmsg_level == SOL_IP || cmsg->cmsg_level == SOL_IPV6) ||
+      !(cmsg->cmsg_type == IP_RECVERR || cmsg->cmsg_type == IPV6_RECVERR)) {
+    return false;
+  }
+  auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cmsg));
+  if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+    return false;
+  }
+  /* The sends with sequence numbers in [ee_info, ee_data] are complete. Each
+   * record holds a contiguous range of sequence numbers. */
+  gpr_mu_lock(&tcp->zerocopy_mu);
+  for (int i = 0; i < tcp->zerocopy_max_sends; i++) {
+    zerocopy_send_record* record = &tcp->zerocopy_records[i];
+    if (!record->in_use || record->sends == 0) continue;
+    /* Relative to first_seq, which copes with the numbers wrapping around */
+    int64_t lo = static_cast<int32_t>(serr->ee_info - record->first_seq);
+    int64_t hi = static_cast<int32_t>(serr->ee_data - record->first_seq);
+    lo = GPR_MAX(lo, 0);
+    hi = GPR_MIN(hi, static_cast<int64_t>(record->sends) - 1);
+    if (hi >= lo) {
+      record->completed += static_cast<uint32_t>(hi - lo + 1);
+      zerocopy_maybe_release_locked(record);
+    }
+  }
+  gpr_mu_unlock(&tcp->zerocopy_mu);
+  return true;
+}
+
 /** For linux platforms, reads the socket's error queue and processes error
  * messages from the queue.
  */
@@ -835,6 +1083,10 @@ static void process_errors(grpc_tcp* tcp) {
     bool seen = false;
     for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg && cmsg->cmsg_len;
          cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (tcp->zerocopy_enabled && process_zerocopy_completion(tcp, cmsg)) {
+        seen = true;
+        continue;
+      }
       if (cmsg->cmsg_level != SOL_SOCKET ||
           cmsg->cmsg_type != SCM_TIMESTAMPING) {
         /* Got a control message that is not a timestamp. Don't know how to
@@ -879,6 +1131,42 @@ static void tcp_handle_error(void* arg /* grpc_tcp */, grpc_error* error) {
   grpc_fd_notify_on_error(tcp->em_fd, &tcp->error_closure);
 }
 
+/** Returns true if the kernel has not completed every MSG_ZEROCOPY send */
+static bool zerocopy_sends_in_flight(grpc_tcp* tcp) {
+  bool in_flight = false;
+  gpr_mu_lock(&tcp->zerocopy_mu);
+  for (int i = 0; i < tcp->zerocopy_max_sends; i++) {
+    const zerocopy_send_record* record = &tcp->zerocopy_records[i];
+    if (record->in_use && record->completed != record->sends) {
+      in_flight = true;
+      break;
+    }
+  }
+  gpr_mu_unlock(&tcp->zerocopy_mu);
+  return in_flight;
+}
+
+/** Stops sending with MSG_ZEROCOPY and reads the error queue until the kernel
+ * completed every send, since it may read from the slices of a record until
+ * then. A write still in progress releases its record when it ends. */
+static void tcp_zerocopy_disable_and_wait(grpc_tcp* tcp) {
+  if (!tcp->zerocopy_enabled) return;
+  gpr_mu_lock(&tcp->zerocopy_mu);
+  tcp->zerocopy_shutdown = true;
+  gpr_mu_unlock(&tcp->zerocopy_mu);
+  for (;;) {
+    process_errors(tcp);
+    if (!zerocopy_sends_in_flight(tcp)) break;
+    /* Sleep until the error queue is readable, which poll reports as
+     * POLLERR whatever the requested events */
+    struct pollfd pfd;
+    pfd.fd = tcp->fd;
+    pfd.events = 0;
+    pfd.revents = 0;
+    poll(&pfd, 1, 100);
+  }
+}
+
 #else  /* GRPC_LINUX_ERRQUEUE */
 static bool tcp_write_with_timestamps(grpc_tcp* tcp, struct msghdr* msg,
                                       size_t sending_length,
@@ -892,6 +1180,9 @@ static void tcp_handle_error(void* arg /* grpc_tcp */, grpc_error* error) {
   gpr_log(GPR_ERROR, "Error handling is not supported for this platform");
   GPR_ASSERT(0);
 }
+
+/* Zerocopy sends are only enabled where the error queue reports them */
+static void tcp_zerocopy_disable_and_wait(grpc_tcp* tcp) {}
 #endif /* GRPC_LINUX_ERRQUEUE */
 
 /* If outgoing_buffer_arg is filled, shuts down the list early, so that any
@@ -907,45 +1198,158 @@ void tcp_shutdown_buffer_list(grpc_tcp* tcp) {
   }
 }
 
-/* returns true if done, false if pending; if returning true, *error is set */
 #if defined(IOV_MAX) && IOV_MAX < 1000
 #define MAX_WRITE_IOVEC IOV_MAX
 #else
 #define MAX_WRITE_IOVEC 1000
 #endif
+
+/* Fills \a iov with the unsent part of outgoing_buffer, from the slice at
+ * *slice_idx on, and advances *slice_idx past the slices used. Returns the
+ * number of iovecs used, and sets *sending_length to the bytes they hold. */
+static msg_iovlen_type populate_iovs(grpc_tcp* tcp, size_t* slice_idx,
+                                     struct iovec* iov,
+                                     size_t* sending_length) {
+  msg_iovlen_type iov_size;
+  *sending_length = 0;
+  for (iov_size = 0; *slice_idx != tcp->outgoing_buffer->count &&
+                     iov_size != MAX_WRITE_IOVEC;
+       iov_size++) {
+    iov[iov_size].iov_base =
+        GRPC_SLICE_START_PTR(tcp->outgoing_buffer->slices[*slice_idx]) +
+        tcp->outgoing_byte_idx;
+    iov[iov_size].iov_len =
+        GRPC_SLICE_LENGTH(tcp->outgoing_buffer->slices[*slice_idx]) -
+        tcp->outgoing_byte_idx;
+    *sending_length += iov[iov_size].iov_len;
+    (*slice_idx)++;
+    tcp->outgoing_byte_idx = 0;
+  }
+  GPR_ASSERT(iov_size > 0);
+  return iov_size;
+}
+
+/* Moves *slice_idx and outgoing_byte_idx back over the \a trailing bytes
+ * populate_iovs() offered that sendmsg did not take. */
+static void unwind_unsent(grpc_tcp* tcp, size_t* slice_idx, size_t trailing) {
+  GPR_ASSERT(tcp->outgoing_byte_idx == 0);
+  while (trailing > 0) {
+    size_t slice_length;
+
+    (*slice_idx)--;
+    slice_length = GRPC_SLICE_LENGTH(tcp->outgoing_buffer->slices[*slice_idx]);
+    if (slice_length > trailing) {
+      tcp->outgoing_byte_idx = slice_length - trailing;
+      break;
+    } else {
+      trailing -= slice_length;
+    }
+  }
+}
+
+#ifdef GRPC_LINUX_ERRQUEUE
+/* Like tcp_flush, but sends the slices of \a record with MSG_ZEROCOPY. Instead
+ * of being unreffed as they are written, the slices stay in the record until
+ * the kernel reports the sends complete. */
+static bool tcp_flush_zerocopy(grpc_tcp* tcp, zerocopy_send_record* record,
+                               grpc_error** error) {
+  struct msghdr msg;
+  struct iovec iov[MAX_WRITE_IOVEC];
+  size_t sending_length;
+
+  for (;;) {
+    size_t unwind_slice_idx = record->slice_idx;
+    size_t unwind_byte_idx = tcp->outgoing_byte_idx;
+    msg_iovlen_type iov_size =
+        populate_iovs(tcp, &record->slice_idx, iov, &sending_length);
+
+    msg.msg_name = nullptr;
+    msg.msg_namelen = 0;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_size;
+    msg.msg_control = nullptr;
+    msg.msg_controllen = 0;
+    msg.msg_flags = 0;
+
+    GRPC_STATS_INC_TCP_WRITE_SIZE(sending_length);
+    GRPC_STATS_INC_TCP_WRITE_IOV_SIZE(iov_size);
+
+    /* Count the send before making it, since the kernel may complete it
+     * before sendmsg returns. Once the endpoint is destroyed, nothing waits
+     * for more sends to complete, so the rest of the write is copied. */
+    gpr_mu_lock(&tcp->zerocopy_mu);
+    bool zerocopy = !tcp->zerocopy_shutdown;
+    if (zerocopy) record->sends++;
+    gpr_mu_unlock(&tcp->zerocopy_mu);
+    ssize_t sent_length = zerocopy ? tcp_send(tcp->fd, &msg, MSG_ZEROCOPY)
+                                   : tcp_send(tcp->fd, &msg);
+    int saved_errno = errno;
+    if (sent_length >= 0) {
+      if (zerocopy) tcp->zerocopy_next_seq++;
+    } else if (zerocopy) {
+      gpr_mu_lock(&tcp->zerocopy_mu);
+      record->sends--;
+      gpr_mu_unlock(&tcp->zerocopy_mu);
+      if (saved_errno == ENOBUFS) {
+        /* Out of memory to pin pages with (see net.core.optmem_max): copy
+         * these bytes instead. */
+        sent_length = tcp_send(tcp->fd, &msg);
+        saved_errno = errno;
+      }
+    }
+
+    if (sent_length < 0) {
+      if (saved_errno == EAGAIN) {
+        tcp->outgoing_byte_idx = unwind_byte_idx;
+        record->slice_idx = unwind_slice_idx;
+        return false;
+      }
+      *error = tcp_annotate_error(GRPC_OS_ERROR(saved_errno, "sendmsg"), tcp);
+      tcp_zerocopy_finish_send(tcp);
+      return true;
+    }
+
+    tcp->bytes_counter += sent_length;
+    unwind_unsent(tcp, &record->slice_idx,
+                  sending_length - static_cast<size_t>(sent_length));
+    if (record->slice_idx == record->buf.count) {
+      *error = GRPC_ERROR_NONE;
+      tcp_zerocopy_finish_send(tcp);
+      return true;
+    }
+  }
+}
+#else  /* GRPC_LINUX_ERRQUEUE */
+static bool tcp_flush_zerocopy(grpc_tcp* tcp, zerocopy_send_record* record,
+                               grpc_error** error) {
+  gpr_log(GPR_ERROR, "Zerocopy sends not supported for this platform");
+  GPR_ASSERT(0);
+  return true;
+}
+#endif /* GRPC_LINUX_ERRQUEUE */
+
+/* returns true if done, false if pending; if returning true, *error is set */
 static bool tcp_flush(grpc_tcp* tcp, grpc_error** error) {
   struct msghdr msg;
   struct iovec iov[MAX_WRITE_IOVEC];
   msg_iovlen_type iov_size;
   ssize_t sent_length = 0;
   size_t sending_length;
-  size_t trailing;
   size_t unwind_slice_idx;
   size_t unwind_byte_idx;
 
+  if (tcp->zerocopy_current != nullptr) {
+    return tcp_flush_zerocopy(tcp, tcp->zerocopy_current, error);
+  }
+
   // We always start at zero, because we eagerly unref and trim the slice
   // buffer as we write
   size_t outgoing_slice_idx = 0;
 
   for (;;) {
-    sending_length = 0;
     unwind_slice_idx = outgoing_slice_idx;
     unwind_byte_idx = tcp->outgoing_byte_idx;
-    for (iov_size = 0; outgoing_slice_idx != tcp->outgoing_buffer->count &&
-                       iov_size != MAX_WRITE_IOVEC;
-         iov_size++) {
-      iov[iov_size].iov_base =
-          GRPC_SLICE_START_PTR(
-              tcp->outgoing_buffer->slices[outgoing_slice_idx]) +
-          tcp->outgoing_byte_idx;
-      iov[iov_size].iov_len =
-          GRPC_SLICE_LENGTH(tcp->outgoing_buffer->slices[outgoing_slice_idx]) -
-          tcp->outgoing_byte_idx;
-      sending_length += iov[iov_size].iov_len;
-      outgoing_slice_idx++;
-      tcp->outgoing_byte_idx = 0;
-    }
-    GPR_ASSERT(iov_size > 0);
+    iov_size = populate_iovs(tcp, &outgoing_slice_idx, iov, &sending_length);
 
     msg.msg_name = nullptr;
     msg.msg_namelen = 0;
@@ -997,22 +1401,9 @@ static bool tcp_flush(grpc_tcp* tcp, grpc_error** error) {
       }
     }
 
-    GPR_ASSERT(tcp->outgoing_byte_idx == 0);
     tcp->bytes_counter += sent_length;
-    trailing = sending_length - static_cast<size_t>(sent_length);
-    while (trailing > 0) {
-      size_t slice_length;
-
-      outgoing_slice_idx--;
-      slice_length =
-          GRPC_SLICE_LENGTH(tcp->outgoing_buffer->slices[outgoing_slice_idx]);
-      if (slice_length > trailing) {
-        tcp->outgoing_byte_idx = slice_length - trailing;
-        break;
-      } else {
-        trailing -= slice_length;
-      }
-    }
+    unwind_unsent(tcp, &outgoing_slice_idx,
+                  sending_length - static_cast<size_t>(sent_length));
     if (outgoing_slice_idx == tcp->outgoing_buffer->count) {
       *error = GRPC_ERROR_NONE;
       grpc_slice_buffer_reset_and_unref_internal(tcp->outgoing_buffer);
@@ -1026,6 +1417,7 @@ static void tcp_handle_write(void* arg /* grpc_tcp */, grpc_error* error) {
   grpc_closure* cb;
 
   if (error != GRPC_ERROR_NONE) {
+    tcp_zerocopy_finish_send(tcp);
     cb = tcp->write_cb;
     tcp->write_cb = nullptr;
     cb->cb(cb->cb_arg, error);
@@ -1087,6 +1479,10 @@ static void tcp_write(grpc_endpoint* ep, grpc_slice_buffer* buf,
   if (arg) {
     GPR_ASSERT(grpc_event_engine_can_track_errors());
   }
+  tcp->zerocopy_current = tcp_zerocopy_start_send(tcp, buf);
+  if (tcp->zerocopy_current != nullptr) {
+    tcp->outgoing_buffer = &tcp->zerocopy_current->buf;
+  }
 
   if (!tcp_flush(tcp, &error)) {
     TCP_REF(tcp, "write");
@@ -1172,6 +1568,10 @@ grpc_endpoint* grpc_tcp_create(grpc_fd* em_fd,
   int tcp_read_chunk_size = GRPC_TCP_DEFAULT_READ_SLICE_SIZE;
   int tcp_max_read_chunk_size = 4 * 1024 * 1024;
   int tcp_min_read_chunk_size = 256;
+  bool tcp_tx_zerocopy_enabled = false;
+  int tcp_tx_zerocopy_threshold =
+      GRPC_TCP_DEFAULT_TX_ZEROCOPY_SEND_BYTES_THRESHOLD;
+  int tcp_tx_zerocopy_max_sends = GRPC_TCP_DEFAULT_TX_ZEROCOPY_MAX_SIMULT_SENDS;
   grpc_resource_quota* resource_quota = grpc_resource_quota_create(nullptr);
   if (channel_args != nullptr) {
     for (size_t i = 0; i < channel_args->num_args; i++) {
@@ -1190,6 +1590,22 @@ grpc_endpoint* grpc_tcp_create(grpc_fd* em_fd,
         grpc_integer_options options = {tcp_read_chunk_size, 1, MAX_CHUNK_SIZE};
         tcp_max_read_chunk_size =
             grpc_channel_arg_get_integer(&channel_args->args[i], options);
+      } else if (0 == strcmp(channel_args->args[i].key,
+                             GRPC_ARG_TCP_TX_ZEROCOPY_ENABLED)) {
+        tcp_tx_zerocopy_enabled =
+            grpc_channel_arg_get_bool(&channel_args->args[i], false);
+      } else if (0 == strcmp(channel_args->args[i].key,
+                             GRPC_ARG_TCP_TX_ZEROCOPY_SEND_BYTES_THRESHOLD)) {
+        grpc_integer_options options = {
+            GRPC_TCP_DEFAULT_TX_ZEROCOPY_SEND_BYTES_THRESHOLD, 0, INT_MAX};
+        tcp_tx_zerocopy_threshold =
+            grpc_channel_arg_get_integer(&channel_args->args[i], options);
+      } else if (0 == strcmp(channel_args->args[i].key,
+                             GRPC_ARG_TCP_TX_ZEROCOPY_MAX_SIMULT_SENDS)) {
+        grpc_integer_options options = {
+            GRPC_TCP_DEFAULT_TX_ZEROCOPY_MAX_SIMULT_SENDS, 1, 64};
+        tcp_tx_zerocopy_max_sends =
+            grpc_channel_arg_get_integer(&channel_args->args[i], options);
       } else if (0 ==
                  strcmp(channel_args->args[i].key, GRPC_ARG_RESOURCE_QUOTA)) {
         grpc_resource_quota_unref_internal(resource_quota);
@@ -1238,6 +1654,9 @@ grpc_endpoint* grpc_tcp_create(grpc_fd* em_fd,
   tcp->tb_head = nullptr;
   GRPC_CLOSURE_INIT(&tcp->read_done_closure, tcp_handle_read, tcp,
                     grpc_schedule_on_exec_ctx);
+  tcp->use_recvmsg = grpc_event_engine_can_recvmsg();
+  GRPC_CLOSURE_INIT(&tcp->recvmsg_done_closure, tcp_handle_recvmsg, tcp,
+                    grpc_schedule_on_exec_ctx);
   if (grpc_event_engine_run_in_background()) {
     // If there is a polling engine always running in the background, there is
     // no need to run the backup poller.
@@ -1261,6 +1680,32 @@ grpc_endpoint* grpc_tcp_create(grpc_fd* em_fd,
 #else
   tcp->inq_capable = false;
 #endif /* GRPC_HAVE_TCP_INQ */
+  tcp->zerocopy_enabled = false;
+  tcp->zerocopy_records = nullptr;
+  tcp->zerocopy_shutdown = false;
+  tcp->zerocopy_current = nullptr;
+  tcp->zerocopy_next_seq = 0;
+#ifdef GRPC_LINUX_ERRQUEUE
+  /* Zerocopy sends are reported complete on the error queue, so they need
+   * errors to be tracked. */
+  if (tcp_tx_zerocopy_enabled && grpc_event_engine_can_track_errors()) {
+    int enable = 1;
+    if (setsockopt(tcp->fd, SOL_SOCKET, SO_ZEROCOPY, &enable,
+                   sizeof(enable)) == 0) {
+      tcp->zerocopy_enabled = true;
+      tcp->zerocopy_threshold = static_cast<size_t>(tcp_tx_zerocopy_threshold);
+      tcp->zerocopy_max_sends = tcp_tx_zerocopy_max_sends;
+      gpr_mu_init(&tcp->zerocopy_mu);
+      tcp->zerocopy_records = static_cast<zerocopy_send_record*>(gpr_zalloc(
+          sizeof(*tcp->zerocopy_records) * tcp->zerocopy_max_sends));
+      for (int i = 0; i < tcp->zerocopy_max_sends; i++) {
+        grpc_slice_buffer_init(&tcp->zerocopy_records[i].buf);
+      }
+    } else {
+      gpr_log(GPR_DEBUG, "cannot set zerocopy fd=%d errno=%d", tcp->fd, errno);
+    }
+  }
+#endif /* GRPC_LINUX_ERRQUEUE */
   /* Start being notified on errors if event engine can track errors. */
   if (grpc_event_engine_can_track_errors()) {
     /* Grab a ref to tcp so that we can safely access the tcp struct when
@@ -1289,6 +1734,7 @@ void grpc_tcp_destroy_and_release_fd(grpc_endpoint* ep, int* fd,
   tcp->release_fd = fd;
   tcp->release_fd_cb = done;
   grpc_slice_buffer_reset_and_unref_internal(&tcp->last_read_buffer);
+  tcp_zerocopy_disable_and_wait(tcp);
   if (grpc_event_engine_can_track_errors()) {
     /* Stop errors notification. */
     gpr_atm_no_barrier_store(&tcp->stop_error_notification, true);
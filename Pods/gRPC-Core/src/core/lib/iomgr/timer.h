@@ -29,7 +29,9 @@
 
 typedef struct grpc_timer {
   grpc_millis deadline;
-  uint32_t heap_index; /* INVALID_HEAP_INDEX if not in heap */
+  /* INVALID_HEAP_INDEX if not in heap. The timer wheel keeps the index of the
+     list holding the timer here. */
+  uint32_t heap_index;
   bool pending;
   struct grpc_timer* next;
   struct grpc_timer* prev;
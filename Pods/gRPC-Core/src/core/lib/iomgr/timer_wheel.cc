@@ -0,0 +1,482 @@
+/*
+ *
+ * Copyright 2019 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/iomgr/timer_wheel.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <grpc/support/alloc.h>
+#include <grpc/support/cpu.h>
+#include <grpc/support/log.h>
+#include <grpc/support/sync.h>
+
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gpr/spinlock.h"
+#include "src/core/lib/gpr/useful.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+
+GPR_GLOBAL_CONFIG_DEFINE_STRING(
+    grpc_timer_impl, "generic",
+    "Declares which timer implementation to use: 'generic' (sharded heaps) or "
+    "'wheel' (hierarchical timing wheels).")
+
+extern grpc_core::TraceFlag grpc_timer_trace;
+extern grpc_core::TraceFlag grpc_timer_check_trace;
+
+/* Each wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots. A slot of level L
+ * holds the timers due within one 64^L ms span, so the levels cover timers due
+ * in the next 64ms, 4s, 4.4min and 4.7h. Timers due later wait in an overflow
+ * list.
+ *
+ * A timer is filed in the lowest level whose range still covers its deadline.
+ * As time reaches a slot of a level above 0, its timers are cascaded: filed
+ * again, now in a lower level. Timers in a slot of level 0 all share the same
+ * deadline, and run when time reaches it. Arming and cancelling a timer only
+ * links it into, or unlinks it from, a slot's list. */
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_LEVELS 4
+/* The index of the overflow list, after the lists of the slots */
+#define WHEEL_OVERFLOW_LIST (WHEEL_LEVELS * WHEEL_SLOTS)
+
+/* The span of a slot of the given level; the span of a slot "above" the top
+ * level is the range of the whole wheel. */
+#define SLOT_SPAN(level) \
+  (static_cast<grpc_millis>(1) << (WHEEL_SLOT_BITS * (level)))
+
+/* A timer wheel. As in the generic implementation, timers are sharded by
+ * address to spread the contention of arming and cancelling them. */
+typedef struct {
+  gpr_mu mu;
+  /* Timers due by this time have been run */
+  grpc_millis now;
+  /* No timer runs, nor needs cascading, before this time */
+  grpc_millis min_deadline;
+  /* Bit n of occupied[L] is set if slot n of level L has timers */
+  uint64_t occupied[WHEEL_LEVELS];
+  /* The timers of each slot, then the overflow list, linked through
+   * grpc_timer::next and prev. A timer keeps the index of its list in
+   * heap_index. */
+  grpc_timer* lists[WHEEL_OVERFLOW_LIST + 1];
+} timer_wheel;
+
+static size_t g_num_wheels;
+static timer_wheel* g_wheels;
+
+struct shared_mutables {
+  /* The earliest min_deadline across all wheels */
+  grpc_millis min_timer;
+  /* Allow only one run_some_expired_timers at once */
+  gpr_spinlock checker_mu;
+  bool initialized;
+  /* Protects min_timer */
+  gpr_mu mu;
+} GPR_ALIGN_STRUCT(GPR_CACHELINE_SIZE);
+
+static struct shared_mutables g_shared_mutables;
+
+static grpc_millis load_min_timer() {
+#if GPR_ARCH_64
+  // See timer_generic.cc for why this is a C-style cast.
+  return static_cast<grpc_millis>(
+      gpr_atm_no_barrier_load((gpr_atm*)(&g_shared_mutables.min_timer)));
+#else
+  // On 32-bit systems, gpr_atm_no_barrier_load does not work on 64-bit types
+  // (like grpc_millis). So all reads and writes to g_shared_mutables.min_timer
+  // are done under g_shared_mutables.mu
+  gpr_mu_lock(&g_shared_mutables.mu);
+  grpc_millis min_timer = g_shared_mutables.min_timer;
+  gpr_mu_unlock(&g_shared_mutables.mu);
+  return min_timer;
+#endif
+}
+
+/* REQUIRES: g_shared_mutables.mu locked */
+static void store_min_timer(grpc_millis min_timer) {
+#if GPR_ARCH_64
+  gpr_atm_no_barrier_store((gpr_atm*)(&g_shared_mutables.min_timer),
+                           min_timer);
+#else
+  g_shared_mutables.min_timer = min_timer;
+#endif
+}
+
+static int lowest_set_bit(uint64_t bits) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(bits);
+#else
+  int n = 0;
+  while ((bits & 1) == 0) {
+    bits >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/* Adds timer to the list for the given deadline, which must not be earlier
+ * than wheel->now.
+ * REQUIRES: wheel->mu locked */
+static void wheel_add(timer_wheel* wheel, grpc_timer* timer,
+                      grpc_millis deadline) {
+  grpc_millis delta = deadline - wheel->now;
+  uint32_t list = WHEEL_OVERFLOW_LIST;
+  for (int level = 0; level < WHEEL_LEVELS; level++) {
+    if (delta < SLOT_SPAN(level + 1)) {
+      uint32_t slot = static_cast<uint32_t>(
+          (deadline >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+      wheel->occupied[level] |= static_cast<uint64_t>(1) << slot;
+      list = level * WHEEL_SLOTS + slot;
+      break;
+    }
+  }
+  timer->heap_index = list;
+  timer->prev = nullptr;
+  timer->next = wheel->lists[list];
+  if (timer->next != nullptr) {
+    timer->next->prev = timer;
+  }
+  wheel->lists[list] = timer;
+}
+
+/* REQUIRES: wheel->mu locked */
+static void wheel_remove(timer_wheel* wheel, grpc_timer* timer) {
+  uint32_t list = timer->heap_index;
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer->next;
+  } else {
+    wheel->lists[list] = timer->next;
+  }
+  if (timer->next != nullptr) {
+    timer->next->prev = timer->prev;
+  }
+  if (wheel->lists[list] == nullptr && list != WHEEL_OVERFLOW_LIST) {
+    wheel->occupied[list / WHEEL_SLOTS] &=
+        ~(static_cast<uint64_t>(1) << (list % WHEEL_SLOTS));
+  }
+}
+
+/* Unlinks and returns all the timers of a list.
+ * REQUIRES: wheel->mu locked */
+static grpc_timer* wheel_take_list(timer_wheel* wheel, uint32_t list) {
+  grpc_timer* timers = wheel->lists[list];
+  wheel->lists[list] = nullptr;
+  if (list != WHEEL_OVERFLOW_LIST) {
+    wheel->occupied[list / WHEEL_SLOTS] &=
+        ~(static_cast<uint64_t>(1) << (list % WHEEL_SLOTS));
+  }
+  return timers;
+}
+
+/* Returns the first time after wheel->now that a slot with timers is reached,
+ * when the timers run or cascade, or GRPC_MILLIS_INF_FUTURE if the wheel is
+ * empty.
+ * REQUIRES: wheel->mu locked */
+static grpc_millis wheel_next_event(timer_wheel* wheel) {
+  grpc_millis next = GRPC_MILLIS_INF_FUTURE;
+  for (int level = 0; level < WHEEL_LEVELS; level++) {
+    uint64_t occupied = wheel->occupied[level];
+    if (occupied == 0) continue;
+    int shift = WHEEL_SLOT_BITS * level;
+    grpc_millis span_index = wheel->now >> shift;
+    /* Look for the first occupied slot after the current one, which itself
+     * comes around again after all the others. */
+    uint32_t start =
+        static_cast<uint32_t>((span_index + 1) & (WHEEL_SLOTS - 1));
+    if (start != 0) occupied = GPR_ROTR(occupied, start);
+    next = GPR_MIN(next, (span_index + lowest_set_bit(occupied) + 1) << shift);
+  }
+  if (wheel->lists[WHEEL_OVERFLOW_LIST] != nullptr) {
+    next = GPR_MIN(next, (wheel->now / SLOT_SPAN(WHEEL_LEVELS) + 1) *
+                             SLOT_SPAN(WHEEL_LEVELS));
+  }
+  return next;
+}
+
+/* Files the timers of a list again, relative to the current time.
+ * REQUIRES: wheel->mu locked */
+static void wheel_cascade(timer_wheel* wheel, uint32_t list) {
+  grpc_timer* timer = wheel_take_list(wheel, list);
+  while (timer != nullptr) {
+    grpc_timer* next = timer->next;
+    wheel_add(wheel, timer, GPR_MAX(timer->deadline, wheel->now));
+    timer = next;
+  }
+}
+
+/* REQUIRES: wheel->mu locked */
+static size_t wheel_run_list(timer_wheel* wheel, uint32_t list,
+                             grpc_error* error) {
+  size_t n = 0;
+  grpc_timer* timer = wheel_take_list(wheel, list);
+  while (timer != nullptr) {
+    grpc_timer* next = timer->next;
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+      gpr_log(GPR_INFO, "TIMER %p: FIRE %" PRId64 "ms late via %s scheduler",
+              timer, wheel->now - timer->deadline,
+              timer->closure->scheduler->vtable->name);
+    }
+    timer->pending = false;
+    GRPC_CLOSURE_SCHED(timer->closure, GRPC_ERROR_REF(error));
+    n++;
+    timer = next;
+  }
+  return n;
+}
+
+/* Moves the wheel's time forward to now, running the timers due by then.
+ * Skips from one occupied slot to the next, so the cost does not depend on how
+ * much time passed. Returns the number of timers run.
+ * REQUIRES: wheel->mu locked */
+static size_t wheel_advance(timer_wheel* wheel, grpc_millis now,
+                            grpc_error* error) {
+  size_t n = 0;
+  if (now == GRPC_MILLIS_INF_FUTURE) {
+    /* Shutting down: run everything */
+    for (uint32_t list = 0; list <= WHEEL_OVERFLOW_LIST; list++) {
+      n += wheel_run_list(wheel, list, error);
+    }
+    wheel->now = now;
+    return n;
+  }
+  for (;;) {
+    grpc_millis tick = wheel_next_event(wheel);
+    if (tick > now) break;
+    wheel->now = tick;
+    /* Cascade from the top, so that timers moving down a level land in slots
+     * that this tick has yet to reach. */
+    if (tick % SLOT_SPAN(WHEEL_LEVELS) == 0) {
+      wheel_cascade(wheel, WHEEL_OVERFLOW_LIST);
+    }
+    for (int level = WHEEL_LEVELS - 1; level > 0; level--) {
+      if (tick % SLOT_SPAN(level) == 0) {
+        wheel_cascade(wheel, static_cast<uint32_t>(
+                                 level * WHEEL_SLOTS +
+                                 ((tick >> (WHEEL_SLOT_BITS * level)) &
+                                  (WHEEL_SLOTS - 1))));
+      }
+    }
+    n += wheel_run_list(wheel,
+                        static_cast<uint32_t>(tick & (WHEEL_SLOTS - 1)), error);
+  }
+  wheel->now = GPR_MAX(wheel->now, now);
+  return n;
+}
+
+static void timer_list_init() {
+  g_num_wheels = GPR_CLAMP(2 * gpr_cpu_num_cores(), 1, 32);
+  g_wheels =
+      static_cast<timer_wheel*>(gpr_zalloc(g_num_wheels * sizeof(*g_wheels)));
+
+  g_shared_mutables.initialized = true;
+  g_shared_mutables.checker_mu = GPR_SPINLOCK_INITIALIZER;
+  gpr_mu_init(&g_shared_mutables.mu);
+  g_shared_mutables.min_timer = GRPC_MILLIS_INF_FUTURE;
+
+  grpc_millis now = grpc_core::ExecCtx::Get()->Now();
+  for (size_t i = 0; i < g_num_wheels; i++) {
+    timer_wheel* wheel = &g_wheels[i];
+    gpr_mu_init(&wheel->mu);
+    wheel->now = now;
+    wheel->min_deadline = GRPC_MILLIS_INF_FUTURE;
+  }
+}
+
+static void timer_list_shutdown() {
+  grpc_error* error =
+      GRPC_ERROR_CREATE_FROM_STATIC_STRING("Timer list shutdown");
+  for (size_t i = 0; i < g_num_wheels; i++) {
+    timer_wheel* wheel = &g_wheels[i];
+    gpr_mu_lock(&wheel->mu);
+    wheel_advance(wheel, GRPC_MILLIS_INF_FUTURE, error);
+    gpr_mu_unlock(&wheel->mu);
+    gpr_mu_destroy(&wheel->mu);
+  }
+  GRPC_ERROR_UNREF(error);
+  gpr_mu_destroy(&g_shared_mutables.mu);
+  gpr_free(g_wheels);
+  g_shared_mutables.initialized = false;
+}
+
+static void timer_init(grpc_timer* timer, grpc_millis deadline,
+                       grpc_closure* closure) {
+  bool is_first_timer = false;
+  timer_wheel* wheel = &g_wheels[GPR_HASH_POINTER(timer, g_num_wheels)];
+  timer->closure = closure;
+  timer->deadline = deadline;
+
+#ifndef NDEBUG
+  timer->hash_table_next = nullptr;
+#endif
+
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+    gpr_log(GPR_INFO, "TIMER %p: SET %" PRId64 " now %" PRId64 " call %p[%p]",
+            timer, deadline, grpc_core::ExecCtx::Get()->Now(), closure,
+            closure->cb);
+  }
+
+  if (!g_shared_mutables.initialized) {
+    timer->pending = false;
+    GRPC_CLOSURE_SCHED(timer->closure,
+                       GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+                           "Attempt to create timer before initialization"));
+    return;
+  }
+
+  if (deadline <= grpc_core::ExecCtx::Get()->Now()) {
+    timer->pending = false;
+    GRPC_CLOSURE_SCHED(timer->closure, GRPC_ERROR_NONE);
+    return;
+  }
+
+  gpr_mu_lock(&wheel->mu);
+  timer->pending = true;
+  /* The wheel may have run timers past this thread's idea of now */
+  grpc_millis slot_deadline = GPR_MAX(deadline, wheel->now + 1);
+  wheel_add(wheel, timer, slot_deadline);
+  if (slot_deadline < wheel->min_deadline) {
+    wheel->min_deadline = slot_deadline;
+    is_first_timer = true;
+  }
+  gpr_mu_unlock(&wheel->mu);
+
+  /* As in the generic implementation, a racing check may have already run the
+     timer by now, in which case this only causes a spurious wakeup. */
+  if (is_first_timer) {
+    gpr_mu_lock(&g_shared_mutables.mu);
+    if (slot_deadline < g_shared_mutables.min_timer) {
+      store_min_timer(slot_deadline);
+      grpc_kick_poller();
+    }
+    gpr_mu_unlock(&g_shared_mutables.mu);
+  }
+}
+
+static void timer_consume_kick(void) {}
+
+static void timer_cancel(grpc_timer* timer) {
+  if (!g_shared_mutables.initialized) {
+    /* must have already been cancelled, also the wheel mutex is invalid */
+    return;
+  }
+
+  timer_wheel* wheel = &g_wheels[GPR_HASH_POINTER(timer, g_num_wheels)];
+  gpr_mu_lock(&wheel->mu);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+    gpr_log(GPR_INFO, "TIMER %p: CANCEL pending=%s", timer,
+            timer->pending ? "true" : "false");
+  }
+
+  if (timer->pending) {
+    GRPC_CLOSURE_SCHED(timer->closure, GRPC_ERROR_CANCELLED);
+    timer->pending = false;
+    wheel_remove(wheel, timer);
+  }
+  gpr_mu_unlock(&wheel->mu);
+}
+
+static grpc_timer_check_result run_some_expired_timers(grpc_millis now,
+                                                       grpc_millis* next,
+                                                       grpc_error* error) {
+  grpc_timer_check_result result = GRPC_TIMERS_NOT_CHECKED;
+
+  if (gpr_spinlock_trylock(&g_shared_mutables.checker_mu)) {
+    gpr_mu_lock(&g_shared_mutables.mu);
+    result = GRPC_TIMERS_CHECKED_AND_EMPTY;
+    grpc_millis min_timer = GRPC_MILLIS_INF_FUTURE;
+    for (size_t i = 0; i < g_num_wheels; i++) {
+      timer_wheel* wheel = &g_wheels[i];
+      gpr_mu_lock(&wheel->mu);
+      if (wheel->min_deadline <= now) {
+        size_t n = wheel_advance(wheel, now, error);
+        if (n > 0) {
+          result = GRPC_TIMERS_FIRED;
+        }
+        wheel->min_deadline = wheel_next_event(wheel);
+        if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+          gpr_log(GPR_INFO,
+                  "  .. wheel[%d] ran %" PRIdPTR ", min_deadline --> %" PRId64,
+                  static_cast<int>(i), n, wheel->min_deadline);
+        }
+      }
+      min_timer = GPR_MIN(min_timer, wheel->min_deadline);
+      gpr_mu_unlock(&wheel->mu);
+    }
+    if (next != nullptr) {
+      *next = GPR_MIN(*next, min_timer);
+    }
+    store_min_timer(min_timer);
+    gpr_mu_unlock(&g_shared_mutables.mu);
+    gpr_spinlock_unlock(&g_shared_mutables.checker_mu);
+  }
+
+  GRPC_ERROR_UNREF(error);
+
+  return result;
+}
+
+static grpc_timer_check_result timer_check(grpc_millis* next) {
+  grpc_millis now = grpc_core::ExecCtx::Get()->Now();
+  grpc_millis min_timer = load_min_timer();
+
+  if (now < min_timer) {
+    if (next != nullptr) {
+      *next = GPR_MIN(*next, min_timer);
+    }
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+      gpr_log(GPR_INFO, "TIMER CHECK SKIP: now=%" PRId64 " min_timer=%" PRId64,
+              now, min_timer);
+    }
+    return GRPC_TIMERS_CHECKED_AND_EMPTY;
+  }
+
+  grpc_error* shutdown_error =
+      now != GRPC_MILLIS_INF_FUTURE
+          ? GRPC_ERROR_NONE
+          : GRPC_ERROR_CREATE_FROM_STATIC_STRING("Shutting down timer system");
+
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+    gpr_log(GPR_INFO, "TIMER CHECK BEGIN: now=%" PRId64 " min=%" PRId64, now,
+            min_timer);
+  }
+  grpc_timer_check_result r =
+      run_some_expired_timers(now, next, shutdown_error);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+    gpr_log(GPR_INFO, "TIMER CHECK END: r=%d", r);
+  }
+  return r;
+}
+
+grpc_timer_vtable grpc_wheel_timer_vtable = {
+    timer_init,      timer_cancel,        timer_check,
+    timer_list_init, timer_list_shutdown, timer_consume_kick};
+
+grpc_timer_vtable* grpc_select_timer_impl(grpc_timer_vtable* default_vtable) {
+  grpc_core::UniquePtr<char> value = GPR_GLOBAL_CONFIG_GET(grpc_timer_impl);
+  if (strcmp(value.get(), "wheel") == 0) {
+    return &grpc_wheel_timer_vtable;
+  }
+  if (strcmp(value.get(), "generic") != 0) {
+    gpr_log(GPR_ERROR, "Unknown timer implementation %s, using the default",
+            value.get());
+  }
+  return default_vtable;
+}
@@ -0,0 +1,38 @@
+/*
+ *
+ * Copyright 2019 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H
+#define GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/gprpp/global_config.h"
+#include "src/core/lib/iomgr/timer.h"
+
+GPR_GLOBAL_CONFIG_DECLARE_STRING(grpc_timer_impl);
+
+/* Timers kept in hierarchical timing wheels, which arm and cancel in constant
+   time. Suited to processes with many timers that are almost always
+   cancelled, like per-call deadlines. */
+extern grpc_timer_vtable grpc_wheel_timer_vtable;
+
+/* Returns the timer implementation selected by the grpc_timer_impl config:
+   grpc_wheel_timer_vtable for "wheel", otherwise default_vtable. */
+grpc_timer_vtable* grpc_select_timer_impl(grpc_timer_vtable* default_vtable);
+
+#endif /* GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H */
@@ -0,0 +1,263 @@
+/*
+ *
+ * Copyright 2019 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Benchmark HPACK on the header blocks of a Firestore Listen call: parsing
+   the recorded blocks, compressing the request's header values again, and
+   encoding the request's headers on one connection. For huffman coding,
+   range(0) selects the implementation: 0 for the nibble state machine and
+   byte at a time encoder, 1 for the lookup tables and 32 bit encoder. */
+
+#include <benchmark/benchmark.h>
+
+#include <grpc/grpc.h>
+#include <grpc/support/log.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "src/core/ext/transport/chttp2/transport/bin_encoder.h"
+#include "src/core/ext/transport/chttp2/transport/hpack_encoder.h"
+#include "src/core/ext/transport/chttp2/transport/hpack_parser.h"
+#include "src/core/ext/transport/chttp2/transport/huffsyms.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/slice/slice_internal.h"
+#include "src/core/lib/transport/metadata_batch.h"
+
+namespace {
+
+/* All strings are huffman encoded, and added to the dynamic table. */
+
+/* :method: POST, :scheme: https,
+   :path: /google.firestore.v1.Firestore/Listen,
+   :authority: firestore.googleapis.com, content-type: application/grpc,
+   te: trailers, grpc-accept-encoding: identity,deflate,gzip,
+   user-agent: grpc-objc/1.21.0 grpc-c/7.0.0 (ios; chttp2; gizmo),
+   x-goog-api-client: gl-objc/ fire/1.4.0 grpc/,
+   google-cloud-resource-prefix: projects/example-project/databases/(default),
+   authorization: Bearer <ID token, 1007 bytes> */
+const char kRequestHeaders[] =
+    "8387449a62639e6a0abca6b0a849ec2afdc2be13585424f6158ce6424b57419194d615"
+    "093d855e639e6a0a3acc85c87a7f5f8b1d75d0620d263d4c4d65644082497f864d8335"
+    "05b11f408e9acac8b0c842d6958b510f21aa9b903485a9264fafa90b2d03497ea6f66a"
+    "ff7aa59acac8b1e3e84602b882b8149acac8b11875702e053fa31d1f6a1274a6b17da9"
+    "31bdd27fef408cf2b4c73ccb0eb32c4a0c5a93929a858f1f4230a4a6b0ac0576970293"
+    "595918409498e79a82ac4a0f6c8b58541edb0855abb0b29bcfa0aec3f42912860be474"
+    "d74156aec3f42912c48348e31a0a863fa90b28eda13fdf57ffaf05ba51d85b142facb3"
+    "c78886d46cbbb87bc81d26c88c94a6bfdbd91cc9d2e9b45fc33fef4d0d64a80be4f52d"
+    "1cd6173935e8edb3c636a8dfa367a970b3cc9c41e23d77456a334d9f76be5cbdbf3f40"
+    "ecf58a7e6e3fb9bc9edf671e3d97c038f9edf1ae9cdb727abfb1b8cc3fd19c9c43caf2"
+    "d26bd5b7ca76f9693cb5b9168bcb3aca24d1b66d55757816b9f92ecc99767e5efd9318"
+    "2a5b2787b093f13836ddeb7cae68d99314bb2f69aa3be6d0b60aebcd355ee166f65711"
+    "7f4b48e3e83c663c656bcc6b01d4bdaaba3c166bfdf6cbb234d0e5fb05ae9d93f8fddf"
+    "e34696a92604e3d9e8bc3233bee8e6b31695a60116e9aafce03eee126ee7d70f26812d"
+    "d7399daa1bdf4f6693fbc7c934f617a07ad5edc46b765f7df89f549ae4b7cc437715eb"
+    "bc39843355eff63f575ec5ef47e66cf6cbeb297f5d9b4ee172db14f2dab7bf16bdb47b"
+    "32f79472fe35783e3b6a16fafcf30b9e21fcfca7f2c29e6cf237395bef26ade0bd476d"
+    "eec9dc93edf4ffe86a456737499d057ac049ab27596ce714962d1ebe08cdf9157e19c5"
+    "7e6e5f8ce5e6177f4bcaeeed49da7d38dbafbadda1b79fe68ccfe5a7dc4ddedb25d07a"
+    "93f7ad50efcb2121276c5347abf7abda4dc05b7560460a45f9b75e6364caeecc357a99"
+    "ce4f51d5b8b4bb9fa72c1b289623829e388bdfb4d7af9fd83f07bfa7bbb9fd616bb6df"
+    "0dc52ebe5ed3aadfdd14c52efb6c94bd23ef7aeeaef36a9e1c7778f5cc98fdc7f9a656"
+    "7ac3e5b5f67569b767af643ce7bcdef6ec7f115c97ccaee1e4e072db9f8fe92dc12766"
+    "7d78cb7a7c38c5e87e1bd77b251df078c254de371c9b8a1adbcfdbf316a9b1eaedcd67"
+    "37a16ef24b63d4eba1fd8ef9d2ef7d7896d96c58bf6be2ee0e59af66a75b3c2dedef8e"
+    "aa7bf44d2ebdd1ea2edb68248ff74eddf36177d6cce67c3bbc79c7c78f5c97baa692fb"
+    "73971ed971149eff6a9618c98f16377d705af3a02970fe9ff7f44297713aa0fb7554ef"
+    "a063cbd79dfcdb7bfbc5e56bb96adffbf91d91d5d067bf926fddb8ff136cc5a3f78c35"
+    "3fcefebf1467e0edbd9ce5d3265c28a8599364dae4d715ad8f7efb786285af3db6e5be"
+    "c937de66deb4cafb79f37edbf93669517b0e14e97b1c517bc5db07ef4f76b8b6e0c7d3"
+    "17";
+
+/* :status: 200, content-type: application/grpc,
+   date: Fri, 18 Oct 2019 03:41:57 GMT,
+   alt-svc: quic=":443"; ma=2592000; v="46,43,39", server: ESF,
+   x-xss-protection: 0, x-frame-options: SAMEORIGIN */
+const char kResponseHeaders[] =
+    "885f8b1d75d0620d263d4c4d65646196c361be940bca6a22541002fa8066e341b8dbaa"
+    "62d1bf40851d09591dc99fed698907f371a699fe7ed4a47009b7c40003ed4ef07f2d39"
+    "f4d33f4cbffcff7683c1bb0f408cf2b794216aec3a4a4498f57f8107408bf2b4b60e92"
+    "ac7ad263d48f89dd0e8c1ab6e4c5934f";
+
+/* grpc-status: 5,
+   grpc-message: No document to update: projects/example-project/databases/
+                 (default)/documents/rooms/abc */
+const char kTrailers[] =
+    "40889acac8b21234da8f816f40899acac8b5254207317fbed27524392da4b525449d4b"
+    "6b90692dc52bb0fd0a44a182f91d35d055abb0fd0a44b120d238c682a18fea42ca3b68"
+    "4ff6c48725b496a4a18b0e7a50c0e327";
+
+grpc_slice HexSlice(const char* hex) {
+  size_t length = strlen(hex) / 2;
+  grpc_slice slice = GRPC_SLICE_MALLOC(length);
+  uint8_t* out = GRPC_SLICE_START_PTR(slice);
+  for (size_t i = 0; i < length; i++) {
+    GPR_ASSERT(sscanf(hex + 2 * i, "%2hhx", &out[i]) == 1);
+  }
+  return slice;
+}
+
+void UseHuffmanImpl(benchmark::State& state) {
+  g_hpack_huffman_tables_enabled = state.range(0) != 0;
+  state.SetLabel(g_hpack_huffman_tables_enabled ? "table" : "nibble");
+}
+
+void UnrefHeader(void* user_data, grpc_mdelem md) { GRPC_MDELEM_UNREF(md); }
+
+void BM_HpackParserParse(benchmark::State& state, const char* block) {
+  UseHuffmanImpl(state);
+  grpc_core::ExecCtx exec_ctx;
+  grpc_slice slice = HexSlice(block);
+  grpc_chttp2_hpack_parser p;
+  grpc_chttp2_hpack_parser_init(&p);
+  p.on_header = UnrefHeader;
+  for (auto _ : state) {
+    GPR_ASSERT(grpc_chttp2_hpack_parser_parse(&p, slice) == GRPC_ERROR_NONE);
+    exec_ctx.Flush();
+  }
+  grpc_chttp2_hpack_parser_destroy(&p);
+  state.SetBytesProcessed(state.iterations() * GRPC_SLICE_LENGTH(slice));
+  grpc_slice_unref_internal(slice);
+}
+BENCHMARK_CAPTURE(BM_HpackParserParse, request, kRequestHeaders)
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_CAPTURE(BM_HpackParserParse, response, kResponseHeaders)
+    ->Arg(0)
+    ->Arg(1);
+BENCHMARK_CAPTURE(BM_HpackParserParse, trailers, kTrailers)->Arg(0)->Arg(1);
+
+void CollectValue(void* user_data, grpc_mdelem md) {
+  static_cast<std::vector<grpc_slice>*>(user_data)->push_back(
+      grpc_slice_ref_internal(GRPC_MDVALUE(md)));
+  GRPC_MDELEM_UNREF(md);
+}
+
+void BM_HuffmanCompress(benchmark::State& state) {
+  UseHuffmanImpl(state);
+  grpc_core::ExecCtx exec_ctx;
+  std::vector<grpc_slice> values;
+  grpc_slice slice = HexSlice(kRequestHeaders);
+  grpc_chttp2_hpack_parser p;
+  grpc_chttp2_hpack_parser_init(&p);
+  p.on_header = CollectValue;
+  p.on_header_user_data = &values;
+  GPR_ASSERT(grpc_chttp2_hpack_parser_parse(&p, slice) == GRPC_ERROR_NONE);
+  grpc_chttp2_hpack_parser_destroy(&p);
+  grpc_slice_unref_internal(slice);
+  size_t bytes = 0;
+  for (grpc_slice value : values) {
+    bytes += GRPC_SLICE_LENGTH(value);
+  }
+  for (auto _ : state) {
+    for (grpc_slice value : values) {
+      grpc_slice_unref_internal(grpc_chttp2_huffman_compress(value));
+    }
+  }
+  for (grpc_slice value : values) {
+    grpc_slice_unref_internal(value);
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_HuffmanCompress)->Arg(0)->Arg(1);
+
+/* binary metadata, such as grpc-status-details-bin, of range(1) bytes */
+void BM_Base64EncodeAndHuffmanCompress(benchmark::State& state) {
+  UseHuffmanImpl(state);
+  grpc_core::ExecCtx exec_ctx;
+  std::string value;
+  for (int64_t i = 0; i < state.range(1); i++) {
+    value.push_back(static_cast<char>(i * 7919));
+  }
+  grpc_slice slice = grpc_slice_from_copied_buffer(value.data(), value.size());
+  for (auto _ : state) {
+    grpc_slice_unref_internal(
+        grpc_chttp2_base64_encode_and_huffman_compress(slice));
+  }
+  grpc_slice_unref_internal(slice);
+  state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_Base64EncodeAndHuffmanCompress)
+    ->Args({0, 32})
+    ->Args({1, 32})
+    ->Args({0, 512})
+    ->Args({1, 512});
+
+void CollectHeader(void* user_data, grpc_mdelem md) {
+  static_cast<std::vector<grpc_mdelem>*>(user_data)->push_back(md);
+}
+
+/* range(0) selects the index policy: 0 for the popularity filter, 1 for the
+   adaptive policy. The counters are the header block bytes sent per call. */
+void BM_HpackEncoderEncodeHeader(benchmark::State& state) {
+  g_hpack_adaptive_indexing_enabled = state.range(0) != 0;
+  state.SetLabel(g_hpack_adaptive_indexing_enabled ? "adaptive" : "filter");
+  grpc_core::ExecCtx exec_ctx;
+  std::vector<grpc_mdelem> headers;
+  grpc_slice slice = HexSlice(kRequestHeaders);
+  grpc_chttp2_hpack_parser p;
+  grpc_chttp2_hpack_parser_init(&p);
+  p.on_header = CollectHeader;
+  p.on_header_user_data = &headers;
+  GPR_ASSERT(grpc_chttp2_hpack_parser_parse(&p, slice) == GRPC_ERROR_NONE);
+  grpc_chttp2_hpack_parser_destroy(&p);
+  grpc_slice_unref_internal(slice);
+  std::vector<grpc_mdelem*> extra_headers;
+  for (grpc_mdelem& md : headers) {
+    extra_headers.push_back(&md);
+  }
+  grpc_chttp2_hpack_compressor c;
+  grpc_chttp2_hpack_compressor_init(&c);
+  grpc_metadata_batch b;
+  grpc_metadata_batch_init(&b);
+  grpc_transport_one_way_stats stats;
+  grpc_encode_header_options options = {1, false, false, 16384, &stats};
+  grpc_slice_buffer outbuf;
+  grpc_slice_buffer_init(&outbuf);
+  for (auto _ : state) {
+    grpc_chttp2_encode_header(&c, extra_headers.data(), extra_headers.size(),
+                              &b, &options, &outbuf);
+    grpc_slice_buffer_reset_and_unref_internal(&outbuf);
+    exec_ctx.Flush();
+  }
+  state.counters["indexed"] = benchmark::Counter(
+      c.indexed_bytes, benchmark::Counter::kAvgIterations);
+  state.counters["incremental"] = benchmark::Counter(
+      c.incremental_bytes, benchmark::Counter::kAvgIterations);
+  state.counters["literal"] = benchmark::Counter(
+      c.literal_bytes, benchmark::Counter::kAvgIterations);
+  grpc_slice_buffer_destroy_internal(&outbuf);
+  grpc_metadata_batch_destroy(&b);
+  grpc_chttp2_hpack_compressor_destroy(&c);
+  for (grpc_mdelem md : headers) {
+    GRPC_MDELEM_UNREF(md);
+  }
+}
+BENCHMARK(BM_HpackEncoderEncodeHeader)->Arg(0)->Arg(1);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  grpc_init();
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  grpc_shutdown();
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ *
+ * Copyright 2019 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Benchmark arming and cancelling grpc_timers the way per-call deadlines do:
+   each thread keeps a window of range(0) outstanding timers, due between
+   range(1) / 10 and range(1) milliseconds out, and every iteration arms a new
+   one and cancels the oldest, usually before it fires.
+
+   Compare the implementations by running with GRPC_TIMER_IMPL=generic and
+   GRPC_TIMER_IMPL=wheel. */
+
+#include <benchmark/benchmark.h>
+
+#include <grpc/grpc.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/timer.h"
+
+namespace {
+
+struct TimerState {
+  grpc_timer timer;
+  grpc_closure closure;
+  /* Set until the closure runs */
+  std::atomic<bool> armed{false};
+};
+
+void OnTimer(void* arg, grpc_error* error) {
+  static_cast<TimerState*>(arg)->armed.store(false, std::memory_order_release);
+}
+
+void Arm(TimerState* t, grpc_millis deadline) {
+  t->armed.store(true, std::memory_order_relaxed);
+  grpc_timer_init(&t->timer, deadline, &t->closure);
+}
+
+void BM_TimerArmCancel(benchmark::State& state) {
+  const size_t outstanding = static_cast<size_t>(state.range(0));
+  std::vector<TimerState> timers(outstanding);
+  std::mt19937 rng{std::random_device{}()};
+  std::uniform_int_distribution<grpc_millis> deadline_ms(state.range(1) / 10,
+                                                         state.range(1));
+
+  grpc_core::ExecCtx exec_ctx;
+  for (TimerState& t : timers) {
+    GRPC_CLOSURE_INIT(&t.closure, OnTimer, &t, grpc_schedule_on_exec_ctx);
+    Arm(&t, exec_ctx.Now() + deadline_ms(rng));
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    TimerState& t = timers[next];
+    grpc_timer_cancel(&t.timer);
+    exec_ctx.Flush();
+    /* If the timer fired instead, its closure may still be queued elsewhere */
+    while (t.armed.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    Arm(&t, exec_ctx.Now() + deadline_ms(rng));
+    next = next + 1 == outstanding ? 0 : next + 1;
+  }
+  for (TimerState& t : timers) {
+    grpc_timer_cancel(&t.timer);
+  }
+  exec_ctx.Flush();
+  for (TimerState& t : timers) {
+    while (t.armed.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerArmCancel)
+    ->Args({1000, 1000})
+    ->Args({100000, 1000})
+    ->Args({1000, 30000})
+    ->Args({100000, 30000})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  grpc_init();
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  grpc_shutdown();
+  return 0;
+}
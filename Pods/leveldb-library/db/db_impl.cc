@@ -45,7 +45,30 @@ struct DBImpl::Writer {
   bool done;
   port::CondVar cv;
 
-  explicit Writer(port::Mutex* mu) : cv(mu) { }
+  // Only used by the leader of a batch group in pipelined write mode,
+  // while the group waits for or runs its memtable insert.
+  WriteBatch* group_batch;          // Combined batch of the group
+  SequenceNumber last_sequence;     // Last sequence number of group_batch
+  std::vector<Writer*> followers;   // Other writers of the group
+
+  // Set by the group leader when this writer should insert its own batch
+  // into the memtable (see InsertGroupConcurrently()).
+  ConcurrentInsertGroup* insert_group;
+
+  explicit Writer(port::Mutex* mu)
+      : cv(mu), group_batch(NULL), last_sequence(0), insert_group(NULL) { }
+};
+
+// A batch group whose writers each insert their own batch into the
+// memtable on their own thread.  Protected by DBImpl::mutex_.
+struct DBImpl::ConcurrentInsertGroup {
+  MemTable* const mem;  // Immutable: memtable to insert into
+  int running;          // Followers still inserting
+  Status status;        // First error reported by a follower
+  port::CondVar cv;     // Signalled when running drops to zero
+
+  ConcurrentInsertGroup(port::Mutex* mu, MemTable* m)
+      : mem(m), running(0), cv(mu) { }
 };
 
 struct DBImpl::CompactionState {
@@ -65,19 +88,63 @@ struct DBImpl::CompactionState {
   };
   std::vector<Output> outputs;
 
+  // Key ranges of the compaction, in increasing key order.  A compaction
+  // that is not split has a single subcompaction.
+  std::vector<SubcompactionState*> subcompactions;
+
+  // Index of the next subcompaction to be merged, and number of
+  // subcompactions being merged.  Protected by mutex_.
+  size_t next_subcompaction;
+  int subcompactions_running;
+
+  uint64_t total_bytes;
+
+  explicit CompactionState(Compaction* c)
+      : compaction(c),
+        next_subcompaction(0),
+        subcompactions_running(0),
+        total_bytes(0) {
+  }
+};
+
+// Work for one key range of a compaction.  Entries whose user keys fall
+// in (begin, end] are merged into this subcompaction's own output files;
+// a missing bound means the range is unbounded on that side.
+struct DBImpl::SubcompactionState {
+  CompactionState* const compact;
+  DBImpl* const db;
+
+  bool has_begin;
+  bool has_end;
+  std::string begin;
+  std::string end;
+
+  // Per-range cursor for IsBaseLevelForKey() and ShouldStopBefore()
+  Compaction::ScanState scan;
+
+  std::vector<CompactionState::Output> outputs;
+
   // State kept for output being generated
   WritableFile* outfile;
   TableBuilder* builder;
 
   uint64_t total_bytes;
+  int64_t imm_micros;  // Micros spent doing imm_ compactions
+  Status status;
 
-  Output* current_output() { return &outputs[outputs.size()-1]; }
+  CompactionState::Output* current_output() {
+    return &outputs[outputs.size()-1];
+  }
 
-  explicit CompactionState(Compaction* c)
-      : compaction(c),
+  SubcompactionState(CompactionState* c, DBImpl* d)
+      : compact(c),
+        db(d),
+        has_begin(false),
+        has_end(false),
         outfile(NULL),
         builder(NULL),
-        total_bytes(0) {
+        total_bytes(0),
+        imm_micros(0) {
   }
 };
 
@@ -98,6 +165,8 @@ Options SanitizeOptions(const std::string& dbname,
   ClipToRange(&result.write_buffer_size, 64<<10,                      1<<30);
   ClipToRange(&result.max_file_size,     1<<20,                       1<<30);
   ClipToRange(&result.block_size,        1<<10,                       4<<20);
+  ClipToRange(&result.max_subcompactions, 1,                          64);
+  ClipToRange(&result.block_cache_shard_bits, 0,                      16);
   if (result.info_log == NULL) {
     // Open a log file in the same directory as the db
     src.env->CreateDir(dbname);  // In case it does not exist
@@ -109,7 +178,13 @@ Options SanitizeOptions(const std::string& dbname,
     }
   }
   if (result.block_cache == NULL) {
-    result.block_cache = NewLRUCache(8 << 20);
+    if (result.block_cache_type == kClockCache) {
+      result.block_cache = NewClockCache(8 << 20,
+                                         result.block_cache_shard_bits);
+    } else {
+      result.block_cache = NewLRUCache(8 << 20,
+                                       result.block_cache_shard_bits);
+    }
   }
   return result;
 }
@@ -134,8 +209,17 @@ DBImpl::DBImpl(const Options& raw_options, const std::string& dbname)
       seed_(0),
       tmp_batch_(new WriteBatch),
       bg_compaction_scheduled_(false),
+      bg_compaction_running_(false),
+      subcompacting_(NULL),
+      bg_subcompaction_helpers_(0),
+      bg_flush_scheduled_(false),
+      imm_flush_running_(false),
+      manifest_writing_(false),
       manual_compaction_(NULL) {
   has_imm_.Release_Store(NULL);
+  BackgroundQueueStats unused;
+  flush_in_background_ =
+      env_->GetBackgroundQueueStats(Env::kHighPriority, &unused);
 
   // Reserve ten files or so for other uses and give the rest to TableCache.
   const int table_cache_size = options_.max_open_files - kNumNonTableCacheFiles;
@@ -149,7 +233,8 @@ DBImpl::~DBImpl() {
   // Wait for background work to finish
   mutex_.Lock();
   shutting_down_.Release_Store(this);  // Any non-NULL value is ok
-  while (bg_compaction_scheduled_) {
+  while (bg_compaction_scheduled_ || bg_flush_scheduled_ ||
+         bg_subcompaction_helpers_ > 0) {
     bg_cv_.Wait();
   }
   mutex_.Unlock();
@@ -438,7 +523,7 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
     if (mem->ApproximateMemoryUsage() > options_.write_buffer_size) {
       compactions++;
       *save_manifest = true;
-      status = WriteLevel0Table(mem, edit, NULL);
+      status = WriteLevel0Table(mem, edit, NULL, NULL);
       mem->Unref();
       mem = NULL;
       if (!status.ok()) {
@@ -477,7 +562,7 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
     // mem did not get reused; compact it.
     if (status.ok()) {
       *save_manifest = true;
-      status = WriteLevel0Table(mem, edit, NULL);
+      status = WriteLevel0Table(mem, edit, NULL, NULL);
     }
     mem->Unref();
   }
@@ -486,7 +571,7 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
 }
 
 Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
-                                Version* base) {
+                                Version* base, uint64_t* pending_number) {
   mutex_.AssertHeld();
   const uint64_t start_micros = env_->NowMicros();
   FileMetaData meta;
@@ -508,7 +593,11 @@ Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
       (unsigned long long) meta.file_size,
       s.ToString().c_str());
   delete iter;
-  pending_outputs_.erase(meta.number);
+  if (pending_number != NULL) {
+    *pending_number = meta.number;
+  } else {
+    pending_outputs_.erase(meta.number);
+  }
 
 
   // Note that if file_size is zero, the file has been deleted and
@@ -517,8 +606,12 @@ Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
   if (s.ok() && meta.file_size > 0) {
     const Slice min_user_key = meta.smallest.user_key();
     const Slice max_user_key = meta.largest.user_key();
-    if (base != NULL) {
-      level = base->PickLevelForMemTableOutput(min_user_key, max_user_key);
+    // Only a level-0 table is safe while a compaction is running, since
+    // the compaction's output may overlap it in any deeper level.  "base"
+    // may be stale by now, so pick from the current version.
+    if (base != NULL && !bg_compaction_running_) {
+      level = versions_->current()->PickLevelForMemTableOutput(
+          min_user_key, max_user_key);
     }
     edit->AddFile(level, meta.number, meta.file_size,
                   meta.smallest, meta.largest);
@@ -539,7 +632,8 @@ void DBImpl::CompactMemTable() {
   VersionEdit edit;
   Version* base = versions_->current();
   base->Ref();
-  Status s = WriteLevel0Table(imm_, &edit, base);
+  uint64_t number;
+  Status s = WriteLevel0Table(imm_, &edit, base, &number);
   base->Unref();
 
   if (s.ok() && shutting_down_.Acquire_Load()) {
@@ -550,8 +644,11 @@ void DBImpl::CompactMemTable() {
   if (s.ok()) {
     edit.SetPrevLogNumber(0);
     edit.SetLogNumber(logfile_number_);  // Earlier logs no longer needed
-    s = versions_->LogAndApply(&edit, &mutex_);
+    s = LogAndApply(&edit);
   }
+  // A compaction may have deleted obsolete files while the table was
+  // waiting to be logged, so it was protected until now.
+  pending_outputs_.erase(number);
 
   if (s.ok()) {
     // Commit to the new state
@@ -642,24 +739,70 @@ void DBImpl::RecordBackgroundError(const Status& s) {
   }
 }
 
+Status DBImpl::LogAndApply(VersionEdit* edit) {
+  mutex_.AssertHeld();
+  while (manifest_writing_) {
+    bg_cv_.Wait();
+  }
+  manifest_writing_ = true;
+  Status s = versions_->LogAndApply(edit, &mutex_);
+  manifest_writing_ = false;
+  bg_cv_.SignalAll();
+  return s;
+}
+
 void DBImpl::MaybeScheduleCompaction() {
   mutex_.AssertHeld();
-  if (bg_compaction_scheduled_) {
-    // Already scheduled
-  } else if (shutting_down_.Acquire_Load()) {
+  if (shutting_down_.Acquire_Load()) {
     // DB is being deleted; no more background compactions
+    return;
   } else if (!bg_error_.ok()) {
     // Already got an error; no more changes
-  } else if (imm_ == NULL &&
-             manual_compaction_ == NULL &&
+    return;
+  }
+
+  // Memtable flushes go to the high priority queue so that writers
+  // waiting for room do not wait behind a long compaction.
+  if (imm_ != NULL && !bg_flush_scheduled_ && !imm_flush_running_) {
+    bg_flush_scheduled_ = true;
+    env_->Schedule(&DBImpl::BGFlushWork, this, Env::kHighPriority);
+  }
+
+  if (bg_compaction_scheduled_) {
+    // Already scheduled
+  } else if (manual_compaction_ == NULL &&
              !versions_->NeedsCompaction()) {
     // No work to be done
   } else {
     bg_compaction_scheduled_ = true;
-    env_->Schedule(&DBImpl::BGWork, this);
+    env_->Schedule(&DBImpl::BGWork, this, Env::kLowPriority);
   }
 }
 
+void DBImpl::BGFlushWork(void* db) {
+  reinterpret_cast<DBImpl*>(db)->BackgroundFlushCall();
+}
+
+void DBImpl::BackgroundFlushCall() {
+  MutexLock l(&mutex_);
+  assert(bg_flush_scheduled_);
+  if (shutting_down_.Acquire_Load()) {
+    // No more background work when shutting down.
+  } else if (!bg_error_.ok()) {
+    // No more background work after a background error.
+  } else if (imm_ != NULL && !imm_flush_running_) {
+    imm_flush_running_ = true;
+    CompactMemTable();
+    imm_flush_running_ = false;
+  }
+
+  bg_flush_scheduled_ = false;
+
+  // The new level-0 file may call for a compaction.
+  MaybeScheduleCompaction();
+  bg_cv_.SignalAll();
+}
+
 void DBImpl::BGWork(void* db) {
   reinterpret_cast<DBImpl*>(db)->BackgroundCall();
 }
@@ -667,12 +810,19 @@ void DBImpl::BGWork(void* db) {
 void DBImpl::BackgroundCall() {
   MutexLock l(&mutex_);
   assert(bg_compaction_scheduled_);
+  // A flush that started before this compaction picks the level of its
+  // table from the current version, so let it finish first.
+  while (imm_flush_running_ && !shutting_down_.Acquire_Load()) {
+    bg_cv_.Wait();
+  }
   if (shutting_down_.Acquire_Load()) {
     // No more background work when shutting down.
   } else if (!bg_error_.ok()) {
     // No more background work after a background error.
   } else {
+    bg_compaction_running_ = true;
     BackgroundCompaction();
+    bg_compaction_running_ = false;
   }
 
   bg_compaction_scheduled_ = false;
@@ -686,11 +836,6 @@ void DBImpl::BackgroundCall() {
 void DBImpl::BackgroundCompaction() {
   mutex_.AssertHeld();
 
-  if (imm_ != NULL) {
-    CompactMemTable();
-    return;
-  }
-
   Compaction* c;
   bool is_manual = (manual_compaction_ != NULL);
   InternalKey manual_end;
@@ -721,7 +866,7 @@ void DBImpl::BackgroundCompaction() {
     c->edit()->DeleteFile(c->level(), f->number);
     c->edit()->AddFile(c->level() + 1, f->number, f->file_size,
                        f->smallest, f->largest);
-    status = versions_->LogAndApply(c->edit(), &mutex_);
+    status = LogAndApply(c->edit());
     if (!status.ok()) {
       RecordBackgroundError(status);
     }
@@ -770,24 +915,28 @@ void DBImpl::BackgroundCompaction() {
 
 void DBImpl::CleanupCompaction(CompactionState* compact) {
   mutex_.AssertHeld();
-  if (compact->builder != NULL) {
-    // May happen if we get a shutdown call in the middle of compaction
-    compact->builder->Abandon();
-    delete compact->builder;
-  } else {
-    assert(compact->outfile == NULL);
-  }
-  delete compact->outfile;
-  for (size_t i = 0; i < compact->outputs.size(); i++) {
-    const CompactionState::Output& out = compact->outputs[i];
-    pending_outputs_.erase(out.number);
+  for (size_t i = 0; i < compact->subcompactions.size(); i++) {
+    SubcompactionState* sub = compact->subcompactions[i];
+    if (sub->builder != NULL) {
+      // May happen if we get a shutdown call in the middle of compaction
+      sub->builder->Abandon();
+      delete sub->builder;
+    } else {
+      assert(sub->outfile == NULL);
+    }
+    delete sub->outfile;
+    for (size_t j = 0; j < sub->outputs.size(); j++) {
+      const CompactionState::Output& out = sub->outputs[j];
+      pending_outputs_.erase(out.number);
+    }
+    delete sub;
   }
   delete compact;
 }
 
-Status DBImpl::OpenCompactionOutputFile(CompactionState* compact) {
-  assert(compact != NULL);
-  assert(compact->builder == NULL);
+Status DBImpl::OpenCompactionOutputFile(SubcompactionState* sub) {
+  assert(sub != NULL);
+  assert(sub->builder == NULL);
   uint64_t file_number;
   {
     mutex_.Lock();
@@ -797,51 +946,51 @@ Status DBImpl::OpenCompactionOutputFile(CompactionState* compact) {
     out.number = file_number;
     out.smallest.Clear();
     out.largest.Clear();
-    compact->outputs.push_back(out);
+    sub->outputs.push_back(out);
     mutex_.Unlock();
   }
 
   // Make the output file
   std::string fname = TableFileName(dbname_, file_number);
-  Status s = env_->NewWritableFile(fname, &compact->outfile);
+  Status s = env_->NewWritableFile(fname, &sub->outfile);
   if (s.ok()) {
-    compact->builder = new TableBuilder(options_, compact->outfile);
+    sub->builder = new TableBuilder(options_, sub->outfile);
   }
   return s;
 }
 
-Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
+Status DBImpl::FinishCompactionOutputFile(SubcompactionState* sub,
                                           Iterator* input) {
-  assert(compact != NULL);
-  assert(compact->outfile != NULL);
-  assert(compact->builder != NULL);
+  assert(sub != NULL);
+  assert(sub->outfile != NULL);
+  assert(sub->builder != NULL);
 
-  const uint64_t output_number = compact->current_output()->number;
+  const uint64_t output_number = sub->current_output()->number;
   assert(output_number != 0);
 
   // Check for iterator errors
   Status s = input->status();
-  const uint64_t current_entries = compact->builder->NumEntries();
+  const uint64_t current_entries = sub->builder->NumEntries();
   if (s.ok()) {
-    s = compact->builder->Finish();
+    s = sub->builder->Finish();
   } else {
-    compact->builder->Abandon();
+    sub->builder->Abandon();
   }
-  const uint64_t current_bytes = compact->builder->FileSize();
-  compact->current_output()->file_size = current_bytes;
-  compact->total_bytes += current_bytes;
-  delete compact->builder;
-  compact->builder = NULL;
+  const uint64_t current_bytes = sub->builder->FileSize();
+  sub->current_output()->file_size = current_bytes;
+  sub->total_bytes += current_bytes;
+  delete sub->builder;
+  sub->builder = NULL;
 
   // Finish and check for file errors
   if (s.ok()) {
-    s = compact->outfile->Sync();
+    s = sub->outfile->Sync();
   }
   if (s.ok()) {
-    s = compact->outfile->Close();
+    s = sub->outfile->Close();
   }
-  delete compact->outfile;
-  compact->outfile = NULL;
+  delete sub->outfile;
+  sub->outfile = NULL;
 
   if (s.ok() && current_entries > 0) {
     // Verify that the table is usable
@@ -854,7 +1003,7 @@ Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
       Log(options_.info_log,
           "Generated table #%llu@%d: %lld keys, %lld bytes",
           (unsigned long long) output_number,
-          compact->compaction->level(),
+          sub->compact->compaction->level(),
           (unsigned long long) current_entries,
           (unsigned long long) current_bytes);
     }
@@ -881,12 +1030,37 @@ Status DBImpl::InstallCompactionResults(CompactionState* compact) {
         level + 1,
         out.number, out.file_size, out.smallest, out.largest);
   }
-  return versions_->LogAndApply(compact->compaction->edit(), &mutex_);
+  return LogAndApply(compact->compaction->edit());
+}
+
+void DBImpl::BGSubcompactionWork(void* db) {
+  DBImpl* impl = reinterpret_cast<DBImpl*>(db);
+  MutexLock l(&impl->mutex_);
+  impl->RunSubcompactions();
+  impl->bg_subcompaction_helpers_--;
+  impl->bg_cv_.SignalAll();
+}
+
+// Merge ranges of subcompacting_ until none is left to start.
+void DBImpl::RunSubcompactions() {
+  mutex_.AssertHeld();
+  while (subcompacting_ != NULL &&
+         subcompacting_->next_subcompaction <
+             subcompacting_->subcompactions.size()) {
+    CompactionState* compact = subcompacting_;
+    SubcompactionState* sub =
+        compact->subcompactions[compact->next_subcompaction++];
+    compact->subcompactions_running++;
+    mutex_.Unlock();
+    DoSubcompactionWork(sub);
+    mutex_.Lock();
+    compact->subcompactions_running--;
+    bg_cv_.SignalAll();
+  }
 }
 
 Status DBImpl::DoCompactionWork(CompactionState* compact) {
   const uint64_t start_micros = env_->NowMicros();
-  int64_t imm_micros = 0;  // Micros spent doing imm_ compactions
 
   Log(options_.info_log,  "Compacting %d@%d + %d@%d files",
       compact->compaction->num_input_files(0),
@@ -895,41 +1069,153 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
       compact->compaction->level() + 1);
 
   assert(versions_->NumLevelFiles(compact->compaction->level()) > 0);
-  assert(compact->builder == NULL);
-  assert(compact->outfile == NULL);
+  assert(compact->subcompactions.empty());
   if (snapshots_.empty()) {
     compact->smallest_snapshot = versions_->LastSequence();
   } else {
     compact->smallest_snapshot = snapshots_.oldest()->number_;
   }
 
-  // Release mutex while we're actually doing the compaction work
+  // Split large compactions into key ranges that can be merged
+  // concurrently.  There is no point in making a range smaller than
+  // one output file.
+  std::vector<std::string> boundaries;
+  if (options_.max_subcompactions > 1) {
+    uint64_t input_bytes = 0;
+    for (int which = 0; which < 2; which++) {
+      for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
+        input_bytes += compact->compaction->input(which, i)->file_size;
+      }
+    }
+    const uint64_t max_ranges =
+        input_bytes / compact->compaction->MaxOutputFileSize();
+    const int n = static_cast<int>(std::min<uint64_t>(
+        options_.max_subcompactions, max_ranges));
+    compact->compaction->GetSubcompactionBoundaries(n, &boundaries);
+  }
+  for (size_t i = 0; i <= boundaries.size(); i++) {
+    SubcompactionState* sub = new SubcompactionState(compact, this);
+    if (i > 0) {
+      sub->has_begin = true;
+      sub->begin = boundaries[i - 1];
+    }
+    if (i < boundaries.size()) {
+      sub->has_end = true;
+      sub->end = boundaries[i];
+    }
+    compact->subcompactions.push_back(sub);
+  }
+  if (compact->subcompactions.size() > 1) {
+    Log(options_.info_log, "Splitting compaction into %d subcompactions",
+        static_cast<int>(compact->subcompactions.size()));
+  }
+
+  // Helpers from the low priority pool merge ranges alongside this
+  // thread.  The pool may be busy, or its only thread may be this one, so
+  // this thread also merges every range no helper has started, and then
+  // only waits for ranges still being merged.  Helpers that run after
+  // that find nothing left to do.  The mutex is released while merging.
+  subcompacting_ = compact;
+  for (size_t i = 1; i < compact->subcompactions.size(); i++) {
+    bg_subcompaction_helpers_++;
+    env_->Schedule(&DBImpl::BGSubcompactionWork, this, Env::kLowPriority);
+  }
+  RunSubcompactions();
+  while (compact->subcompactions_running > 0) {
+    bg_cv_.Wait();
+  }
+  subcompacting_ = NULL;
   mutex_.Unlock();
 
-  Iterator* input = versions_->MakeInputIterator(compact->compaction);
-  input->SeekToFirst();
+  // Ranges are in key order, so their outputs can simply be concatenated
   Status status;
+  int64_t imm_micros = 0;  // Micros spent doing imm_ compactions
+  for (size_t i = 0; i < compact->subcompactions.size(); i++) {
+    const SubcompactionState* sub = compact->subcompactions[i];
+    if (status.ok()) {
+      status = sub->status;
+    }
+    compact->outputs.insert(compact->outputs.end(),
+                            sub->outputs.begin(), sub->outputs.end());
+    compact->total_bytes += sub->total_bytes;
+    imm_micros += sub->imm_micros;
+  }
+
+  CompactionStats stats;
+  stats.micros = env_->NowMicros() - start_micros - imm_micros;
+  for (int which = 0; which < 2; which++) {
+    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
+      stats.bytes_read += compact->compaction->input(which, i)->file_size;
+    }
+  }
+  for (size_t i = 0; i < compact->outputs.size(); i++) {
+    stats.bytes_written += compact->outputs[i].file_size;
+  }
+
+  mutex_.Lock();
+  stats_[compact->compaction->level() + 1].Add(stats);
+
+  if (status.ok()) {
+    status = InstallCompactionResults(compact);
+  }
+  if (!status.ok()) {
+    RecordBackgroundError(status);
+  }
+  VersionSet::LevelSummaryStorage tmp;
+  Log(options_.info_log,
+      "compacted to: %s", versions_->LevelSummary(&tmp));
+  return status;
+}
+
+void DBImpl::DoSubcompactionWork(SubcompactionState* sub) {
+  CompactionState* const compact = sub->compact;
+  Compaction* const c = compact->compaction;
+  assert(sub->builder == NULL);
+  assert(sub->outfile == NULL);
+
+  Iterator* input = versions_->MakeInputIterator(c);
   ParsedInternalKey ikey;
+  if (sub->has_begin) {
+    // Skip every entry for the last user key of the previous range
+    input->Seek(
+        InternalKey(sub->begin, 0, static_cast<ValueType>(0)).Encode());
+    while (input->Valid() && ParseInternalKey(input->key(), &ikey) &&
+           user_comparator()->Compare(ikey.user_key, sub->begin) <= 0) {
+      input->Next();
+    }
+  } else {
+    input->SeekToFirst();
+  }
+  Status status;
   std::string current_user_key;
   bool has_current_user_key = false;
   SequenceNumber last_sequence_for_key = kMaxSequenceNumber;
   for (; input->Valid() && !shutting_down_.Acquire_Load(); ) {
-    // Prioritize immutable compaction work
-    if (has_imm_.NoBarrier_Load() != NULL) {
+    // Prioritize immutable compaction work, unless the flush job can run
+    // alongside this compaction.  Only one thread at a time may flush
+    // imm_, since CompactMemTable() releases mutex_.
+    if (!flush_in_background_ && has_imm_.NoBarrier_Load() != NULL) {
       const uint64_t imm_start = env_->NowMicros();
       mutex_.Lock();
-      if (imm_ != NULL) {
+      if (imm_ != NULL && !imm_flush_running_) {
+        imm_flush_running_ = true;
         CompactMemTable();
+        imm_flush_running_ = false;
         bg_cv_.SignalAll();  // Wakeup MakeRoomForWrite() if necessary
       }
       mutex_.Unlock();
-      imm_micros += (env_->NowMicros() - imm_start);
+      sub->imm_micros += (env_->NowMicros() - imm_start);
     }
 
     Slice key = input->key();
-    if (compact->compaction->ShouldStopBefore(key) &&
-        compact->builder != NULL) {
-      status = FinishCompactionOutputFile(compact, input);
+    if (sub->has_end && ParseInternalKey(key, &ikey) &&
+        user_comparator()->Compare(ikey.user_key, sub->end) > 0) {
+      // Reached the range of the next subcompaction
+      break;
+    }
+    if (c->ShouldStopBefore(key, &sub->scan) &&
+        sub->builder != NULL) {
+      status = FinishCompactionOutputFile(sub, input);
       if (!status.ok()) {
         break;
       }
@@ -957,7 +1243,7 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         drop = true;    // (A)
       } else if (ikey.type == kTypeDeletion &&
                  ikey.sequence <= compact->smallest_snapshot &&
-                 compact->compaction->IsBaseLevelForKey(ikey.user_key)) {
+                 c->IsBaseLevelForKey(ikey.user_key, &sub->scan)) {
         // For this user key:
         // (1) there is no data in higher levels
         // (2) data in lower levels will have larger sequence numbers
@@ -976,28 +1262,27 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         "%d smallest_snapshot: %d",
         ikey.user_key.ToString().c_str(),
         (int)ikey.sequence, ikey.type, kTypeValue, drop,
-        compact->compaction->IsBaseLevelForKey(ikey.user_key),
+        c->IsBaseLevelForKey(ikey.user_key, &sub->scan),
         (int)last_sequence_for_key, (int)compact->smallest_snapshot);
 #endif
 
     if (!drop) {
       // Open output file if necessary
-      if (compact->builder == NULL) {
-        status = OpenCompactionOutputFile(compact);
+      if (sub->builder == NULL) {
+        status = OpenCompactionOutputFile(sub);
         if (!status.ok()) {
           break;
         }
       }
-      if (compact->builder->NumEntries() == 0) {
-        compact->current_output()->smallest.DecodeFrom(key);
+      if (sub->builder->NumEntries() == 0) {
+        sub->current_output()->smallest.DecodeFrom(key);
       }
-      compact->current_output()->largest.DecodeFrom(key);
-      compact->builder->Add(key, input->value());
+      sub->current_output()->largest.DecodeFrom(key);
+      sub->builder->Add(key, input->value());
 
       // Close output file if it is big enough
-      if (compact->builder->FileSize() >=
-          compact->compaction->MaxOutputFileSize()) {
-        status = FinishCompactionOutputFile(compact, input);
+      if (sub->builder->FileSize() >= c->MaxOutputFileSize()) {
+        status = FinishCompactionOutputFile(sub, input);
         if (!status.ok()) {
           break;
         }
@@ -1010,39 +1295,14 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
   if (status.ok() && shutting_down_.Acquire_Load()) {
     status = Status::IOError("Deleting DB during compaction");
   }
-  if (status.ok() && compact->builder != NULL) {
-    status = FinishCompactionOutputFile(compact, input);
+  if (status.ok() && sub->builder != NULL) {
+    status = FinishCompactionOutputFile(sub, input);
   }
   if (status.ok()) {
     status = input->status();
   }
   delete input;
-  input = NULL;
-
-  CompactionStats stats;
-  stats.micros = env_->NowMicros() - start_micros - imm_micros;
-  for (int which = 0; which < 2; which++) {
-    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
-      stats.bytes_read += compact->compaction->input(which, i)->file_size;
-    }
-  }
-  for (size_t i = 0; i < compact->outputs.size(); i++) {
-    stats.bytes_written += compact->outputs[i].file_size;
-  }
-
-  mutex_.Lock();
-  stats_[compact->compaction->level() + 1].Add(stats);
-
-  if (status.ok()) {
-    status = InstallCompactionResults(compact);
-  }
-  if (!status.ok()) {
-    RecordBackgroundError(status);
-  }
-  VersionSet::LevelSummaryStorage tmp;
-  Log(options_.info_log,
-      "compacted to: %s", versions_->LevelSummary(&tmp));
-  return status;
+  sub->status = status;
 }
 
 namespace {
@@ -1162,7 +1422,7 @@ Iterator* DBImpl::NewIterator(const ReadOptions& options) {
       (options.snapshot != NULL
        ? reinterpret_cast<const SnapshotImpl*>(options.snapshot)->number_
        : latest_snapshot),
-      seed);
+      options.prefix, seed);
 }
 
 void DBImpl::RecordReadSample(Slice key) {
@@ -1192,6 +1452,10 @@ Status DBImpl::Delete(const WriteOptions& options, const Slice& key) {
 }
 
 Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
+  if (options_.enable_pipelined_write) {
+    return PipelinedWrite(options, my_batch);
+  }
+
   Writer w(&mutex_);
   w.batch = my_batch;
   w.sync = options.sync;
@@ -1199,8 +1463,12 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
 
   MutexLock l(&mutex_);
   writers_.push_back(&w);
-  while (!w.done && &w != writers_.front()) {
-    w.cv.Wait();
+  while (true) {
+    while (!w.done && w.insert_group == NULL && &w != writers_.front()) {
+      w.cv.Wait();
+    }
+    if (w.insert_group == NULL) break;
+    InsertOwnBatch(&w);
   }
   if (w.done) {
     return w.status;
@@ -1211,10 +1479,15 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
   uint64_t last_sequence = versions_->LastSequence();
   Writer* last_writer = &w;
   if (status.ok() && my_batch != NULL) {  // NULL batch is for compactions
-    WriteBatch* updates = BuildBatchGroup(&last_writer);
+    WriteBatch* updates = BuildBatchGroup(&last_writer, tmp_batch_);
     WriteBatchInternal::SetSequence(updates, last_sequence + 1);
     last_sequence += WriteBatchInternal::Count(updates);
 
+    // A group that combined several batches may spread its memtable
+    // insert over the threads of its writers.
+    const bool insert_concurrently =
+        options_.allow_concurrent_memtable_write && updates != my_batch;
+
     // Add to log and apply to memtable.  We can release the lock
     // during this phase since &w is currently responsible for logging
     // and protects against concurrent loggers and concurrent writes
@@ -1229,7 +1502,7 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
           sync_error = true;
         }
       }
-      if (status.ok()) {
+      if (status.ok() && !insert_concurrently) {
         status = WriteBatchInternal::InsertInto(updates, mem_);
       }
       mutex_.Lock();
@@ -1240,6 +1513,16 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
         RecordBackgroundError(status);
       }
     }
+    if (status.ok() && insert_concurrently) {
+      std::vector<Writer*> followers;
+      std::deque<Writer*>::iterator iter = writers_.begin();
+      while (*iter != last_writer) {
+        ++iter;
+        followers.push_back(*iter);
+      }
+      status = InsertGroupConcurrently(
+          &w, followers, WriteBatchInternal::Sequence(updates));
+    }
     if (updates == tmp_batch_) tmp_batch_->Clear();
 
     versions_->SetLastSequence(last_sequence);
@@ -1264,9 +1547,205 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* my_batch) {
   return status;
 }
 
+// Pipelined writes run in two stages.  The writer at the front of writers_
+// leads the WAL stage: it builds a batch group, appends it to the log and
+// syncs if needed, exactly like Write().  The group then leaves writers_ for
+// memtable_writers_, which lets the next group start logging while this one
+// is inserted into the memtable.  Groups are inserted and published through
+// SetLastSequence() strictly in log order, one group at a time.
+//
+// Switching memtables (and logs) in MakeRoomForWrite() first waits for the
+// memtable stage to drain, so every group in memtable_writers_ targets the
+// current mem_ and its records live in the current log.
+Status DBImpl::PipelinedWrite(const WriteOptions& options,
+                              WriteBatch* my_batch) {
+  Writer w(&mutex_);
+  w.batch = my_batch;
+  w.sync = options.sync;
+  w.done = false;
+
+  MutexLock l(&mutex_);
+  writers_.push_back(&w);
+  while (true) {
+    while (!w.done && w.insert_group == NULL &&
+           (writers_.empty() || &w != writers_.front())) {
+      w.cv.Wait();
+    }
+    if (w.insert_group == NULL) break;
+    InsertOwnBatch(&w);
+  }
+  if (w.done) {
+    return w.status;
+  }
+
+  // May temporarily unlock and wait.
+  Status status = MakeRoomForWrite(my_batch == NULL);
+  Writer* last_writer = &w;
+  WriteBatch group_batch;
+  if (status.ok() && my_batch != NULL) {  // NULL batch is for compactions
+    WriteBatch* updates = BuildBatchGroup(&last_writer, &group_batch);
+    SequenceNumber last_sequence = memtable_writers_.empty() ?
+        versions_->LastSequence() : memtable_writers_.back()->last_sequence;
+    WriteBatchInternal::SetSequence(updates, last_sequence + 1);
+    last_sequence += WriteBatchInternal::Count(updates);
+
+    // Add to log.  &w stays at the front of writers_ while logging, which
+    // protects against concurrent loggers; earlier groups may meanwhile be
+    // inserting into mem_.
+    {
+      mutex_.Unlock();
+      status = log_->AddRecord(WriteBatchInternal::Contents(updates));
+      bool sync_error = false;
+      if (status.ok() && options.sync) {
+        status = logfile_->Sync();
+        if (!status.ok()) {
+          sync_error = true;
+        }
+      }
+      mutex_.Lock();
+      if (sync_error) {
+        // The state of the log file is indeterminate: the log record we
+        // just added may or may not show up when the DB is re-opened.
+        // So we force the DB into a mode where all future writes fail.
+        RecordBackgroundError(status);
+      }
+    }
+
+    if (status.ok()) {
+      // Hand the WAL stage to the next group and queue up for the
+      // memtable stage.
+      w.group_batch = updates;
+      w.last_sequence = last_sequence;
+      while (true) {
+        Writer* member = writers_.front();
+        writers_.pop_front();
+        if (member != &w) {
+          w.followers.push_back(member);
+        }
+        if (member == last_writer) break;
+      }
+      if (!writers_.empty()) {
+        writers_.front()->cv.Signal();
+      }
+      memtable_writers_.push_back(&w);
+      while (&w != memtable_writers_.front()) {
+        w.cv.Wait();
+      }
+
+      // Apply to memtable.  We can release the lock during this phase
+      // since &w is at the front of memtable_writers_, which protects
+      // against concurrent writes into mem_ from other groups.
+      if (options_.allow_concurrent_memtable_write && updates != my_batch) {
+        status = InsertGroupConcurrently(
+            &w, w.followers, WriteBatchInternal::Sequence(updates));
+      } else {
+        mutex_.Unlock();
+        status = WriteBatchInternal::InsertInto(updates, mem_);
+        mutex_.Lock();
+      }
+
+      versions_->SetLastSequence(last_sequence);
+      memtable_writers_.pop_front();
+      for (size_t i = 0; i < w.followers.size(); i++) {
+        Writer* ready = w.followers[i];
+        ready->status = status;
+        ready->done = true;
+        ready->cv.Signal();
+      }
+      if (!memtable_writers_.empty()) {
+        memtable_writers_.front()->cv.Signal();
+      } else {
+        // Wakeup MakeRoomForWrite() if it is waiting to switch memtables
+        bg_cv_.SignalAll();
+      }
+      return status;
+    }
+  }
+
+  while (true) {
+    Writer* ready = writers_.front();
+    writers_.pop_front();
+    if (ready != &w) {
+      ready->status = status;
+      ready->done = true;
+      ready->cv.Signal();
+    }
+    if (ready == last_writer) break;
+  }
+
+  // Notify new head of write queue
+  if (!writers_.empty()) {
+    writers_.front()->cv.Signal();
+  }
+
+  return status;
+}
+
+// Insert a logged batch group into mem_ with every writer of the group
+// inserting its own batch on its own thread.  "first_sequence" is the
+// sequence number assigned to the group's first entry.
+// REQUIRES: mutex_ is held and the caller leads the group
+// REQUIRES: no other thread is writing into mem_
+Status DBImpl::InsertGroupConcurrently(Writer* leader,
+                                       const std::vector<Writer*>& followers,
+                                       SequenceNumber first_sequence) {
+  mutex_.AssertHeld();
+  ConcurrentInsertGroup group(&mutex_, mem_);
+
+  // Give every batch its slice of the group's sequence numbers
+  SequenceNumber sequence = first_sequence;
+  WriteBatchInternal::SetSequence(leader->batch, sequence);
+  sequence += WriteBatchInternal::Count(leader->batch);
+  for (size_t i = 0; i < followers.size(); i++) {
+    Writer* w = followers[i];
+    if (w->batch == NULL) {
+      continue;
+    }
+    WriteBatchInternal::SetSequence(w->batch, sequence);
+    sequence += WriteBatchInternal::Count(w->batch);
+    w->insert_group = &group;
+    group.running++;
+    w->cv.Signal();
+  }
+
+  mutex_.Unlock();
+  Status status = WriteBatchInternal::InsertIntoConcurrently(leader->batch,
+                                                             group.mem);
+  mutex_.Lock();
+  while (group.running > 0) {
+    group.cv.Wait();
+  }
+  if (status.ok()) {
+    status = group.status;
+  }
+  return status;
+}
+
+// Called by a follower whose group leader asked it to insert its own
+// batch.  Temporarily releases mutex_.
+void DBImpl::InsertOwnBatch(Writer* w) {
+  mutex_.AssertHeld();
+  ConcurrentInsertGroup* group = w->insert_group;
+  w->insert_group = NULL;
+
+  mutex_.Unlock();
+  Status s = WriteBatchInternal::InsertIntoConcurrently(w->batch, group->mem);
+  mutex_.Lock();
+
+  if (!s.ok() && group->status.ok()) {
+    group->status = s;
+  }
+  group->running--;
+  if (group->running == 0) {
+    group->cv.Signal();
+  }
+}
+
 // REQUIRES: Writer list must be non-empty
 // REQUIRES: First writer must have a non-NULL batch
-WriteBatch* DBImpl::BuildBatchGroup(Writer** last_writer) {
+// REQUIRES: tmp_batch is empty; it is used to combine the group's batches
+WriteBatch* DBImpl::BuildBatchGroup(Writer** last_writer,
+                                    WriteBatch* tmp_batch) {
   assert(!writers_.empty());
   Writer* first = writers_.front();
   WriteBatch* result = first->batch;
@@ -1302,7 +1781,7 @@ WriteBatch* DBImpl::BuildBatchGroup(Writer** last_writer) {
       // Append to *result
       if (result == first->batch) {
         // Switch to temporary batch instead of disturbing caller's batch
-        result = tmp_batch_;
+        result = tmp_batch;
         assert(WriteBatchInternal::Count(result) == 0);
         WriteBatchInternal::Append(result, first->batch);
       }
@@ -1342,6 +1821,10 @@ Status DBImpl::MakeRoomForWrite(bool force) {
                (mem_->ApproximateMemoryUsage() <= options_.write_buffer_size)) {
       // There is room in current memtable
       break;
+    } else if (!memtable_writers_.empty()) {
+      // Pipelined writes that are already logged must reach the current
+      // memtable before it is switched.
+      bg_cv_.Wait();
     } else if (imm_ != NULL) {
       // We have filled up the current memtable, but the previous
       // one is still being compacted, so we wait.
@@ -1440,6 +1923,31 @@ bool DBImpl::GetProperty(const Slice& property, std::string* value) {
              static_cast<unsigned long long>(total_usage));
     value->append(buf);
     return true;
+  } else if (in == "background-queues") {
+    static const char* kPriorityNames[Env::kNumPriorities] = { "high", "low" };
+    for (int pri = 0; pri < Env::kNumPriorities; pri++) {
+      BackgroundQueueStats stats;
+      if (!env_->GetBackgroundQueueStats(static_cast<Env::Priority>(pri),
+                                         &stats)) {
+        return false;
+      }
+      const double completed = stats.completed > 0 ? stats.completed : 1;
+      char buf[300];
+      snprintf(buf, sizeof(buf),
+               "%-4s threads=%d running=%d queued=%llu max_queued=%llu "
+               "scheduled=%llu completed=%llu avg_wait_micros=%.0f "
+               "max_wait_micros=%llu avg_run_micros=%.0f\n",
+               kPriorityNames[pri], stats.threads, stats.running,
+               static_cast<unsigned long long>(stats.queue_depth),
+               static_cast<unsigned long long>(stats.max_queue_depth),
+               static_cast<unsigned long long>(stats.scheduled),
+               static_cast<unsigned long long>(stats.completed),
+               stats.total_wait_micros / completed,
+               static_cast<unsigned long long>(stats.max_wait_micros),
+               stats.total_run_micros / completed);
+      value->append(buf);
+    }
+    return true;
   }
 
   return false;
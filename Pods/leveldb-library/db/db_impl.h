@@ -7,6 +7,7 @@
 
 #include <deque>
 #include <set>
+#include <vector>
 #include "db/dbformat.h"
 #include "db/log_writer.h"
 #include "db/snapshot.h"
@@ -67,7 +68,9 @@ class DBImpl : public DB {
  private:
   friend class DB;
   struct CompactionState;
+  struct SubcompactionState;
   struct Writer;
+  struct ConcurrentInsertGroup;
 
   Iterator* NewInternalIterator(const ReadOptions&,
                                 SequenceNumber* latest_snapshot,
@@ -95,16 +98,32 @@ class DBImpl : public DB {
                         VersionEdit* edit, SequenceNumber* max_sequence)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
-  Status WriteLevel0Table(MemTable* mem, VersionEdit* edit, Version* base)
+  // If "pending_number" is non-NULL, the new table stays in
+  // pending_outputs_ and its number is stored there; the caller must
+  // erase it once *edit has been applied.
+  Status WriteLevel0Table(MemTable* mem, VersionEdit* edit, Version* base,
+                          uint64_t* pending_number)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   Status MakeRoomForWrite(bool force /* compact even if there is room? */)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
-  WriteBatch* BuildBatchGroup(Writer** last_writer);
+  WriteBatch* BuildBatchGroup(Writer** last_writer, WriteBatch* tmp_batch);
+  Status PipelinedWrite(const WriteOptions& options, WriteBatch* my_batch);
+  Status InsertGroupConcurrently(Writer* leader,
+                                 const std::vector<Writer*>& followers,
+                                 SequenceNumber first_sequence)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void InsertOwnBatch(Writer* w) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   void RecordBackgroundError(const Status& s);
 
+  // Serializes VersionSet::LogAndApply() between the flush job and the
+  // compaction job, which may both be running.
+  Status LogAndApply(VersionEdit* edit) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   void MaybeScheduleCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  static void BGFlushWork(void* db);
+  void BackgroundFlushCall();
   static void BGWork(void* db);
   void BackgroundCall();
   void  BackgroundCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -112,9 +131,12 @@ class DBImpl : public DB {
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Status DoCompactionWork(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  static void BGSubcompactionWork(void* db);
+  void RunSubcompactions() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void DoSubcompactionWork(SubcompactionState* sub);
 
-  Status OpenCompactionOutputFile(CompactionState* compact);
-  Status FinishCompactionOutputFile(CompactionState* compact, Iterator* input);
+  Status OpenCompactionOutputFile(SubcompactionState* sub);
+  Status FinishCompactionOutputFile(SubcompactionState* sub, Iterator* input);
   Status InstallCompactionResults(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
@@ -137,6 +159,7 @@ class DBImpl : public DB {
   port::Mutex mutex_;
   port::AtomicPointer shutting_down_;
   port::CondVar bg_cv_;          // Signalled when background work finishes
+                                 // or the memtable write stage drains
   MemTable* mem_;
   MemTable* imm_;                // Memtable being compacted
   port::AtomicPointer has_imm_;  // So bg thread can detect non-NULL imm_
@@ -149,6 +172,10 @@ class DBImpl : public DB {
   std::deque<Writer*> writers_;
   WriteBatch* tmp_batch_;
 
+  // Leaders of logged batch groups waiting for their memtable insert, in
+  // log order.  Only used when options_.enable_pipelined_write is set.
+  std::deque<Writer*> memtable_writers_;
+
   SnapshotList snapshots_;
 
   // Set of table files to protect from deletion because they are
@@ -158,6 +185,29 @@ class DBImpl : public DB {
   // Has a background compaction been scheduled or is running?
   bool bg_compaction_scheduled_;
 
+  // Has a background compaction picked its inputs and not yet finished?
+  bool bg_compaction_running_;
+
+  // Compaction whose key ranges are being handed out, or NULL
+  CompactionState* subcompacting_;
+
+  // Number of BGSubcompactionWork() calls scheduled and not yet returned
+  int bg_subcompaction_helpers_;
+
+  // Has a background memtable flush been scheduled or is running?
+  bool bg_flush_scheduled_;
+
+  // Is some thread currently writing imm_ to a table?
+  bool imm_flush_running_;
+
+  // Is some thread inside VersionSet::LogAndApply()?
+  bool manifest_writing_;
+
+  // Does env_ run high priority work on threads of its own?  If not,
+  // compactions flush imm_ themselves instead of leaving it to the
+  // flush job, which may be queued behind them.
+  bool flush_in_background_;
+
   // Information for a manual compaction
   struct ManualCompaction {
     int level;
@@ -49,11 +49,12 @@ class DBIter: public Iterator {
   };
 
   DBIter(DBImpl* db, const Comparator* cmp, Iterator* iter, SequenceNumber s,
-         uint32_t seed)
+         const Slice& prefix, uint32_t seed)
       : db_(db),
         user_comparator_(cmp),
         iter_(iter),
         sequence_(s),
+        prefix_(prefix.data(), prefix.size()),
         direction_(kForward),
         valid_(false),
         rnd_(seed),
@@ -90,6 +91,11 @@ class DBIter: public Iterator {
   void FindPrevUserEntry();
   bool ParseKey(ParsedInternalKey* key);
 
+  // Keys outside of prefix_ end the iteration.
+  inline bool OutsidePrefix(const Slice& user_key) const {
+    return !prefix_.empty() && !user_key.starts_with(prefix_);
+  }
+
   inline void SaveKey(const Slice& k, std::string* dst) {
     dst->assign(k.data(), k.size());
   }
@@ -112,6 +118,7 @@ class DBIter: public Iterator {
   const Comparator* const user_comparator_;
   Iterator* const iter_;
   SequenceNumber const sequence_;
+  const std::string prefix_;  // See ReadOptions::prefix
 
   Status status_;
   std::string saved_key_;     // == current key when direction_==kReverse
@@ -177,6 +184,9 @@ void DBIter::FindNextUserEntry(bool skipping, std::string* skip) {
   do {
     ParsedInternalKey ikey;
     if (ParseKey(&ikey) && ikey.sequence <= sequence_) {
+      if (OutsidePrefix(ikey.user_key)) {
+        break;
+      }
       switch (ikey.type) {
         case kTypeDeletion:
           // Arrange to skip all upcoming entries for this key since
@@ -237,6 +247,10 @@ void DBIter::FindPrevUserEntry() {
     do {
       ParsedInternalKey ikey;
       if (ParseKey(&ikey) && ikey.sequence <= sequence_) {
+        if (OutsidePrefix(ikey.user_key)) {
+          // Every earlier entry is outside of the prefix too.
+          break;
+        }
         if ((value_type != kTypeDeletion) &&
             user_comparator_->Compare(ikey.user_key, saved_key_) < 0) {
           // We encountered a non-deleted value in entries for previous keys,
@@ -310,8 +324,10 @@ Iterator* NewDBIterator(
     const Comparator* user_key_comparator,
     Iterator* internal_iter,
     SequenceNumber sequence,
+    const Slice& prefix,
     uint32_t seed) {
-  return new DBIter(db, user_key_comparator, internal_iter, sequence, seed);
+  return new DBIter(db, user_key_comparator, internal_iter, sequence, prefix,
+                    seed);
 }
 
 }  // namespace leveldb
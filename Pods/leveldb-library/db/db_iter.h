@@ -15,12 +15,14 @@ class DBImpl;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
-// into appropriate user keys.
+// into appropriate user keys.  If "prefix" is non-empty, the iterator
+// stops at the first key that does not start with it.
 extern Iterator* NewDBIterator(
     DBImpl* db,
     const Comparator* user_key_comparator,
     Iterator* internal_iter,
     SequenceNumber sequence,
+    const Slice& prefix,
     uint32_t seed);
 
 }  // namespace leveldb
@@ -118,6 +118,12 @@ bool InternalFilterPolicy::KeyMayMatch(const Slice& key, const Slice& f) const {
   return user_policy_->KeyMayMatch(ExtractUserKey(key), f);
 }
 
+bool InternalFilterPolicy::PrefixMayMatch(const Slice& prefix,
+                                          const Slice& f) const {
+  // Prefixes are always user key prefixes.
+  return user_policy_->PrefixMayMatch(prefix, f);
+}
+
 LookupKey::LookupKey(const Slice& user_key, SequenceNumber s) {
   size_t usize = user_key.size();
   size_t needed = usize + 13;  // A conservative estimate
@@ -136,6 +136,7 @@ class InternalFilterPolicy : public FilterPolicy {
   virtual const char* Name() const;
   virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const;
   virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const;
+  virtual bool PrefixMayMatch(const Slice& prefix, const Slice& filter) const;
 };
 
 // Modules in this directory should keep internal keys wrapped inside
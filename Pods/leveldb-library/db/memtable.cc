@@ -8,6 +8,7 @@
 #include "leveldb/env.h"
 #include "leveldb/iterator.h"
 #include "util/coding.h"
+#include "util/mutexlock.h"
 
 namespace leveldb {
 
@@ -21,14 +22,29 @@ static Slice GetLengthPrefixedSlice(const char* data) {
 MemTable::MemTable(const InternalKeyComparator& cmp)
     : comparator_(cmp),
       refs_(0),
-      table_(comparator_, &arena_) {
+      table_(comparator_, &arena_),
+      has_arenas_(NULL) {
 }
 
 MemTable::~MemTable() {
   assert(refs_ == 0);
+  assert(free_arenas_.size() == arenas_.size());
+  for (size_t i = 0; i < arenas_.size(); i++) {
+    delete arenas_[i];
+  }
 }
 
-size_t MemTable::ApproximateMemoryUsage() { return arena_.MemoryUsage(); }
+size_t MemTable::ApproximateMemoryUsage() {
+  size_t usage = arena_.MemoryUsage();
+  if (has_arenas_.Acquire_Load() == NULL) {
+    return usage;
+  }
+  MutexLock l(&arenas_mutex_);
+  for (size_t i = 0; i < arenas_.size(); i++) {
+    usage += arenas_[i]->arena.MemoryUsage();
+  }
+  return usage;
+}
 
 int MemTable::KeyComparator::operator()(const char* aptr, const char* bptr)
     const {
@@ -82,6 +98,12 @@ Iterator* MemTable::NewIterator() {
 void MemTable::Add(SequenceNumber s, ValueType type,
                    const Slice& key,
                    const Slice& value) {
+  table_.Insert(EncodeEntry(&arena_, s, type, key, value));
+}
+
+const char* MemTable::EncodeEntry(Arena* arena, SequenceNumber s,
+                                  ValueType type, const Slice& key,
+                                  const Slice& value) {
   // Format of an entry is concatenation of:
   //  key_size     : varint32 of internal_key.size()
   //  key bytes    : char[internal_key.size()]
@@ -93,7 +115,7 @@ void MemTable::Add(SequenceNumber s, ValueType type,
   const size_t encoded_len =
       VarintLength(internal_key_size) + internal_key_size +
       VarintLength(val_size) + val_size;
-  char* buf = arena_.Allocate(encoded_len);
+  char* buf = arena->Allocate(encoded_len);
   char* p = EncodeVarint32(buf, internal_key_size);
   memcpy(p, key.data(), key_size);
   p += key_size;
@@ -102,7 +124,42 @@ void MemTable::Add(SequenceNumber s, ValueType type,
   p = EncodeVarint32(p, val_size);
   memcpy(p, value.data(), val_size);
   assert((p + val_size) - buf == encoded_len);
-  table_.Insert(buf);
+  return buf;
+}
+
+MemTable::InsertArena* MemTable::AcquireArena() {
+  MutexLock l(&arenas_mutex_);
+  if (free_arenas_.empty()) {
+    InsertArena* arena = new InsertArena(0xdeadbeef + arenas_.size());
+    arenas_.push_back(arena);
+    has_arenas_.Release_Store(this);
+    return arena;
+  }
+  InsertArena* arena = free_arenas_.back();
+  free_arenas_.pop_back();
+  return arena;
+}
+
+void MemTable::ReleaseArena(InsertArena* arena) {
+  MutexLock l(&arenas_mutex_);
+  free_arenas_.push_back(arena);
+}
+
+MemTable::ConcurrentInserter::ConcurrentInserter(MemTable* mem)
+    : mem_(mem),
+      arena_(mem->AcquireArena()) {
+}
+
+MemTable::ConcurrentInserter::~ConcurrentInserter() {
+  mem_->ReleaseArena(arena_);
+}
+
+void MemTable::ConcurrentInserter::Add(SequenceNumber s, ValueType type,
+                                       const Slice& key,
+                                       const Slice& value) {
+  mem_->table_.InsertConcurrently(
+      EncodeEntry(&arena_->arena, s, type, key, value),
+      &arena_->arena, &arena_->rnd);
 }
 
 bool MemTable::Get(const LookupKey& key, std::string* value, Status* s) {
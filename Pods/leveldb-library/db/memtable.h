@@ -6,10 +6,13 @@
 #define STORAGE_LEVELDB_DB_MEMTABLE_H_
 
 #include <string>
+#include <vector>
 #include "leveldb/db.h"
 #include "db/dbformat.h"
 #include "db/skiplist.h"
+#include "port/port.h"
 #include "util/arena.h"
+#include "util/random.h"
 
 namespace leveldb {
 
@@ -54,6 +57,32 @@ class MemTable {
            const Slice& key,
            const Slice& value);
 
+ private:
+  struct InsertArena;
+
+ public:
+  // Adds entries like Add(), but several ConcurrentInserters on the same
+  // memtable may be used from different threads at the same time.  Each
+  // one borrows a private arena from the memtable for its lifetime, so
+  // allocation needs no locking.  Must not be used concurrently with Add().
+  class ConcurrentInserter {
+   public:
+    explicit ConcurrentInserter(MemTable* mem);
+    ~ConcurrentInserter();
+
+    void Add(SequenceNumber seq, ValueType type,
+             const Slice& key,
+             const Slice& value);
+
+   private:
+    MemTable* const mem_;
+    InsertArena* const arena_;
+
+    // No copying allowed
+    ConcurrentInserter(const ConcurrentInserter&);
+    void operator=(const ConcurrentInserter&);
+  };
+
   // If memtable contains a value for key, store it in *value and return true.
   // If memtable contains a deletion for key, store a NotFound() error
   // in *status and return true.
@@ -73,11 +102,38 @@ class MemTable {
 
   typedef SkipList<const char*, KeyComparator> Table;
 
+  // Encode an entry into memory allocated from *arena.
+  static const char* EncodeEntry(Arena* arena, SequenceNumber s,
+                                 ValueType type, const Slice& key,
+                                 const Slice& value);
+
+  // Allocation state private to one ConcurrentInserter at a time.  The
+  // random generator for skiplist node heights lives with the arena so
+  // that its sequence continues across inserters.
+  struct InsertArena {
+    Arena arena;
+    Random rnd;
+    explicit InsertArena(uint32_t seed) : rnd(seed) { }
+  };
+
+  InsertArena* AcquireArena();
+  void ReleaseArena(InsertArena* arena);
+
   KeyComparator comparator_;
   int refs_;
   Arena arena_;
   Table table_;
 
+  // Arenas of ConcurrentInserters.  Kept until the memtable is deleted,
+  // since they hold entries of table_.
+  port::Mutex arenas_mutex_;
+  std::vector<InsertArena*> arenas_;       // All; protected by arenas_mutex_
+  std::vector<InsertArena*> free_arenas_;  // Not borrowed; ditto
+
+  // Non-NULL once arenas_ is non-empty, so that ApproximateMemoryUsage()
+  // only takes arenas_mutex_ if concurrent inserts have been used.
+  port::AtomicPointer has_arenas_;
+
   // No copying allowed
   MemTable(const MemTable&);
   void operator=(const MemTable&);
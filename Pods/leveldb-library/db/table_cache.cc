@@ -118,6 +118,25 @@ Status TableCache::Get(const ReadOptions& options,
   return s;
 }
 
+bool TableCache::PrefixMayMatch(const ReadOptions& options,
+                                uint64_t file_number,
+                                uint64_t file_size,
+                                const Slice& seek_key,
+                                const Slice& prefix) {
+  if (options_->filter_policy == NULL) {
+    return true;
+  }
+  Cache::Handle* handle = NULL;
+  Status s = FindTable(file_number, file_size, &handle);
+  if (!s.ok()) {
+    return true;  // Let the iterator report the error
+  }
+  Table* t = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
+  const bool result = t->PrefixMayMatch(options, seek_key, prefix);
+  cache_->Release(handle);
+  return result;
+}
+
 void TableCache::Evict(uint64_t file_number) {
   char buf[sizeof(file_number)];
   EncodeFixed64(buf, file_number);
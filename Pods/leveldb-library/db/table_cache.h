@@ -44,6 +44,15 @@ class TableCache {
              void* arg,
              void (*handle_result)(void*, const Slice&, const Slice&));
 
+  // Returns false if the filter of the specified file shows that it holds
+  // no key starting with "prefix".  "seek_key" is the internal key to
+  // seek to for the first such key.
+  bool PrefixMayMatch(const ReadOptions& options,
+                      uint64_t file_number,
+                      uint64_t file_size,
+                      const Slice& seek_key,
+                      const Slice& prefix);
+
   // Evict any entry for the specified file number
   void Evict(uint64_t file_number);
 
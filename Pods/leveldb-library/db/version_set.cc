@@ -231,8 +231,17 @@ Iterator* Version::NewConcatenatingIterator(const ReadOptions& options,
       &GetFileIterator, vset_->table_cache_, options);
 }
 
+static void DeleteFileList(void* arg, void* ignored) {
+  delete reinterpret_cast<std::vector<FileMetaData*>*>(arg);
+}
+
 void Version::AddIterators(const ReadOptions& options,
                            std::vector<Iterator*>* iters) {
+  if (!options.prefix.empty()) {
+    AddPrefixIterators(options, iters);
+    return;
+  }
+
   // Merge all level zero files together since they may overlap
   for (size_t i = 0; i < files_[0].size(); i++) {
     iters->push_back(
@@ -250,6 +259,57 @@ void Version::AddIterators(const ReadOptions& options,
   }
 }
 
+// Like AddIterators(), but only covers the files that may hold keys
+// starting with options.prefix.  Files whose key range misses the prefix
+// or whose filter rules it out are left out entirely.
+void Version::AddPrefixIterators(const ReadOptions& options,
+                                 std::vector<Iterator*>* iters) {
+  const Slice prefix = options.prefix;
+  const Comparator* ucmp = vset_->icmp_.user_comparator();
+  InternalKey seek_key(prefix, kMaxSequenceNumber, kValueTypeForSeek);
+  for (int level = 0; level < config::kNumLevels; level++) {
+    const std::vector<FileMetaData*>& files = files_[level];
+    // Files in levels > 0 are sorted and disjoint, so start at the first
+    // one that may hold the prefix.
+    size_t i = (level == 0) ? 0 : FindFile(vset_->icmp_, files,
+                                           seek_key.Encode());
+    std::vector<FileMetaData*>* selected = NULL;
+    for (; i < files.size(); i++) {
+      FileMetaData* f = files[i];
+      const Slice smallest = f->smallest.user_key();
+      if (ucmp->Compare(smallest, prefix) > 0 &&
+          !smallest.starts_with(prefix)) {
+        // File starts after every key with the prefix
+        if (level == 0) continue;
+        break;
+      }
+      if (ucmp->Compare(f->largest.user_key(), prefix) < 0) {
+        continue;  // File ends before every key with the prefix
+      }
+      if (!vset_->table_cache_->PrefixMayMatch(
+              options, f->number, f->file_size, seek_key.Encode(), prefix)) {
+        continue;
+      }
+      if (level == 0) {
+        iters->push_back(vset_->table_cache_->NewIterator(
+            options, f->number, f->file_size));
+      } else {
+        if (selected == NULL) {
+          selected = new std::vector<FileMetaData*>;
+        }
+        selected->push_back(f);
+      }
+    }
+    if (selected != NULL) {
+      Iterator* iter = NewTwoLevelIterator(
+          new LevelFileNumIterator(vset_->icmp_, selected),
+          &GetFileIterator, vset_->table_cache_, options);
+      iter->RegisterCleanup(&DeleteFileList, selected, NULL);
+      iters->push_back(iter);
+    }
+  }
+}
+
 // Callback from TableCache::Get()
 namespace {
 enum SaverState {
@@ -1448,12 +1508,15 @@ Compaction* VersionSet::CompactRange(
 Compaction::Compaction(const Options* options, int level)
     : level_(level),
       max_output_file_size_(MaxFileSizeForLevel(options, level)),
-      input_version_(NULL),
-      grandparent_index_(0),
-      seen_key_(false),
-      overlapped_bytes_(0) {
+      input_version_(NULL) {
+}
+
+Compaction::ScanState::ScanState()
+    : grandparent_index(0),
+      seen_key(false),
+      overlapped_bytes(0) {
   for (int i = 0; i < config::kNumLevels; i++) {
-    level_ptrs_[i] = 0;
+    level_ptrs[i] = 0;
   }
 }
 
@@ -1481,13 +1544,14 @@ void Compaction::AddInputDeletions(VersionEdit* edit) {
   }
 }
 
-bool Compaction::IsBaseLevelForKey(const Slice& user_key) {
+bool Compaction::IsBaseLevelForKey(const Slice& user_key,
+                                   ScanState* state) const {
   // Maybe use binary search to find right entry instead of linear search?
   const Comparator* user_cmp = input_version_->vset_->icmp_.user_comparator();
   for (int lvl = level_ + 2; lvl < config::kNumLevels; lvl++) {
     const std::vector<FileMetaData*>& files = input_version_->files_[lvl];
-    for (; level_ptrs_[lvl] < files.size(); ) {
-      FileMetaData* f = files[level_ptrs_[lvl]];
+    for (; state->level_ptrs[lvl] < files.size(); ) {
+      FileMetaData* f = files[state->level_ptrs[lvl]];
       if (user_cmp->Compare(user_key, f->largest.user_key()) <= 0) {
         // We've advanced far enough
         if (user_cmp->Compare(user_key, f->smallest.user_key()) >= 0) {
@@ -1496,35 +1560,104 @@ bool Compaction::IsBaseLevelForKey(const Slice& user_key) {
         }
         break;
       }
-      level_ptrs_[lvl]++;
+      state->level_ptrs[lvl]++;
     }
   }
   return true;
 }
 
-bool Compaction::ShouldStopBefore(const Slice& internal_key) {
+bool Compaction::ShouldStopBefore(const Slice& internal_key,
+                                  ScanState* state) const {
   const VersionSet* vset = input_version_->vset_;
   // Scan to find earliest grandparent file that contains key.
   const InternalKeyComparator* icmp = &vset->icmp_;
-  while (grandparent_index_ < grandparents_.size() &&
+  while (state->grandparent_index < grandparents_.size() &&
       icmp->Compare(internal_key,
-                    grandparents_[grandparent_index_]->largest.Encode()) > 0) {
-    if (seen_key_) {
-      overlapped_bytes_ += grandparents_[grandparent_index_]->file_size;
+                    grandparents_[state->grandparent_index]->largest.Encode())
+          > 0) {
+    if (state->seen_key) {
+      state->overlapped_bytes +=
+          grandparents_[state->grandparent_index]->file_size;
     }
-    grandparent_index_++;
+    state->grandparent_index++;
   }
-  seen_key_ = true;
+  state->seen_key = true;
 
-  if (overlapped_bytes_ > MaxGrandParentOverlapBytes(vset->options_)) {
+  if (state->overlapped_bytes > MaxGrandParentOverlapBytes(vset->options_)) {
     // Too much overlap for current output; start new output
-    overlapped_bytes_ = 0;
+    state->overlapped_bytes = 0;
     return true;
   } else {
     return false;
   }
 }
 
+namespace {
+struct BoundaryCandidate {
+  Slice user_key;
+  uint64_t bytes;
+};
+
+struct BoundaryCandidateOrder {
+  const Comparator* user_cmp;
+  bool operator()(const BoundaryCandidate& a,
+                  const BoundaryCandidate& b) const {
+    return user_cmp->Compare(a.user_key, b.user_key) < 0;
+  }
+};
+}  // namespace
+
+void Compaction::GetSubcompactionBoundaries(
+    int n, std::vector<std::string>* boundaries) const {
+  boundaries->clear();
+  if (n <= 1) {
+    return;
+  }
+
+  // Use the largest user key of every input file as a candidate split
+  // point and charge the whole file to it.  Level-0 inputs may overlap,
+  // so this is only an estimate, but it is good enough for balancing.
+  const Comparator* user_cmp = input_version_->vset_->icmp_.user_comparator();
+  std::vector<BoundaryCandidate> candidates;
+  uint64_t total = 0;
+  for (int which = 0; which < 2; which++) {
+    for (size_t i = 0; i < inputs_[which].size(); i++) {
+      BoundaryCandidate c;
+      c.user_key = inputs_[which][i]->largest.user_key();
+      c.bytes = inputs_[which][i]->file_size;
+      candidates.push_back(c);
+      total += c.bytes;
+    }
+  }
+  BoundaryCandidateOrder order;
+  order.user_cmp = user_cmp;
+  std::sort(candidates.begin(), candidates.end(), order);
+
+  // The last candidate is the largest key of the compaction, so splitting
+  // there would only produce an empty trailing range.
+  uint64_t seen = 0;
+  for (size_t i = 0; i + 1 < candidates.size(); i++) {
+    seen += candidates[i].bytes;
+    const uint64_t target = total * (boundaries->size() + 1) / n;
+    if (seen < target) {
+      continue;
+    }
+    if (!boundaries->empty() &&
+        user_cmp->Compare(candidates[i].user_key,
+                          Slice(boundaries->back())) <= 0) {
+      continue;
+    }
+    if (user_cmp->Compare(candidates[i].user_key,
+                          candidates.back().user_key) >= 0) {
+      break;
+    }
+    boundaries->push_back(candidates[i].user_key.ToString());
+    if (boundaries->size() + 1 >= static_cast<size_t>(n)) {
+      break;
+    }
+  }
+}
+
 void Compaction::ReleaseInputs() {
   if (input_version_ != NULL) {
     input_version_->Unref();
@@ -29,6 +29,22 @@ class Cache;
 // of Cache uses a least-recently-used eviction policy.
 extern Cache* NewLRUCache(size_t capacity);
 
+// Number of shards, as a power of two, used by NewLRUCache(capacity).
+static const int kDefaultCacheShardBits = 4;
+
+// Create a new cache with a fixed size capacity that is split into
+// 2^num_shard_bits independently locked shards.  More shards reduce lock
+// contention between threads, but each shard only gets an equal slice of
+// the capacity.  num_shard_bits is clipped to [0, 16].
+extern Cache* NewLRUCache(size_t capacity, int num_shard_bits);
+
+// Create a new cache with a fixed size capacity and 2^num_shard_bits
+// shards that approximates LRU with the CLOCK algorithm.  Lookups that
+// hit only take their shard's lock in shared mode and Release() takes no
+// lock, so this cache scales better than NewLRUCache() when many threads
+// read from it concurrently.
+extern Cache* NewClockCache(size_t capacity, int num_shard_bits);
+
 class Cache {
  public:
   Cache() { }
@@ -117,6 +117,9 @@ class DB {
   //     of the sstables that make up the db contents.
   //  "leveldb.approximate-memory-usage" - returns the approximate number of
   //     bytes of memory in use by the DB.
+  //  "leveldb.background-queues" - returns one line per priority of the
+  //     Env's background work queues (see Env::GetBackgroundQueueStats())
+  //     with thread counts, queue depths and wait and run latencies.
   virtual bool GetProperty(const Slice& property, std::string* value) = 0;
 
   // For each i in [0,n-1], store in "sizes[i]", the approximate
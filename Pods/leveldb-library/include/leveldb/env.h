@@ -28,8 +28,36 @@ class SequentialFile;
 class Slice;
 class WritableFile;
 
+// Counters for one queue of background work, see
+// Env::GetBackgroundQueueStats().  Latencies are in microseconds.
+struct BackgroundQueueStats {
+  int threads;                 // Threads serving the queue
+  int running;                 // Work items running right now
+  uint64_t queue_depth;        // Work items waiting for a thread
+  uint64_t max_queue_depth;    // Largest queue_depth seen
+  uint64_t scheduled;          // Work items ever scheduled
+  uint64_t completed;          // Work items that have finished
+  uint64_t total_wait_micros;  // Time items spent waiting for a thread
+  uint64_t max_wait_micros;    // Longest time an item waited
+  uint64_t total_run_micros;   // Time threads spent running items
+
+  BackgroundQueueStats()
+      : threads(0), running(0), queue_depth(0), max_queue_depth(0),
+        scheduled(0), completed(0), total_wait_micros(0),
+        max_wait_micros(0), total_run_micros(0) { }
+};
+
 class Env {
  public:
+  // Background work is queued by priority.  High priority work (such as
+  // memtable flushes, which writers may be waiting for) never waits
+  // behind low priority work (such as compactions).
+  enum Priority {
+    kHighPriority = 0,
+    kLowPriority = 1,
+    kNumPriorities = 2
+  };
+
   Env() { }
   virtual ~Env();
 
@@ -140,6 +168,22 @@ class Env {
       void (*function)(void* arg),
       void* arg) = 0;
 
+  // Like Schedule(function, arg), but queue the work with priority "pri".
+  // The default implementation ignores the priority.
+  virtual void Schedule(void (*function)(void* arg), void* arg,
+                        Priority pri);
+
+  // Allow up to "number" threads to run work queued with priority "pri".
+  // Envs may ignore this, and may never stop threads that were started
+  // before the number was lowered.
+  virtual void SetBackgroundThreads(int number, Priority pri);
+
+  // If the Env runs work of priority "pri" from a queue and threads of
+  // its own, store that queue's counters in *stats and return true.
+  // Otherwise return false.
+  virtual bool GetBackgroundQueueStats(Priority pri,
+                                       BackgroundQueueStats* stats);
+
   // Start a new thread, invoking "function(arg)" within the new thread.
   // When "function(arg)" returns, the thread will be destroyed.
   virtual void StartThread(void (*function)(void* arg), void* arg) = 0;
@@ -327,6 +371,15 @@ class EnvWrapper : public Env {
   void Schedule(void (*f)(void*), void* a) {
     return target_->Schedule(f, a);
   }
+  void Schedule(void (*f)(void*), void* a, Priority pri) {
+    return target_->Schedule(f, a, pri);
+  }
+  void SetBackgroundThreads(int number, Priority pri) {
+    target_->SetBackgroundThreads(number, pri);
+  }
+  bool GetBackgroundQueueStats(Priority pri, BackgroundQueueStats* stats) {
+    return target_->GetBackgroundQueueStats(pri, stats);
+  }
   void StartThread(void (*f)(void*), void* a) {
     return target_->StartThread(f, a);
   }
@@ -47,6 +47,30 @@ class FilterPolicy {
   // This method may return true or false if the key was not on the
   // list, but it should aim to return false with a high probability.
   virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const = 0;
+
+  // "filter" contains the data appended by a preceding call to
+  // CreateFilter() on this class.  This method must return true if any
+  // key passed to CreateFilter() starts with "prefix" and has "prefix"
+  // as its extracted prefix (see PrefixExtractor below).  Policies that
+  // do not record prefixes return true.
+  virtual bool PrefixMayMatch(const Slice& prefix, const Slice& filter) const;
+};
+
+// A PrefixExtractor picks the part of each key that a prefix filter
+// records, e.g. the collection a document key belongs to.  Keys with the
+// same prefix must be adjacent in the database's comparator order, which
+// holds for BytewiseComparator().
+class PrefixExtractor {
+ public:
+  virtual ~PrefixExtractor();
+
+  // Return the name of this extractor.  It becomes part of the name of
+  // the filter policy, so it must change whenever PrefixLength() changes.
+  virtual const char* Name() const = 0;
+
+  // Return the length of the prefix of "key" to record, or zero if the
+  // key should only be recorded whole.  Must not exceed key.size().
+  virtual size_t PrefixLength(const Slice& key) const = 0;
 };
 
 // Return a new filter policy that uses a bloom filter with approximately
@@ -65,6 +89,16 @@ class FilterPolicy {
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key);
 
+// Return a new filter policy that behaves like NewBloomFilterPolicy(), but
+// also records the prefix that "extractor" picks from each key.  This lets
+// DB iterators created with ReadOptions::prefix skip tables that hold no
+// key with that prefix.  Prefixes cost about as much filter space as keys.
+//
+// Callers must delete the result after any database that is using the
+// result has been closed, and must keep *extractor live until then.
+extern const FilterPolicy* NewPrefixBloomFilterPolicy(
+    int bits_per_key, const PrefixExtractor* extractor);
+
 }
 
 #endif  // STORAGE_LEVELDB_INCLUDE_FILTER_POLICY_H_
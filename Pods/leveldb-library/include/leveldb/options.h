@@ -6,6 +6,7 @@
 #define STORAGE_LEVELDB_INCLUDE_OPTIONS_H_
 
 #include <stddef.h>
+#include "leveldb/slice.h"
 
 namespace leveldb {
 
@@ -27,6 +28,13 @@ enum CompressionType {
   kSnappyCompression = 0x1
 };
 
+// Replacement policy of the block cache that leveldb creates itself when
+// Options::block_cache is NULL.  See NewLRUCache() and NewClockCache().
+enum CacheType {
+  kLRUCache   = 0x0,
+  kClockCache = 0x1
+};
+
 // Options to control the behavior of a database (passed to DB::Open)
 struct Options {
   // -------------------
@@ -97,6 +105,21 @@ struct Options {
   // Default: NULL
   Cache* block_cache;
 
+  // Number of shards, as a power of two, of the internal block cache
+  // created when block_cache is NULL.  Each shard has its own lock, so
+  // more shards reduce contention between concurrent readers.  Ignored
+  // when block_cache is non-NULL.
+  //
+  // Default: 4
+  int block_cache_shard_bits;
+
+  // Replacement policy of the internal block cache created when
+  // block_cache is NULL.  kClockCache serves cache hits without taking
+  // the shard lock exclusively.  Ignored when block_cache is non-NULL.
+  //
+  // Default: kLRUCache
+  CacheType block_cache_type;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -112,6 +135,42 @@ struct Options {
   // Default: 16
   int block_restart_interval;
 
+  // If true, each data block written to a table ends with a small hash
+  // index that maps the user keys in the block to their restart
+  // interval, so that point lookups can skip the binary search over the
+  // restart array.  Costs roughly one byte per key.  Blocks that have
+  // too many restart intervals are written without an index.  Tables
+  // written with this option cannot be read by older versions of
+  // leveldb; tables written without it are unchanged.
+  //
+  // Default: false
+  bool data_block_hash_index;
+
+  // If true, the index block of each table is split into partitions of
+  // about metadata_block_size bytes, and the filter block (if there is a
+  // filter_policy) into one filter per index partition.  An open table
+  // then only holds a small top-level index over the partitions; the
+  // partitions themselves are read on demand through block_cache, so
+  // memory use scales with the working set instead of the database
+  // size.  Tables written with this option cannot be read by older
+  // versions of leveldb.
+  //
+  // Default: false
+  bool partition_index_and_filters;
+
+  // Approximate size of the index and filter partitions written when
+  // partition_index_and_filters is true.
+  //
+  // Default: 4K
+  size_t metadata_block_size;
+
+  // If true, the top-level index and filter blocks of partitioned tables
+  // are kept in memory for as long as the table is open.  If false they
+  // are read through block_cache like the partitions they point to.
+  //
+  // Default: true
+  bool pin_top_level_index_and_filter;
+
   // Leveldb will write up to this amount of bytes to a file before
   // switching to a new one.
   // Most clients should leave this parameter alone.  However if your
@@ -153,6 +212,37 @@ struct Options {
   // Default: NULL
   const FilterPolicy* filter_policy;
 
+  // Maximum number of threads that may work on a single compaction.  A
+  // large compaction is split into key ranges ("subcompactions") that are
+  // merged concurrently and then installed as one version edit.  Each
+  // range still produces output files of at most max_file_size bytes.
+  // A value of 1 disables splitting.
+  //
+  // The compaction thread is helped by work scheduled on the env's low
+  // priority queue, so ranges only run concurrently if the env allows
+  // that queue more than one thread (see Env::SetBackgroundThreads()).
+  //
+  // Default: 1
+  int max_subcompactions;
+
+  // If true, writes go through a two stage pipeline: while one batch group
+  // is inserted into the memtable, the next group can already be appended
+  // to the log (and synced).  A sync write then no longer holds up the
+  // memtable inserts of writers queued before it.  Writes still become
+  // visible in the order they were logged.  Only useful with several
+  // concurrent writer threads.
+  //
+  // Default: false
+  bool enable_pipelined_write;
+
+  // If true, when several concurrent writes are committed together as one
+  // group, each writer inserts its own batch into the memtable on its own
+  // thread instead of the group leader inserting all of them.  Inserts use
+  // a lock-free skiplist insert and per-thread memtable arenas.
+  //
+  // Default: false
+  bool allow_concurrent_memtable_write;
+
   // Create an Options object with default values for all fields.
   Options();
 };
@@ -176,6 +266,18 @@ struct ReadOptions {
   // Default: NULL
   const Snapshot* snapshot;
 
+  // If non-empty, an iterator created with these options only returns
+  // keys that start with "prefix": it becomes invalid as soon as it is
+  // positioned outside of them, so callers should Seek(prefix).  If the
+  // filter_policy records prefixes (see NewPrefixBloomFilterPolicy()),
+  // tables whose filters rule out "prefix" are not read at all; keys from
+  // which the extractor picks a different prefix may then be missing, so
+  // "prefix" should be one the extractor produces.  The prefix data only
+  // needs to stay live until NewIterator() returns.
+  // Ignored by Get().
+  // Default: empty
+  Slice prefix;
+
   ReadOptions()
       : verify_checksums(false),
         fill_cache(true),
@@ -61,6 +61,8 @@ class Table {
 
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const ReadOptions&, const Slice&);
+  static Iterator* BlockReader(void*, const ReadOptions&, const Slice&,
+                               bool point_lookup);
 
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
@@ -71,9 +73,22 @@ class Table {
       void* arg,
       void (*handle_result)(void* arg, const Slice& k, const Slice& v));
 
+  // Returns false if the filters show that no key starting with "prefix"
+  // is stored in the table.  "seek_key" must sort before every such key
+  // and after every smaller key.
+  bool PrefixMayMatch(const ReadOptions&, const Slice& seek_key,
+                      const Slice& prefix);
 
-  void ReadMeta(const Footer& footer);
+
+  Iterator* NewTopLevelIndexIterator(const ReadOptions&) const;
+  Iterator* NewIndexIterator(const ReadOptions&) const;
+  bool FilterMayMatch(const ReadOptions&, const Slice& index_key,
+                      const Slice& handle_value, const Slice& probe,
+                      bool is_prefix);
+
+  Status ReadMeta(const Footer& footer);
   void ReadFilter(const Slice& filter_handle_value);
+  void ReadFilterIndex(const Slice& filter_index_handle_value);
 
   // No copying allowed
   Table(const Table&);
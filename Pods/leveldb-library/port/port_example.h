@@ -42,6 +42,25 @@ class Mutex {
   void AssertHeld();
 };
 
+// A RWMutex is a lock that may be held exclusively by one writer or
+// shared by any number of readers.
+class RWMutex {
+ public:
+  RWMutex();
+  ~RWMutex();
+
+  // Acquire the lock in shared mode.  Waits while a writer holds it.
+  void ReadLock();
+
+  // Acquire the lock in exclusive mode.  Waits until all other holders
+  // have released it.
+  void WriteLock();
+
+  // Release a lock acquired by ReadLock() or WriteLock().
+  // REQUIRES: This lock was acquired by this thread.
+  void Unlock();
+};
+
 class CondVar {
  public:
   explicit CondVar(Mutex* mu);
@@ -135,6 +154,13 @@ extern bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg);
 // the newly extended CRC value (which may also be zero).
 uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size);
 
+typedef uint32_t (*CRC32CFunction)(uint32_t crc, const char* buf, size_t size);
+
+// Returns the named hardware CRC32C kernel if the port provides it and the
+// running CPU supports it, else NULL.  AcceleratedCRC32C() uses the fastest
+// supported kernel; this lets benchmarks compare the individual kernels.
+CRC32CFunction GetCRC32CKernel(const char* name);
+
 }  // namespace port
 }  // namespace leveldb
 
@@ -26,6 +26,26 @@ void Mutex::Lock() { PthreadCall("lock", pthread_mutex_lock(&mu_)); }
 
 void Mutex::Unlock() { PthreadCall("unlock", pthread_mutex_unlock(&mu_)); }
 
+RWMutex::RWMutex() {
+  PthreadCall("init rwlock", pthread_rwlock_init(&mu_, NULL));
+}
+
+RWMutex::~RWMutex() {
+  PthreadCall("destroy rwlock", pthread_rwlock_destroy(&mu_));
+}
+
+void RWMutex::ReadLock() {
+  PthreadCall("read lock", pthread_rwlock_rdlock(&mu_));
+}
+
+void RWMutex::WriteLock() {
+  PthreadCall("write lock", pthread_rwlock_wrlock(&mu_));
+}
+
+void RWMutex::Unlock() {
+  PthreadCall("unlock rwlock", pthread_rwlock_unlock(&mu_));
+}
+
 CondVar::CondVar(Mutex* mu)
     : mu_(mu) {
     PthreadCall("init cv", pthread_cond_init(&cv_, NULL));
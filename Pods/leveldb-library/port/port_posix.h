@@ -97,6 +97,23 @@ class Mutex {
   void operator=(const Mutex&);
 };
 
+class RWMutex {
+ public:
+  RWMutex();
+  ~RWMutex();
+
+  void ReadLock();
+  void WriteLock();
+  void Unlock();
+
+ private:
+  pthread_rwlock_t mu_;
+
+  // No copying
+  RWMutex(const RWMutex&);
+  void operator=(const RWMutex&);
+};
+
 class CondVar {
  public:
   explicit CondVar(Mutex* mu);
@@ -150,6 +167,12 @@ inline bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg) {
 
 uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size);
 
+typedef uint32_t (*CRC32CFunction)(uint32_t crc, const char* buf, size_t size);
+
+// Returns the named CRC32C kernel if it is compiled in and supported by
+// this CPU, else NULL.  See port_posix_sse.cc for the kernel names.
+CRC32CFunction GetCRC32CKernel(const char* name);
+
 } // namespace port
 } // namespace leveldb
 
@@ -2,43 +2,90 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 //
-// A portable implementation of crc32c, optimized to handle
-// four bytes at a time.
+// Hardware accelerated implementations of crc32c.
 //
-// In a separate source file to allow this accelerated CRC32C function to be
-// compiled with the appropriate compiler flags to enable x86 SSE 4.2
-// instructions.
+// In a separate source file to allow these accelerated CRC32C functions to
+// be compiled with the instruction set extensions they need.  With GCC and
+// Clang each kernel is compiled with a per-function target attribute, so
+// this file does not need any special compiler flags; the kernel that is
+// actually used is picked at runtime from the features of the CPU.
+//
+// Kernels, fastest first:
+//   "sse42_pclmul"  x86-64 SSE 4.2 crc32 over three interleaved streams,
+//                   combined with a PCLMULQDQ carry-less multiply.
+//   "sse42"         x86 SSE 4.2 crc32, one stream.
+//   "armv8_pmull"   ARMv8 CRC32 instructions over three interleaved
+//                   streams, combined with a PMULL carry-less multiply.
+//   "armv8"         ARMv8 CRC32 instructions, one stream.
 
 #include <stdint.h>
 #include <string.h>
 #include "port/port.h"
 
-#if defined(LEVELDB_PLATFORM_POSIX_SSE)
+#if defined(LEVELDB_PLATFORM_POSIX_SSE) || \
+    (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define LEVELDB_CRC32C_X86 1
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+#define LEVELDB_CRC32C_ARM64 1
+#endif
+
+#if defined(LEVELDB_CRC32C_X86)
 
 #if defined(_MSC_VER)
 #include <intrin.h>
-#elif defined(__GNUC__) && defined(__SSE4_2__)
-#include <nmmintrin.h>
+#define LEVELDB_TARGET_SSE42
+#define LEVELDB_TARGET_SSE42_PCLMUL
+#elif defined(__GNUC__)
 #include <cpuid.h>
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#define LEVELDB_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define LEVELDB_TARGET_SSE42_PCLMUL __attribute__((target("sse4.2,pclmul")))
+#endif
+
+#endif  // defined(LEVELDB_CRC32C_X86)
+
+#if defined(LEVELDB_CRC32C_ARM64)
+
+#include <arm_acle.h>
+#include <arm_neon.h>
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+#if defined(__clang__)
+#define LEVELDB_TARGET_ARMV8_CRC __attribute__((target("crc")))
+#define LEVELDB_TARGET_ARMV8_CRC_PMULL __attribute__((target("crc,crypto")))
+#else
+#define LEVELDB_TARGET_ARMV8_CRC __attribute__((target("+crc")))
+#define LEVELDB_TARGET_ARMV8_CRC_PMULL __attribute__((target("+crc+crypto")))
 #endif
 
-#endif  // defined(LEVELDB_PLATFORM_POSIX_SSE)
+#endif  // defined(LEVELDB_CRC32C_ARM64)
 
 namespace leveldb {
 namespace port {
 
-#if defined(LEVELDB_PLATFORM_POSIX_SSE)
+#if defined(LEVELDB_CRC32C_X86) || defined(LEVELDB_CRC32C_ARM64)
 
 // Used to fetch a naturally-aligned 32-bit word in little endian byte-order
 static inline uint32_t LE_LOAD32(const uint8_t *p) {
-  // SSE is x86 only, so ensured that |p| is always little-endian.
+  // Both x86 and the AArch64 targets we support are little-endian.
   uint32_t word;
   memcpy(&word, p, sizeof(word));
   return word;
 }
 
-#if defined(_M_X64) || defined(__x86_64__)  // LE_LOAD64 is only used on x64.
-
 // Used to fetch a naturally-aligned 64-bit word in little endian byte-order
 static inline uint64_t LE_LOAD64(const uint8_t *p) {
   uint64_t dword;
@@ -46,7 +93,23 @@ static inline uint64_t LE_LOAD64(const uint8_t *p) {
   return dword;
 }
 
-#endif  // defined(_M_X64) || defined(__x86_64__)
+// The interleaved kernels split the input into three equally sized streams
+// so that three independent crc32 instructions are in flight at a time,
+// then fold the streams back together.  Moving a crc past n zero bytes is
+// a multiplication by x^(8n) modulo the CRC32C polynomial; a 32x32
+// carry-less multiply by x^(8n-33) followed by a crc32 of the 64-bit
+// product computes exactly that.  The constants below are x^(8n-33) mod P
+// (bit-reflected) for the stream lengths we use.
+static const size_t kLongStream = 2048;
+static const size_t kShortStream = 256;
+static const uint32_t kLongShift1 = 0xa51b6135;   // n = kLongStream
+static const uint32_t kLongShift2 = 0x82f89c77;   // n = 2 * kLongStream
+static const uint32_t kShortShift1 = 0xb9e02b86;  // n = kShortStream
+static const uint32_t kShortShift2 = 0xdd7e3b0c;  // n = 2 * kShortStream
+
+#endif  // defined(LEVELDB_CRC32C_X86) || defined(LEVELDB_CRC32C_ARM64)
+
+#if defined(LEVELDB_CRC32C_X86)
 
 static inline bool HaveSSE42() {
 #if defined(_MSC_VER)
@@ -54,7 +117,7 @@ static inline bool HaveSSE42() {
   __cpuid(cpu_info, 1);
   return (cpu_info[2] & (1 << 20)) != 0;
 #elif defined(__GNUC__)
-  unsigned int eax, ebx, ecx, edx;
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
   __get_cpuid(1, &eax, &ebx, &ecx, &edx);
   return (ecx & (1 << 20)) != 0;
 #else
@@ -62,19 +125,24 @@ static inline bool HaveSSE42() {
 #endif
 }
 
-#endif  // defined(LEVELDB_PLATFORM_POSIX_SSE)
+static inline bool HavePCLMUL() {
+#if defined(_MSC_VER)
+  int cpu_info[4];
+  __cpuid(cpu_info, 1);
+  return (cpu_info[2] & (1 << 1)) != 0;
+#elif defined(__GNUC__)
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+  return (ecx & (1 << 1)) != 0;
+#else
+  return false;
+#endif
+}
 
 // For further improvements see Intel publication at:
 // http://download.intel.com/design/intarch/papers/323405.pdf
-uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
-#if !defined(LEVELDB_PLATFORM_POSIX_SSE)
-  return 0;
-#else
-  static bool have = HaveSSE42();
-  if (!have) {
-    return 0;
-  }
-
+LEVELDB_TARGET_SSE42
+static uint32_t ExtendSSE42(uint32_t crc, const char* buf, size_t size) {
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
   const uint8_t *e = p + size;
   uint32_t l = crc ^ 0xffffffffu;
@@ -87,7 +155,8 @@ uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
     p += 4;                                     \
 } while (0)
 #define STEP8 do {                              \
-    l = _mm_crc32_u64(l, LE_LOAD64(p));         \
+    l = static_cast<uint32_t>(                  \
+        _mm_crc32_u64(l, LE_LOAD64(p)));        \
     p += 8;                                     \
 } while (0)
 
@@ -122,7 +191,259 @@ uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
 #undef STEP4
 #undef STEP1
   return l ^ 0xffffffffu;
-#endif  // defined(LEVELDB_PLATFORM_POSIX_SSE)
+}
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+// Extends |l| over three consecutive streams of |n| bytes each starting at
+// |p|.  |shift1| and |shift2| are the constants for n and 2n.
+LEVELDB_TARGET_SSE42_PCLMUL
+static inline uint64_t ThreeStreamsSSE42(uint64_t l0, const uint8_t* p,
+                                         size_t n,
+                                         uint32_t shift1, uint32_t shift2) {
+  const uint8_t* p1 = p + n;
+  const uint8_t* p2 = p + 2 * n;
+  const uint8_t* const end = p1;
+  uint64_t l1 = 0;
+  uint64_t l2 = 0;
+  while (p != end) {
+    l0 = _mm_crc32_u64(l0, LE_LOAD64(p));
+    l1 = _mm_crc32_u64(l1, LE_LOAD64(p1));
+    l2 = _mm_crc32_u64(l2, LE_LOAD64(p2));
+    p += 8;
+    p1 += 8;
+    p2 += 8;
+  }
+  const __m128i m0 = _mm_clmulepi64_si128(
+      _mm_cvtsi64_si128(static_cast<int64_t>(l0)),
+      _mm_cvtsi32_si128(static_cast<int>(shift2)), 0x00);
+  const __m128i m1 = _mm_clmulepi64_si128(
+      _mm_cvtsi64_si128(static_cast<int64_t>(l1)),
+      _mm_cvtsi32_si128(static_cast<int>(shift1)), 0x00);
+  const uint64_t folded =
+      static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_xor_si128(m0, m1)));
+  return _mm_crc32_u64(0, folded) ^ l2;
+}
+
+LEVELDB_TARGET_SSE42_PCLMUL
+static uint32_t ExtendSSE42PCLMUL(uint32_t crc, const char* buf,
+                                  size_t size) {
+  if (size < 3 * kShortStream + 8) {
+    return ExtendSSE42(crc, buf, size);
+  }
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  const uint8_t *e = p + size;
+  uint64_t l = crc ^ 0xffffffffu;
+
+  // Process unaligned bytes
+  for (unsigned int i = (8 - reinterpret_cast<uintptr_t>(p) % 8) % 8;
+       i; --i) {
+    l = _mm_crc32_u8(static_cast<uint32_t>(l), *p++);
+  }
+  while (static_cast<size_t>(e-p) >= 3 * kLongStream) {
+    l = ThreeStreamsSSE42(l, p, kLongStream, kLongShift1, kLongShift2);
+    p += 3 * kLongStream;
+  }
+  while (static_cast<size_t>(e-p) >= 3 * kShortStream) {
+    l = ThreeStreamsSSE42(l, p, kShortStream, kShortShift1, kShortShift2);
+    p += 3 * kShortStream;
+  }
+  // Process 8 bytes at a time
+  while ((e-p) >= 8) {
+    l = _mm_crc32_u64(l, LE_LOAD64(p));
+    p += 8;
+  }
+  // Process the last few bytes
+  uint32_t l32 = static_cast<uint32_t>(l);
+  while (p != e) {
+    l32 = _mm_crc32_u8(l32, *p++);
+  }
+  return l32 ^ 0xffffffffu;
+}
+
+#endif  // defined(_M_X64) || defined(__x86_64__)
+
+#endif  // defined(LEVELDB_CRC32C_X86)
+
+#if defined(LEVELDB_CRC32C_ARM64)
+
+static inline bool HaveARMv8CRC32() {
+#if defined(__APPLE__)
+  int value = 0;
+  size_t length = sizeof(value);
+  return sysctlbyname("hw.optional.armv8_crc32", &value, &length,
+                      NULL, 0) == 0 && value != 0;
+#elif defined(__linux__)
+  return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+  return false;
+#endif
+}
+
+static inline bool HaveARMv8PMULL() {
+#if defined(__APPLE__)
+  // Every 64-bit Apple CPU implements the cryptography extension.
+  return true;
+#elif defined(__linux__)
+  return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#else
+  return false;
+#endif
+}
+
+LEVELDB_TARGET_ARMV8_CRC
+static uint32_t ExtendARMv8(uint32_t crc, const char* buf, size_t size) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  const uint8_t *e = p + size;
+  uint32_t l = crc ^ 0xffffffffu;
+
+  if (size > 16) {
+    // Process unaligned bytes
+    for (unsigned int i = (8 - reinterpret_cast<uintptr_t>(p) % 8) % 8;
+         i; --i) {
+      l = __crc32cb(l, *p++);
+    }
+    // Process 32 bytes at a time
+    while ((e-p) >= 32) {
+      l = __crc32cd(l, LE_LOAD64(p));
+      l = __crc32cd(l, LE_LOAD64(p + 8));
+      l = __crc32cd(l, LE_LOAD64(p + 16));
+      l = __crc32cd(l, LE_LOAD64(p + 24));
+      p += 32;
+    }
+    // Process 8 bytes at a time
+    while ((e-p) >= 8) {
+      l = __crc32cd(l, LE_LOAD64(p));
+      p += 8;
+    }
+  }
+  // Process the last few bytes
+  while (p != e) {
+    l = __crc32cb(l, *p++);
+  }
+  return l ^ 0xffffffffu;
+}
+
+// Extends |l| over three consecutive streams of |n| bytes each starting at
+// |p|.  |shift1| and |shift2| are the constants for n and 2n.
+LEVELDB_TARGET_ARMV8_CRC_PMULL
+static inline uint32_t ThreeStreamsARMv8(uint32_t l0, const uint8_t* p,
+                                         size_t n,
+                                         uint32_t shift1, uint32_t shift2) {
+  const uint8_t* p1 = p + n;
+  const uint8_t* p2 = p + 2 * n;
+  const uint8_t* const end = p1;
+  uint32_t l1 = 0;
+  uint32_t l2 = 0;
+  while (p != end) {
+    l0 = __crc32cd(l0, LE_LOAD64(p));
+    l1 = __crc32cd(l1, LE_LOAD64(p1));
+    l2 = __crc32cd(l2, LE_LOAD64(p2));
+    p += 8;
+    p1 += 8;
+    p2 += 8;
+  }
+  const uint64_t m0 = vgetq_lane_u64(vreinterpretq_u64_p128(
+      vmull_p64(static_cast<poly64_t>(l0), static_cast<poly64_t>(shift2))), 0);
+  const uint64_t m1 = vgetq_lane_u64(vreinterpretq_u64_p128(
+      vmull_p64(static_cast<poly64_t>(l1), static_cast<poly64_t>(shift1))), 0);
+  return __crc32cd(0, m0 ^ m1) ^ l2;
+}
+
+LEVELDB_TARGET_ARMV8_CRC_PMULL
+static uint32_t ExtendARMv8PMULL(uint32_t crc, const char* buf, size_t size) {
+  if (size < 3 * kShortStream + 8) {
+    return ExtendARMv8(crc, buf, size);
+  }
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  const uint8_t *e = p + size;
+  uint32_t l = crc ^ 0xffffffffu;
+
+  // Process unaligned bytes
+  for (unsigned int i = (8 - reinterpret_cast<uintptr_t>(p) % 8) % 8;
+       i; --i) {
+    l = __crc32cb(l, *p++);
+  }
+  while (static_cast<size_t>(e-p) >= 3 * kLongStream) {
+    l = ThreeStreamsARMv8(l, p, kLongStream, kLongShift1, kLongShift2);
+    p += 3 * kLongStream;
+  }
+  while (static_cast<size_t>(e-p) >= 3 * kShortStream) {
+    l = ThreeStreamsARMv8(l, p, kShortStream, kShortShift1, kShortShift2);
+    p += 3 * kShortStream;
+  }
+  // Process 8 bytes at a time
+  while ((e-p) >= 8) {
+    l = __crc32cd(l, LE_LOAD64(p));
+    p += 8;
+  }
+  // Process the last few bytes
+  while (p != e) {
+    l = __crc32cb(l, *p++);
+  }
+  return l ^ 0xffffffffu;
+}
+
+#endif  // defined(LEVELDB_CRC32C_ARM64)
+
+namespace {
+
+struct CRC32CKernel {
+  const char* name;
+  CRC32CFunction function;
+  bool (*supported)();
+};
+
+#if defined(LEVELDB_CRC32C_X86)
+bool SupportsSSE42() { return HaveSSE42(); }
+bool SupportsSSE42PCLMUL() { return HaveSSE42() && HavePCLMUL(); }
+#endif
+#if defined(LEVELDB_CRC32C_ARM64)
+bool SupportsARMv8() { return HaveARMv8CRC32(); }
+bool SupportsARMv8PMULL() { return HaveARMv8CRC32() && HaveARMv8PMULL(); }
+#endif
+
+// Fastest first.
+const CRC32CKernel kKernels[] = {
+#if defined(LEVELDB_CRC32C_X86)
+#if defined(_M_X64) || defined(__x86_64__)
+  { "sse42_pclmul", &ExtendSSE42PCLMUL, &SupportsSSE42PCLMUL },
+#endif
+  { "sse42", &ExtendSSE42, &SupportsSSE42 },
+#endif
+#if defined(LEVELDB_CRC32C_ARM64)
+  { "armv8_pmull", &ExtendARMv8PMULL, &SupportsARMv8PMULL },
+  { "armv8", &ExtendARMv8, &SupportsARMv8 },
+#endif
+  { NULL, NULL, NULL }
+};
+
+CRC32CFunction ChooseCRC32C() {
+  for (const CRC32CKernel* k = kKernels; k->name != NULL; k++) {
+    if ((*k->supported)()) {
+      return k->function;
+    }
+  }
+  return NULL;
+}
+
+}  // namespace
+
+CRC32CFunction GetCRC32CKernel(const char* name) {
+  for (const CRC32CKernel* k = kKernels; k->name != NULL; k++) {
+    if (strcmp(k->name, name) == 0) {
+      return (*k->supported)() ? k->function : NULL;
+    }
+  }
+  return NULL;
+}
+
+uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
+  static const CRC32CFunction accelerated = ChooseCRC32C();
+  if (accelerated == NULL) {
+    return 0;
+  }
+  return (*accelerated)(crc, buf, size);
 }
 
 }  // namespace port
@@ -11,29 +11,46 @@
 #include "leveldb/comparator.h"
 #include "table/format.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/logging.h"
 
 namespace leveldb {
 
-inline uint32_t Block::NumRestarts() const {
-  assert(size_ >= sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
-}
-
 Block::Block(const BlockContents& contents)
     : data_(contents.data.data()),
       size_(contents.data.size()),
+      num_restarts_(0),
+      hash_buckets_(NULL),
+      num_hash_buckets_(0),
       owned_(contents.heap_allocated) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
-  } else {
-    size_t max_restarts_allowed = (size_-sizeof(uint32_t)) / sizeof(uint32_t);
-    if (NumRestarts() > max_restarts_allowed) {
-      // The size is too small for NumRestarts()
+    return;
+  }
+  const uint32_t packed = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  num_restarts_ = packed & ~kBlockHashIndexFlag;
+  size_t trailer = sizeof(uint32_t);
+  if ((packed & kBlockHashIndexFlag) != 0) {
+    if (size_ < 2 * sizeof(uint32_t)) {
       size_ = 0;
-    } else {
-      restart_offset_ = size_ - (1 + NumRestarts()) * sizeof(uint32_t);
+      return;
     }
+    num_hash_buckets_ = DecodeFixed32(data_ + size_ - 2 * sizeof(uint32_t));
+    trailer += sizeof(uint32_t);
+    if (num_hash_buckets_ == 0 || num_hash_buckets_ > size_ - trailer ||
+        num_restarts_ > kBlockHashIndexMaxRestarts) {
+      size_ = 0;
+      return;
+    }
+    trailer += num_hash_buckets_;
+    hash_buckets_ = data_ + size_ - trailer;
+  }
+  size_t max_restarts_allowed = (size_ - trailer) / sizeof(uint32_t);
+  if (num_restarts_ > max_restarts_allowed) {
+    // The size is too small for num_restarts_
+    size_ = 0;
+  } else {
+    restart_offset_ = size_ - trailer - num_restarts_ * sizeof(uint32_t);
   }
 }
 
@@ -79,6 +96,8 @@ class Block::Iter : public Iterator {
   const char* const data_;      // underlying block contents
   uint32_t const restarts_;     // Offset of restart array (list of fixed32)
   uint32_t const num_restarts_; // Number of uint32_t entries in restart array
+  const char* const hash_buckets_;  // Hash index; NULL unless point lookup
+  uint32_t const num_hash_buckets_;
 
   // current_ is offset in data_ of current entry.  >= restarts_ if !Valid
   uint32_t current_;
@@ -115,11 +134,15 @@ class Block::Iter : public Iterator {
   Iter(const Comparator* comparator,
        const char* data,
        uint32_t restarts,
-       uint32_t num_restarts)
+       uint32_t num_restarts,
+       const char* hash_buckets,
+       uint32_t num_hash_buckets)
       : comparator_(comparator),
         data_(data),
         restarts_(restarts),
         num_restarts_(num_restarts),
+        hash_buckets_(hash_buckets),
+        num_hash_buckets_(num_hash_buckets),
         current_(restarts_),
         restart_index_(num_restarts_) {
     assert(num_restarts_ > 0);
@@ -163,6 +186,38 @@ class Block::Iter : public Iterator {
   }
 
   virtual void Seek(const Slice& target) {
+    if (hash_buckets_ != NULL) {
+      const Slice hash_key = BlockHashIndexKey(target);
+      const uint32_t h = Hash(hash_key.data(), hash_key.size(), 0);
+      const uint32_t entry =
+          static_cast<uint8_t>(hash_buckets_[h % num_hash_buckets_]);
+      if (entry == kBlockHashIndexNoEntry) {
+        // No key in this block has the target's user key.
+        MarkInvalid();
+        return;
+      } else if (entry != kBlockHashIndexCollision &&
+                 entry < num_restarts_) {
+        // Every version of the user key, if present, lies in this
+        // restart interval, so scan it alone.
+        SeekToRestartPoint(entry);
+        const uint32_t limit = (entry + 1 < num_restarts_) ?
+            GetRestartPoint(entry + 1) : restarts_;
+        while (true) {
+          if (!ParseNextKey()) {
+            return;
+          }
+          if (current_ >= limit) {
+            MarkInvalid();
+            return;
+          }
+          if (Compare(key_, target) >= 0) {
+            return;
+          }
+        }
+      }
+      // Fall back to the binary search on collisions.
+    }
+
     // Binary search in restart array to find the last restart point
     // with a key < target
     uint32_t left = 0;
@@ -215,6 +270,11 @@ class Block::Iter : public Iterator {
   }
 
  private:
+  void MarkInvalid() {
+    current_ = restarts_;
+    restart_index_ = num_restarts_;
+  }
+
   void CorruptionError() {
     current_ = restarts_;
     restart_index_ = num_restarts_;
@@ -254,14 +314,23 @@ class Block::Iter : public Iterator {
 };
 
 Iterator* Block::NewIterator(const Comparator* cmp) {
+  return NewIterator(cmp, false);
+}
+
+Iterator* Block::NewPointLookupIterator(const Comparator* cmp) {
+  return NewIterator(cmp, true);
+}
+
+Iterator* Block::NewIterator(const Comparator* cmp, bool point_lookup) {
   if (size_ < sizeof(uint32_t)) {
     return NewErrorIterator(Status::Corruption("bad block contents"));
   }
-  const uint32_t num_restarts = NumRestarts();
-  if (num_restarts == 0) {
+  if (num_restarts_ == 0) {
     return NewEmptyIterator();
   } else {
-    return new Iter(cmp, data_, restart_offset_, num_restarts);
+    return new Iter(cmp, data_, restart_offset_, num_restarts_,
+                    point_lookup ? hash_buckets_ : NULL,
+                    num_hash_buckets_);
   }
 }
 
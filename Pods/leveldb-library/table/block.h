@@ -24,12 +24,22 @@ class Block {
   size_t size() const { return size_; }
   Iterator* NewIterator(const Comparator* comparator);
 
+  // Returns an iterator for a point lookup of internal keys.  It behaves
+  // like NewIterator(), except that if the block has a hash index and
+  // the index shows that the user key of the Seek() target is not in the
+  // block, Seek() may leave the iterator !Valid() instead of positioning
+  // it at the next larger key.
+  Iterator* NewPointLookupIterator(const Comparator* comparator);
+
  private:
-  uint32_t NumRestarts() const;
+  Iterator* NewIterator(const Comparator* comparator, bool point_lookup);
 
   const char* data_;
   size_t size_;
   uint32_t restart_offset_;     // Offset in data_ of restart array
+  uint32_t num_restarts_;
+  const char* hash_buckets_;    // Hash index, or NULL if the block has none
+  uint32_t num_hash_buckets_;
   bool owned_;                  // Block owns data_[]
 
   // No copying allowed
@@ -25,6 +25,10 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// If options->data_block_hash_index is set, a hash index of the keys is
+// placed between the restart array and num_restarts, and the top bit of
+// num_restarts is set; see kBlockHashIndexFlag in format.h.
 
 #include "table/block_builder.h"
 
@@ -32,7 +36,9 @@
 #include <assert.h>
 #include "leveldb/comparator.h"
 #include "leveldb/table_builder.h"
+#include "table/format.h"
 #include "util/coding.h"
+#include "util/hash.h"
 
 namespace leveldb {
 
@@ -40,7 +46,8 @@ BlockBuilder::BlockBuilder(const Options* options)
     : options_(options),
       restarts_(),
       counter_(0),
-      finished_(false) {
+      finished_(false),
+      hashed_all_keys_(true) {
   assert(options->block_restart_interval >= 1);
   restarts_.push_back(0);       // First restart point is at offset 0
 }
@@ -52,11 +59,23 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  hashes_.clear();
+  hashed_all_keys_ = true;
+}
+
+// Keep the hash table at most 75% full.
+static size_t NumHashIndexBuckets(size_t num_keys) {
+  return num_keys * 4 / 3 + 1;
 }
 
 size_t BlockBuilder::CurrentSizeEstimate() const {
+  size_t hash_index = 0;
+  if (!hashes_.empty()) {
+    hash_index = NumHashIndexBuckets(hashes_.size()) + sizeof(uint32_t);
+  }
   return (buffer_.size() +                        // Raw data buffer
           restarts_.size() * sizeof(uint32_t) +   // Restart array
+          hash_index +                            // Hash index
           sizeof(uint32_t));                      // Restart array length
 }
 
@@ -65,11 +84,36 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, restarts_.size());
+  if (!hashes_.empty() && hashed_all_keys_ &&
+      restarts_.size() <= kBlockHashIndexMaxRestarts) {
+    AppendHashIndex();
+    PutFixed32(&buffer_, restarts_.size() | kBlockHashIndexFlag);
+  } else {
+    PutFixed32(&buffer_, restarts_.size());
+  }
   finished_ = true;
   return Slice(buffer_);
 }
 
+void BlockBuilder::AppendHashIndex() {
+  const size_t num_buckets = NumHashIndexBuckets(hashes_.size());
+  std::string buckets(num_buckets, static_cast<char>(kBlockHashIndexNoEntry));
+  for (size_t i = 0; i < hashes_.size(); i++) {
+    const uint8_t restart = static_cast<uint8_t>(hashes_[i].second);
+    char* bucket = &buckets[hashes_[i].first % num_buckets];
+    const uint8_t current = static_cast<uint8_t>(*bucket);
+    if (current == kBlockHashIndexNoEntry) {
+      *bucket = static_cast<char>(restart);
+    } else if (current != restart) {
+      // Keys from different restart intervals share this bucket (this
+      // includes a user key whose versions straddle a restart point).
+      *bucket = static_cast<char>(kBlockHashIndexCollision);
+    }
+  }
+  buffer_.append(buckets);
+  PutFixed32(&buffer_, num_buckets);
+}
+
 void BlockBuilder::Add(const Slice& key, const Slice& value) {
   Slice last_key_piece(last_key_);
   assert(!finished_);
@@ -104,6 +148,15 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   last_key_.append(key.data() + shared, non_shared);
   assert(Slice(last_key_) == key);
   counter_++;
+
+  if (options_->data_block_hash_index) {
+    const Slice hash_key = BlockHashIndexKey(key);
+    hashes_.push_back(std::make_pair(
+        Hash(hash_key.data(), hash_key.size(), 0),
+        static_cast<uint32_t>(restarts_.size() - 1)));
+  } else {
+    hashed_all_keys_ = false;
+  }
 }
 
 }  // namespace leveldb
@@ -5,6 +5,7 @@
 #ifndef STORAGE_LEVELDB_TABLE_BLOCK_BUILDER_H_
 #define STORAGE_LEVELDB_TABLE_BLOCK_BUILDER_H_
 
+#include <utility>
 #include <vector>
 
 #include <stdint.h>
@@ -47,6 +48,13 @@ class BlockBuilder {
   bool                  finished_;    // Has Finish() been called?
   std::string           last_key_;
 
+  // Hash index: (key hash, restart index) of every entry added while
+  // options_->data_block_hash_index was set.
+  std::vector<std::pair<uint32_t, uint32_t> > hashes_;
+  bool                  hashed_all_keys_;
+
+  void AppendHashIndex();
+
   // No copying allowed
   BlockBuilder(const BlockBuilder&);
   void operator=(const BlockBuilder&);
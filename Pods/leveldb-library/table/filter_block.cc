@@ -75,6 +75,36 @@ void FilterBlockBuilder::GenerateFilter() {
   start_.clear();
 }
 
+FilterPartitionBuilder::FilterPartitionBuilder(const FilterPolicy* policy)
+    : policy_(policy) {
+}
+
+void FilterPartitionBuilder::AddKey(const Slice& key) {
+  start_.push_back(keys_.size());
+  keys_.append(key.data(), key.size());
+}
+
+Slice FilterPartitionBuilder::Finish() {
+  const size_t num_keys = start_.size();
+  result_.clear();
+  start_.push_back(keys_.size());  // Simplify length computation
+  tmp_keys_.resize(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    const char* base = keys_.data() + start_[i];
+    size_t length = start_[i+1] - start_[i];
+    tmp_keys_[i] = Slice(base, length);
+  }
+  if (num_keys > 0) {
+    policy_->CreateFilter(&tmp_keys_[0], static_cast<int>(num_keys),
+                          &result_);
+  }
+
+  tmp_keys_.clear();
+  keys_.clear();
+  start_.clear();
+  return Slice(result_);
+}
+
 FilterBlockReader::FilterBlockReader(const FilterPolicy* policy,
                                      const Slice& contents)
     : policy_(policy),
@@ -93,13 +123,24 @@ FilterBlockReader::FilterBlockReader(const FilterPolicy* policy,
 }
 
 bool FilterBlockReader::KeyMayMatch(uint64_t block_offset, const Slice& key) {
+  return MayMatch(block_offset, key, false);
+}
+
+bool FilterBlockReader::PrefixMayMatch(uint64_t block_offset,
+                                       const Slice& prefix) {
+  return MayMatch(block_offset, prefix, true);
+}
+
+bool FilterBlockReader::MayMatch(uint64_t block_offset, const Slice& key,
+                                 bool is_prefix) {
   uint64_t index = block_offset >> base_lg_;
   if (index < num_) {
     uint32_t start = DecodeFixed32(offset_ + index*4);
     uint32_t limit = DecodeFixed32(offset_ + index*4 + 4);
     if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
       Slice filter = Slice(data_ + start, limit - start);
-      return policy_->KeyMayMatch(key, filter);
+      return is_prefix ? policy_->PrefixMayMatch(key, filter)
+                       : policy_->KeyMayMatch(key, filter);
     } else if (start == limit) {
       // Empty filters do not match any keys
       return false;
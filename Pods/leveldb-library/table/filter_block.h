@@ -49,13 +49,46 @@ class FilterBlockBuilder {
   void operator=(const FilterBlockBuilder&);
 };
 
+// A FilterPartitionBuilder is used instead of a FilterBlockBuilder when
+// the table's index is partitioned.  It generates one filter over all of
+// the keys added since the previous Finish(), i.e. over the data blocks
+// of one index partition.  Each filter is stored as its own block and
+// probed directly with FilterPolicy::KeyMayMatch().
+//
+// The sequence of calls to FilterPartitionBuilder must match the regexp:
+//      (AddKey* Finish)*
+class FilterPartitionBuilder {
+ public:
+  explicit FilterPartitionBuilder(const FilterPolicy*);
+
+  void AddKey(const Slice& key);
+
+  // Returns the filter for the keys added since the last call.  The
+  // result remains valid until the next call to Finish().
+  Slice Finish();
+
+ private:
+  const FilterPolicy* policy_;
+  std::string keys_;              // Flattened key contents
+  std::vector<size_t> start_;     // Starting index in keys_ of each key
+  std::string result_;            // Filter for the last partition
+  std::vector<Slice> tmp_keys_;   // policy_->CreateFilter() argument
+
+  // No copying allowed
+  FilterPartitionBuilder(const FilterPartitionBuilder&);
+  void operator=(const FilterPartitionBuilder&);
+};
+
 class FilterBlockReader {
  public:
  // REQUIRES: "contents" and *policy must stay live while *this is live.
   FilterBlockReader(const FilterPolicy* policy, const Slice& contents);
   bool KeyMayMatch(uint64_t block_offset, const Slice& key);
+  bool PrefixMayMatch(uint64_t block_offset, const Slice& prefix);
 
  private:
+  bool MayMatch(uint64_t block_offset, const Slice& key, bool is_prefix);
+
   const FilterPolicy* policy_;
   const char* data_;    // Pointer to filter data (at block-start)
   const char* offset_;  // Pointer to beginning of offset array (at block-end)
@@ -83,6 +83,39 @@ static const uint64_t kTableMagicNumber = 0xdb4775248b80fb57ull;
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// Metaindex entries of tables written with partitioned index and filter
+// blocks.  The presence of kPartitionedIndexMetaKey means the footer's
+// index handle points at a top-level index whose values are the handles
+// of index partitions.  "partitionedfilter.<policy name>" maps to a
+// top-level filter index, keyed like the top-level index, whose values
+// are the handles of raw filter blocks.
+static const char kPartitionedIndexMetaKey[] = "index.partitioned";
+static const char kPartitionedFilterMetaPrefix[] = "partitionedfilter.";
+
+// A data block may carry a hash index between its restart array and the
+// restart count.  Its presence is flagged by the top bit of the restart
+// count, which is never set in blocks written without an index:
+//     buckets: uint8[num_buckets]
+//     num_buckets: uint32
+//     num_restarts | kBlockHashIndexFlag: uint32
+// Each bucket holds the index of the restart interval containing the keys
+// that hash to it, or one of the two markers below.
+static const uint32_t kBlockHashIndexFlag = 1u << 31;
+static const uint8_t kBlockHashIndexNoEntry = 255;
+static const uint8_t kBlockHashIndexCollision = 254;
+static const uint32_t kBlockHashIndexMaxRestarts = 254;
+
+// The hash index covers internal keys by their user key portion, so that
+// a lookup at any snapshot lands in the same bucket as every version of
+// the key.
+inline Slice BlockHashIndexKey(const Slice& key) {
+  const size_t kTagSize = 8;  // Sequence number and value type
+  if (key.size() < kTagSize) {
+    return key;
+  }
+  return Slice(key.data(), key.size() - kTagSize);
+}
+
 struct BlockContents {
   Slice data;           // Actual contents of data
   bool cachable;        // True iff data can be cached
@@ -22,6 +22,7 @@ struct Table::Rep {
     delete filter;
     delete [] filter_data;
     delete index_block;
+    delete filter_index_block;
   }
 
   Options options;
@@ -33,6 +34,15 @@ struct Table::Rep {
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+
+  // Set for tables written with partition_index_and_filters.  The
+  // top-level index and filter blocks are pinned in index_block and
+  // filter_index_block, or, if the options say not to pin them, read
+  // through the block cache using the encoded handles below.
+  bool partitioned_index;
+  std::string index_handle_encoding;
+  Block* filter_index_block;
+  std::string filter_index_handle_encoding;  // Empty if no partitioned filter
 };
 
 Status Table::Open(const Options& options,
@@ -54,67 +64,91 @@ Status Table::Open(const Options& options,
   s = footer.DecodeFrom(&footer_input);
   if (!s.ok()) return s;
 
-  // Read the index block
-  BlockContents contents;
-  Block* index_block = NULL;
-  if (s.ok()) {
+  Rep* rep = new Table::Rep;
+  rep->options = options;
+  rep->file = file;
+  rep->metaindex_handle = footer.metaindex_handle();
+  rep->index_block = NULL;
+  rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
+  rep->filter_data = NULL;
+  rep->filter = NULL;
+  rep->partitioned_index = false;
+  footer.index_handle().EncodeTo(&rep->index_handle_encoding);
+  rep->filter_index_block = NULL;
+  Table* t = new Table(rep);
+
+  // Read the metaindex block first: it tells us how the index is laid out.
+  s = t->ReadMeta(footer);
+
+  // Read the index block, unless it is the top level of a partitioned
+  // index that should live in the block cache.
+  if (s.ok() &&
+      (!rep->partitioned_index || options.pin_top_level_index_and_filter)) {
     ReadOptions opt;
     if (options.paranoid_checks) {
       opt.verify_checksums = true;
     }
+    BlockContents contents;
     s = ReadBlock(file, opt, footer.index_handle(), &contents);
     if (s.ok()) {
-      index_block = new Block(contents);
+      rep->index_block = new Block(contents);
     }
   }
 
   if (s.ok()) {
     // We've successfully read the footer and the index block: we're
     // ready to serve requests.
-    Rep* rep = new Table::Rep;
-    rep->options = options;
-    rep->file = file;
-    rep->metaindex_handle = footer.metaindex_handle();
-    rep->index_block = index_block;
-    rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
-    rep->filter_data = NULL;
-    rep->filter = NULL;
-    *table = new Table(rep);
-    (*table)->ReadMeta(footer);
+    *table = t;
   } else {
-    delete index_block;
+    delete t;
   }
 
   return s;
 }
 
-void Table::ReadMeta(const Footer& footer) {
-  if (rep_->options.filter_policy == NULL) {
-    return;  // Do not need any metadata
+Status Table::ReadMeta(const Footer& footer) {
+  // An empty metaindex block consists of just its restart array.
+  const uint64_t kEmptyBlockSize = 2 * sizeof(uint32_t);
+  if (footer.metaindex_handle().size() <= kEmptyBlockSize) {
+    return Status::OK();  // No metadata
   }
 
-  // TODO(sanjay): Skip this if footer.metaindex_handle() size indicates
-  // it is an empty block.
   ReadOptions opt;
   if (rep_->options.paranoid_checks) {
     opt.verify_checksums = true;
   }
   BlockContents contents;
-  if (!ReadBlock(rep_->file, opt, footer.metaindex_handle(), &contents).ok()) {
-    // Do not propagate errors since meta info is not needed for operation
-    return;
+  Status s = ReadBlock(rep_->file, opt, footer.metaindex_handle(), &contents);
+  if (!s.ok()) {
+    // Filters are optional, but a partitioned index cannot be read
+    // without knowing that it is partitioned.
+    return s;
   }
   Block* meta = new Block(contents);
 
   Iterator* iter = meta->NewIterator(BytewiseComparator());
-  std::string key = "filter.";
-  key.append(rep_->options.filter_policy->Name());
-  iter->Seek(key);
-  if (iter->Valid() && iter->key() == Slice(key)) {
-    ReadFilter(iter->value());
+  iter->Seek(kPartitionedIndexMetaKey);
+  rep_->partitioned_index =
+      iter->Valid() && iter->key() == Slice(kPartitionedIndexMetaKey);
+  if (rep_->options.filter_policy != NULL) {
+    std::string key = "filter.";
+    key.append(rep_->options.filter_policy->Name());
+    iter->Seek(key);
+    if (iter->Valid() && iter->key() == Slice(key)) {
+      ReadFilter(iter->value());
+    }
+    key = kPartitionedFilterMetaPrefix;
+    key.append(rep_->options.filter_policy->Name());
+    iter->Seek(key);
+    if (rep_->partitioned_index &&
+        iter->Valid() && iter->key() == Slice(key)) {
+      ReadFilterIndex(iter->value());
+    }
   }
+  s = iter->status();
   delete iter;
   delete meta;
+  return s;
 }
 
 void Table::ReadFilter(const Slice& filter_handle_value) {
@@ -140,6 +174,29 @@ void Table::ReadFilter(const Slice& filter_handle_value) {
   rep_->filter = new FilterBlockReader(rep_->options.filter_policy, block.data);
 }
 
+void Table::ReadFilterIndex(const Slice& filter_index_handle_value) {
+  Slice v = filter_index_handle_value;
+  BlockHandle handle;
+  if (!handle.DecodeFrom(&v).ok()) {
+    return;
+  }
+  if (!rep_->options.pin_top_level_index_and_filter) {
+    handle.EncodeTo(&rep_->filter_index_handle_encoding);
+    return;
+  }
+
+  ReadOptions opt;
+  if (rep_->options.paranoid_checks) {
+    opt.verify_checksums = true;
+  }
+  BlockContents block;
+  if (!ReadBlock(rep_->file, opt, handle, &block).ok()) {
+    return;  // Filters are optional
+  }
+  rep_->filter_index_block = new Block(block);
+  handle.EncodeTo(&rep_->filter_index_handle_encoding);
+}
+
 Table::~Table() {
   delete rep_;
 }
@@ -159,11 +216,38 @@ static void ReleaseBlock(void* arg, void* h) {
   cache->Release(handle);
 }
 
+// The filter of one partition of a partitioned filter, as stored in the
+// block cache.
+struct FilterPartition {
+  BlockContents contents;
+
+  explicit FilterPartition(const BlockContents& c) : contents(c) { }
+  ~FilterPartition() {
+    if (contents.heap_allocated) {
+      delete[] contents.data.data();
+    }
+  }
+};
+
+static void DeleteCachedFilterPartition(const Slice& key, void* value) {
+  delete reinterpret_cast<FilterPartition*>(value);
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg,
                              const ReadOptions& options,
                              const Slice& index_value) {
+  return BlockReader(arg, options, index_value, false);
+}
+
+// Like BlockReader() above, but if point_lookup is true the returned
+// iterator may use the block's hash index; see
+// Block::NewPointLookupIterator().
+Iterator* Table::BlockReader(void* arg,
+                             const ReadOptions& options,
+                             const Slice& index_value,
+                             bool point_lookup) {
   Table* table = reinterpret_cast<Table*>(arg);
   Cache* block_cache = table->rep_->options.block_cache;
   Block* block = NULL;
@@ -205,7 +289,11 @@ Iterator* Table::BlockReader(void* arg,
 
   Iterator* iter;
   if (block != NULL) {
-    iter = block->NewIterator(table->rep_->options.comparator);
+    if (point_lookup) {
+      iter = block->NewPointLookupIterator(table->rep_->options.comparator);
+    } else {
+      iter = block->NewIterator(table->rep_->options.comparator);
+    }
     if (cache_handle == NULL) {
       iter->RegisterCleanup(&DeleteBlock, block, NULL);
     } else {
@@ -217,28 +305,149 @@ Iterator* Table::BlockReader(void* arg,
   return iter;
 }
 
+// Returns an iterator over the top-level index (or the whole index of an
+// unpartitioned table).
+Iterator* Table::NewTopLevelIndexIterator(const ReadOptions& options) const {
+  if (rep_->index_block != NULL) {
+    return rep_->index_block->NewIterator(rep_->options.comparator);
+  }
+  return BlockReader(const_cast<Table*>(this), options,
+                     rep_->index_handle_encoding);
+}
+
+// Returns an iterator whose values are the handles of the data blocks.
+Iterator* Table::NewIndexIterator(const ReadOptions& options) const {
+  Iterator* top_level = NewTopLevelIndexIterator(options);
+  if (!rep_->partitioned_index) {
+    return top_level;
+  }
+  // Index partitions are ordinary blocks, so BlockReader serves them
+  // through the block cache just like data blocks.
+  return NewTwoLevelIterator(top_level, &Table::BlockReader,
+                             const_cast<Table*>(this), options);
+}
+
 Iterator* Table::NewIterator(const ReadOptions& options) const {
   return NewTwoLevelIterator(
-      rep_->index_block->NewIterator(rep_->options.comparator),
+      NewIndexIterator(options),
       &Table::BlockReader, const_cast<Table*>(this), options);
 }
 
+// Returns false if the filters show that the data block with index entry
+// (index_key, handle_value) holds no entry for "probe", which is a key or,
+// if is_prefix is true, a key prefix.
+bool Table::FilterMayMatch(const ReadOptions& options,
+                           const Slice& index_key, const Slice& handle_value,
+                           const Slice& probe, bool is_prefix) {
+  FilterBlockReader* filter = rep_->filter;
+  if (filter != NULL) {
+    Slice input = handle_value;
+    BlockHandle handle;
+    if (!handle.DecodeFrom(&input).ok()) {
+      return true;
+    }
+    return is_prefix ? filter->PrefixMayMatch(handle.offset(), probe)
+                     : filter->KeyMayMatch(handle.offset(), probe);
+  }
+  if (rep_->filter_index_handle_encoding.empty()) {
+    return true;
+  }
+
+  // Find the filter partition covering key
+  Iterator* iter;
+  if (rep_->filter_index_block != NULL) {
+    iter = rep_->filter_index_block->NewIterator(rep_->options.comparator);
+  } else {
+    iter = BlockReader(this, options, rep_->filter_index_handle_encoding);
+  }
+  iter->Seek(index_key);
+  BlockHandle handle;
+  bool found = false;
+  if (iter->Valid()) {
+    Slice input = iter->value();
+    found = handle.DecodeFrom(&input).ok();
+  }
+  delete iter;
+  if (!found) {
+    return true;
+  }
+
+  // Load the partition, through the block cache if there is one
+  Cache* block_cache = rep_->options.block_cache;
+  Cache::Handle* cache_handle = NULL;
+  FilterPartition* partition = NULL;
+  char cache_key_buffer[16];
+  EncodeFixed64(cache_key_buffer, rep_->cache_id);
+  EncodeFixed64(cache_key_buffer+8, handle.offset());
+  Slice cache_key(cache_key_buffer, sizeof(cache_key_buffer));
+  if (block_cache != NULL) {
+    cache_handle = block_cache->Lookup(cache_key);
+  }
+  if (cache_handle != NULL) {
+    partition = reinterpret_cast<FilterPartition*>(
+        block_cache->Value(cache_handle));
+  } else {
+    BlockContents contents;
+    if (!ReadBlock(rep_->file, options, handle, &contents).ok()) {
+      return true;
+    }
+    partition = new FilterPartition(contents);
+    if (block_cache != NULL && contents.cachable && options.fill_cache) {
+      cache_handle = block_cache->Insert(
+          cache_key, partition, contents.data.size(),
+          &DeleteCachedFilterPartition);
+    }
+  }
+
+  const FilterPolicy* policy = rep_->options.filter_policy;
+  const Slice data = partition->contents.data;
+  const bool may_match = is_prefix ? policy->PrefixMayMatch(probe, data)
+                                   : policy->KeyMayMatch(probe, data);
+  if (cache_handle != NULL) {
+    block_cache->Release(cache_handle);
+  } else {
+    delete partition;
+  }
+  return may_match;
+}
+
+bool Table::PrefixMayMatch(const ReadOptions& options,
+                           const Slice& seek_key, const Slice& prefix) {
+  if (rep_->filter == NULL && rep_->filter_index_handle_encoding.empty()) {
+    return true;
+  }
+  // The keys starting with prefix are contiguous and begin at the first
+  // key >= seek_key.  They can only continue into the next block if the
+  // index key separating the two blocks also starts with prefix.
+  Iterator* iiter = NewIndexIterator(options);
+  bool may_match = false;
+  for (iiter->Seek(seek_key); iiter->Valid(); iiter->Next()) {
+    if (FilterMayMatch(options, iiter->key(), iiter->value(), prefix, true)) {
+      may_match = true;
+      break;
+    }
+    if (!iiter->key().starts_with(prefix)) {
+      break;
+    }
+  }
+  if (!iiter->status().ok()) {
+    may_match = true;
+  }
+  delete iiter;
+  return may_match;
+}
+
 Status Table::InternalGet(const ReadOptions& options, const Slice& k,
                           void* arg,
                           void (*saver)(void*, const Slice&, const Slice&)) {
   Status s;
-  Iterator* iiter = rep_->index_block->NewIterator(rep_->options.comparator);
+  Iterator* iiter = NewIndexIterator(options);
   iiter->Seek(k);
   if (iiter->Valid()) {
-    Slice handle_value = iiter->value();
-    FilterBlockReader* filter = rep_->filter;
-    BlockHandle handle;
-    if (filter != NULL &&
-        handle.DecodeFrom(&handle_value).ok() &&
-        !filter->KeyMayMatch(handle.offset(), k)) {
+    if (!FilterMayMatch(options, iiter->key(), iiter->value(), k, false)) {
       // Not found
     } else {
-      Iterator* block_iter = BlockReader(this, options, iiter->value());
+      Iterator* block_iter = BlockReader(this, options, iiter->value(), true);
       block_iter->Seek(k);
       if (block_iter->Valid()) {
         (*saver)(arg, block_iter->key(), block_iter->value());
@@ -256,8 +465,7 @@ Status Table::InternalGet(const ReadOptions& options, const Slice& k,
 
 
 uint64_t Table::ApproximateOffsetOf(const Slice& key) const {
-  Iterator* index_iter =
-      rep_->index_block->NewIterator(rep_->options.comparator);
+  Iterator* index_iter = NewIndexIterator(ReadOptions());
   index_iter->Seek(key);
   uint64_t result;
   if (index_iter->Valid()) {
@@ -30,6 +30,13 @@ struct TableBuilder::Rep {
   bool closed;          // Either Finish() or Abandon() has been called.
   FilterBlockBuilder* filter_block;
 
+  // Used instead of filter_block when options.partition_index_and_filters
+  // is set.  index_block then holds the current index partition, and the
+  // top-level blocks map the last key of each partition to its handle.
+  FilterPartitionBuilder* filter_partition;
+  BlockBuilder top_level_index_block;
+  BlockBuilder top_level_filter_block;
+
   // We do not emit the index entry for a block until we have seen the
   // first key for the next data block.  This allows us to use shorter
   // keys in the index block.  For example, consider a block boundary
@@ -53,10 +60,17 @@ struct TableBuilder::Rep {
         index_block(&index_block_options),
         num_entries(0),
         closed(false),
-        filter_block(opt.filter_policy == NULL ? NULL
+        filter_block(opt.filter_policy == NULL ||
+                     opt.partition_index_and_filters ? NULL
                      : new FilterBlockBuilder(opt.filter_policy)),
+        filter_partition(opt.filter_policy == NULL ||
+                         !opt.partition_index_and_filters ? NULL
+                         : new FilterPartitionBuilder(opt.filter_policy)),
+        top_level_index_block(&index_block_options),
+        top_level_filter_block(&index_block_options),
         pending_index_entry(false) {
     index_block_options.block_restart_interval = 1;
+    index_block_options.data_block_hash_index = false;
   }
 };
 
@@ -70,6 +84,7 @@ TableBuilder::TableBuilder(const Options& options, WritableFile* file)
 TableBuilder::~TableBuilder() {
   assert(rep_->closed);  // Catch errors where caller forgot to call Finish()
   delete rep_->filter_block;
+  delete rep_->filter_partition;
   delete rep_;
 }
 
@@ -80,12 +95,18 @@ Status TableBuilder::ChangeOptions(const Options& options) {
   if (options.comparator != rep_->options.comparator) {
     return Status::InvalidArgument("changing comparator while building table");
   }
+  if (options.partition_index_and_filters !=
+      rep_->options.partition_index_and_filters) {
+    return Status::InvalidArgument(
+        "changing index partitioning while building table");
+  }
 
   // Note that any live BlockBuilders point to rep_->options and therefore
   // will automatically pick up the updated options.
   rep_->options = options;
   rep_->index_block_options = options;
   rep_->index_block_options.block_restart_interval = 1;
+  rep_->index_block_options.data_block_hash_index = false;
   return Status::OK();
 }
 
@@ -104,11 +125,19 @@ void TableBuilder::Add(const Slice& key, const Slice& value) {
     r->pending_handle.EncodeTo(&handle_encoding);
     r->index_block.Add(r->last_key, Slice(handle_encoding));
     r->pending_index_entry = false;
+    if (r->options.partition_index_and_filters &&
+        r->index_block.CurrentSizeEstimate() >=
+            r->options.metadata_block_size) {
+      FlushIndexPartition();
+    }
   }
 
   if (r->filter_block != NULL) {
     r->filter_block->AddKey(key);
   }
+  if (r->filter_partition != NULL) {
+    r->filter_partition->AddKey(key);
+  }
 
   r->last_key.assign(key.data(), key.size());
   r->num_entries++;
@@ -136,6 +165,29 @@ void TableBuilder::Flush() {
   }
 }
 
+// Writes out the current index partition and the filter for the keys it
+// covers, and records both in the top-level blocks under the last key of
+// the partition.
+void TableBuilder::FlushIndexPartition() {
+  Rep* r = rep_;
+  assert(r->options.partition_index_and_filters);
+  if (!ok() || r->index_block.empty()) return;
+  BlockHandle handle;
+  std::string handle_encoding;
+  if (r->filter_partition != NULL) {
+    WriteRawBlock(r->filter_partition->Finish(), kNoCompression, &handle);
+    if (!ok()) return;
+    handle.EncodeTo(&handle_encoding);
+    r->top_level_filter_block.Add(r->last_key, Slice(handle_encoding));
+  }
+  WriteBlock(&r->index_block, &handle);
+  if (ok()) {
+    handle_encoding.clear();
+    handle.EncodeTo(&handle_encoding);
+    r->top_level_index_block.Add(r->last_key, Slice(handle_encoding));
+  }
+}
+
 void TableBuilder::WriteBlock(BlockBuilder* block, BlockHandle* handle) {
   // File format contains a sequence of blocks where each block has:
   //    block_data: uint8[n]
@@ -204,15 +256,31 @@ Status TableBuilder::Finish() {
 
   BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
 
+  // Add the index entry for the last data block
+  if (ok() && r->pending_index_entry) {
+    r->options.comparator->FindShortSuccessor(&r->last_key);
+    std::string handle_encoding;
+    r->pending_handle.EncodeTo(&handle_encoding);
+    r->index_block.Add(r->last_key, Slice(handle_encoding));
+    r->pending_index_entry = false;
+  }
+  if (r->options.partition_index_and_filters) {
+    FlushIndexPartition();
+  }
+
   // Write filter block
   if (ok() && r->filter_block != NULL) {
     WriteRawBlock(r->filter_block->Finish(), kNoCompression,
                   &filter_block_handle);
   }
+  if (ok() && r->filter_partition != NULL) {
+    WriteBlock(&r->top_level_filter_block, &filter_block_handle);
+  }
 
-  // Write metaindex block
+  // Write metaindex block (its keys are not internal keys, so build it
+  // without a hash index)
   if (ok()) {
-    BlockBuilder meta_index_block(&r->options);
+    BlockBuilder meta_index_block(&r->index_block_options);
     if (r->filter_block != NULL) {
       // Add mapping from "filter.Name" to location of filter data
       std::string key = "filter.";
@@ -221,6 +289,17 @@ Status TableBuilder::Finish() {
       filter_block_handle.EncodeTo(&handle_encoding);
       meta_index_block.Add(key, handle_encoding);
     }
+    if (r->options.partition_index_and_filters) {
+      meta_index_block.Add(kPartitionedIndexMetaKey, Slice());
+    }
+    if (r->filter_partition != NULL) {
+      // Add mapping from "partitionedfilter.Name" to the top-level filter
+      std::string key = kPartitionedFilterMetaPrefix;
+      key.append(r->options.filter_policy->Name());
+      std::string handle_encoding;
+      filter_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(key, handle_encoding);
+    }
 
     // TODO(postrelease): Add stats and other meta blocks
     WriteBlock(&meta_index_block, &metaindex_block_handle);
@@ -228,14 +307,11 @@ Status TableBuilder::Finish() {
 
   // Write index block
   if (ok()) {
-    if (r->pending_index_entry) {
-      r->options.comparator->FindShortSuccessor(&r->last_key);
-      std::string handle_encoding;
-      r->pending_handle.EncodeTo(&handle_encoding);
-      r->index_block.Add(r->last_key, Slice(handle_encoding));
-      r->pending_index_entry = false;
+    if (r->options.partition_index_and_filters) {
+      WriteBlock(&r->top_level_index_block, &index_block_handle);
+    } else {
+      WriteBlock(&r->index_block, &index_block_handle);
     }
-    WriteBlock(&r->index_block, &index_block_handle);
   }
 
   // Write footer
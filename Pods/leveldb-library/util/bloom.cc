@@ -4,6 +4,7 @@
 
 #include "leveldb/filter_policy.h"
 
+#include <vector>
 #include "leveldb/slice.h"
 #include "util/hash.h"
 
@@ -86,10 +87,65 @@ class BloomFilterPolicy : public FilterPolicy {
     return true;
   }
 };
+
+// Stores each key and, once per run of keys sharing it, the key's prefix
+// in a single bloom filter.  A key that happens to equal some prefix can
+// only cause false positives.
+class PrefixBloomFilterPolicy : public FilterPolicy {
+ private:
+  BloomFilterPolicy bloom_;
+  const PrefixExtractor* extractor_;
+  std::string name_;
+
+ public:
+  PrefixBloomFilterPolicy(int bits_per_key, const PrefixExtractor* extractor)
+      : bloom_(bits_per_key),
+        extractor_(extractor) {
+    name_ = "leveldb.PrefixBloomFilter.";
+    name_.append(extractor->Name());
+  }
+
+  virtual const char* Name() const {
+    return name_.c_str();
+  }
+
+  virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const {
+    std::vector<Slice> entries(keys, keys + n);
+    Slice last_prefix;
+    bool have_prefix = false;
+    for (int i = 0; i < n; i++) {
+      const size_t length = extractor_->PrefixLength(keys[i]);
+      if (length == 0) {
+        continue;
+      }
+      const Slice prefix(keys[i].data(), length);
+      if (!have_prefix || prefix != last_prefix) {
+        entries.push_back(prefix);
+        last_prefix = prefix;
+        have_prefix = true;
+      }
+    }
+    bloom_.CreateFilter(entries.empty() ? NULL : &entries[0],
+                        static_cast<int>(entries.size()), dst);
+  }
+
+  virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const {
+    return bloom_.KeyMayMatch(key, filter);
+  }
+
+  virtual bool PrefixMayMatch(const Slice& prefix, const Slice& filter) const {
+    return bloom_.KeyMayMatch(prefix, filter);
+  }
+};
 }
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key) {
   return new BloomFilterPolicy(bits_per_key);
 }
 
+const FilterPolicy* NewPrefixBloomFilterPolicy(
+    int bits_per_key, const PrefixExtractor* extractor) {
+  return new PrefixBloomFilterPolicy(bits_per_key, extractor);
+}
+
 }  // namespace leveldb
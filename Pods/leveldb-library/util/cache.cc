@@ -5,6 +5,8 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <atomic>
+#include <new>
 
 #include "leveldb/cache.h"
 #include "port/port.h"
@@ -68,18 +70,22 @@ struct LRUHandle {
 // table implementations in some of the compiler/runtime combinations
 // we have tested.  E.g., readrandom speeds up by ~5% over the g++
 // 4.4.3's builtin hashtable.
+//
+// Handle must provide "next_hash", "hash" and "key()".  Lookup() does not
+// modify the table, so it may run concurrently with other lookups.
+template <class Handle>
 class HandleTable {
  public:
   HandleTable() : length_(0), elems_(0), list_(NULL) { Resize(); }
   ~HandleTable() { delete[] list_; }
 
-  LRUHandle* Lookup(const Slice& key, uint32_t hash) {
+  Handle* Lookup(const Slice& key, uint32_t hash) const {
     return *FindPointer(key, hash);
   }
 
-  LRUHandle* Insert(LRUHandle* h) {
-    LRUHandle** ptr = FindPointer(h->key(), h->hash);
-    LRUHandle* old = *ptr;
+  Handle* Insert(Handle* h) {
+    Handle** ptr = FindPointer(h->key(), h->hash);
+    Handle* old = *ptr;
     h->next_hash = (old == NULL ? NULL : old->next_hash);
     *ptr = h;
     if (old == NULL) {
@@ -93,9 +99,9 @@ class HandleTable {
     return old;
   }
 
-  LRUHandle* Remove(const Slice& key, uint32_t hash) {
-    LRUHandle** ptr = FindPointer(key, hash);
-    LRUHandle* result = *ptr;
+  Handle* Remove(const Slice& key, uint32_t hash) {
+    Handle** ptr = FindPointer(key, hash);
+    Handle* result = *ptr;
     if (result != NULL) {
       *ptr = result->next_hash;
       --elems_;
@@ -108,13 +114,13 @@ class HandleTable {
   // a linked list of cache entries that hash into the bucket.
   uint32_t length_;
   uint32_t elems_;
-  LRUHandle** list_;
+  Handle** list_;
 
   // Return a pointer to slot that points to a cache entry that
   // matches key/hash.  If there is no such cache entry, return a
   // pointer to the trailing slot in the corresponding linked list.
-  LRUHandle** FindPointer(const Slice& key, uint32_t hash) {
-    LRUHandle** ptr = &list_[hash & (length_ - 1)];
+  Handle** FindPointer(const Slice& key, uint32_t hash) const {
+    Handle** ptr = &list_[hash & (length_ - 1)];
     while (*ptr != NULL &&
            ((*ptr)->hash != hash || key != (*ptr)->key())) {
       ptr = &(*ptr)->next_hash;
@@ -127,15 +133,15 @@ class HandleTable {
     while (new_length < elems_) {
       new_length *= 2;
     }
-    LRUHandle** new_list = new LRUHandle*[new_length];
+    Handle** new_list = new Handle*[new_length];
     memset(new_list, 0, sizeof(new_list[0]) * new_length);
     uint32_t count = 0;
     for (uint32_t i = 0; i < length_; i++) {
-      LRUHandle* h = list_[i];
+      Handle* h = list_[i];
       while (h != NULL) {
-        LRUHandle* next = h->next_hash;
+        Handle* next = h->next_hash;
         uint32_t hash = h->hash;
-        LRUHandle** ptr = &new_list[hash & (new_length - 1)];
+        Handle** ptr = &new_list[hash & (new_length - 1)];
         h->next_hash = *ptr;
         *ptr = h;
         h = next;
@@ -194,7 +200,7 @@ class LRUCache {
   // Entries are in use by clients, and have refs >= 2 and in_cache==true.
   LRUHandle in_use_;
 
-  HandleTable table_;
+  HandleTable<LRUHandle> table_;
 };
 
 LRUCache::LRUCache()
@@ -332,12 +338,235 @@ void LRUCache::Prune() {
   }
 }
 
-static const int kNumShardBits = 4;
-static const int kNumShards = 1 << kNumShardBits;
+// CLOCK cache implementation
+//
+// A read-mostly alternative to the LRU cache.  Hits take the shard lock
+// only in shared mode: a lookup bumps the entry's atomic reference count and
+// sets its "usage" bit, and Release() needs no lock at all.  Insert(), Erase()
+// and eviction take the lock exclusively.  Eviction sweeps a clock hand over
+// the circular list of cached entries, skipping entries referenced by clients,
+// giving entries whose usage bit is set a second chance, and evicting the
+// first entry found with the bit clear.
+//
+// An entry's reference count includes one reference held by the cache while
+// the entry is in the hash table.  That reference is only dropped with the
+// lock held exclusively, so a lookup holding the shared lock may safely take
+// a new reference on any entry it finds.
+struct ClockHandle {
+  void* value;
+  void (*deleter)(const Slice&, void* value);
+  ClockHandle* next_hash;
+  ClockHandle* next;  // Circular clock list; protected by the shard lock
+  ClockHandle* prev;
+  size_t charge;
+  size_t key_length;
+  std::atomic<uint32_t> refs;  // References, including cache reference
+  std::atomic<bool> usage;     // Recently looked up; cleared by clock hand
+  bool in_cache;               // Protected by the shard lock
+  uint32_t hash;
+  char key_data[1];   // Beginning of key
+
+  Slice key() const { return Slice(key_data, key_length); }
+};
+
+// A single shard of sharded cache.
+class ClockCache {
+ public:
+  ClockCache();
+  ~ClockCache();
+
+  // Separate from constructor so caller can easily make an array of ClockCache
+  void SetCapacity(size_t capacity) { capacity_ = capacity; }
+
+  // Like Cache methods, but with an extra "hash" parameter.
+  Cache::Handle* Insert(const Slice& key, uint32_t hash,
+                        void* value, size_t charge,
+                        void (*deleter)(const Slice& key, void* value));
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash);
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+  void Prune();
+  size_t TotalCharge() const {
+    ReadLock l(&mutex_);
+    return usage_;
+  }
 
-class ShardedLRUCache : public Cache {
  private:
-  LRUCache shard_[kNumShards];
+  void Unref(ClockHandle* e);
+  bool FinishErase(ClockHandle* e);
+  void EvictIfNeeded();
+
+  // Initialized before use.
+  size_t capacity_;
+
+  // mutex_ protects the following state.  Lookups hold it in shared mode.
+  mutable port::RWMutex mutex_;
+  size_t usage_;
+  size_t entries_;
+
+  // Dummy head of the circular clock list of entries in the cache, and the
+  // next entry the clock hand will examine (&clock_ if the list is empty).
+  ClockHandle clock_;
+  ClockHandle* hand_;
+
+  HandleTable<ClockHandle> table_;
+};
+
+ClockCache::ClockCache()
+    : usage_(0),
+      entries_(0) {
+  clock_.next = &clock_;
+  clock_.prev = &clock_;
+  hand_ = &clock_;
+}
+
+ClockCache::~ClockCache() {
+  for (ClockHandle* e = clock_.next; e != &clock_; ) {
+    ClockHandle* next = e->next;
+    assert(e->in_cache);
+    assert(e->refs.load() == 1);  // Error if caller has an unreleased handle
+    e->in_cache = false;
+    Unref(e);
+    e = next;
+  }
+}
+
+void ClockCache::Unref(ClockHandle* e) {
+  const uint32_t old_refs = e->refs.fetch_sub(1, std::memory_order_acq_rel);
+  assert(old_refs > 0);
+  if (old_refs == 1) {  // Deallocate.
+    assert(!e->in_cache);
+    (*e->deleter)(e->key(), e->value);
+    e->~ClockHandle();
+    free(e);
+  }
+}
+
+Cache::Handle* ClockCache::Lookup(const Slice& key, uint32_t hash) {
+  ReadLock l(&mutex_);
+  ClockHandle* e = table_.Lookup(key, hash);
+  if (e != NULL) {
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+    if (!e->usage.load(std::memory_order_relaxed)) {
+      e->usage.store(true, std::memory_order_relaxed);
+    }
+  }
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+void ClockCache::Release(Cache::Handle* handle) {
+  Unref(reinterpret_cast<ClockHandle*>(handle));
+}
+
+Cache::Handle* ClockCache::Insert(
+    const Slice& key, uint32_t hash, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value)) {
+  WriteLock l(&mutex_);
+
+  ClockHandle* e = new (malloc(sizeof(ClockHandle)-1 + key.size()))
+      ClockHandle;
+  e->value = value;
+  e->deleter = deleter;
+  e->charge = charge;
+  e->key_length = key.size();
+  e->hash = hash;
+  e->in_cache = false;
+  e->refs.store(1, std::memory_order_relaxed);  // for the returned handle.
+  e->usage.store(true, std::memory_order_relaxed);
+  memcpy(e->key_data, key.data(), key.size());
+
+  if (capacity_ > 0) {
+    e->refs.fetch_add(1, std::memory_order_relaxed);  // for the cache's ref.
+    e->in_cache = true;
+    // Insert just behind the hand so the new entry is examined last.
+    e->next = hand_;
+    e->prev = hand_->prev;
+    e->prev->next = e;
+    e->next->prev = e;
+    usage_ += charge;
+    entries_++;
+    FinishErase(table_.Insert(e));
+  } // else don't cache.  (Tests use capacity_==0 to turn off caching.)
+
+  EvictIfNeeded();
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+// If e != NULL, finish removing *e from the cache; it has already been removed
+// from the hash table.  Return whether e != NULL.  Requires mutex_ held
+// exclusively.
+bool ClockCache::FinishErase(ClockHandle* e) {
+  if (e != NULL) {
+    assert(e->in_cache);
+    if (hand_ == e) {
+      hand_ = e->next;
+    }
+    e->next->prev = e->prev;
+    e->prev->next = e->next;
+    e->in_cache = false;
+    usage_ -= e->charge;
+    entries_--;
+    Unref(e);
+  }
+  return e != NULL;
+}
+
+// Requires mutex_ held exclusively.
+void ClockCache::EvictIfNeeded() {
+  // Every entry is visited at most twice (once to clear its usage bit and
+  // once more to evict it) before we give up on a shard whose remaining
+  // entries are all referenced by clients.
+  size_t budget = 2 * entries_;
+  while (usage_ > capacity_ && entries_ > 0 && budget > 0) {
+    budget--;
+    if (hand_ == &clock_) {
+      hand_ = clock_.next;
+    }
+    ClockHandle* e = hand_;
+    hand_ = e->next;
+    if (e->refs.load(std::memory_order_relaxed) > 1) {
+      // In use by a client
+    } else if (e->usage.load(std::memory_order_relaxed)) {
+      e->usage.store(false, std::memory_order_relaxed);  // Second chance
+    } else {
+      bool erased = FinishErase(table_.Remove(e->key(), e->hash));
+      if (!erased) {  // to avoid unused variable when compiled NDEBUG
+        assert(erased);
+      }
+      budget = 2 * entries_;
+    }
+  }
+}
+
+void ClockCache::Erase(const Slice& key, uint32_t hash) {
+  WriteLock l(&mutex_);
+  FinishErase(table_.Remove(key, hash));
+}
+
+void ClockCache::Prune() {
+  WriteLock l(&mutex_);
+  for (ClockHandle* e = clock_.next; e != &clock_; ) {
+    ClockHandle* next = e->next;
+    if (e->refs.load(std::memory_order_relaxed) == 1) {
+      bool erased = FinishErase(table_.Remove(e->key(), e->hash));
+      if (!erased) {  // to avoid unused variable when compiled NDEBUG
+        assert(erased);
+      }
+    }
+    e = next;
+  }
+}
+
+static const int kMaxNumShardBits = 16;
+
+// Spreads entries over 2^num_shard_bits independently locked shards, chosen
+// by the top bits of the key hash.  Shard is LRUCache or ClockCache and
+// Entry the entry type it hands out.
+template <class Shard, class Entry>
+class ShardedCache : public Cache {
+ private:
+  const int num_shard_bits_;
+  Shard* const shard_;
   port::Mutex id_mutex_;
   uint64_t last_id_;
 
@@ -345,61 +574,83 @@ class ShardedLRUCache : public Cache {
     return Hash(s.data(), s.size(), 0);
   }
 
-  static uint32_t Shard(uint32_t hash) {
-    return hash >> (32 - kNumShardBits);
+  static int ClipShardBits(int num_shard_bits) {
+    if (num_shard_bits < 0) return 0;
+    if (num_shard_bits > kMaxNumShardBits) return kMaxNumShardBits;
+    return num_shard_bits;
+  }
+
+  int NumShards() const { return 1 << num_shard_bits_; }
+
+  uint32_t ShardOf(uint32_t hash) const {
+    return (num_shard_bits_ == 0) ? 0 : (hash >> (32 - num_shard_bits_));
   }
 
  public:
-  explicit ShardedLRUCache(size_t capacity)
-      : last_id_(0) {
-    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
-    for (int s = 0; s < kNumShards; s++) {
+  ShardedCache(size_t capacity, int num_shard_bits)
+      : num_shard_bits_(ClipShardBits(num_shard_bits)),
+        shard_(new Shard[1 << num_shard_bits_]),
+        last_id_(0) {
+    const int num_shards = NumShards();
+    const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
+    for (int s = 0; s < num_shards; s++) {
       shard_[s].SetCapacity(per_shard);
     }
   }
-  virtual ~ShardedLRUCache() { }
+  virtual ~ShardedCache() { delete[] shard_; }
   virtual Handle* Insert(const Slice& key, void* value, size_t charge,
                          void (*deleter)(const Slice& key, void* value)) {
     const uint32_t hash = HashSlice(key);
-    return shard_[Shard(hash)].Insert(key, hash, value, charge, deleter);
+    return shard_[ShardOf(hash)].Insert(key, hash, value, charge, deleter);
   }
   virtual Handle* Lookup(const Slice& key) {
     const uint32_t hash = HashSlice(key);
-    return shard_[Shard(hash)].Lookup(key, hash);
+    return shard_[ShardOf(hash)].Lookup(key, hash);
   }
   virtual void Release(Handle* handle) {
-    LRUHandle* h = reinterpret_cast<LRUHandle*>(handle);
-    shard_[Shard(h->hash)].Release(handle);
+    Entry* h = reinterpret_cast<Entry*>(handle);
+    shard_[ShardOf(h->hash)].Release(handle);
   }
   virtual void Erase(const Slice& key) {
     const uint32_t hash = HashSlice(key);
-    shard_[Shard(hash)].Erase(key, hash);
+    shard_[ShardOf(hash)].Erase(key, hash);
   }
   virtual void* Value(Handle* handle) {
-    return reinterpret_cast<LRUHandle*>(handle)->value;
+    return reinterpret_cast<Entry*>(handle)->value;
   }
   virtual uint64_t NewId() {
     MutexLock l(&id_mutex_);
     return ++(last_id_);
   }
   virtual void Prune() {
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < NumShards(); s++) {
       shard_[s].Prune();
     }
   }
   virtual size_t TotalCharge() const {
     size_t total = 0;
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < NumShards(); s++) {
       total += shard_[s].TotalCharge();
     }
     return total;
   }
 };
 
+typedef ShardedCache<LRUCache, LRUHandle> ShardedLRUCache;
+typedef ShardedCache<ClockCache, ClockHandle> ShardedClockCache;
+
 }  // end anonymous namespace
 
 Cache* NewLRUCache(size_t capacity) {
-  return new ShardedLRUCache(capacity);
+  return new ShardedLRUCache(capacity, kDefaultCacheShardBits);
+}
+
+Cache* NewLRUCache(size_t capacity, int num_shard_bits) {
+  return new ShardedLRUCache(capacity, num_shard_bits);
+}
+
+Cache* NewClockCache(size_t capacity, int num_shard_bits) {
+  return new ShardedClockCache(capacity, num_shard_bits);
 }
 
 }  // namespace leveldb
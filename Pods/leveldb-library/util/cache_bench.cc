@@ -0,0 +1,179 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+// Multi-threaded block cache benchmark.  Every thread performs a mix of
+// Lookup()/Release() and Insert() calls against one shared cache, so the
+// cost of the shard locks shows up as the thread count grows.
+//
+//   --cache=lru|clock     cache implementation to benchmark
+//   --shard_bits=N        number of shards is 2^N
+//   --threads=N           number of concurrent threads
+//   --ops=N               operations per thread
+//   --keys=N              number of distinct keys
+//   --capacity=N          cache capacity in entries (each entry costs 1)
+//   --lookup_percent=N    percentage of operations that are lookups
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "leveldb/cache.h"
+#include "leveldb/env.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+#include "util/random.h"
+
+namespace {
+
+const char* FLAGS_cache = "lru";
+int FLAGS_shard_bits = leveldb::kDefaultCacheShardBits;
+int FLAGS_threads = 4;
+int FLAGS_ops = 1000000;
+int FLAGS_keys = 100000;
+int FLAGS_capacity = 50000;
+int FLAGS_lookup_percent = 90;
+
+void Deleter(const leveldb::Slice& key, void* value) {
+}
+
+struct SharedState {
+  leveldb::port::Mutex mu;
+  leveldb::port::CondVar cv;
+  leveldb::Cache* cache;
+  int num_initialized;
+  int num_done;
+  bool start;
+  uint64_t hits;
+
+  SharedState() : cv(&mu), cache(NULL), num_initialized(0), num_done(0),
+                  start(false), hits(0) { }
+};
+
+struct ThreadState {
+  SharedState* shared;
+  int tid;
+};
+
+void ThreadBody(void* arg) {
+  ThreadState* thread = reinterpret_cast<ThreadState*>(arg);
+  SharedState* shared = thread->shared;
+  {
+    leveldb::MutexLock l(&shared->mu);
+    shared->num_initialized++;
+    if (shared->num_initialized >= FLAGS_threads) {
+      shared->cv.SignalAll();
+    }
+    while (!shared->start) {
+      shared->cv.Wait();
+    }
+  }
+
+  leveldb::Random rnd(1000 + thread->tid);
+  leveldb::Cache* cache = shared->cache;
+  uint64_t hits = 0;
+  char buf[4];
+  for (int i = 0; i < FLAGS_ops; i++) {
+    leveldb::EncodeFixed32(buf, rnd.Uniform(FLAGS_keys));
+    const leveldb::Slice key(buf, sizeof(buf));
+    if (static_cast<int>(rnd.Uniform(100)) < FLAGS_lookup_percent) {
+      leveldb::Cache::Handle* h = cache->Lookup(key);
+      if (h != NULL) {
+        hits++;
+        cache->Release(h);
+      }
+    } else {
+      cache->Release(cache->Insert(key, NULL, 1, &Deleter));
+    }
+  }
+
+  leveldb::MutexLock l(&shared->mu);
+  shared->hits += hits;
+  shared->num_done++;
+  if (shared->num_done >= FLAGS_threads) {
+    shared->cv.SignalAll();
+  }
+}
+
+void Run() {
+  leveldb::Env* env = leveldb::Env::Default();
+  SharedState shared;
+  if (strcmp(FLAGS_cache, "clock") == 0) {
+    shared.cache = leveldb::NewClockCache(FLAGS_capacity, FLAGS_shard_bits);
+  } else {
+    shared.cache = leveldb::NewLRUCache(FLAGS_capacity, FLAGS_shard_bits);
+  }
+
+  // Pre-populate so that lookups mostly hit from the start.
+  char buf[4];
+  for (int k = 0; k < FLAGS_keys; k++) {
+    leveldb::EncodeFixed32(buf, k);
+    shared.cache->Release(shared.cache->Insert(
+        leveldb::Slice(buf, sizeof(buf)), NULL, 1, &Deleter));
+  }
+
+  ThreadState* threads = new ThreadState[FLAGS_threads];
+  for (int i = 0; i < FLAGS_threads; i++) {
+    threads[i].shared = &shared;
+    threads[i].tid = i;
+    env->StartThread(&ThreadBody, &threads[i]);
+  }
+
+  uint64_t start_micros;
+  {
+    leveldb::MutexLock l(&shared.mu);
+    while (shared.num_initialized < FLAGS_threads) {
+      shared.cv.Wait();
+    }
+    start_micros = env->NowMicros();
+    shared.start = true;
+    shared.cv.SignalAll();
+    while (shared.num_done < FLAGS_threads) {
+      shared.cv.Wait();
+    }
+  }
+  const uint64_t elapsed = env->NowMicros() - start_micros;
+
+  const double total_ops = static_cast<double>(FLAGS_ops) * FLAGS_threads;
+  const double lookups = total_ops * FLAGS_lookup_percent / 100.0;
+  fprintf(stdout,
+          "%-6s shards=%-5d threads=%-3d : %8.3f micros/op; "
+          "%7.2f Mops/s; hit rate %.1f%%\n",
+          FLAGS_cache, 1 << FLAGS_shard_bits, FLAGS_threads,
+          elapsed * FLAGS_threads / total_ops,
+          total_ops / elapsed,
+          lookups > 0 ? 100.0 * shared.hits / lookups : 0.0);
+
+  delete[] threads;
+  delete shared.cache;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    int n;
+    char junk;
+    if (strncmp(argv[i], "--cache=", 8) == 0) {
+      FLAGS_cache = argv[i] + 8;
+    } else if (sscanf(argv[i], "--shard_bits=%d%c", &n, &junk) == 1) {
+      FLAGS_shard_bits = n;
+    } else if (sscanf(argv[i], "--threads=%d%c", &n, &junk) == 1) {
+      FLAGS_threads = n;
+    } else if (sscanf(argv[i], "--ops=%d%c", &n, &junk) == 1) {
+      FLAGS_ops = n;
+    } else if (sscanf(argv[i], "--keys=%d%c", &n, &junk) == 1) {
+      FLAGS_keys = n;
+    } else if (sscanf(argv[i], "--capacity=%d%c", &n, &junk) == 1) {
+      FLAGS_capacity = n;
+    } else if (sscanf(argv[i], "--lookup_percent=%d%c", &n, &junk) == 1) {
+      FLAGS_lookup_percent = n;
+    } else {
+      fprintf(stderr, "Invalid flag '%s'\n", argv[i]);
+      exit(1);
+    }
+  }
+
+  Run();
+  return 0;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+// CRC32C throughput benchmark.  Compares the portable table-driven code
+// with every hardware kernel the CPU supports, for a range of buffer
+// sizes that covers log records and table blocks.  Each kernel is also
+// checked against the portable result before it is timed.
+//
+//   --sizes=N[,N...]      buffer sizes in bytes
+//   --bytes=N             bytes to checksum per kernel and size
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "leveldb/env.h"
+#include "port/port.h"
+#include "util/crc32c.h"
+#include "util/random.h"
+
+namespace {
+
+const char* FLAGS_sizes = "64,256,1024,4096,16384,65536";
+int FLAGS_bytes = 256 << 20;
+
+struct Kernel {
+  const char* name;
+  leveldb::port::CRC32CFunction function;
+};
+
+uint32_t Portable(uint32_t crc, const char* buf, size_t size) {
+  return leveldb::crc32c::ExtendPortable(crc, buf, size);
+}
+
+uint32_t Dispatched(uint32_t crc, const char* buf, size_t size) {
+  return leveldb::crc32c::Extend(crc, buf, size);
+}
+
+void Run() {
+  static const char* kHardware[] = {
+    "sse42", "sse42_pclmul", "armv8", "armv8_pmull"
+  };
+  std::vector<Kernel> kernels;
+  Kernel portable = { "portable", &Portable };
+  kernels.push_back(portable);
+  for (size_t i = 0; i < sizeof(kHardware) / sizeof(kHardware[0]); i++) {
+    leveldb::port::CRC32CFunction f =
+        leveldb::port::GetCRC32CKernel(kHardware[i]);
+    if (f != NULL) {
+      Kernel k = { kHardware[i], f };
+      kernels.push_back(k);
+    }
+  }
+  Kernel dispatched = { "extend", &Dispatched };
+  kernels.push_back(dispatched);
+
+  std::vector<size_t> sizes;
+  for (const char* p = FLAGS_sizes; p != NULL && *p != '\0'; ) {
+    sizes.push_back(strtoul(p, NULL, 10));
+    p = strchr(p, ',');
+    if (p != NULL) p++;
+  }
+
+  // Odd offset so that the alignment prologue is exercised.
+  size_t max_size = 0;
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] > max_size) max_size = sizes[i];
+  }
+  leveldb::Random rnd(301);
+  std::string data;
+  for (size_t i = 0; i < max_size + 1; i++) {
+    data.push_back(static_cast<char>(rnd.Uniform(256)));
+  }
+  const char* buf = data.data() + 1;
+
+  leveldb::Env* env = leveldb::Env::Default();
+  for (size_t s = 0; s < sizes.size(); s++) {
+    const size_t size = sizes[s];
+    if (size == 0) continue;
+    const uint32_t expected = Portable(0, buf, size);
+    const int iterations = static_cast<int>(FLAGS_bytes / size) + 1;
+    for (size_t k = 0; k < kernels.size(); k++) {
+      if ((*kernels[k].function)(0, buf, size) != expected) {
+        fprintf(stderr, "%s: wrong crc for size %d\n",
+                kernels[k].name, static_cast<int>(size));
+        exit(1);
+      }
+      uint32_t crc = 0;
+      const uint64_t start = env->NowMicros();
+      for (int i = 0; i < iterations; i++) {
+        crc = (*kernels[k].function)(crc, buf, size);
+      }
+      const uint64_t elapsed = env->NowMicros() - start + 1;
+      fprintf(stdout, "%-13s size=%-7d : %9.1f MB/s (crc %08x)\n",
+              kernels[k].name, static_cast<int>(size),
+              (static_cast<double>(size) * iterations / 1048576.0) /
+                  (elapsed * 1e-6),
+              crc);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    int n;
+    char junk;
+    if (strncmp(argv[i], "--sizes=", 8) == 0) {
+      FLAGS_sizes = argv[i] + 8;
+    } else if (sscanf(argv[i], "--bytes=%d%c", &n, &junk) == 1) {
+      FLAGS_bytes = n;
+    } else {
+      fprintf(stderr, "Invalid flag '%s'\n", argv[i]);
+      exit(1);
+    }
+  }
+
+  Run();
+  return 0;
+}
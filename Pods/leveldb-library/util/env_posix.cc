@@ -16,6 +16,7 @@
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
+#include <algorithm>
 #include <deque>
 #include <limits>
 #include <set>
@@ -495,7 +496,16 @@ class PosixEnv : public Env {
     return result;
   }
 
-  virtual void Schedule(void (*function)(void*), void* arg);
+  virtual void Schedule(void (*function)(void*), void* arg) {
+    Schedule(function, arg, kLowPriority);
+  }
+
+  virtual void Schedule(void (*function)(void*), void* arg, Priority pri);
+
+  virtual void SetBackgroundThreads(int number, Priority pri);
+
+  virtual bool GetBackgroundQueueStats(Priority pri,
+                                       BackgroundQueueStats* stats);
 
   virtual void StartThread(void (*function)(void* arg), void* arg);
 
@@ -549,22 +559,45 @@ class PosixEnv : public Env {
     }
   }
 
-  // BGThread() is the body of the background thread
-  void BGThread();
+  // BGThread() is the body of every background thread serving "pri"
+  void BGThread(Priority pri);
+  struct BGThreadArg {
+    PosixEnv* env;
+    Priority pri;
+  };
   static void* BGThreadWrapper(void* arg) {
-    reinterpret_cast<PosixEnv*>(arg)->BGThread();
+    BGThreadArg* thread_arg = reinterpret_cast<BGThreadArg*>(arg);
+    PosixEnv* env = thread_arg->env;
+    const Priority pri = thread_arg->pri;
+    delete thread_arg;
+    env->BGThread(pri);
     return NULL;
   }
 
-  pthread_mutex_t mu_;
-  pthread_cond_t bgsignal_;
-  pthread_t bgthread_;
-  bool started_bgthread_;
-
   // Entry per Schedule() call
-  struct BGItem { void* arg; void (*function)(void*); };
+  struct BGItem {
+    void* arg;
+    void (*function)(void*);
+    uint64_t schedule_micros;
+  };
   typedef std::deque<BGItem> BGQueue;
-  BGQueue queue_;
+
+  // Work queue and threads for one priority.  Threads are started on
+  // demand, up to max_threads, and then run until the process exits.
+  struct BGPool {
+    pthread_cond_t signal;
+    BGQueue queue;
+    int max_threads;
+    int idle_threads;
+    BackgroundQueueStats stats;
+  };
+
+  // Start threads for "pri" while its queue holds more items than there
+  // are idle threads to take them.  REQUIRES: mu_ is held.
+  void MaybeStartBGThreads(Priority pri);
+
+  pthread_mutex_t mu_;  // Protects pools_
+  BGPool pools_[kNumPriorities];
 
   PosixLockTable locks_;
   Limiter mmap_limit_;
@@ -600,52 +633,112 @@ static intptr_t MaxOpenFiles() {
 }
 
 PosixEnv::PosixEnv()
-    : started_bgthread_(false),
-      mmap_limit_(MaxMmaps()),
+    : mmap_limit_(MaxMmaps()),
       fd_limit_(MaxOpenFiles()) {
   PthreadCall("mutex_init", pthread_mutex_init(&mu_, NULL));
-  PthreadCall("cvar_init", pthread_cond_init(&bgsignal_, NULL));
+  for (int i = 0; i < kNumPriorities; i++) {
+    PthreadCall("cvar_init", pthread_cond_init(&pools_[i].signal, NULL));
+    pools_[i].max_threads = 1;
+    pools_[i].idle_threads = 0;
+  }
 }
 
-void PosixEnv::Schedule(void (*function)(void*), void* arg) {
+void PosixEnv::Schedule(void (*function)(void*), void* arg, Priority pri) {
+  assert(pri >= 0 && pri < kNumPriorities);
+  const uint64_t now = NowMicros();
   PthreadCall("lock", pthread_mutex_lock(&mu_));
+  BGPool* pool = &pools_[pri];
 
-  // Start background thread if necessary
-  if (!started_bgthread_) {
-    started_bgthread_ = true;
-    PthreadCall(
-        "create thread",
-        pthread_create(&bgthread_, NULL,  &PosixEnv::BGThreadWrapper, this));
+  // Add to the queue of this priority
+  pool->queue.push_back(BGItem());
+  pool->queue.back().function = function;
+  pool->queue.back().arg = arg;
+  pool->queue.back().schedule_micros = now;
+  pool->stats.scheduled++;
+  pool->stats.queue_depth = pool->queue.size();
+  if (pool->stats.queue_depth > pool->stats.max_queue_depth) {
+    pool->stats.max_queue_depth = pool->stats.queue_depth;
   }
 
-  // If the queue is currently empty, the background thread may currently be
-  // waiting.
-  if (queue_.empty()) {
-    PthreadCall("signal", pthread_cond_signal(&bgsignal_));
+  // Idle threads may currently be waiting.
+  if (pool->idle_threads > 0) {
+    PthreadCall("signal", pthread_cond_signal(&pool->signal));
   }
+  MaybeStartBGThreads(pri);
 
-  // Add to priority queue
-  queue_.push_back(BGItem());
-  queue_.back().function = function;
-  queue_.back().arg = arg;
+  PthreadCall("unlock", pthread_mutex_unlock(&mu_));
+}
 
+void PosixEnv::SetBackgroundThreads(int number, Priority pri) {
+  assert(pri >= 0 && pri < kNumPriorities);
+  PthreadCall("lock", pthread_mutex_lock(&mu_));
+  pools_[pri].max_threads = std::max(number, 1);
+  MaybeStartBGThreads(pri);
   PthreadCall("unlock", pthread_mutex_unlock(&mu_));
 }
 
-void PosixEnv::BGThread() {
+bool PosixEnv::GetBackgroundQueueStats(Priority pri,
+                                       BackgroundQueueStats* stats) {
+  assert(pri >= 0 && pri < kNumPriorities);
+  PthreadCall("lock", pthread_mutex_lock(&mu_));
+  *stats = pools_[pri].stats;
+  PthreadCall("unlock", pthread_mutex_unlock(&mu_));
+  return true;
+}
+
+void PosixEnv::MaybeStartBGThreads(Priority pri) {
+  BGPool* pool = &pools_[pri];
+  while (pool->stats.threads < pool->max_threads &&
+         pool->queue.size() > static_cast<size_t>(pool->idle_threads)) {
+    BGThreadArg* thread_arg = new BGThreadArg;
+    thread_arg->env = this;
+    thread_arg->pri = pri;
+    pthread_t t;
+    PthreadCall(
+        "create thread",
+        pthread_create(&t, NULL,  &PosixEnv::BGThreadWrapper, thread_arg));
+    PthreadCall("detach thread", pthread_detach(t));
+    pool->stats.threads++;
+    pool->idle_threads++;  // Until it takes an item off the queue
+  }
+}
+
+void PosixEnv::BGThread(Priority pri) {
+  BGPool* pool = &pools_[pri];
+  PthreadCall("lock", pthread_mutex_lock(&mu_));
   while (true) {
-    // Wait until there is an item that is ready to run
-    PthreadCall("lock", pthread_mutex_lock(&mu_));
-    while (queue_.empty()) {
-      PthreadCall("wait", pthread_cond_wait(&bgsignal_, &mu_));
+    // Wait until there is an item that is ready to run.  The thread was
+    // counted as idle when it was started or finished its last item.
+    while (pool->queue.empty()) {
+      PthreadCall("wait", pthread_cond_wait(&pool->signal, &mu_));
     }
+    pool->idle_threads--;
 
-    void (*function)(void*) = queue_.front().function;
-    void* arg = queue_.front().arg;
-    queue_.pop_front();
+    void (*function)(void*) = pool->queue.front().function;
+    void* arg = pool->queue.front().arg;
+    const uint64_t schedule_micros = pool->queue.front().schedule_micros;
+    pool->queue.pop_front();
+    pool->stats.queue_depth = pool->queue.size();
+    pool->stats.running++;
 
     PthreadCall("unlock", pthread_mutex_unlock(&mu_));
+    const uint64_t start_micros = NowMicros();
     (*function)(arg);
+    const uint64_t end_micros = NowMicros();
+    PthreadCall("lock", pthread_mutex_lock(&mu_));
+
+    const uint64_t wait_micros =
+        start_micros > schedule_micros ? start_micros - schedule_micros : 0;
+    pool->stats.running--;
+    pool->stats.completed++;
+    pool->stats.total_wait_micros += wait_micros;
+    if (wait_micros > pool->stats.max_wait_micros) {
+      pool->stats.max_wait_micros = wait_micros;
+    }
+    if (end_micros > start_micros) {
+      pool->stats.total_run_micros += end_micros - start_micros;
+    }
+    pool->idle_threads++;
   }
 }
 
@@ -4,8 +4,17 @@
 
 #include "leveldb/filter_policy.h"
 
+#include "leveldb/slice.h"
+
 namespace leveldb {
 
 FilterPolicy::~FilterPolicy() { }
 
+bool FilterPolicy::PrefixMayMatch(const Slice& prefix,
+                                  const Slice& filter) const {
+  return true;
+}
+
+PrefixExtractor::~PrefixExtractor() { }
+
 }  // namespace leveldb
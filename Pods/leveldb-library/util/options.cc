@@ -4,6 +4,7 @@
 
 #include "leveldb/options.h"
 
+#include "leveldb/cache.h"
 #include "leveldb/comparator.h"
 #include "leveldb/env.h"
 
@@ -19,12 +20,21 @@ Options::Options()
       write_buffer_size(4<<20),
       max_open_files(1000),
       block_cache(NULL),
+      block_cache_shard_bits(kDefaultCacheShardBits),
+      block_cache_type(kLRUCache),
       block_size(4096),
       block_restart_interval(16),
+      data_block_hash_index(false),
+      partition_index_and_filters(false),
+      metadata_block_size(4096),
+      pin_top_level_index_and_filter(true),
       max_file_size(2<<20),
       compression(kSnappyCompression),
       reuse_logs(false),
-      filter_policy(NULL) {
+      filter_policy(NULL),
+      max_subcompactions(1),
+      enable_pipelined_write(false),
+      allow_concurrent_memtable_write(false) {
 }
 
 }  // namespace leveldb